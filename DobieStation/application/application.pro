@@ -34,6 +34,9 @@ INSTALLS += target
 
 SOURCES += ../../src/qt/main.cpp \
     ../../src/core/audio/utils.cpp \
+    ../../src/core/audio/audiosink.cpp \
+    ../../src/core/audio/audiostream.cpp \
+    ../../src/core/audio/timestretch.cpp \
     ../../src/core/errors.cpp \
     ../../src/core/ee/emotion.cpp \
     ../../src/core/emulator.cpp \
@@ -45,8 +48,10 @@ SOURCES += ../../src/qt/main.cpp \
     ../../src/core/ee/emotion_special.cpp \
     ../../src/core/gs.cpp \
     ../../src/core/gsregisters.cpp \
+    ../../src/core/gsscanout.cpp \
     ../../src/core/gsthread.cpp \
     ../../src/core/ee/dmac.cpp \
+    ../../src/core/ee/ee_idleloop.cpp \
     ../../src/qt/emuwindow.cpp \
     ../../src/core/gscontext.cpp \
     ../../src/core/ee/emotiondisasm.cpp \
@@ -62,6 +67,8 @@ SOURCES += ../../src/qt/main.cpp \
     ../../src/core/iop/iop_timers.cpp \
     ../../src/core/ee/intc.cpp \
     ../../src/core/iop/cdvd/cdvd.cpp \
+    ../../src/core/iop/cdvd/cdvd_readahead.cpp \
+    ../../src/core/iop/cdvd/cdvd_blockcache.cpp \
     ../../src/core/iop/cdvd/cso_reader.cpp\
     ../../src/core/iop/cdvd/chd_reader.cpp\
     ../../src/core/iop/sio2.cpp \
@@ -76,6 +83,12 @@ SOURCES += ../../src/qt/main.cpp \
     ../../src/core/iop/spu/spu_reverb.cpp \
     ../../src/qt/emuthread.cpp \
     ../../src/core/tests/iop/alu.cpp \
+    ../../src/core/tests/ee/mmi.cpp \
+    ../../src/core/tests/ee/loop.cpp \
+    ../../src/core/tests/gs/sprite.cpp \
+    ../../src/core/tests/ipu/convert.cpp \
+    ../../src/core/tests/vu/flags.cpp \
+    ../../src/core/tests/jit/profiler.cpp \
     ../../src/core/ee/vif.cpp \
     ../../src/core/ee/ipu/ipu.cpp \
     ../../src/core/ee/ipu/vlc_table.cpp \
@@ -98,13 +111,19 @@ SOURCES += ../../src/qt/main.cpp \
     ../../src/core/iop/memcard.cpp \
     ../../src/qt/settings.cpp \
     ../../src/core/jitcommon/jitcache.cpp \
+    ../../src/core/jitcommon/jitprofiler.cpp \
     ../../src/core/jitcommon/emitter64.cpp \
+    ../../src/core/jitcommon/jitfallbacks.cpp \
+    ../../src/core/jitcommon/cpuinfo.cpp \
     ../../src/core/ee/vu_jittrans.cpp \
     ../../src/core/jitcommon/ir_block.cpp \
     ../../src/core/jitcommon/ir_instr.cpp \
     ../../src/core/ee/vu_jit.cpp \
     ../../src/core/ee/vu_jit64.cpp \
     ../../src/core/scheduler.cpp \
+    ../../src/core/trace.cpp \
+    ../../src/core/framepacer.cpp \
+    ../../src/core/guestprofiler.cpp \
     ../../src/qt/renderwidget.cpp \
     ../../src/qt/settingswindow.cpp \
     ../../src/qt/bios.cpp \
@@ -124,6 +143,9 @@ SOURCES += ../../src/qt/main.cpp \
 
 HEADERS += \
     ../../src/core/audio/utils.hpp \
+    ../../src/core/audio/audiosink.hpp \
+    ../../src/core/audio/audiostream.hpp \
+    ../../src/core/audio/timestretch.hpp \
     ../../src/core/errors.hpp \
     ../../src/core/ee/emotion.hpp \
     ../../src/core/emulator.hpp \
@@ -135,7 +157,9 @@ HEADERS += \
     ../../src/core/circularFIFO.hpp \
     ../../src/core/gsthread.hpp \
     ../../src/core/gsregisters.hpp \
+    ../../src/core/gsscanout.hpp \
     ../../src/core/ee/dmac.hpp \
+    ../../src/core/ee/ee_idleloop.hpp \
     ../../src/qt/emuwindow.hpp \
     ../../src/core/gscontext.hpp \
     ../../src/core/ee/emotiondisasm.hpp \
@@ -150,6 +174,8 @@ HEADERS += \
     ../../src/core/iop/iop_timers.hpp \
     ../../src/core/ee/intc.hpp \
     ../../src/core/iop/cdvd/cdvd.hpp \
+    ../../src/core/iop/cdvd/cdvd_readahead.hpp \
+    ../../src/core/iop/cdvd/cdvd_blockcache.hpp \
     ../../src/core/iop/cdvd/cso_reader.hpp\
     ../../src/core/iop/cdvd/chd_reader.hpp\
     ../../src/core/iop/sio2.hpp \
@@ -183,13 +209,20 @@ HEADERS += \
     ../../src/core/iop/memcard.hpp \
     ../../src/qt/settings.hpp \
     ../../src/core/jitcommon/jitcache.hpp \
+    ../../src/core/jitcommon/jitprofiler.hpp \
+    ../../src/core/tests/testcheck.hpp \
     ../../src/core/jitcommon/emitter64.hpp \
+    ../../src/core/jitcommon/jitfallbacks.hpp \
+    ../../src/core/jitcommon/cpuinfo.hpp \
     ../../src/core/ee/vu_jittrans.hpp \
     ../../src/core/jitcommon/ir_block.hpp \
     ../../src/core/jitcommon/ir_instr.hpp \
     ../../src/core/ee/vu_jit.hpp \
     ../../src/core/ee/vu_jit64.hpp \
     ../../src/core/scheduler.hpp \
+    ../../src/core/trace.hpp \
+    ../../src/core/framepacer.hpp \
+    ../../src/core/guestprofiler.hpp \
     ../../src/qt/renderwidget.hpp \
     ../../src/qt/settingswindow.hpp \
     ../../src/qt/bios.hpp \
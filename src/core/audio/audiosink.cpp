@@ -0,0 +1,85 @@
+#include <chrono>
+#include <vector>
+#include "audiosink.hpp"
+
+ClockedAudioSink::ClockedAudioSink() : running(false), stream(nullptr)
+{
+
+}
+
+ClockedAudioSink::~ClockedAudioSink()
+{
+    close();
+}
+
+void ClockedAudioSink::open(AudioStream* stream)
+{
+    close();
+    this->stream = stream;
+    running = true;
+    thread = std::thread(&ClockedAudioSink::worker_loop, this);
+}
+
+void ClockedAudioSink::close()
+{
+    running = false;
+    if (thread.joinable())
+        thread.join();
+}
+
+//Samples are requested by elapsed time rather than per period, so sleep jitter doesn't add up to drift
+void ClockedAudioSink::worker_loop()
+{
+    using namespace std::chrono;
+
+    std::vector<stereo_sample> samples;
+    steady_clock::time_point start = steady_clock::now();
+    uint64_t samples_played = 0;
+
+    while (running)
+    {
+        std::this_thread::sleep_for(milliseconds(PERIOD_MS));
+
+        auto elapsed = duration_cast<microseconds>(steady_clock::now() - start).count();
+        uint64_t due = (uint64_t)elapsed * stream->get_sample_rate() / 1000000;
+        int count = (int)(due - samples_played);
+
+        samples.resize(count);
+        stream->read(samples.data(), count);
+        write(samples.data(), count);
+        samples_played = due;
+    }
+}
+
+NullAudioSink::~NullAudioSink()
+{
+    close();
+}
+
+void NullAudioSink::write(const stereo_sample* samples, int count)
+{
+
+}
+
+WAVAudioSink::WAVAudioSink(std::string filename) : filename(filename)
+{
+
+}
+
+WAVAudioSink::~WAVAudioSink()
+{
+    close();
+}
+
+void WAVAudioSink::open(AudioStream* stream)
+{
+    close();
+    writer.reset(new WAVWriter(filename));
+    ClockedAudioSink::open(stream);
+}
+
+void WAVAudioSink::write(const stereo_sample* samples, int count)
+{
+    for (int i = 0; i < count; i++)
+        writer->append_pcm_stereo(samples[i]);
+}
@@ -0,0 +1,68 @@
+#ifndef AUDIOSINK_HPP
+#define AUDIOSINK_HPP
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include "audiostream.hpp"
+#include "utils.hpp"
+
+/**
+Destination for the emulator's audio. A sink pulls samples from the AudioStream with
+AudioStream::read on its own thread, at the rate of whatever it plays to. Audio backends in
+the frontend derive from this; the sinks here run on the wall clock so audio can be
+consumed without any device.
+**/
+
+class AudioSink
+{
+    public:
+        virtual ~AudioSink() {}
+
+        virtual void open(AudioStream* stream) = 0;
+        virtual void close() = 0;
+};
+
+class ClockedAudioSink : public AudioSink
+{
+    private:
+        constexpr static int PERIOD_MS = 10;
+
+        std::thread thread;
+        std::atomic_bool running;
+        AudioStream* stream;
+
+        void worker_loop();
+    protected:
+        virtual void write(const stereo_sample* samples, int count) = 0;
+    public:
+        ClockedAudioSink();
+        ~ClockedAudioSink();
+
+        void open(AudioStream* stream) override;
+        void close() override;
+};
+
+class NullAudioSink : public ClockedAudioSink
+{
+    protected:
+        void write(const stereo_sample* samples, int count) override;
+    public:
+        ~NullAudioSink();
+};
+
+class WAVAudioSink : public ClockedAudioSink
+{
+    private:
+        std::unique_ptr<WAVWriter> writer;
+        std::string filename;
+    protected:
+        void write(const stereo_sample* samples, int count) override;
+    public:
+        WAVAudioSink(std::string filename);
+        ~WAVAudioSink();
+
+        void open(AudioStream* stream) override;
+};
+
+#endif // AUDIOSINK_HPP
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <thread>
+#include "audiostream.hpp"
+
+PCMRing::PCMRing(size_t capacity_log2) :
+    buffer(new stereo_sample[(size_t)1 << capacity_log2]),
+    mask(((size_t)1 << capacity_log2) - 1),
+    head(0),
+    tail(0)
+{
+
+}
+
+size_t PCMRing::capacity() const
+{
+    return mask + 1;
+}
+
+size_t PCMRing::size() const
+{
+    return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+}
+
+size_t PCMRing::push(const stereo_sample* samples, size_t count)
+{
+    size_t cur_tail = tail.load(std::memory_order_relaxed);
+    size_t free_space = capacity() - (cur_tail - head.load(std::memory_order_acquire));
+    count = std::min(count, free_space);
+
+    for (size_t i = 0; i < count; i++)
+        buffer[(cur_tail + i) & mask] = samples[i];
+
+    tail.store(cur_tail + count, std::memory_order_release);
+    return count;
+}
+
+size_t PCMRing::pop(stereo_sample* samples, size_t count)
+{
+    size_t cur_head = head.load(std::memory_order_relaxed);
+    count = std::min(count, tail.load(std::memory_order_acquire) - cur_head);
+
+    for (size_t i = 0; i < count; i++)
+        samples[i] = buffer[(cur_head + i) & mask];
+
+    head.store(cur_head + count, std::memory_order_release);
+    return count;
+}
+
+void PCMRing::clear()
+{
+    head.store(0);
+    tail.store(0);
+}
+
+AudioStream::AudioStream() : ring(14), active(false), pushing(0), stretch_enabled(true)
+{
+    reset();
+}
+
+void AudioStream::reset()
+{
+    ring.clear();
+    stretcher.reset();
+    tempo = 1.0;
+    stretcher_level = 0;
+    dropped_samples = 0;
+    underrun_samples = 0;
+}
+
+void AudioStream::set_active(bool active)
+{
+    //Both sides use sequentially consistent operations. Otherwise this load could be ordered before
+    //the store, missing a push that still saw the stream as active.
+    this->active.store(active);
+    if (!active)
+    {
+        while (pushing.load())
+            std::this_thread::yield();
+    }
+}
+
+void AudioStream::set_time_stretch(bool enabled)
+{
+    stretch_enabled = enabled;
+}
+
+uint64_t AudioStream::get_dropped_samples() const
+{
+    return dropped_samples.load(std::memory_order_relaxed);
+}
+
+uint64_t AudioStream::get_underrun_samples() const
+{
+    return underrun_samples.load(std::memory_order_relaxed);
+}
+
+int AudioStream::buffered_samples() const
+{
+    return (int)ring.size() + stretcher_level.load(std::memory_order_relaxed);
+}
+
+/**
+Scale for the frontend's target frame rate. A buffer running dry asks for slightly faster
+emulation and an overfull one for slightly slower, so emulation settles at the sink's clock
+instead of the two drifting apart. The range is kept small enough that the speed change
+itself isn't noticeable.
+**/
+double AudioStream::get_pacing_factor() const
+{
+    if (!active.load(std::memory_order_relaxed))
+        return 1.0;
+
+    double error = (double)(TARGET_LATENCY - buffered_samples()) / TARGET_LATENCY;
+    error = std::max(-1.0, std::min(error, 1.0));
+    return 1.0 + error * 0.02;
+}
+
+int AudioStream::read(stereo_sample* samples, int count)
+{
+    int read = 0;
+    if (!stretch_enabled)
+        read = (int)ring.pop(samples, count);
+    else
+    {
+        //Only take as much as this read and the target latency need. Anything more stays in the ring,
+        //which drops samples once full, so the stretcher's buffers never grow past the target.
+        while (stretcher.output_size() < count ||
+               stretcher.input_size() + stretcher.output_size() < TARGET_LATENCY)
+        {
+            int popped = (int)ring.pop(read_buffer, MAX_READ);
+            if (!popped)
+                break;
+            stretcher.put_samples(read_buffer, popped);
+        }
+
+        //Play back at the speed that brings the buffer to its target. The ratio is smoothed so that
+        //bursty delivery, such as a whole frame of samples at once, doesn't wobble the pitch.
+        int level = (int)ring.size() + stretcher.input_size() + stretcher.output_size();
+        double target_tempo = std::max(0.5, std::min((double)level / TARGET_LATENCY, 2.0));
+        tempo += (target_tempo - tempo) * 0.05;
+        stretcher.set_tempo(tempo);
+
+        read = stretcher.receive_samples(samples, count);
+        stretcher_level.store(stretcher.input_size() + stretcher.output_size(), std::memory_order_relaxed);
+    }
+
+    if (read < count)
+    {
+        underrun_samples.fetch_add(count - read, std::memory_order_relaxed);
+        std::fill(samples + read, samples + count, stereo_sample());
+    }
+    return read;
+}
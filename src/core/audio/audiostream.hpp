@@ -0,0 +1,106 @@
+#ifndef AUDIOSTREAM_HPP
+#define AUDIOSTREAM_HPP
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include "../iop/spu/spu_utils.hpp"
+#include "timestretch.hpp"
+
+/**
+Single-producer single-consumer ring of stereo PCM. The emulator thread pushes and the
+audio sink's thread pops; neither side ever blocks. The indices only ever grow, so the
+fill level is just the difference between them.
+**/
+
+class PCMRing
+{
+    private:
+        std::unique_ptr<stereo_sample[]> buffer;
+        size_t mask;
+
+        alignas(64) std::atomic<size_t> head; //consumer
+        alignas(64) std::atomic<size_t> tail; //producer
+    public:
+        PCMRing(size_t capacity_log2);
+
+        size_t capacity() const;
+        size_t size() const;
+
+        //Producer only. Returns how many samples fit.
+        size_t push(const stereo_sample* samples, size_t count);
+
+        //Consumer only. Returns how many samples were read.
+        size_t pop(stereo_sample* samples, size_t count);
+
+        //Only safe while neither side is running
+        void clear();
+};
+
+/**
+Real-time output of the final SPU2 mix. The emulator pushes samples at whatever speed it
+runs; a sink pulls them at the rate of its audio device. With time-stretching enabled the
+buffered audio is played faster or slower to keep the buffer near its target latency
+instead of dropping or repeating samples.
+**/
+
+class AudioStream
+{
+    private:
+        constexpr static int SAMPLE_RATE = 48000;
+        constexpr static int TARGET_LATENCY = SAMPLE_RATE / 10; //100 ms
+        constexpr static int MAX_READ = 1024;
+
+        PCMRing ring;
+        std::atomic_bool active;
+        std::atomic<int> pushing;
+
+        //Consumer side
+        bool stretch_enabled;
+        TimeStretcher stretcher;
+        double tempo;
+        stereo_sample read_buffer[MAX_READ];
+        std::atomic<int> stretcher_level;
+
+        std::atomic<uint64_t> dropped_samples;
+        std::atomic<uint64_t> underrun_samples;
+
+        int buffered_samples() const;
+    public:
+        AudioStream();
+
+        //Emulator thread
+        void push(stereo_sample sample);
+        double get_pacing_factor() const;
+
+        //Sink thread
+        int read(stereo_sample* samples, int count);
+
+        //Deactivating waits for a push in progress, after which the ring can be reset
+        void set_active(bool active);
+        void set_time_stretch(bool enabled);
+        void reset();
+
+        int get_sample_rate() const;
+        uint64_t get_dropped_samples() const;
+        uint64_t get_underrun_samples() const;
+};
+
+inline void AudioStream::push(stereo_sample sample)
+{
+    //Announced before checking active, so set_active(false) either sees this push or stops it
+    pushing.fetch_add(1);
+    if (active.load())
+    {
+        //Running ahead of the sink is never allowed to stall emulation
+        if (!ring.push(&sample, 1))
+            dropped_samples.fetch_add(1, std::memory_order_relaxed);
+    }
+    pushing.fetch_sub(1, std::memory_order_release);
+}
+
+inline int AudioStream::get_sample_rate() const
+{
+    return SAMPLE_RATE;
+}
+
+#endif // AUDIOSTREAM_HPP
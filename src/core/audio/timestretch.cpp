@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cmath>
+#include "timestretch.hpp"
+
+TimeStretcher::TimeStretcher()
+{
+    reset();
+}
+
+void TimeStretcher::reset()
+{
+    input.clear();
+    output.clear();
+    tempo = 1.0;
+    skip_fraction = 0.0;
+    first_sequence = true;
+}
+
+void TimeStretcher::set_tempo(double tempo)
+{
+    this->tempo = tempo;
+}
+
+int TimeStretcher::input_size() const
+{
+    return (int)input.size();
+}
+
+int TimeStretcher::output_size() const
+{
+    return (int)output.size();
+}
+
+void TimeStretcher::put_samples(const stereo_sample* samples, int count)
+{
+    input.insert(input.end(), samples, samples + count);
+    process();
+}
+
+int TimeStretcher::receive_samples(stereo_sample* samples, int count)
+{
+    count = std::min(count, output_size());
+    std::copy(output.begin(), output.begin() + count, samples);
+
+    //Drop what has been played so the buffer only ever holds unread output
+    output.erase(output.begin(), output.begin() + count);
+    return count;
+}
+
+//Normalized cross-correlation of the last sequence's tail against every position in the seek window
+int TimeStretcher::find_best_offset() const
+{
+    int best_offset = SEEK / 2;
+    float best_corr = -1.0e30f;
+
+    for (int offset = 0; offset < SEEK; offset++)
+    {
+        float corr = 0.0f, norm = 0.0f;
+        const stereo_sample* candidate = &input[offset];
+        for (int i = 0; i < OVERLAP; i++)
+        {
+            float mono = (float)candidate[i].left + candidate[i].right;
+            corr += mono * overlap_mono[i];
+            norm += mono * mono;
+        }
+
+        corr /= std::sqrt(norm + 1.0f);
+        if (corr > best_corr)
+        {
+            best_corr = corr;
+            best_offset = offset;
+        }
+    }
+    return best_offset;
+}
+
+void TimeStretcher::process()
+{
+    //Above a tempo of about 1.7 one step skips past the end of the seek window, so wait for that much too
+    while ((int)input.size() >= std::max(SEEK + SEQUENCE, (int)(tempo * STEP + skip_fraction)))
+    {
+        //The tail of the previous sequence lines up with the middle of the seek window when the input
+        //advances by exactly one step, so the search is centred there
+        int offset = first_sequence ? SEEK / 2 : find_best_offset();
+        const stereo_sample* sequence = &input[offset];
+
+        if (first_sequence)
+            output.insert(output.end(), sequence, sequence + OVERLAP);
+        else
+        {
+            for (int i = 0; i < OVERLAP; i++)
+            {
+                stereo_sample mixed;
+                mixed.left = clamp16((overlap_buffer[i].left * (OVERLAP - i) + sequence[i].left * i) / OVERLAP);
+                mixed.right = clamp16((overlap_buffer[i].right * (OVERLAP - i) + sequence[i].right * i) / OVERLAP);
+                output.push_back(mixed);
+            }
+        }
+
+        output.insert(output.end(), sequence + OVERLAP, sequence + STEP);
+
+        for (int i = 0; i < OVERLAP; i++)
+        {
+            overlap_buffer[i] = sequence[STEP + i];
+            overlap_mono[i] = (float)overlap_buffer[i].left + overlap_buffer[i].right;
+        }
+        first_sequence = false;
+
+        double skip = tempo * STEP + skip_fraction;
+        int skip_int = (int)skip;
+        skip_fraction = skip - skip_int;
+        input.erase(input.begin(), input.begin() + skip_int);
+    }
+}
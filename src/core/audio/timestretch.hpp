@@ -0,0 +1,47 @@
+#ifndef TIMESTRETCH_HPP
+#define TIMESTRETCH_HPP
+#include <vector>
+#include "../iop/spu/spu_utils.hpp"
+
+/**
+WSOLA time-stretcher. Output is built from overlapping sequences of the input; each new
+sequence is taken from wherever in a small seek window it lines up best with the tail of
+the last one, then cross-faded in. Changing how far the input advances per sequence changes
+the playback speed without changing pitch.
+**/
+
+class TimeStretcher
+{
+    private:
+        constexpr static int SEQUENCE = 1920; //40 ms
+        constexpr static int OVERLAP = 384; //8 ms
+        constexpr static int SEEK = 720; //15 ms
+        constexpr static int STEP = SEQUENCE - OVERLAP;
+
+        std::vector<stereo_sample> input, output;
+
+        stereo_sample overlap_buffer[OVERLAP];
+        float overlap_mono[OVERLAP];
+
+        double tempo;
+        double skip_fraction;
+        bool first_sequence;
+
+        int find_best_offset() const;
+        void process();
+    public:
+        TimeStretcher();
+
+        void reset();
+
+        //Above 1 plays faster and consumes more input per output sample
+        void set_tempo(double tempo);
+
+        void put_samples(const stereo_sample* samples, int count);
+        int receive_samples(stereo_sample* samples, int count);
+
+        int input_size() const;
+        int output_size() const;
+};
+
+#endif // TIMESTRETCH_HPP
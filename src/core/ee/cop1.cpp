@@ -1,8 +1,7 @@
 #include <cmath>
 #include <cstdio>
 #include "cop1.hpp"
-
-#define printf(fmt, ...)(0)
+#include "../trace.hpp"
 
 Cop1::Cop1()
 {
@@ -29,7 +28,7 @@ void Cop1::check_overflow(uint32_t& dest, bool set_flags)
 {
     if ((dest & ~0x80000000) == 0x7F800000)
     {
-        printf("[FPU] Overflow Dest = %x\n", dest);
+        TRACE_DEBUG(Trace::EE, "[FPU] Overflow Dest = %x\n", dest);
         dest = (dest & 0x80000000) | 0x7F7FFFFF;
        
         if (set_flags)
@@ -49,7 +48,7 @@ void Cop1::check_underflow(uint32_t& dest, bool set_flags)
 {
     if ((dest & 0x7F800000) == 0 && (dest & 0x7FFFFF) != 0)
     {
-        printf("[FPU] Underflow Dest = %x\n", dest);
+        TRACE_DEBUG(Trace::EE, "[FPU] Underflow Dest = %x\n", dest);
         dest &= 0x80000000;
         
         if (set_flags)
@@ -150,7 +149,7 @@ uint32_t Cop1::get_gpr(int index)
 
 void Cop1::mtc(int index, uint32_t value)
 {
-    printf("[FPU] MTC1: %d, $%08X\n", index, value);
+    TRACE_DEBUG(Trace::EE, "[FPU] MTC1: %d, $%08X\n", index, value);
     gpr[index].u = value;
 }
 
@@ -172,7 +171,7 @@ uint32_t Cop1::cfc(int index)
             reg |= control.d << 16;
             reg |= control.i << 17;
             reg |= control.condition << 23;
-            printf("[FPU] Read Control Flag %x\n", control.condition);
+            TRACE_DEBUG(Trace::EE, "[FPU] Read Control Flag %x\n", control.condition);
             return reg;
         default:
             return 0;
@@ -181,7 +180,7 @@ uint32_t Cop1::cfc(int index)
 
 void Cop1::ctc(int index, uint32_t value)
 {
-    printf("[FPU] CTC1: $%08X (%d)\n", value, index);
+    TRACE_DEBUG(Trace::EE, "[FPU] CTC1: $%08X (%d)\n", value, index);
     switch (index)
     {
         case 31:
@@ -202,7 +201,7 @@ void Cop1::cvt_s_w(int dest, int source)
 {
     gpr[dest].f = (float)gpr[source].s;
     gpr[dest].f = convert(gpr[dest].u);
-    printf("[FPU] CVT_S_W: %f(%d)\n", gpr[dest].f, dest);
+    TRACE_DEBUG(Trace::EE, "[FPU] CVT_S_W: %f(%d)\n", gpr[dest].f, dest);
 }
 
 void Cop1::cvt_w_s(int dest, int source)
@@ -213,7 +212,7 @@ void Cop1::cvt_w_s(int dest, int source)
         gpr[dest].u = 0x7FFFFFFF;
     else
         gpr[dest].u = 0x80000000;
-    printf("[FPU] CVT_W_S: $%08X(%d)\n", gpr[dest].u, dest);
+    TRACE_DEBUG(Trace::EE, "[FPU] CVT_W_S: $%08X(%d)\n", gpr[dest].u, dest);
 }
 
 void Cop1::add_s(int dest, int reg1, int reg2)
@@ -222,12 +221,15 @@ void Cop1::add_s(int dest, int reg1, int reg2)
     float op2 = convert(gpr[reg2].u);
     gpr[dest].f = op1 + op2;*/
 
-    gpr[dest].f = accurate_add_sub(gpr[reg1].u, gpr[reg2].u, false);
+    //Kept for the trace, dest may be one of the sources
+    uint32_t op1 = gpr[reg1].u;
+    uint32_t op2 = gpr[reg2].u;
+    gpr[dest].f = accurate_add_sub(op1, op2, false);
 
     check_overflow(gpr[dest].u, true);
     check_underflow(gpr[dest].u, true);
 
-    printf("[FPU] add.s: %f(%d) + %f(%d) = %f(%d)\n", op1, reg1, op2, reg2, gpr[dest].f, dest);
+    TRACE_DEBUG(Trace::EE, "[FPU] add.s: %f(%d) + %f(%d) = %f(%d)\n", convert(op1), reg1, convert(op2), reg2, gpr[dest].f, dest);
 }
 
 void Cop1::sub_s(int dest, int reg1, int reg2)
@@ -236,12 +238,15 @@ void Cop1::sub_s(int dest, int reg1, int reg2)
     float op2 = convert(gpr[reg2].u);
     gpr[dest].f = op1 - op2;*/
 
-    gpr[dest].f = accurate_add_sub(gpr[reg1].u, gpr[reg2].u, true);
+    //Kept for the trace, dest may be one of the sources
+    uint32_t op1 = gpr[reg1].u;
+    uint32_t op2 = gpr[reg2].u;
+    gpr[dest].f = accurate_add_sub(op1, op2, true);
 
     check_overflow(gpr[dest].u, true);
     check_underflow(gpr[dest].u, true);
 
-    printf("[FPU] sub.s: %f(%d) - %f(%d) = %f(%d)\n", op1, reg1, op2, reg2, gpr[dest].f, dest);
+    TRACE_DEBUG(Trace::EE, "[FPU] sub.s: %f(%d) - %f(%d) = %f(%d)\n", convert(op1), reg1, convert(op2), reg2, gpr[dest].f, dest);
 }
 
 void Cop1::mul_s(int dest, int reg1, int reg2)
@@ -252,7 +257,7 @@ void Cop1::mul_s(int dest, int reg1, int reg2)
 
     check_overflow(gpr[dest].u, true);
     check_underflow(gpr[dest].u, true);
-    printf("[FPU] mul.s: %f(%d) * %f(%d) = %f(%d)\n", op1, reg1, op2, reg2, gpr[dest].f, dest);
+    TRACE_DEBUG(Trace::EE, "[FPU] mul.s: %f(%d) * %f(%d) = %f(%d)\n", op1, reg1, op2, reg2, gpr[dest].f, dest);
 }
 
 void Cop1::div_s(int dest, int reg1, int reg2)
@@ -263,13 +268,13 @@ void Cop1::div_s(int dest, int reg1, int reg2)
     {
         if ((numerator & 0x7F800000) == 0)
         {
-            printf("[FPU] DIV 0/0 Fs = %x Ft = %x\n", numerator, denominator);
+            TRACE_DEBUG(Trace::EE, "[FPU] DIV 0/0 Fs = %x Ft = %x\n", numerator, denominator);
             control.i = true;
             control.si = true;
         }
         else
         {
-            printf("[FPU] DIV #/0 Fs = %x Ft = %x\n", numerator, denominator);
+            TRACE_DEBUG(Trace::EE, "[FPU] DIV #/0 Fs = %x Ft = %x\n", numerator, denominator);
             control.d = true;
             control.sd = true;
         }
@@ -282,19 +287,20 @@ void Cop1::div_s(int dest, int reg1, int reg2)
     check_overflow(gpr[dest].u, false);
     check_underflow(gpr[dest].u, false);
 
-    printf("[FPU] div.s: %f(%d) / %f(%d) = %f(%d)\n", convert(numerator), reg1, convert(denominator), reg2,
+    TRACE_DEBUG(Trace::EE, "[FPU] div.s: %f(%d) / %f(%d) = %f(%d)\n", convert(numerator), reg1, convert(denominator), reg2,
            gpr[dest].f, dest);
 }
 
 void Cop1::sqrt_s(int dest, int source)
 {
+    float op = gpr[source].f;
     if ((gpr[source].u & 0x7F800000) == 0)
         gpr[dest].u = gpr[source].u & 0x80000000;
     else
     {
         if (gpr[source].u & 0x80000000)
         {
-            printf("[FPU] Negative Sqrt Fs = %x\n", gpr[source].u);
+            TRACE_DEBUG(Trace::EE, "[FPU] Negative Sqrt Fs = %x\n", gpr[source].u);
             control.i = true;
             control.si = true;
         }
@@ -303,37 +309,41 @@ void Cop1::sqrt_s(int dest, int source)
     }
 
     control.d = false;
-    printf("[FPU] sqrt.s: %f(%d) = %f(%d)\n", gpr[source].f, source, gpr[dest].f, dest);
+    TRACE_DEBUG(Trace::EE, "[FPU] sqrt.s: %f(%d) = %f(%d)\n", op, source, gpr[dest].f, dest);
 }
 
 void Cop1::abs_s(int dest, int source)
 {
+    float op = gpr[source].f;
     gpr[dest].u = gpr[source].u & 0x7FFFFFFF;
 
     control.u = false;
     control.o = false;
 
-    printf("[FPU] abs.s: %f = -%f\n", gpr[source].f, gpr[dest].f);
+    TRACE_DEBUG(Trace::EE, "[FPU] abs.s: %f = -%f\n", op, gpr[dest].f);
 }
 
 void Cop1::mov_s(int dest, int source)
 {
     gpr[dest].u = gpr[source].u;
-    printf("[FPU] mov.s: %d = %d", source, dest);
+    TRACE_DEBUG(Trace::EE, "[FPU] mov.s: %d = %d", source, dest);
 }
 
 void Cop1::neg_s(int dest, int source)
 {
+    float op = gpr[source].f;
     gpr[dest].u = gpr[source].u ^ 0x80000000;
 
     control.u = false;
     control.o = false;
 
-    printf("[FPU] neg.s: %f = -%f\n", gpr[source].f, gpr[dest].f);
+    TRACE_DEBUG(Trace::EE, "[FPU] neg.s: %f = -%f\n", op, gpr[dest].f);
 }
 
 void Cop1::rsqrt_s(int dest, int reg1, int reg2)
 {
+    float op1 = gpr[reg1].f;
+    float op2 = gpr[reg2].f;
     if ((gpr[reg2].u & 0x7F800000) == 0)
     {
         gpr[dest].u = (gpr[reg1].u & 0x80000000) | 0x7F7FFFFF;
@@ -345,7 +355,7 @@ void Cop1::rsqrt_s(int dest, int reg1, int reg2)
     {
         if (gpr[reg2].u & 0x80000000)
         {
-            printf("[FPU] Negative RSqrt Fs = %x\n", gpr[reg2].u);
+            TRACE_DEBUG(Trace::EE, "[FPU] Negative RSqrt Fs = %x\n", gpr[reg2].u);
             control.i = true;
             control.si = true;
         }
@@ -357,7 +367,7 @@ void Cop1::rsqrt_s(int dest, int reg1, int reg2)
     control.d = false;
     check_overflow(gpr[dest].u, false);
     check_underflow(gpr[dest].u, false);
-    printf("[FPU] rsqrt.s: %f(%d) = %f(%d)\n", gpr[source].f, source, gpr[dest].f, dest);
+    TRACE_DEBUG(Trace::EE, "[FPU] rsqrt.s: %f(%d) / sqrt(%f(%d)) = %f(%d)\n", op1, reg1, op2, reg2, gpr[dest].f, dest);
 }
 
 
@@ -369,7 +379,7 @@ void Cop1::adda_s(int reg1, int reg2)
 
     check_overflow(accumulator.u, true);
     check_underflow(accumulator.u, true);
-    printf("[FPU] adda.s: %f + %f = %f\n", op1, op2, accumulator.f);
+    TRACE_DEBUG(Trace::EE, "[FPU] adda.s: %f + %f = %f\n", op1, op2, accumulator.f);
 }
 
 void Cop1::suba_s(int reg1, int reg2)
@@ -381,7 +391,7 @@ void Cop1::suba_s(int reg1, int reg2)
     check_overflow(accumulator.u, true);
     check_underflow(accumulator.u, true);
 
-    printf("[FPU] suba.s: %f - %f = %f\n", op1, op2, accumulator.f);
+    TRACE_DEBUG(Trace::EE, "[FPU] suba.s: %f - %f = %f\n", op1, op2, accumulator.f);
 }
 
 void Cop1::mula_s(int reg1, int reg2)
@@ -392,7 +402,7 @@ void Cop1::mula_s(int reg1, int reg2)
 
     check_overflow(accumulator.u, true);
     check_underflow(accumulator.u, true);
-    printf("[FPU] mula.s: %f * %f = %f\n", op1, op2, accumulator.f);
+    TRACE_DEBUG(Trace::EE, "[FPU] mula.s: %f * %f = %f\n", op1, op2, accumulator.f);
 }
 
 void Cop1::madd_s(int dest, int reg1, int reg2)
@@ -404,7 +414,7 @@ void Cop1::madd_s(int dest, int reg1, int reg2)
     
     check_overflow(gpr[dest].u, true);
     check_underflow(gpr[dest].u, true);
-    printf("[FPU] madd.s: %f + %f * %f = %f\n", acc, op1, op2, gpr[dest].f);
+    TRACE_DEBUG(Trace::EE, "[FPU] madd.s: %f + %f * %f = %f\n", acc, op1, op2, gpr[dest].f);
 }
 
 void Cop1::msub_s(int dest, int reg1, int reg2)
@@ -417,7 +427,7 @@ void Cop1::msub_s(int dest, int reg1, int reg2)
     check_overflow(gpr[dest].u, true);
     check_underflow(gpr[dest].u, true);
 
-    printf("[FPU] msub.s: %f - %f * %f = %f\n", acc, op1, op2, gpr[dest].f);
+    TRACE_DEBUG(Trace::EE, "[FPU] msub.s: %f - %f * %f = %f\n", acc, op1, op2, gpr[dest].f);
 }
 
 void Cop1::madda_s(int reg1, int reg2)
@@ -428,7 +438,7 @@ void Cop1::madda_s(int reg1, int reg2)
 
     check_overflow(accumulator.u, true);
     check_underflow(accumulator.u, true);
-    printf("[FPU] madda.s: %f + (%f * %f) = %f", acc, op1, op2, accumulator.f);
+    TRACE_DEBUG(Trace::EE, "[FPU] madda.s: ACC + (%f * %f) = %f\n", op1, op2, accumulator.f);
 }
 
 void Cop1::msuba_s(int reg1, int reg2)
@@ -439,12 +449,12 @@ void Cop1::msuba_s(int reg1, int reg2)
 
     check_overflow(accumulator.u, true);
     check_underflow(accumulator.u, true);
-    printf("[FPU] msuba.s: %f + (%f * %f) = %f", acc, op1, op2, accumulator.f);
+    TRACE_DEBUG(Trace::EE, "[FPU] msuba.s: ACC - (%f * %f) = %f\n", op1, op2, accumulator.f);
 }
 
 void Cop1::max_s(int dest, int reg1, int reg2)
 {
-    printf("[FPU] max.s: %f(%d) >= %f(%d)", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
+    TRACE_DEBUG(Trace::EE, "[FPU] max.s: %f(%d) >= %f(%d)", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
     if (gpr[reg1].f >= gpr[reg2].f)
         gpr[dest].f = gpr[reg1].f;
     else
@@ -452,12 +462,12 @@ void Cop1::max_s(int dest, int reg1, int reg2)
 
     control.u = false;
     control.o = false;
-    printf(" Result = %f(%d)\n", gpr[dest].f, dest);
+    TRACE_DEBUG(Trace::EE, " Result = %f(%d)\n", gpr[dest].f, dest);
 }
 
 void Cop1::min_s(int dest, int reg1, int reg2)
 {
-    printf("[FPU] min.s: %f(%d) <= %f(%d)", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
+    TRACE_DEBUG(Trace::EE, "[FPU] min.s: %f(%d) <= %f(%d)", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
     if (gpr[reg1].f <= gpr[reg2].f)
         gpr[dest].f = gpr[reg1].f;
     else
@@ -465,29 +475,29 @@ void Cop1::min_s(int dest, int reg1, int reg2)
 
     control.u = false;
     control.o = false;
-    printf(" Result = %f(%d)\n", gpr[dest].f, dest);
+    TRACE_DEBUG(Trace::EE, " Result = %f(%d)\n", gpr[dest].f, dest);
 }
 
 void Cop1::c_f_s()
 {
     control.condition = false;
-    printf("[FPU] c.f.s\n");
+    TRACE_DEBUG(Trace::EE, "[FPU] c.f.s\n");
 }
 
 void Cop1::c_lt_s(int reg1, int reg2)
 {
     control.condition = convert(gpr[reg1].u) < convert(gpr[reg2].u);
-    printf("[FPU] c.lt.s: %f(%d), %f(%d)\n", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
+    TRACE_DEBUG(Trace::EE, "[FPU] c.lt.s: %f(%d), %f(%d)\n", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
 }
 
 void Cop1::c_eq_s(int reg1, int reg2)
 {
     control.condition = convert(gpr[reg1].u) == convert(gpr[reg2].u);
-    printf("[FPU] c.eq.s: %f(%d), %f(%d)\n", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
+    TRACE_DEBUG(Trace::EE, "[FPU] c.eq.s: %f(%d), %f(%d)\n", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
 }
 
 void Cop1::c_le_s(int reg1, int reg2)
 {
     control.condition = convert(gpr[reg1].u) <= convert(gpr[reg2].u);
-    printf("[FPU] c.le.s: %f(%d), %f(%d)\n", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
+    TRACE_DEBUG(Trace::EE, "[FPU] c.le.s: %f(%d), %f(%d)\n", gpr[reg1].f, reg1, gpr[reg2].f, reg2);
 }
@@ -5,6 +5,7 @@
 
 #include "../emulator.hpp"
 #include "../errors.hpp"
+#include "../trace.hpp"
 
 const char* DMAC::CHAN(int index)
 {
@@ -144,6 +145,12 @@ void DMAC::run(int cycles)
     }
 }
 
+//Channels only become active through a register write or a DMA request, so until then run has nothing to do
+bool DMAC::is_idle()
+{
+    return !active_channel || !control.master_enable || (master_disable & (1 << 16));
+}
+
 //mfifo_handler will return false if the MFIFO is empty and the MFIFO is in use. Otherwise it returns true
 bool DMAC::mfifo_handler(int index)
 {
@@ -171,7 +178,7 @@ bool DMAC::mfifo_handler(int index)
                 interrupt_stat.channel_stat[MFIFO_EMPTY] = true;
                 int1_check();
                 mfifo_empty_triggered = true;
-                printf("[DMAC] MFIFO Empty\n");
+                TRACE_DEBUG(Trace::DMAC, "[DMAC] MFIFO Empty\n");
             }
             //Continue transfer if using a reference and there's QWC left
             if (channels[index].quadword_count && (id == 0 || id == 3 || id == 4))
@@ -187,7 +194,7 @@ bool DMAC::mfifo_handler(int index)
 
 void DMAC::transfer_end(int index)
 {
-    printf("[DMAC] %s transfer ended\n", CHAN(index));
+    TRACE_DEBUG(Trace::DMAC, "[DMAC] %s transfer ended\n", CHAN(index));
 
     channels[index].control &= ~0x100;
     channels[index].started = false;
@@ -279,7 +286,7 @@ int DMAC::process_VIF1()
             {
                 if (channels[VIF1].has_dma_stalled == false)
                 {
-                    printf("[DMAC] VIF1 DMA Stall at %x STADR = %x\n", channels[VIF1].address, STADR);
+                    TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF1 DMA Stall at %x STADR = %x\n", channels[VIF1].address, STADR);
                     interrupt_stat.channel_stat[DMA_STALL] = true;
                     int1_check();
                     channels[VIF1].has_dma_stalled = true;
@@ -412,7 +419,7 @@ int DMAC::process_GIF()
             {
                 if (channels[GIF].has_dma_stalled == false)
                 {
-                    printf("[DMAC] GIF DMA Stall at %x STADR = %x\n", channels[GIF].address, STADR);
+                    TRACE_DEBUG(Trace::DMAC, "[DMAC] GIF DMA Stall at %x STADR = %x\n", channels[GIF].address, STADR);
                     interrupt_stat.channel_stat[DMA_STALL] = true;
                     int1_check();
                     gif->deactivate_PATH(3);
@@ -612,7 +619,7 @@ int DMAC::process_SIF0()
         {
             uint64_t DMAtag = sif->read_SIF0();
             DMAtag |= (uint64_t)sif->read_SIF0() << 32;
-            printf("[DMAC] SIF0 tag: $%08lX_%08lX\n", DMAtag >> 32, DMAtag & 0xFFFFFFFF);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF0 tag: $%08lX_%08lX\n", DMAtag >> 32, DMAtag & 0xFFFFFFFF);
 
             channels[EE_SIF0].quadword_count = DMAtag & 0xFFFF;
             channels[EE_SIF0].address = DMAtag >> 32;
@@ -664,7 +671,7 @@ int DMAC::process_SIF0()
             {
                 uint64_t DMAtag = sif->read_SIF0();
                 DMAtag |= (uint64_t)sif->read_SIF0() << 32;
-                printf("[DMAC] SIF0 tag: $%08lX_%08lX\n", DMAtag >> 32, DMAtag & 0xFFFFFFFF);
+                TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF0 tag: $%08lX_%08lX\n", DMAtag >> 32, DMAtag & 0xFFFFFFFF);
 
                 channels[EE_SIF0].quadword_count = DMAtag & 0xFFFF;
                 channels[EE_SIF0].address = DMAtag >> 32;
@@ -697,7 +704,7 @@ int DMAC::process_SIF1()
             {
                 if (channels[EE_SIF1].has_dma_stalled == false)
                 {
-                    printf("[DMAC] SIF1 DMA Stall at %x STADR = %x\n", channels[EE_SIF1].address, STADR);
+                    TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF1 DMA Stall at %x STADR = %x\n", channels[EE_SIF1].address, STADR);
                     interrupt_stat.channel_stat[DMA_STALL] = true;
                     int1_check();
                     channels[EE_SIF1].has_dma_stalled = true;
@@ -802,7 +809,7 @@ int DMAC::process_SPR_FROM()
         else
         {
             uint128_t DMAtag = fetch128(channels[SPR_FROM].scratchpad_address | (1 << 31));
-            printf("[DMAC] SPR_FROM tag: $%08X_%08X\n", DMAtag._u32[1], DMAtag._u32[0]);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_FROM tag: $%08X_%08X\n", DMAtag._u32[1], DMAtag._u32[0]);
 
             channels[SPR_FROM].quadword_count = DMAtag._u32[0] & 0xFFFF;
             channels[SPR_FROM].address = DMAtag._u32[1];
@@ -1054,7 +1061,7 @@ void DMAC::handle_source_chain(int index)
 
 void DMAC::start_DMA(int index)
 {
-    printf("[DMAC] %s DMA started: $%08X\n", CHAN(index), channels[index].control);
+    TRACE_DEBUG(Trace::DMAC, "[DMAC] %s DMA started: $%08X\n", CHAN(index), channels[index].control);
     int mode = (channels[index].control >> 2) & 0x3;
     if (mode == 3)
     {
@@ -1271,7 +1278,7 @@ uint32_t DMAC::read32(uint32_t address)
             reg = RBOR;
             break;
         default:
-            printf("[DMAC] Unrecognized read32 from $%08X\n", address);
+            TRACE_WARN(Trace::DMAC, "[DMAC] Unrecognized read32 from $%08X\n", address);
             break;
     }
     //printf("[DMAC] Read32 $%08X: $%08X\n", address, reg);
@@ -1313,7 +1320,7 @@ void DMAC::write8(uint32_t address, uint8_t value)
             control.stall_dest_channel = (value >> 6) & 0x3;
             break;
         default:
-            printf("[DMAC] Unrecognized write8 to $%08X of $%02X\n", address, value);
+            TRACE_WARN(Trace::DMAC, "[DMAC] Unrecognized write8 to $%08X of $%02X\n", address, value);
             break;
     }
 }
@@ -1344,7 +1351,7 @@ void DMAC::write16(uint32_t address, uint16_t value)
             write32(address, (channels[SPR_TO].control & 0xFFFF0000) | value);
             break;
         default:
-            printf("[DMAC] Unrecognized write16 to $%08X of $%04X\n", address, value);
+            TRACE_WARN(Trace::DMAC, "[DMAC] Unrecognized write16 to $%08X of $%04X\n", address, value);
             break;
     }
 }
@@ -1354,7 +1361,7 @@ void DMAC::write32(uint32_t address, uint32_t value)
     switch (address)
     {
         case 0x10008000:
-            printf("[DMAC] VIF0 CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF0 CTRL: $%08X\n", value);
             if (!(channels[VIF0].control & 0x100))
             {
                 channels[VIF0].control = value;
@@ -1372,27 +1379,27 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x10008010:
-            printf("[DMAC] VIF0 M_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF0 M_ADR: $%08X\n", value);
             channels[VIF0].address = value & ~0xF;
             break;
         case 0x10008020:
-            printf("[DMAC] VIF0 QWC: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF0 QWC: $%08X\n", value);
             channels[VIF0].quadword_count = value & 0xFFFF;
             break;
         case 0x10008030:
-            printf("[DMAC] VIF0 T_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF0 T_ADR: $%08X\n", value);
             channels[VIF0].tag_address = value & ~0xF;
             break;
         case 0x10008040:
-            printf("[DMAC] VIF0 ASR0: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF0 ASR0: $%08X\n", value);
             channels[VIF0].tag_save0 = value & ~0xF;
             break;
         case 0x10008050:
-            printf("[DMAC] VIF0 ASR1: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF0 ASR1: $%08X\n", value);
             channels[VIF0].tag_save1 = value & ~0xF;
             break;
         case 0x10009000:
-            printf("[DMAC] VIF1 CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF1 CTRL: $%08X\n", value);
             if (!(channels[VIF1].control & 0x100))
             {
                 channels[VIF1].control = value;
@@ -1410,27 +1417,27 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x10009010:
-            printf("[DMAC] VIF1 M_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF1 M_ADR: $%08X\n", value);
             channels[VIF1].address = value & ~0xF;
             break;
         case 0x10009020:
-            printf("[DMAC] VIF1 QWC: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF1 QWC: $%08X\n", value);
             channels[VIF1].quadword_count = value & 0xFFFF;
             break;
         case 0x10009030:
-            printf("[DMAC] VIF1 T_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF1 T_ADR: $%08X\n", value);
             channels[VIF1].tag_address = value & ~0xF;
             break;
         case 0x10009040:
-            printf("[DMAC] VIF1 ASR0: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF1 ASR0: $%08X\n", value);
             channels[VIF1].tag_save0 = value & ~0xF;
             break;
         case 0x10009050:
-            printf("[DMAC] VIF1 ASR1: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] VIF1 ASR1: $%08X\n", value);
             channels[VIF1].tag_save1 = value & ~0xF;
             break;
         case 0x1000A000:
-            printf("[DMAC] GIF CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] GIF CTRL: $%08X\n", value);
             if (!(channels[GIF].control & 0x100))
             {
                 channels[GIF].control = value;
@@ -1456,27 +1463,27 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x1000A010:
-            printf("[DMAC] GIF M_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] GIF M_ADR: $%08X\n", value);
             channels[GIF].address = value & ~0xF;
             break;
         case 0x1000A020:
-            printf("[DMAC] GIF QWC: $%08X\n", value & 0xFFFF);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] GIF QWC: $%08X\n", value & 0xFFFF);
             channels[GIF].quadword_count = value & 0xFFFF;
             break;
         case 0x1000A030:
-            printf("[DMAC] GIF T_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] GIF T_ADR: $%08X\n", value);
             channels[GIF].tag_address = value & ~0xF;
             break;
         case 0x1000A040:
-            printf("[DMAC] GIF ASR0: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] GIF ASR0: $%08X\n", value);
             channels[GIF].tag_save0 = value & ~0xF;
             break;
         case 0x1000A050:
-            printf("[DMAC] GIF ASR1: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] GIF ASR1: $%08X\n", value);
             channels[GIF].tag_save1 = value & ~0xF;
             break;
         case 0x1000B000:
-            printf("[DMAC] IPU_FROM CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] IPU_FROM CTRL: $%08X\n", value);
             if (!(channels[IPU_FROM].control & 0x100))
             {
                 channels[IPU_FROM].control = value;
@@ -1494,15 +1501,15 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x1000B010:
-            printf("[DMAC] IPU_FROM M_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] IPU_FROM M_ADR: $%08X\n", value);
             channels[IPU_FROM].address = value & ~0xF;
             break;
         case 0x1000B020:
-            printf("[DMAC] IPU_FROM QWC: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] IPU_FROM QWC: $%08X\n", value);
             channels[IPU_FROM].quadword_count = value & 0xFFFF;
             break;
         case 0x1000B400:
-            printf("[DMAC] IPU_TO CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] IPU_TO CTRL: $%08X\n", value);
             if (!(channels[IPU_TO].control & 0x100))
             {
                 channels[IPU_TO].control = value;
@@ -1520,19 +1527,19 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x1000B410:
-            printf("[DMAC] IPU_TO M_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] IPU_TO M_ADR: $%08X\n", value);
             channels[IPU_TO].address = value & ~0xF;
             break;
         case 0x1000B420:
-            printf("[DMAC] IPU_TO QWC: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] IPU_TO QWC: $%08X\n", value);
             channels[IPU_TO].quadword_count = value & 0xFFFF;
             break;
         case 0x1000B430:
-            printf("[DMAC] IPU_TO T_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] IPU_TO T_ADR: $%08X\n", value);
             channels[IPU_TO].tag_address = value & ~0xF;
             break;
         case 0x1000C000:
-            printf("[DMAC] SIF0 CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF0 CTRL: $%08X\n", value);
             if (!(channels[EE_SIF0].control & 0x100))
             {
                 channels[EE_SIF0].control = value;
@@ -1550,15 +1557,15 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x1000C010:
-            printf("[DMAC] SIF0 M_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF0 M_ADR: $%08X\n", value);
             channels[EE_SIF0].address = value & ~0xF;
             break;
         case 0x1000C020:
-            printf("[DMAC] SIF0 QWC: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF0 QWC: $%08X\n", value);
             channels[EE_SIF0].quadword_count = value & 0xFFFF;
             break;
         case 0x1000C400:
-            printf("[DMAC] SIF1 CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF1 CTRL: $%08X\n", value);
             if (!(channels[EE_SIF1].control & 0x100))
             {
                 channels[EE_SIF1].control = value;
@@ -1576,19 +1583,19 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x1000C410:
-            printf("[DMAC] SIF1 M_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF1 M_ADR: $%08X\n", value);
             channels[EE_SIF1].address = value & ~0xF;
             break;
         case 0x1000C420:
-            printf("[DMAC] SIF1 QWC: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF1 QWC: $%08X\n", value);
             channels[EE_SIF1].quadword_count = value & 0xFFFF;
             break;
         case 0x1000C430:
-            printf("[DMAC] SIF1 T_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SIF1 T_ADR: $%08X\n", value);
             channels[EE_SIF1].tag_address = value & ~0xF;
             break;
         case 0x1000D000:
-            printf("[DMAC] SPR_FROM CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_FROM CTRL: $%08X\n", value);
             if (!(channels[SPR_FROM].control & 0x100))
             {
                 channels[SPR_FROM].control = value;
@@ -1606,19 +1613,19 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x1000D010:
-            printf("[DMAC] SPR_FROM M_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_FROM M_ADR: $%08X\n", value);
             channels[SPR_FROM].address = value & ~0xF;
             break;
         case 0x1000D020:
-            printf("[DMAC] SPR_FROM QWC: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_FROM QWC: $%08X\n", value);
             channels[SPR_FROM].quadword_count = value & 0xFFFF;
             break;
         case 0x1000D080:
-            printf("[DMAC] SPR_FROM SADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_FROM SADR: $%08X\n", value);
             channels[SPR_FROM].scratchpad_address = value & 0x3FFC;
             break;
         case 0x1000D400:
-            printf("[DMAC] SPR_TO CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_TO CTRL: $%08X\n", value);
             if (!(channels[SPR_TO].control & 0x100))
             {
                 channels[SPR_TO].control = value;
@@ -1636,23 +1643,23 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x1000D410:
-            printf("[DMAC] SPR_TO M_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_TO M_ADR: $%08X\n", value);
             channels[SPR_TO].address = value & ~0xF;
             break;
         case 0x1000D420:
-            printf("[DMAC] SPR_TO QWC: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_TO QWC: $%08X\n", value);
             channels[SPR_TO].quadword_count = value & 0xFFFF;
             break;
         case 0x1000D430:
-            printf("[DMAC] SPR_TO T_ADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_TO T_ADR: $%08X\n", value);
             channels[SPR_TO].tag_address = value & ~0xF;
             break;
         case 0x1000D480:
-            printf("[DMAC] SPR_TO SADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] SPR_TO SADR: $%08X\n", value);
             channels[SPR_TO].scratchpad_address = value & 0x3FFC;
             break;
         case 0x1000E000:
-            printf("[DMAC] Write32 D_CTRL: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] Write32 D_CTRL: $%08X\n", value);
             control.master_enable = value & 0x1;
             control.cycle_stealing = value & 0x2;
             control.mem_drain_channel = (value >> 2) & 0x3;
@@ -1662,7 +1669,7 @@ void DMAC::write32(uint32_t address, uint32_t value)
             break;
         case 0x1000E010:
         case 0x1000E100:
-            printf("[DMAC] Write32 D_STAT: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] Write32 D_STAT: $%08X\n", value);
             for (int i = 0; i < 15; i++)
             {
                 if (value & (1 << i))
@@ -1675,7 +1682,7 @@ void DMAC::write32(uint32_t address, uint32_t value)
             int1_check();
             break;
         case 0x1000E020:
-            printf("[DMAC] Write to PCR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] Write to PCR: $%08X\n", value);
             PCR = value;
 
             //Global priority control
@@ -1685,24 +1692,24 @@ void DMAC::write32(uint32_t address, uint32_t value)
             }
             break;
         case 0x1000E030:
-            printf("[DMAC] Write to SQWC: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] Write to SQWC: $%08X\n", value);
             SQWC.skip_qwc = value & 0xFF;
             SQWC.transfer_qwc = (value >> 16) & 0xFF;
             break;
         case 0x1000E040:
-            printf("[DMAC] Write to RBSR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] Write to RBSR: $%08X\n", value);
             RBSR = value;
             break;
         case 0x1000E050:
-            printf("[DMAC] Write to RBOR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] Write to RBOR: $%08X\n", value);
             RBOR = value;
             break;
         case 0x1000E060:
-            printf("[DMAC] Write to STADR: $%08X\n", value);
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] Write to STADR: $%08X\n", value);
             update_stadr(value);
             break;
         default:
-            printf("[DMAC] Unrecognized write32 of $%08X to $%08X\n", value, address);
+            TRACE_WARN(Trace::DMAC, "[DMAC] Unrecognized write32 of $%08X to $%08X\n", value, address);
             break;
     }
 }
@@ -1724,6 +1731,11 @@ void DMAC::clear_DMA_request(int index)
         deactivate_channel(index);
 }
 
+bool DMAC::get_DMA_request(int index)
+{
+    return channels[index].dma_req;
+}
+
 void DMAC::update_stadr(uint32_t addr)
 {
     uint32_t old_stadr = STADR;
@@ -1775,7 +1787,7 @@ void DMAC::check_for_activation(int index)
         {
             if (channels[index].has_dma_stalled == false)
             {
-                printf("DMA Stall Drain channel %d Addr %x STADR %x\n", index, channels[index].address, STADR);
+                TRACE_DEBUG(Trace::DMAC, "DMA Stall Drain channel %d Addr %x STADR %x\n", index, channels[index].address, STADR);
                 interrupt_stat.channel_stat[DMA_STALL] = true;
                 int1_check();
                 channels[index].has_dma_stalled = true;
@@ -1823,13 +1835,13 @@ void DMAC::arbitrate()
     {
         /*bool is_active = active_channel;
         if (is_active)
-            printf("[DMAC] Arbitrating from %s to ", CHAN(active_channel->index));*/
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] Arbitrating from %s to ", CHAN(active_channel->index));*/
         find_new_active_channel();
 
         /*if (is_active)
-            printf("%s\n", CHAN(active_channel->index));
+            TRACE_DEBUG(Trace::DMAC, "%s\n", CHAN(active_channel->index));
         else
-            printf("[DMAC] Arbitrating to %s\n", CHAN(active_channel->index));*/
+            TRACE_DEBUG(Trace::DMAC, "[DMAC] Arbitrating to %s\n", CHAN(active_channel->index));*/
     }
 }
 
@@ -142,6 +142,7 @@ class DMAC
              VectorInterface* vif0, VectorInterface* vif1, VectorUnit* vu0, VectorUnit* vu1);
         void reset(uint8_t* RDRAM, uint8_t* scratchpad);
         void run(int cycles);
+        bool is_idle();
         void start_DMA(int index);
 
         uint32_t read_master_disable();
@@ -156,6 +157,7 @@ class DMAC
 
         void set_DMA_request(int index);
         void clear_DMA_request(int index);
+        bool get_DMA_request(int index);
 
         void load_state(std::ifstream& state);
         void save_state(std::ofstream& state);
@@ -0,0 +1,166 @@
+#include "ee_idleloop.hpp"
+#include "emotion.hpp"
+#include "emotioninterpreter.hpp"
+
+static bool is_back_branch(uint32_t instr, uint32_t branch_pc, uint32_t start)
+{
+    int op = instr >> 26;
+    switch (op)
+    {
+        case 0x01:
+            //BLTZ, BGEZ, BLTZL, BGEZL. The linking variants write $ra.
+            if (((instr >> 16) & 0x1F) > 0x03)
+                return false;
+            break;
+        case 0x04: //BEQ
+        case 0x05: //BNE
+        case 0x06: //BLEZ
+        case 0x07: //BGTZ
+        case 0x14: //BEQL
+        case 0x15: //BNEL
+        case 0x16: //BLEZL
+        case 0x17: //BGTZL
+            break;
+        default:
+            return false;
+    }
+    int32_t offset = (int16_t)instr;
+    return branch_pc + (offset << 2) + 4 == start;
+}
+
+//Instructions whose only effect is writing a GPR
+static bool is_pure(uint32_t instr)
+{
+    int op = instr >> 26;
+    switch (op)
+    {
+        case 0x00:
+            switch (instr & 0x3F)
+            {
+                case 0x00: //SLL
+                case 0x02: //SRL
+                case 0x03: //SRA
+                case 0x04: //SLLV
+                case 0x06: //SRLV
+                case 0x07: //SRAV
+                case 0x0F: //SYNC
+                case 0x10: //MFHI
+                case 0x12: //MFLO
+                case 0x14: //DSLLV
+                case 0x16: //DSRLV
+                case 0x17: //DSRAV
+                case 0x20: //ADD
+                case 0x21: //ADDU
+                case 0x22: //SUB
+                case 0x23: //SUBU
+                case 0x24: //AND
+                case 0x25: //OR
+                case 0x26: //XOR
+                case 0x27: //NOR
+                case 0x2A: //SLT
+                case 0x2B: //SLTU
+                case 0x2C: //DADD
+                case 0x2D: //DADDU
+                case 0x2E: //DSUB
+                case 0x2F: //DSUBU
+                case 0x38: //DSLL
+                case 0x3A: //DSRL
+                case 0x3B: //DSRA
+                case 0x3C: //DSLL32
+                case 0x3E: //DSRL32
+                case 0x3F: //DSRA32
+                    return true;
+                default:
+                    return false;
+            }
+        case 0x08: //ADDI
+        case 0x09: //ADDIU
+        case 0x0A: //SLTI
+        case 0x0B: //SLTIU
+        case 0x0C: //ANDI
+        case 0x0D: //ORI
+        case 0x0E: //XORI
+        case 0x0F: //LUI
+        case 0x18: //DADDI
+        case 0x19: //DADDIU
+        case 0x20: //LB
+        case 0x21: //LH
+        case 0x23: //LW
+        case 0x24: //LBU
+        case 0x25: //LHU
+        case 0x27: //LWU
+        case 0x37: //LD
+            return true;
+        case 0x10:
+            //MFC0. Count only moves between slices.
+            return ((instr >> 21) & 0x1F) == 0x00;
+        default:
+            return false;
+    }
+}
+
+bool EE_IdleLoop::is_idle_loop(EmotionEngine& cpu, uint32_t start, uint32_t branch_pc)
+{
+    if (start > branch_pc || (start & 0x3))
+        return false;
+
+    //Includes the branch and its delay slot
+    int length = (branch_pc - start) / 4 + 2;
+    if (length > MAX_LOOP_LENGTH)
+        return false;
+
+    uint32_t instrs[MAX_LOOP_LENGTH];
+    for (int i = 0; i < length; i++)
+        instrs[i] = cpu.read32(start + i * 4);
+
+    int branch_index = length - 2;
+    if (!is_back_branch(instrs[branch_index], branch_pc, start))
+        return false;
+
+    for (int i = 0; i < length; i++)
+    {
+        if (i != branch_index && !is_pure(instrs[i]))
+            return false;
+    }
+
+    EE_InstrInfo info[MAX_LOOP_LENGTH];
+    uint32_t written_in_loop = 0;
+    for (int i = 0; i < length; i++)
+    {
+        EmotionInterpreter::lookup(info[i], instrs[i]);
+        for (size_t j = 0; j < info[i].write_dependencies.size(); j++)
+        {
+            EE_DependencyInfo dep;
+            info[i].get_dependency(dep, j, DependencyType::Write);
+            if (dep.type == RegType::GPR)
+                written_in_loop |= 1u << dep.reg;
+        }
+    }
+    written_in_loop &= ~1u;
+
+    //A register read before this iteration writes it carries a value over from the last one,
+    //so iterations could differ, e.g. a loop counting down.
+    uint32_t written = 0;
+    for (int i = 0; i < length; i++)
+    {
+        for (size_t j = 0; j < info[i].read_dependencies.size(); j++)
+        {
+            EE_DependencyInfo dep;
+            info[i].get_dependency(dep, j, DependencyType::Read);
+            if (dep.type != RegType::GPR)
+                continue;
+            uint32_t mask = 1u << dep.reg;
+            if ((written_in_loop & mask) && !(written & mask))
+                return false;
+        }
+        for (size_t j = 0; j < info[i].write_dependencies.size(); j++)
+        {
+            EE_DependencyInfo dep;
+            info[i].get_dependency(dep, j, DependencyType::Write);
+            if (dep.type == RegType::GPR)
+                written |= 1u << dep.reg;
+        }
+    }
+    return true;
+}
+
@@ -0,0 +1,29 @@
+#ifndef EE_IDLELOOP_HPP
+#define EE_IDLELOOP_HPP
+#include <cstdint>
+
+class EmotionEngine;
+
+/**
+Recognizes the short loops games and the kernel use to wait for VSYNC, DMA completion and the like:
+a few loads and ALU operations ending in a conditional branch back to the start. If the loop stores
+nothing and carries no register from one iteration to the next, every iteration computes the same
+thing from the same memory. Once it branches back, it will keep doing so until something other than
+the EE changes what it reads.
+
+Devices only run between EE time slices, so the rest of the slice can be skipped whenever such a
+loop branches back, and the loop is only evaluated once per slice.
+
+Quadword loads are not allowed, as that's how the EE reads the VIF/GIF/IPU FIFOs, where every read
+pops data.
+**/
+
+namespace EE_IdleLoop
+{
+    constexpr int MAX_LOOP_LENGTH = 16;
+
+    //start is the branch target and branch_pc the branch at the end of the loop, followed by its delay slot
+    bool is_idle_loop(EmotionEngine& cpu, uint32_t start, uint32_t branch_pc);
+};
+
+#endif // EE_IDLELOOP_HPP
@@ -11,21 +11,18 @@
 namespace EE_JIT
 {
 
-    EE_JIT64 jit64;
-
     uint16_t run(EmotionEngine *ee)
     {
-        return jit64.run(*ee);
+        return ee->get_jit().run(*ee);
     }
 
-    void reset(bool clear_cache)
+    void reset(EmotionEngine *ee, bool clear_cache)
     {
-        jit64.reset(clear_cache);
+        ee->get_jit().reset(clear_cache);
     }
-    /*
-    void set_current_program(uint32_t crc)
+
+    void print_fallback_counts(EmotionEngine *ee)
     {
-        jit64.set_current_program(crc);
+        ee->get_jit().get_fallback_counters().print("EE_JIT64");
     }
-    */
 };
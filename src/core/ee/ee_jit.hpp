@@ -7,7 +7,8 @@ class EmotionEngine;
 namespace EE_JIT
 {
     uint16_t run(EmotionEngine* ee);
-    void reset(bool clear_cache);
+    void reset(EmotionEngine* ee, bool clear_cache);
+    void print_fallback_counts(EmotionEngine* ee);
 };
 
 #endif // EE_JIT_HPP
@@ -2,9 +2,11 @@
 #include <algorithm>
 
 #include "ee_jit64.hpp"
+#include "emotiondisasm.hpp"
 #include "emotioninterpreter.hpp"
 #include "vu.hpp"
 #include "../gif.hpp"
+#include "../jitcommon/cpuinfo.hpp"
 
 #include "../errors.hpp"
 
@@ -116,6 +118,11 @@ uint16_t EE_JIT64::run(EmotionEngine& ee)
     return cycle_count;
 }
 
+const JitFallbackCounters& EE_JIT64::get_fallback_counters() const
+{
+    return fallback_counters;
+}
+
 EEJitPrologue EE_JIT64::create_prologue_block()
 {
     jit_block.clear();
@@ -210,9 +217,15 @@ EEJitBlockRecord* EE_JIT64::recompile_block(EmotionEngine& ee, IR::Block& block)
     cycles_added = 0;
     ee_branch = false;
     likely_branch = false;
+    idle_loop = block.is_idle_loop();
+    block_pc = ee.get_PC();
     saved_int_regs = std::vector<REG_64>();
     saved_xmm_regs = std::vector<REG_64>();
 
+    AllocReg loop_int_regs[16], loop_xmm_regs[16];
+    if (block.is_loop())
+        find_loop_regs(ee, block, loop_int_regs, loop_xmm_regs);
+
     jit_block.clear();
 
     //Create new stack frame
@@ -227,6 +240,10 @@ EEJitBlockRecord* EE_JIT64::recompile_block(EmotionEngine& ee, IR::Block& block)
     // An extra 0x8 is needed so that functions we call can have a 16-byte aligned stack pointer.
     emitter.SUB64_REG_IMM(0x1B8, REG_64::RSP);
 
+    uint8_t* loop_start = nullptr;
+    if (block.is_loop())
+        loop_start = load_loop_regs(ee, loop_int_regs, loop_xmm_regs);
+
     while (block.get_instruction_count() > 0 && !likely_branch)
     {
         IR::Instruction instr = block.get_next_instr();
@@ -235,12 +252,183 @@ EEJitBlockRecord* EE_JIT64::recompile_block(EmotionEngine& ee, IR::Block& block)
 
     if (likely_branch)
         handle_branch_likely(ee, block);
+    else if (block.is_loop())
+        emit_loop_back_edge(ee, block, loop_int_regs, loop_xmm_regs, loop_start);
     else
         cleanup_recompiler(ee, true, true, block.get_cycle_count());
 
     return jit_heap.insert_block(ee.get_PC(), &jit_block);
 }
 
+//Scratchpads never outlive an instruction, and VI registers can't be loaded yet
+static bool is_loop_reg(const AllocReg& reg)
+{
+    if (!reg.used || reg.locked)
+        return false;
+
+    switch (reg.type)
+    {
+        case REG_TYPE::GPR:
+        case REG_TYPE::FPU:
+        case REG_TYPE::GPREXTENDED:
+        case REG_TYPE::VF:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool same_loop_reg(const AllocReg& reg, const AllocReg& loop_reg)
+{
+    return reg.used && loop_reg.used && reg.reg == loop_reg.reg && reg.type == loop_reg.type;
+}
+
+void EE_JIT64::find_loop_regs(EmotionEngine& ee, IR::Block block, AllocReg* loop_int_regs, AllocReg* loop_xmm_regs)
+{
+    //Emit the body once to see which registers it leaves allocated at the back-edge, those are the ones kept
+    //live across iterations. Only the assignment is kept, the code is thrown away.
+    AllocReg start_int_regs[16], start_xmm_regs[16];
+    std::copy(int_regs, int_regs + 16, start_int_regs);
+    std::copy(xmm_regs, xmm_regs + 16, start_xmm_regs);
+
+    jit_block.clear();
+
+    while (block.get_instruction_count() > 0)
+    {
+        IR::Instruction instr = block.get_next_instr();
+        emit_instruction(ee, instr);
+    }
+
+    //Whether a register is modified at the back-edge tells whether the body writes it
+    for (int i = 0; i < 16; i++)
+    {
+        loop_int_regs[i] = int_regs[i];
+        loop_int_regs[i].used = is_loop_reg(int_regs[i]);
+        loop_xmm_regs[i] = xmm_regs[i];
+        loop_xmm_regs[i].used = is_loop_reg(xmm_regs[i]);
+    }
+
+    //The allocator never holds a GPR in both halves, but don't rely on it here. Two copies would
+    //go stale against each other across iterations.
+    for (int i = 0; i < 16; i++)
+    {
+        for (int j = 0; j < 16; j++)
+        {
+            if (loop_int_regs[i].used && loop_xmm_regs[j].used && loop_int_regs[i].type == REG_TYPE::GPR &&
+                    loop_xmm_regs[j].type == REG_TYPE::GPREXTENDED && loop_int_regs[i].reg == loop_xmm_regs[j].reg)
+            {
+                loop_int_regs[i].used = false;
+                loop_xmm_regs[j].used = false;
+            }
+        }
+    }
+
+    std::copy(start_int_regs, start_int_regs + 16, int_regs);
+    std::copy(start_xmm_regs, start_xmm_regs + 16, xmm_regs);
+
+    cycles_added = 0;
+    ee_branch = false;
+    likely_branch = false;
+    saved_int_regs.clear();
+    saved_xmm_regs.clear();
+}
+
+uint8_t* EE_JIT64::load_loop_regs(EmotionEngine& ee, const AllocReg* loop_int_regs, const AllocReg* loop_xmm_regs)
+{
+    //From the second iteration on, the registers the body writes hold values the EE state hasn't seen yet,
+    //so they count as modified and any exit from the body stores them
+    for (int i = 0; i < 16; i++)
+    {
+        if (loop_int_regs[i].used)
+        {
+            alloc_reg(ee, loop_int_regs[i].reg, loop_int_regs[i].type, REG_STATE::READ, (REG_64)i);
+            int_regs[i].modified = loop_int_regs[i].modified;
+        }
+        if (loop_xmm_regs[i].used)
+        {
+            alloc_reg(ee, loop_xmm_regs[i].reg, loop_xmm_regs[i].type, REG_STATE::READ, (REG_64)i);
+            xmm_regs[i].modified = loop_xmm_regs[i].modified;
+
+            //A VF register may come round the back-edge unclamped, clamping again is harmless
+            xmm_regs[i].needs_clamping = loop_xmm_regs[i].type == REG_TYPE::VF ? 0xF : 0;
+        }
+    }
+    return jit_block.get_code_pos();
+}
+
+void EE_JIT64::emit_loop_back_edge(EmotionEngine& ee, IR::Block& block, const AllocReg* loop_int_regs,
+                                   const AllocReg* loop_xmm_regs, uint8_t* loop_start)
+{
+    //Bring the allocation back to the one the body starts with. Registers the body moved or
+    //picked up along the way are stored, and those it evicted are loaded again.
+    for (int i = 0; i < 16; i++)
+    {
+        if (int_regs[i].used && !int_regs[i].locked && !same_loop_reg(int_regs[i], loop_int_regs[i]))
+        {
+            flush_int_reg(ee, i);
+            int_regs[i].used = false;
+        }
+        if (xmm_regs[i].used && !xmm_regs[i].locked && !same_loop_reg(xmm_regs[i], loop_xmm_regs[i]))
+        {
+            flush_xmm_reg(ee, i);
+            xmm_regs[i].used = false;
+        }
+    }
+
+    //The loop start only expects the registers the body writes to be modified, store any others.
+    //XMM registers saved around a call are brought back from the stack.
+    for (int i = 0; i < 16; i++)
+    {
+        if (loop_int_regs[i].used && same_loop_reg(int_regs[i], loop_int_regs[i]) &&
+                int_regs[i].modified && !loop_int_regs[i].modified)
+        {
+            flush_int_reg(ee, i);
+            int_regs[i].modified = false;
+        }
+        if (loop_xmm_regs[i].used && same_loop_reg(xmm_regs[i], loop_xmm_regs[i]))
+        {
+            restore_xmm_regs({(REG_64)i}, true);
+            if (xmm_regs[i].modified && !loop_xmm_regs[i].modified)
+            {
+                flush_xmm_reg(ee, i);
+                xmm_regs[i].modified = false;
+            }
+        }
+    }
+
+    for (int i = 0; i < 16; i++)
+    {
+        if (loop_int_regs[i].used && !same_loop_reg(int_regs[i], loop_int_regs[i]))
+        {
+            alloc_reg(ee, loop_int_regs[i].reg, loop_int_regs[i].type, REG_STATE::READ, (REG_64)i);
+            int_regs[i].modified = loop_int_regs[i].modified;
+        }
+        if (loop_xmm_regs[i].used && !same_loop_reg(xmm_regs[i], loop_xmm_regs[i]))
+        {
+            alloc_reg(ee, loop_xmm_regs[i].reg, loop_xmm_regs[i].type, REG_STATE::READ, (REG_64)i);
+            xmm_regs[i].modified = loop_xmm_regs[i].modified;
+        }
+    }
+
+    //Each iteration accounts for its cycles here, as it would when leaving through the dispatcher
+    update_cycle_count(block.get_cycle_count());
+
+    //Go around again if the branch was taken and the timeslice isn't over, which is all the dispatcher checks
+    //before running the next block. Interrupts are checked once the JIT returns, as they are for any block.
+    emitter.CMP32_IMM_MEM(block_pc, REG_64::R15, offsetof(EmotionEngine, PC));
+    uint8_t* exit_loop = emitter.JCC_NEAR_DEFERRED(ConditionCode::NE);
+    emitter.CMP32_IMM_MEM(0, REG_64::R15, offsetof(EmotionEngine, cycles_to_run));
+    emitter.JCC_NEAR(ConditionCode::G, loop_start);
+    emitter.set_jump_dest(exit_loop);
+
+    flush_regs(ee);
+    clear_reg_state();
+
+    emitter.ADD64_REG_IMM(0x1B8, REG_64::RSP);
+    emitter.POP(REG_64::RBP);
+    emit_dispatcher();
+}
+
 void EE_JIT64::emit_instruction(EmotionEngine &ee, IR::Instruction &instr)
 {
     switch (instr.op)
@@ -368,10 +556,16 @@ void EE_JIT64::emit_instruction(EmotionEngine &ee, IR::Instruction &instr)
             floating_point_divide(ee, instr);
             break;
         case IR::Opcode::FloatingPointMaximum:
-            floating_point_maximum(ee, instr);
+            if (HostCPU::has_avx())
+                floating_point_maximum_AVX(ee, instr);
+            else
+                floating_point_maximum(ee, instr);
             break;
         case IR::Opcode::FloatingPointMinimum:
-            floating_point_minimum(ee, instr);
+            if (HostCPU::has_avx())
+                floating_point_minimum_AVX(ee, instr);
+            else
+                floating_point_minimum(ee, instr);
             break;
         case IR::Opcode::FloatingPointMultiply:
             floating_point_multiply(ee, instr);
@@ -515,154 +709,178 @@ void EE_JIT64::emit_instruction(EmotionEngine &ee, IR::Instruction &instr)
             or_reg(ee, instr);
             break;
         case IR::Opcode::ParallelAbsoluteHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_absolute_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelAbsoluteWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_absolute_word(ee, instr);
             break;
         case IR::Opcode::ParallelAnd:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_and(ee, instr);
             break;
         case IR::Opcode::ParallelAddByte:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_add_byte(ee, instr);
             break;
         case IR::Opcode::ParallelAddHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_add_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelAddWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_add_word(ee, instr);
             break;
         case IR::Opcode::ParallelAddWithSignedSaturationByte:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_add_with_signed_saturation_byte(ee, instr);
             break;
         case IR::Opcode::ParallelAddWithSignedSaturationHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_add_with_signed_saturation_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelAddWithSignedSaturationWord:
-            fallback_interpreter(ee, instr); // TODO
+            parallel_add_with_signed_saturation_word(ee, instr);
             break;
         case IR::Opcode::ParallelAddWithUnsignedSaturationByte:
-            fallback_interpreter(ee, instr); // TODO, broken in YuGiOh Duelists of The Roses
+            parallel_add_with_unsigned_saturation_byte(ee, instr);
             break;
         case IR::Opcode::ParallelAddWithUnsignedSaturationHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_add_with_unsigned_saturation_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelAddWithUnsignedSaturationWord:
-            fallback_interpreter(ee, instr); // TODO
+            parallel_add_with_unsigned_saturation_word(ee, instr);
             break;
         case IR::Opcode::ParallelCompareEqualByte:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_compare_equal_byte(ee, instr);
             break;
         case IR::Opcode::ParallelCompareEqualHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_compare_equal_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelCompareEqualWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_compare_equal_word(ee, instr);
             break;
         case IR::Opcode::ParallelCompareGreaterThanByte:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_compare_greater_than_byte(ee, instr);
             break;
         case IR::Opcode::ParallelCompareGreaterThanHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_compare_greater_than_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelCompareGreaterThanWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_compare_greater_than_word(ee, instr);
+            break;
+        case IR::Opcode::ParallelCopyLowerDoubleword:
+            parallel_copy_lower_doubleword(ee, instr);
+            break;
+        case IR::Opcode::ParallelCopyUpperDoubleword:
+            parallel_copy_upper_doubleword(ee, instr);
             break;
         case IR::Opcode::ParallelDivideWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_divide_word(ee, instr);
             break;
         case IR::Opcode::ParallelExchangeEvenHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_exchange_halfword(ee, instr, true);
             break;
         case IR::Opcode::ParallelExchangeCenterHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_exchange_halfword(ee, instr, false);
             break;
         case IR::Opcode::ParallelExchangeEvenWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_exchange_word(ee, instr, true);
             break;
         case IR::Opcode::ParallelExchangeCenterWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_exchange_word(ee, instr, false);
+            break;
+        case IR::Opcode::ParallelExtendLowerFromByte:
+            parallel_extend_lower_from_byte(ee, instr);
+            break;
+        case IR::Opcode::ParallelExtendLowerFromHalfword:
+            parallel_extend_lower_from_halfword(ee, instr);
+            break;
+        case IR::Opcode::ParallelExtendLowerFromWord:
+            parallel_extend_lower_from_word(ee, instr);
+            break;
+        case IR::Opcode::ParallelExtendUpperFromByte:
+            parallel_extend_upper_from_byte(ee, instr);
+            break;
+        case IR::Opcode::ParallelExtendUpperFromHalfword:
+            parallel_extend_upper_from_halfword(ee, instr);
+            break;
+        case IR::Opcode::ParallelExtendUpperFromWord:
+            parallel_extend_upper_from_word(ee, instr);
             break;
         case IR::Opcode::ParallelMaximizeHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_maximize_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelMaximizeWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_maximize_word(ee, instr);
             break;
         case IR::Opcode::ParallelMinimizeHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_minimize_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelMinimizeWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_minimize_word(ee, instr);
             break;
         case IR::Opcode::ParallelNor:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_nor(ee, instr);
             break;
         case IR::Opcode::ParallelOr:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_or(ee, instr);
             break;
         case IR::Opcode::ParallelPackToByte:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_pack_to_byte(ee, instr);
             break;
         case IR::Opcode::ParallelPackToHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_pack_to_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelPackToWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_pack_to_word(ee, instr);
             break;
         case IR::Opcode::ParallelShiftLeftLogicalHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_shift_left_logical_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelShiftLeftLogicalWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_shift_left_logical_word(ee, instr);
             break;
         case IR::Opcode::ParallelShiftRightArithmeticHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_shift_right_arithmetic_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelShiftRightArithmeticWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_shift_right_arithmetic_word(ee, instr);
             break;
         case IR::Opcode::ParallelShiftRightLogicalHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_shift_right_logical_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelShiftRightLogicalWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_shift_right_logical_word(ee, instr);
             break;
         case IR::Opcode::ParallelSubtractByte:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_subtract_byte(ee, instr);
             break;
         case IR::Opcode::ParallelSubtractHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_subtract_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelSubtractWord:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_subtract_word(ee, instr);
             break;
         case IR::Opcode::ParallelSubtractWithSignedSaturationByte:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_subtract_with_signed_saturation_byte(ee, instr);
             break;
         case IR::Opcode::ParallelSubtractWithSignedSaturationHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_subtract_with_signed_saturation_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelSubtractWithSignedSaturationWord:
-            fallback_interpreter(ee, instr); // TODO
+            parallel_subtract_with_signed_saturation_word(ee, instr);
             break;
         case IR::Opcode::ParallelSubtractWithUnsignedSaturationByte:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_subtract_with_unsigned_saturation_byte(ee, instr);
             break;
         case IR::Opcode::ParallelSubtractWithUnsignedSaturationHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_subtract_with_unsigned_saturation_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelReverseHalfword:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_reverse_halfword(ee, instr);
             break;
         case IR::Opcode::ParallelRotate3WordsLeft:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_rotate_3_words_left(ee, instr);
             break;
         case IR::Opcode::ParallelSubtractWithUnsignedSaturationWord:
-            fallback_interpreter(ee, instr); // TODO
+            parallel_subtract_with_unsigned_saturation_word(ee, instr);
             break;
         case IR::Opcode::ParallelXor:
-            fallback_interpreter(ee, instr); // TODO, needs testing
+            parallel_xor(ee, instr);
             break;
         case IR::Opcode::SetOnLessThan:
             set_on_less_than(ee, instr);
@@ -1509,36 +1727,37 @@ uint64_t EE_JIT64::get_gpr_offset(int index) const
         Errors::die("EE_JIT64::get_gpr_offset not supported for special registers");
 }
 
-void EE_JIT64::cleanup_recompiler(EmotionEngine& ee, bool clear_regs, bool dispatcher, uint64_t cycles)
+void EE_JIT64::clear_reg_state()
 {
-    // FIXME: COP2 should handle incrementing the EE cycle count on its on when spinning on mbit (we'll need to increment it ourself on vuwait)
-    // Maybe keep it after COP2 fixes incrementing on stalls and conditionally check for vu0wait?
-    // Make sure to remove this line when that feature is implemented in COP2 logic!
-    cycles = std::max((uint64_t)1, cycles);
+    for (int i = 0; i < 16; i++)
+    {
+        int_regs[i].age = 0;
+        int_regs[i].used = false;
+        int_regs[i].stored = false;
+        xmm_regs[i].age = 0;
+        xmm_regs[i].used = false;
+        xmm_regs[i].stored = false;
+    }
+}
 
+void EE_JIT64::cleanup_recompiler(EmotionEngine& ee, bool clear_regs, bool dispatcher, uint64_t cycles)
+{
     flush_regs(ee);
 
     if (clear_regs)
-    {
-        for (int i = 0; i < 16; i++)
-        {
-            int_regs[i].age = 0;
-            int_regs[i].used = false;
-            int_regs[i].stored = false;
-            xmm_regs[i].age = 0;
-            xmm_regs[i].used = false;
-            xmm_regs[i].stored = false;
-        }
-    }
+        clear_reg_state();
 
-    // Decrement cycles to run by the cycles argument
-    emitter.SUB32_MEM_IMM(cycles, REG_64::R15, offsetof(EmotionEngine, cycles_to_run));
+    update_cycle_count(cycles);
 
-    // Update cycle_count_now for COP2 sync
-    // cycle_count_now = cycle_count += cycles - cycles we already added
-    emitter.MOV64_FROM_MEM(REG_64::R15, REG_64::RAX, offsetof(EmotionEngine, cycle_count));
-    emitter.ADD64_REG_IMM(cycles - cycles_added, REG_64::RAX);
-    emitter.MOV64_TO_MEM(REG_64::RAX, REG_64::R15, offsetof(EmotionEngine, cycle_count));
+    // If an idle loop is about to go around again, skip to the end of the timeslice
+    if (dispatcher && idle_loop)
+    {
+        emitter.CMP32_IMM_MEM(block_pc, REG_64::R15, offsetof(EmotionEngine, PC));
+        uint8_t* offset_addr = emitter.JCC_NEAR_DEFERRED(ConditionCode::NE);
+        prepare_abi((uint64_t)&ee);
+        call_abi_func((uint64_t)&ee_skip_idle_loop);
+        emitter.set_jump_dest(offset_addr);
+    }
 
     //Clean up stack, has to be handled before we enter dispatcher
     emitter.ADD64_REG_IMM(0x1B8, REG_64::RSP);
@@ -1551,6 +1770,23 @@ void EE_JIT64::cleanup_recompiler(EmotionEngine& ee, bool clear_regs, bool dispa
         emit_epilogue();
 }
 
+void EE_JIT64::update_cycle_count(uint64_t cycles)
+{
+    // FIXME: COP2 should handle incrementing the EE cycle count on its on when spinning on mbit (we'll need to increment it ourself on vuwait)
+    // Maybe keep it after COP2 fixes incrementing on stalls and conditionally check for vu0wait?
+    // Make sure to remove this line when that feature is implemented in COP2 logic!
+    cycles = std::max((uint64_t)1, cycles);
+
+    // Decrement cycles to run by the cycles argument
+    emitter.SUB32_MEM_IMM(cycles, REG_64::R15, offsetof(EmotionEngine, cycles_to_run));
+
+    // Update cycle_count_now for COP2 sync
+    // cycle_count_now = cycle_count += cycles - cycles we already added
+    emitter.MOV64_FROM_MEM(REG_64::R15, REG_64::RAX, offsetof(EmotionEngine, cycle_count));
+    emitter.ADD64_REG_IMM(cycles - cycles_added, REG_64::RAX);
+    emitter.MOV64_TO_MEM(REG_64::RAX, REG_64::R15, offsetof(EmotionEngine, cycle_count));
+}
+
 void EE_JIT64::emit_prologue()
 {
     emitter.PUSH(REG_64::RBX);
@@ -1625,18 +1861,15 @@ void EE_JIT64::handle_branch_likely(EmotionEngine& ee, IR::Block& block)
 void EE_JIT64::fallback_interpreter(EmotionEngine& ee, const IR::Instruction &instr)
 {
     flush_regs(ee);
-    for (int i = 0; i < 16; i++)
-    {
-        int_regs[i].age = 0;
-        int_regs[i].used = false;
-        int_regs[i].stored = false;
-        xmm_regs[i].age = 0;
-        xmm_regs[i].used = false;
-        xmm_regs[i].stored = false;
-    }
+    clear_reg_state();
 
     uint32_t instr_word = instr.get_opcode();
 
+    std::string name = EmotionDisasm::disasm_instr(instr_word, 0);
+    name = name.substr(0, name.find(' '));
+    emitter.load_addr((uint64_t)fallback_counters.get_counter(name), REG_64::RAX);
+    emitter.INC64_MEM(REG_64::RAX);
+
     prepare_abi((uint64_t)&ee);
     prepare_abi(instr_word);
 
@@ -1786,4 +2019,9 @@ bool ee_check_interlock(EmotionEngine& ee)
 void ee_clear_interlock(EmotionEngine& ee)
 {
     ee.clear_interlock();
+}
+
+void ee_skip_idle_loop(EmotionEngine& ee)
+{
+    ee.skip_idle_loop();
 }
\ No newline at end of file
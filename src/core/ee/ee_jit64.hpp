@@ -2,6 +2,7 @@
 #define EE_JIT64_HPP
 #include "../jitcommon/emitter64.hpp"
 #include "../jitcommon/ir_block.hpp"
+#include "../jitcommon/jitfallbacks.hpp"
 #include "ee_jittrans.hpp"
 #include "emotion.hpp"
 #include "vu.hpp"
@@ -74,6 +75,7 @@ private:
     EEJitHeap jit_heap;
     Emitter64 emitter;
     EE_JitTranslator ir;
+    JitFallbackCounters fallback_counters;
 
     int sp_offset;
     std::vector<REG_64> saved_int_regs;
@@ -90,6 +92,10 @@ private:
     // Cycles added to the cycle count in the middle of the block, e.g. UpdateVU0
     uint64_t cycles_added;
 
+    // Set for blocks that EE_IdleLoop recognizes as waiting on something outside the EE
+    bool idle_loop;
+    uint32_t block_pc;
+
     bool should_update_mac;
 
     //Pointer to the dispatcher prologue that begins execution of recompiled code
@@ -203,9 +209,17 @@ private:
     void parallel_compare_greater_than_byte(EmotionEngine& ee, IR::Instruction& instr);
     void parallel_compare_greater_than_halfword(EmotionEngine& ee, IR::Instruction& instr);
     void parallel_compare_greater_than_word(EmotionEngine& ee, IR::Instruction& instr);
+    void parallel_copy_lower_doubleword(EmotionEngine& ee, IR::Instruction& instr);
+    void parallel_copy_upper_doubleword(EmotionEngine& ee, IR::Instruction& instr);
     void parallel_divide_word(EmotionEngine& ee, IR::Instruction& instr);
     void parallel_exchange_halfword(EmotionEngine& ee, IR::Instruction& instr, bool even);
     void parallel_exchange_word(EmotionEngine& ee, IR::Instruction& instr, bool even);
+    void parallel_extend_lower_from_byte(EmotionEngine& ee, IR::Instruction& instr);
+    void parallel_extend_lower_from_halfword(EmotionEngine& ee, IR::Instruction& instr);
+    void parallel_extend_lower_from_word(EmotionEngine& ee, IR::Instruction& instr);
+    void parallel_extend_upper_from_byte(EmotionEngine& ee, IR::Instruction& instr);
+    void parallel_extend_upper_from_halfword(EmotionEngine& ee, IR::Instruction& instr);
+    void parallel_extend_upper_from_word(EmotionEngine& ee, IR::Instruction& instr);
     void parallel_pack_to_byte(EmotionEngine& ee, IR::Instruction& instr);
     void parallel_maximize_halfword(EmotionEngine& ee, IR::Instruction& instr);
     void parallel_maximize_word(EmotionEngine& ee, IR::Instruction& instr);
@@ -314,14 +328,21 @@ private:
     void emit_prologue();
     void emit_dispatcher();
     void emit_instruction(EmotionEngine &ee, IR::Instruction &instr);
+    void find_loop_regs(EmotionEngine& ee, IR::Block block, AllocReg* loop_int_regs, AllocReg* loop_xmm_regs);
+    uint8_t* load_loop_regs(EmotionEngine& ee, const AllocReg* loop_int_regs, const AllocReg* loop_xmm_regs);
+    void emit_loop_back_edge(EmotionEngine& ee, IR::Block& block, const AllocReg* loop_int_regs,
+                             const AllocReg* loop_xmm_regs, uint8_t* loop_start);
     EEJitBlockRecord* recompile_block(EmotionEngine& ee, IR::Block& block);
     void cleanup_recompiler(EmotionEngine& ee, bool clear_regs, bool dispatcher, uint64_t cycles);
+    void update_cycle_count(uint64_t cycles);
+    void clear_reg_state();
     void emit_epilogue();
 public:
     EE_JIT64();
 
     void reset(bool clear_cache = true);
     uint16_t run(EmotionEngine& ee);
+    const JitFallbackCounters& get_fallback_counters() const;
 
     friend uint8_t* exec_block_ee(EE_JIT64& jit, EmotionEngine& ee);
 };
@@ -343,5 +364,6 @@ uint32_t vu0_read_CMSAR0_shl3(VectorUnit& vu0);
 bool ee_vu0_wait(EmotionEngine& ee);
 bool ee_check_interlock(EmotionEngine& ee);
 void ee_clear_interlock(EmotionEngine& ee);
+void ee_skip_idle_loop(EmotionEngine& ee);
 
 #endif // EE_JIT64_HPP
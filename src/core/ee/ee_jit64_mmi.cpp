@@ -1,4 +1,5 @@
 #include "ee_jit64.hpp"
+#include "../jitcommon/cpuinfo.hpp"
 
 void EE_JIT64::move_quadword_reg(EmotionEngine& ee, IR::Instruction& instr)
 {
@@ -13,7 +14,14 @@ void EE_JIT64::parallel_absolute_halfword(EmotionEngine& ee, IR::Instruction& in
     REG_64 source = alloc_reg(ee, instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
     REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
 
+    REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+
+    //PABSW leaves 0x8000 as is, the EE saturates it to 0x7FFF
     emitter.PABSW(source, dest);
+    emitter.PCMPEQW_XMM(XMM0, XMM0);
+    emitter.PSRLW(1, XMM0);
+    emitter.PMINUW_XMM(XMM0, dest);
+    free_xmm_reg(ee, XMM0);
 }
 
 void EE_JIT64::parallel_absolute_word(EmotionEngine& ee, IR::Instruction& instr)
@@ -21,7 +29,14 @@ void EE_JIT64::parallel_absolute_word(EmotionEngine& ee, IR::Instruction& instr)
     REG_64 source = alloc_reg(ee, instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
     REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
 
+    REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+
+    //PABSD leaves 0x80000000 as is, the EE saturates it to 0x7FFFFFFF
     emitter.PABSD(source, dest);
+    emitter.PCMPEQD_XMM(XMM0, XMM0);
+    emitter.PSRLD(1, XMM0);
+    emitter.PMINUD_XMM(XMM0, dest);
+    free_xmm_reg(ee, XMM0);
 }
 
 void EE_JIT64::parallel_and(EmotionEngine& ee, IR::Instruction& instr)
@@ -38,6 +53,8 @@ void EE_JIT64::parallel_and(EmotionEngine& ee, IR::Instruction& instr)
     {
         emitter.PAND_XMM(source, dest);
     }
+    else if (HostCPU::has_avx())
+        emitter.VPAND(source, source2, dest);
     else
     {
         emitter.MOVAPS_REG(source, dest);
@@ -87,6 +104,8 @@ void EE_JIT64::parallel_or(EmotionEngine& ee, IR::Instruction& instr)
     {
         emitter.POR_XMM(source, dest);
     }
+    else if (HostCPU::has_avx())
+        emitter.VPOR(source, source2, dest);
     else
     {
         emitter.MOVAPS_REG(source, dest);
@@ -108,6 +127,8 @@ void EE_JIT64::parallel_add_byte(EmotionEngine& ee, IR::Instruction& instr)
     {
         emitter.PADDB(source, dest);
     }
+    else if (HostCPU::has_avx())
+        emitter.VPADDB(source, source2, dest);
     else
     {
         emitter.MOVAPS_REG(source, dest);
@@ -129,6 +150,8 @@ void EE_JIT64::parallel_add_halfword(EmotionEngine& ee, IR::Instruction& instr)
     {
         emitter.PADDW(source, dest);
     }
+    else if (HostCPU::has_avx())
+        emitter.VPADDW(source, source2, dest);
     else
     {
         emitter.MOVAPS_REG(source, dest);
@@ -150,6 +173,8 @@ void EE_JIT64::parallel_add_word(EmotionEngine& ee, IR::Instruction& instr)
     {
         emitter.PADDD(source, dest);
     }
+    else if (HostCPU::has_avx())
+        emitter.VPADDD(source, source2, dest);
     else
     {
         emitter.MOVAPS_REG(source, dest);
@@ -201,7 +226,34 @@ void EE_JIT64::parallel_add_with_signed_saturation_halfword(EmotionEngine& ee, I
 
 void EE_JIT64::parallel_add_with_signed_saturation_word(EmotionEngine& ee, IR::Instruction& instr)
 {
-    // TODO
+    REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD, REG_64::XMM0);
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+    REG_64 result = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+    REG_64 saturated = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+
+    emitter.MOVAPS_REG(source, result);
+    emitter.PADDD(source2, result);
+
+    //The sum overflowed where the operands have the same sign and the sum has the other one
+    emitter.MOVAPS_REG(source, XMM0);
+    emitter.PXOR_XMM(source2, XMM0);
+    emitter.MOVAPS_REG(source, saturated);
+    emitter.PXOR_XMM(result, saturated);
+    emitter.PANDN_XMM(saturated, XMM0);
+
+    //Overflowed words saturate towards the sign of source
+    emitter.MOVAPS_REG(source, saturated);
+    emitter.PSRAD(31, saturated);
+    emitter.load_addr((uint64_t)&FPU_MASK_ABS, REG_64::RAX);
+    emitter.PXOR_XMM_FROM_MEM(REG_64::RAX, saturated);
+    emitter.BLENDVPS_XMM0(saturated, result);
+    emitter.MOVAPS_REG(result, dest);
+
+    free_xmm_reg(ee, XMM0);
+    free_xmm_reg(ee, result);
+    free_xmm_reg(ee, saturated);
 }
 
 void EE_JIT64::parallel_add_with_unsigned_saturation_byte(EmotionEngine& ee, IR::Instruction& instr)
@@ -248,7 +300,18 @@ void EE_JIT64::parallel_add_with_unsigned_saturation_halfword(EmotionEngine& ee,
 
 void EE_JIT64::parallel_add_with_unsigned_saturation_word(EmotionEngine& ee, IR::Instruction& instr)
 {
-    // TODO
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+    REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+
+    //source + min(source2, ~source) saturates at 0xFFFFFFFF
+    emitter.PCMPEQD_XMM(XMM0, XMM0);
+    emitter.PXOR_XMM(source, XMM0);
+    emitter.PMINUD_XMM(source2, XMM0);
+    emitter.PADDD(source, XMM0);
+    emitter.MOVAPS_REG(XMM0, dest);
+    free_xmm_reg(ee, XMM0);
 }
 
 void EE_JIT64::parallel_compare_equal_byte(EmotionEngine& ee, IR::Instruction& instr)
@@ -392,6 +455,56 @@ void EE_JIT64::parallel_compare_greater_than_word(EmotionEngine& ee, IR::Instruc
     }
 }
 
+void EE_JIT64::parallel_copy_lower_doubleword(EmotionEngine& ee, IR::Instruction& instr)
+{
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+
+    if (dest == source2)
+    {
+        emitter.PUNPCKLQDQ(source, dest);
+    }
+    else if (dest == source)
+    {
+        REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+        emitter.MOVAPS_REG(source2, XMM0);
+        emitter.PUNPCKLQDQ(source, XMM0);
+        emitter.MOVAPS_REG(XMM0, dest);
+        free_xmm_reg(ee, XMM0);
+    }
+    else
+    {
+        emitter.MOVAPS_REG(source2, dest);
+        emitter.PUNPCKLQDQ(source, dest);
+    }
+}
+
+void EE_JIT64::parallel_copy_upper_doubleword(EmotionEngine& ee, IR::Instruction& instr)
+{
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+
+    if (dest == source)
+    {
+        emitter.PUNPCKHQDQ(source2, dest);
+    }
+    else if (dest == source2)
+    {
+        REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+        emitter.MOVAPS_REG(source, XMM0);
+        emitter.PUNPCKHQDQ(source2, XMM0);
+        emitter.MOVAPS_REG(XMM0, dest);
+        free_xmm_reg(ee, XMM0);
+    }
+    else
+    {
+        emitter.MOVAPS_REG(source, dest);
+        emitter.PUNPCKHQDQ(source2, dest);
+    }
+}
+
 
 void EE_JIT64::parallel_divide_word(EmotionEngine& ee, IR::Instruction& instr)
 {
@@ -493,12 +606,12 @@ void EE_JIT64::parallel_exchange_halfword(EmotionEngine& ee, IR::Instruction& in
     if (even)
     {
         emitter.PSHUFLW(0xC6, source, dest);
-        emitter.PSHUFHW(0xC6, source, dest);
+        emitter.PSHUFHW(0xC6, dest, dest);
     }
     else
     {
         emitter.PSHUFLW(0xD8, source, dest);
-        emitter.PSHUFHW(0xD8, source, dest);
+        emitter.PSHUFHW(0xD8, dest, dest);
     }
 }
 
@@ -513,6 +626,156 @@ void EE_JIT64::parallel_exchange_word(EmotionEngine& ee, IR::Instruction& instr,
         emitter.PSHUFD(0xD8, source, dest);
 }
 
+void EE_JIT64::parallel_extend_lower_from_byte(EmotionEngine& ee, IR::Instruction& instr)
+{
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+
+    if (dest == source2)
+    {
+        emitter.PUNPCKLBW(source, dest);
+    }
+    else if (dest == source)
+    {
+        REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+        emitter.MOVAPS_REG(source2, XMM0);
+        emitter.PUNPCKLBW(source, XMM0);
+        emitter.MOVAPS_REG(XMM0, dest);
+        free_xmm_reg(ee, XMM0);
+    }
+    else
+    {
+        emitter.MOVAPS_REG(source2, dest);
+        emitter.PUNPCKLBW(source, dest);
+    }
+}
+
+void EE_JIT64::parallel_extend_lower_from_halfword(EmotionEngine& ee, IR::Instruction& instr)
+{
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+
+    if (dest == source2)
+    {
+        emitter.PUNPCKLWD(source, dest);
+    }
+    else if (dest == source)
+    {
+        REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+        emitter.MOVAPS_REG(source2, XMM0);
+        emitter.PUNPCKLWD(source, XMM0);
+        emitter.MOVAPS_REG(XMM0, dest);
+        free_xmm_reg(ee, XMM0);
+    }
+    else
+    {
+        emitter.MOVAPS_REG(source2, dest);
+        emitter.PUNPCKLWD(source, dest);
+    }
+}
+
+void EE_JIT64::parallel_extend_lower_from_word(EmotionEngine& ee, IR::Instruction& instr)
+{
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+
+    if (dest == source2)
+    {
+        emitter.PUNPCKLDQ(source, dest);
+    }
+    else if (dest == source)
+    {
+        REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+        emitter.MOVAPS_REG(source2, XMM0);
+        emitter.PUNPCKLDQ(source, XMM0);
+        emitter.MOVAPS_REG(XMM0, dest);
+        free_xmm_reg(ee, XMM0);
+    }
+    else
+    {
+        emitter.MOVAPS_REG(source2, dest);
+        emitter.PUNPCKLDQ(source, dest);
+    }
+}
+
+void EE_JIT64::parallel_extend_upper_from_byte(EmotionEngine& ee, IR::Instruction& instr)
+{
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+
+    if (dest == source2)
+    {
+        emitter.PUNPCKHBW(source, dest);
+    }
+    else if (dest == source)
+    {
+        REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+        emitter.MOVAPS_REG(source2, XMM0);
+        emitter.PUNPCKHBW(source, XMM0);
+        emitter.MOVAPS_REG(XMM0, dest);
+        free_xmm_reg(ee, XMM0);
+    }
+    else
+    {
+        emitter.MOVAPS_REG(source2, dest);
+        emitter.PUNPCKHBW(source, dest);
+    }
+}
+
+void EE_JIT64::parallel_extend_upper_from_halfword(EmotionEngine& ee, IR::Instruction& instr)
+{
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+
+    if (dest == source2)
+    {
+        emitter.PUNPCKHWD(source, dest);
+    }
+    else if (dest == source)
+    {
+        REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+        emitter.MOVAPS_REG(source2, XMM0);
+        emitter.PUNPCKHWD(source, XMM0);
+        emitter.MOVAPS_REG(XMM0, dest);
+        free_xmm_reg(ee, XMM0);
+    }
+    else
+    {
+        emitter.MOVAPS_REG(source2, dest);
+        emitter.PUNPCKHWD(source, dest);
+    }
+}
+
+void EE_JIT64::parallel_extend_upper_from_word(EmotionEngine& ee, IR::Instruction& instr)
+{
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+
+    if (dest == source2)
+    {
+        emitter.PUNPCKHDQ(source, dest);
+    }
+    else if (dest == source)
+    {
+        REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+        emitter.MOVAPS_REG(source2, XMM0);
+        emitter.PUNPCKHDQ(source, XMM0);
+        emitter.MOVAPS_REG(XMM0, dest);
+        free_xmm_reg(ee, XMM0);
+    }
+    else
+    {
+        emitter.MOVAPS_REG(source2, dest);
+        emitter.PUNPCKHDQ(source, dest);
+    }
+}
+
 void EE_JIT64::parallel_maximize_halfword(EmotionEngine& ee, IR::Instruction& instr)
 {
     REG_64 source = alloc_reg(ee, instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
@@ -737,6 +1000,8 @@ void EE_JIT64::parallel_subtract_byte(EmotionEngine& ee, IR::Instruction& instr)
     {
         emitter.PSUBB(source2, dest);
     }
+    else if (HostCPU::has_avx())
+        emitter.VPSUBB(source, source2, dest);
     else if (dest == source2)
     {
         REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
@@ -762,6 +1027,8 @@ void EE_JIT64::parallel_subtract_halfword(EmotionEngine& ee, IR::Instruction& in
     {
         emitter.PSUBW(source2, dest);
     }
+    else if (HostCPU::has_avx())
+        emitter.VPSUBW(source, source2, dest);
     else if (dest == source2)
     {
         REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
@@ -787,6 +1054,8 @@ void EE_JIT64::parallel_subtract_word(EmotionEngine& ee, IR::Instruction& instr)
     {
         emitter.PSUBD(source2, dest);
     }
+    else if (HostCPU::has_avx())
+        emitter.VPSUBD(source, source2, dest);
     else if (dest == source2)
     {
         REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
@@ -854,7 +1123,35 @@ void EE_JIT64::parallel_subtract_with_signed_saturation_halfword(EmotionEngine&
 
 void EE_JIT64::parallel_subtract_with_signed_saturation_word(EmotionEngine& ee, IR::Instruction& instr)
 {
-    // TODO
+    REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD, REG_64::XMM0);
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+    REG_64 result = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+    REG_64 saturated = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+
+    emitter.MOVAPS_REG(source, result);
+    emitter.PSUBD(source2, result);
+
+    //The difference overflowed where the operands have different signs and the difference has
+    //the sign of source2
+    emitter.MOVAPS_REG(source, XMM0);
+    emitter.PXOR_XMM(source2, XMM0);
+    emitter.MOVAPS_REG(source, saturated);
+    emitter.PXOR_XMM(result, saturated);
+    emitter.PAND_XMM(saturated, XMM0);
+
+    //Overflowed words saturate towards the sign of source
+    emitter.MOVAPS_REG(source, saturated);
+    emitter.PSRAD(31, saturated);
+    emitter.load_addr((uint64_t)&FPU_MASK_ABS, REG_64::RAX);
+    emitter.PXOR_XMM_FROM_MEM(REG_64::RAX, saturated);
+    emitter.BLENDVPS_XMM0(saturated, result);
+    emitter.MOVAPS_REG(result, dest);
+
+    free_xmm_reg(ee, XMM0);
+    free_xmm_reg(ee, result);
+    free_xmm_reg(ee, saturated);
 }
 
 void EE_JIT64::parallel_subtract_with_unsigned_saturation_byte(EmotionEngine& ee, IR::Instruction& instr)
@@ -909,7 +1206,17 @@ void EE_JIT64::parallel_subtract_with_unsigned_saturation_halfword(EmotionEngine
 
 void EE_JIT64::parallel_subtract_with_unsigned_saturation_word(EmotionEngine& ee, IR::Instruction& instr)
 {
-    // TODO
+    REG_64 source = alloc_reg(ee, (int)instr.get_source(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 source2 = alloc_reg(ee, (int)instr.get_source2(), REG_TYPE::GPREXTENDED, REG_STATE::READ);
+    REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
+    REG_64 XMM0 = lalloc_xmm_reg(ee, 0, REG_TYPE::XMMSCRATCHPAD, REG_STATE::SCRATCHPAD);
+
+    //max(source, source2) - source2 saturates at 0
+    emitter.MOVAPS_REG(source, XMM0);
+    emitter.PMAXUD_XMM(source2, XMM0);
+    emitter.PSUBD(source2, XMM0);
+    emitter.MOVAPS_REG(XMM0, dest);
+    free_xmm_reg(ee, XMM0);
 }
 
 void EE_JIT64::parallel_reverse_halfword(EmotionEngine& ee, IR::Instruction& instr)
@@ -918,7 +1225,7 @@ void EE_JIT64::parallel_reverse_halfword(EmotionEngine& ee, IR::Instruction& ins
     REG_64 dest = alloc_reg(ee, instr.get_dest(), REG_TYPE::GPREXTENDED, REG_STATE::WRITE);
 
     emitter.PSHUFLW(0x1B, source, dest);
-    emitter.PSHUFHW(0x1B, source, dest);
+    emitter.PSHUFHW(0x1B, dest, dest);
 }
 
 void EE_JIT64::parallel_rotate_3_words_left(EmotionEngine& ee, IR::Instruction& instr)
@@ -943,6 +1250,8 @@ void EE_JIT64::parallel_xor(EmotionEngine& ee, IR::Instruction& instr)
     {
         emitter.PXOR_XMM(source, dest);
     }
+    else if (HostCPU::has_avx())
+        emitter.VPXOR(source, source2, dest);
     else
     {
         emitter.MOVAPS_REG(source, dest);
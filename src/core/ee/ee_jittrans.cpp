@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <cstring>
 #include <unordered_map> 
+#include "ee_idleloop.hpp"
 #include "ee_jittrans.hpp"
 #include "emotioninterpreter.hpp"
 #include "../errors.hpp"
@@ -115,9 +116,25 @@ IR::Block EE_JitTranslator::translate(EmotionEngine &ee)
         if (instr.op != IR::Opcode::Null)
             block.add_instr(instr);
 
+    block.set_cycle_count(cycle_count);
 
+    //A block ending in a branch back to its own start is a loop, pc is now past the delay slot
+    block.set_idle_loop(EE_IdleLoop::is_idle_loop(ee, ee.get_PC(), pc - 8));
 
-    block.set_cycle_count(cycle_count);
+    //Any other loop can go around again without leaving the block, keeping its registers allocated.
+    //Likely branches are excluded, as their delay slot is emitted apart from the rest of the block.
+    if (!block.is_idle_loop())
+    {
+        for (auto it = instrs.rbegin(); it != instrs.rend(); ++it)
+        {
+            if (!it->is_jump())
+                continue;
+
+            block.set_loop(it->op != IR::Opcode::JumpIndirect && !it->get_is_likely() &&
+                           it->get_jump_dest() == ee.get_PC());
+            break;
+        }
+    }
 
     return block;
 }
@@ -2257,6 +2274,11 @@ void EE_JitTranslator::translate_op_mmi(uint32_t opcode, uint32_t PC, EE_InstrIn
             uint8_t dest = (opcode >> 11) & 0x1F;
             uint8_t source = (opcode >> 16) & 0x1F;
             uint8_t sa = (opcode >> 6) & 0xF;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
             instr.op = IR::Opcode::ParallelShiftLeftLogicalHalfword;
             instr.set_dest(dest);
             instr.set_source(source);
@@ -2270,6 +2292,11 @@ void EE_JitTranslator::translate_op_mmi(uint32_t opcode, uint32_t PC, EE_InstrIn
             uint8_t dest = (opcode >> 11) & 0x1F;
             uint8_t source = (opcode >> 16) & 0x1F;
             uint8_t sa = (opcode >> 6) & 0xF;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
             instr.op = IR::Opcode::ParallelShiftRightLogicalHalfword;
             instr.set_dest(dest);
             instr.set_source(source);
@@ -2283,6 +2310,11 @@ void EE_JitTranslator::translate_op_mmi(uint32_t opcode, uint32_t PC, EE_InstrIn
             uint8_t dest = (opcode >> 11) & 0x1F;
             uint8_t source = (opcode >> 16) & 0x1F;
             uint8_t sa = (opcode >> 6) & 0xF;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
             instr.op = IR::Opcode::ParallelShiftRightArithmeticHalfword;
             instr.set_dest(dest);
             instr.set_source(source);
@@ -2296,6 +2328,11 @@ void EE_JitTranslator::translate_op_mmi(uint32_t opcode, uint32_t PC, EE_InstrIn
             uint8_t dest = (opcode >> 11) & 0x1F;
             uint8_t source = (opcode >> 16) & 0x1F;
             uint8_t sa = (opcode >> 6) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
             instr.op = IR::Opcode::ParallelShiftLeftLogicalWord;
             instr.set_dest(dest);
             instr.set_source(source);
@@ -2309,6 +2346,11 @@ void EE_JitTranslator::translate_op_mmi(uint32_t opcode, uint32_t PC, EE_InstrIn
             uint8_t dest = (opcode >> 11) & 0x1F;
             uint8_t source = (opcode >> 16) & 0x1F;
             uint8_t sa = (opcode >> 6) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
             instr.op = IR::Opcode::ParallelShiftRightLogicalWord;
             instr.set_dest(dest);
             instr.set_source(source);
@@ -2322,6 +2364,11 @@ void EE_JitTranslator::translate_op_mmi(uint32_t opcode, uint32_t PC, EE_InstrIn
             uint8_t dest = (opcode >> 11) & 0x1F;
             uint8_t source = (opcode >> 16) & 0x1F;
             uint8_t sa = (opcode >> 6) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
             instr.op = IR::Opcode::ParallelShiftRightArithmeticWord;
             instr.set_dest(dest);
             instr.set_source(source);
@@ -2579,10 +2626,22 @@ void EE_JitTranslator::translate_op_mmi0(uint32_t opcode, uint32_t PC, EE_InstrI
         }
         case 0x12:
             // PEXTLW
-            Errors::print_warning("[EE_JIT] Unrecognized mmi0 op PEXTLW\n", op);
-            instr.op = IR::Opcode::FallbackInterpreter;
+        {
+            uint8_t dest = (opcode >> 11) & 0x1F;
+            uint8_t source = (opcode >> 21) & 0x1F;
+            uint8_t source2 = (opcode >> 16) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
+            instr.set_dest(dest);
+            instr.set_source(source);
+            instr.set_source2(source2);
+            instr.op = IR::Opcode::ParallelExtendLowerFromWord;
             instrs.push_back(instr);
             break;
+        }
         case 0x13:
             // PPACW
         {
@@ -2639,10 +2698,22 @@ void EE_JitTranslator::translate_op_mmi0(uint32_t opcode, uint32_t PC, EE_InstrI
         }
         case 0x16:
             // PEXTLH
-            Errors::print_warning("[EE_JIT] Unrecognized mmi0 op PEXTLH\n", op);
-            instr.op = IR::Opcode::FallbackInterpreter;
+        {
+            uint8_t dest = (opcode >> 11) & 0x1F;
+            uint8_t source = (opcode >> 21) & 0x1F;
+            uint8_t source2 = (opcode >> 16) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
+            instr.set_dest(dest);
+            instr.set_source(source);
+            instr.set_source2(source2);
+            instr.op = IR::Opcode::ParallelExtendLowerFromHalfword;
             instrs.push_back(instr);
             break;
+        }
         case 0x17:
             // PPACH
         {
@@ -2699,10 +2770,22 @@ void EE_JitTranslator::translate_op_mmi0(uint32_t opcode, uint32_t PC, EE_InstrI
         }
         case 0x1A:
             // PEXTLB
-            Errors::print_warning("[EE_JIT] Unrecognized mmi0 op PEXTLB\n", op);
-            instr.op = IR::Opcode::FallbackInterpreter;
+        {
+            uint8_t dest = (opcode >> 11) & 0x1F;
+            uint8_t source = (opcode >> 21) & 0x1F;
+            uint8_t source2 = (opcode >> 16) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
+            instr.set_dest(dest);
+            instr.set_source(source);
+            instr.set_source2(source2);
+            instr.op = IR::Opcode::ParallelExtendLowerFromByte;
             instrs.push_back(instr);
             break;
+        }
         case 0x1B:
             // PPACB
         {
@@ -2913,9 +2996,22 @@ void EE_JitTranslator::translate_op_mmi1(uint32_t opcode, uint32_t PC, EE_InstrI
         }
         case 0x12:
             // PEXTUW
-            Errors::print_warning("[EE_JIT] Unrecognized mmi1 op PEXTUW\n", op);
+        {
+            uint8_t dest = (opcode >> 11) & 0x1F;
+            uint8_t source = (opcode >> 21) & 0x1F;
+            uint8_t source2 = (opcode >> 16) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
+            instr.set_dest(dest);
+            instr.set_source(source);
+            instr.set_source2(source2);
+            instr.op = IR::Opcode::ParallelExtendUpperFromWord;
             instrs.push_back(instr);
             break;
+        }
         case 0x14:
             // PADDUH
         {
@@ -2954,9 +3050,22 @@ void EE_JitTranslator::translate_op_mmi1(uint32_t opcode, uint32_t PC, EE_InstrI
         }
         case 0x16:
             // PEXTUH
-            Errors::print_warning("[EE_JIT] Unrecognized mmi1 op PEXTUH\n", op);
+        {
+            uint8_t dest = (opcode >> 11) & 0x1F;
+            uint8_t source = (opcode >> 21) & 0x1F;
+            uint8_t source2 = (opcode >> 16) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
+            instr.set_dest(dest);
+            instr.set_source(source);
+            instr.set_source2(source2);
+            instr.op = IR::Opcode::ParallelExtendUpperFromHalfword;
             instrs.push_back(instr);
             break;
+        }
         case 0x18:
             // PADDUB
         {
@@ -2995,9 +3104,22 @@ void EE_JitTranslator::translate_op_mmi1(uint32_t opcode, uint32_t PC, EE_InstrI
         }
         case 0x1A:
             // PEXTUB
-            Errors::print_warning("[EE_JIT] Unrecognized mmi1 op PEXTUB\n", op);
+        {
+            uint8_t dest = (opcode >> 11) & 0x1F;
+            uint8_t source = (opcode >> 21) & 0x1F;
+            uint8_t source2 = (opcode >> 16) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
+            instr.set_dest(dest);
+            instr.set_source(source);
+            instr.set_source2(source2);
+            instr.op = IR::Opcode::ParallelExtendUpperFromByte;
             instrs.push_back(instr);
             break;
+        }
         case 0x1B:
             // QFSRV
             Errors::print_warning("[EE_JIT] Unrecognized mmi1 op QFSRV\n", op);
@@ -3081,9 +3203,22 @@ void EE_JitTranslator::translate_op_mmi2(uint32_t opcode, uint32_t PC, EE_InstrI
         }
         case 0x0E:
             // PCPYLD
-            Errors::print_warning("[EE_JIT] Unrecognized mmi2 op PCPYLD\n", op);
+        {
+            uint8_t dest = (opcode >> 11) & 0x1F;
+            uint8_t source = (opcode >> 21) & 0x1F;
+            uint8_t source2 = (opcode >> 16) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
+            instr.set_dest(dest);
+            instr.set_source(source);
+            instr.set_source2(source2);
+            instr.op = IR::Opcode::ParallelCopyLowerDoubleword;
             instrs.push_back(instr);
             break;
+        }
         case 0x10:
             // PMADDH
             Errors::print_warning("[EE_JIT] Unrecognized mmi2 op PMADDH\n", op);
@@ -3276,9 +3411,22 @@ void EE_JitTranslator::translate_op_mmi3(uint32_t opcode, uint32_t PC, EE_InstrI
             break;
         case 0x0E:
             // PCPYUD
-            Errors::print_warning("[EE_JIT] Unrecognized mmi3 op PCPYUD\n", op);
+        {
+            uint8_t dest = (opcode >> 11) & 0x1F;
+            uint8_t source = (opcode >> 21) & 0x1F;
+            uint8_t source2 = (opcode >> 16) & 0x1F;
+            if (!dest)
+            {
+                // NOP
+                break;
+            }
+            instr.set_dest(dest);
+            instr.set_source(source);
+            instr.set_source2(source2);
+            instr.op = IR::Opcode::ParallelCopyUpperDoubleword;
             instrs.push_back(instr);
             break;
+        }
         case 0x12:
             // POR
         {
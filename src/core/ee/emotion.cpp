@@ -1,28 +1,40 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include "ee_idleloop.hpp"
 #include "ee_jit.hpp"
+#include "ee_jit64.hpp"
 #include "emotion.hpp"
 #include "emotiondisasm.hpp"
 #include "emotioninterpreter.hpp"
 #include "vu.hpp"
 
 #include "../errors.hpp"
+#include "../trace.hpp"
 #include "../emulator.hpp"
 #include "../sif.hpp"
 
 //#define SKIPMPEG_ON
 
-//#define printf(fmt, ...)(0)
-
 EmotionEngine::EmotionEngine(Cop0* cp0, Cop1* fpu, Emulator* e, SubsystemInterface* sif,
                              VectorUnit* vu0, VectorUnit* vu1) :
     cp0(cp0), fpu(fpu), e(e), sif(sif), vu0(vu0), vu1(vu1)
 {
     tlb_map = nullptr;
+    jit = std::unique_ptr<EE_JIT64>(new EE_JIT64());
     set_run_func(&EmotionEngine::run_interpreter);
 }
 
+EmotionEngine::~EmotionEngine()
+{
+
+}
+
+EE_JIT64& EmotionEngine::get_jit()
+{
+    return *jit;
+}
+
 const char* EmotionEngine::REG(int id)
 {
     static const char* names[] =
@@ -136,6 +148,9 @@ void EmotionEngine::reset()
         icache[i].lfu[1] = false;
     }
 
+    for (int i = 0; i < 64; i++)
+        idle_loops[i].branch_pc = 0xFFFFFFFF;
+
     //Clear out $zero
     for (int i = 0; i < 16; i++)
         gpr[i] = 0;
@@ -192,7 +207,7 @@ void EmotionEngine::run_interpreter()
         if (can_disassemble)
         {
             std::string disasm = EmotionDisasm::disasm_instr(instruction, PC);
-            printf("[$%08X] $%08X - %s\n", PC, instruction, disasm.c_str());
+            TRACE_INFO(Trace::EE, "[$%08X] $%08X - %s\n", PC, instruction, disasm.c_str());
             //print_state();
         }
 
@@ -216,6 +231,10 @@ void EmotionEngine::run_interpreter()
                         Errors::die("[EE] Jump to invalid address $%08X from $%08X\n", new_PC, PC - 8);
                     }
                     set_PC(new_PC);
+
+                    //lastPC is the delay slot
+                    if (new_PC < lastPC && check_idle_loop(new_PC, lastPC - 4))
+                        skip_idle_loop();
                 }
             }
             else
@@ -224,13 +243,52 @@ void EmotionEngine::run_interpreter()
     }
 }
 
+uint32_t EmotionEngine::idle_loop_checksum(uint32_t start, uint32_t branch_pc)
+{
+    uint32_t checksum = 2166136261;
+    for (uint32_t addr = start; addr <= branch_pc + 4; addr += 4)
+    {
+        checksum ^= read32(addr);
+        checksum *= 16777619;
+    }
+    return checksum;
+}
+
+bool EmotionEngine::check_idle_loop(uint32_t start, uint32_t branch_pc)
+{
+    if ((branch_pc - start) / 4 + 2 > EE_IdleLoop::MAX_LOOP_LENGTH)
+        return false;
+
+    //The checksum catches code that has been overwritten since the loop was last checked
+    EE_IdleLoopEntry& entry = idle_loops[(branch_pc >> 2) & 63];
+    uint32_t checksum = idle_loop_checksum(start, branch_pc);
+    if (entry.branch_pc != branch_pc || entry.start != start || entry.checksum != checksum)
+    {
+        entry.branch_pc = branch_pc;
+        entry.start = start;
+        entry.checksum = checksum;
+        entry.idle = EE_IdleLoop::is_idle_loop(*this, start, branch_pc);
+    }
+    return entry.idle;
+}
+
+//Called when an idle loop branches back. Nothing it reads can change until the devices run at the
+//end of the slice, so the rest of the slice would be spent going around the loop.
+void EmotionEngine::skip_idle_loop()
+{
+    if (cycles_to_run <= 0)
+        return;
+    cycle_count += cycles_to_run;
+    cycles_to_run = 0;
+}
+
 void EmotionEngine::run_jit()
 {
     //If FlushCache(2) has been executed, reset the JIT.
     //This represents an icache flush.
     if (flush_jit_cache)
     {
-        EE_JIT::reset(true);
+        EE_JIT::reset(this, true);
         flush_jit_cache = false;
     }
 
@@ -268,35 +326,35 @@ void EmotionEngine::set_run_func(std::function<void (EmotionEngine &)> func)
 
 void EmotionEngine::print_state()
 {
-    printf("pc:$%08X\n", PC);
+    TRACE_INFO(Trace::EE, "pc:$%08X\n", PC);
     for (int i = 0; i < 32; i++)
     {
-        printf("%s:$%08X_%08X_%08X_%08X", REG(i), get_gpr<uint32_t>(i, 3), get_gpr<uint32_t>(i, 2), get_gpr<uint32_t>(i, 1), get_gpr<uint32_t>(i));
+        TRACE_INFO(Trace::EE, "%s:$%08X_%08X_%08X_%08X", REG(i), get_gpr<uint32_t>(i, 3), get_gpr<uint32_t>(i, 2), get_gpr<uint32_t>(i, 1), get_gpr<uint32_t>(i));
         if ((i & 1) == 1)
-            printf("\n");
+            TRACE_INFO(Trace::EE, "\n");
         else
-            printf("\t");
+            TRACE_INFO(Trace::EE, "\t");
     }
-    printf("lo:$%08X_%08X_%08X_%08X\t", LO._u32[3], LO._u32[2], LO._u32[1], LO._u32[0]);
-    printf("hi:$%08X_%08X_%08X_%08X\t\n", HI._u32[3], HI._u32[2], HI._u32[1], HI._u32[0]);
-    printf("KSU: %d\n", cp0->status.mode);
+    TRACE_INFO(Trace::EE, "lo:$%08X_%08X_%08X_%08X\t", LO._u32[3], LO._u32[2], LO._u32[1], LO._u32[0]);
+    TRACE_INFO(Trace::EE, "hi:$%08X_%08X_%08X_%08X\t\n", HI._u32[3], HI._u32[2], HI._u32[1], HI._u32[0]);
+    TRACE_INFO(Trace::EE, "KSU: %d\n", cp0->status.mode);
     for (int i = 0; i < 32; i++)
     {
-        printf("f%02d:$%08X", i, fpu->get_gpr(i));
+        TRACE_INFO(Trace::EE, "f%02d:$%08X", i, fpu->get_gpr(i));
         if ((i & 1) == 1)
-            printf("\n");
+            TRACE_INFO(Trace::EE, "\n");
         else
-            printf("\t");
+            TRACE_INFO(Trace::EE, "\t");
     }
     for (int i = 0; i < 32; i++)
     {
-        printf("vf%02d:$%08X_%08X_%08X_%08X", i, vu0->get_gpr_u(i, 3), vu0->get_gpr_u(i, 2), vu0->get_gpr_u(i, 1), vu0->get_gpr_u(i, 0));
+        TRACE_INFO(Trace::EE, "vf%02d:$%08X_%08X_%08X_%08X", i, vu0->get_gpr_u(i, 3), vu0->get_gpr_u(i, 2), vu0->get_gpr_u(i, 1), vu0->get_gpr_u(i, 0));
         if ((i & 1) == 1)
-            printf("\n");
+            TRACE_INFO(Trace::EE, "\n");
         else
-            printf("\t");
+            TRACE_INFO(Trace::EE, "\t");
     }
-    printf("\n");
+    TRACE_INFO(Trace::EE, "\n");
 }
 
 void EmotionEngine::set_disassembly(bool dis)
@@ -976,7 +1034,7 @@ void EmotionEngine::deci2call(uint32_t func, uint32_t param)
     {
         case 0x01:
         {
-            printf("Deci2Open\n");
+            TRACE_INFO(Trace::EE, "Deci2Open\n");
             int id = deci2size;
             deci2size++;
             deci2handlers[id].active = true;
@@ -987,15 +1045,15 @@ void EmotionEngine::deci2call(uint32_t func, uint32_t param)
             break;
         case 0x03:
         {
-            printf("Deci2Send\n");
+            TRACE_INFO(Trace::EE, "Deci2Send\n");
             int id = read32(param);
             if (deci2handlers[id].active)
             {
                 uint32_t addr = read32(deci2handlers[id].addr + 0x10);
-                printf("Str addr: $%08X\n", addr);
+                TRACE_INFO(Trace::EE, "Str addr: $%08X\n", addr);
                 int len = read32(addr) - 0x0C;
                 uint32_t str = addr + 0x0C;
-                printf("Len: %d\n", len);
+                TRACE_INFO(Trace::EE, "Len: %d\n", len);
                 e->ee_deci2send(str, len);
             }
             set_gpr<uint64_t>(2, 1);
@@ -1003,7 +1061,7 @@ void EmotionEngine::deci2call(uint32_t func, uint32_t param)
             break;
         case 0x04:
         {
-            printf("Deci2Poll\n");
+            TRACE_INFO(Trace::EE, "Deci2Poll\n");
             int id = read32(param);
             if (deci2handlers[id].active)
                 write32(deci2handlers[id].addr + 0x0C, 0);
@@ -1011,7 +1069,7 @@ void EmotionEngine::deci2call(uint32_t func, uint32_t param)
         }
             break;
         case 0x10:
-            printf("kputs\n");
+            TRACE_INFO(Trace::EE, "kputs\n");
             e->ee_kputs(param);
             break;
     }
@@ -1021,7 +1079,7 @@ void EmotionEngine::int0()
 {
     if (cp0->status.int0_mask)
     {
-        printf("[EE] INT0!\n");
+        TRACE_DEBUG(Trace::EE, "[EE] INT0!\n");
         handle_exception(0x80000200, 0);
     }
 }
@@ -1030,7 +1088,7 @@ void EmotionEngine::int1()
 {
     if (cp0->status.int1_mask)
     {
-        printf("[EE] INT1!\n");
+        TRACE_DEBUG(Trace::EE, "[EE] INT1!\n");
         //can_disassemble = true;
         handle_exception(0x80000200, 0);
     }
@@ -1040,7 +1098,7 @@ void EmotionEngine::int_timer()
 {
     if (cp0->status.timer_int_mask)
     {
-        printf("[EE] INT TIMER!\n");
+        TRACE_DEBUG(Trace::EE, "[EE] INT TIMER!\n");
         //can_disassemble = true;
         handle_exception(0x80000200, 0);
     }
@@ -1051,7 +1109,7 @@ void EmotionEngine::set_int0_signal(bool value)
     cp0->cause.int0_pending = value;
     if (value)
     {
-        printf("[EE] Set INT0\n");
+        TRACE_DEBUG(Trace::EE, "[EE] Set INT0\n");
         if (cp0->int_enabled())
             int0();
     }
@@ -1061,7 +1119,7 @@ void EmotionEngine::set_int1_signal(bool value)
 {
     cp0->cause.int1_pending = value;
     if (value)
-        printf("[EE] Set INT1\n");
+        TRACE_DEBUG(Trace::EE, "[EE] Set INT1\n");
 }
 
 void EmotionEngine::tlbr()
@@ -1123,7 +1181,7 @@ void EmotionEngine::eret()
     //BIFC0 speedhack
     if (PC >= 0x81FC0 && PC < 0x81FE0)
     {
-        printf("[EE] Entering BIFCO loop\n");
+        TRACE_INFO(Trace::EE, "[EE] Entering BIFCO loop\n");
         halt();
     }
     //And this is for ELFs.
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <functional>
 #include <list>
+#include <memory>
 #include "cop0.hpp"
 #include "cop1.hpp"
 
@@ -29,6 +30,15 @@ struct EE_ICacheLine
     uint32_t tag[2];
 };
 
+//Result of EE_IdleLoop::is_idle_loop for a backwards branch, so the interpreter doesn't redo it every time
+struct EE_IdleLoopEntry
+{
+    uint32_t branch_pc;
+    uint32_t start;
+    uint32_t checksum;
+    bool idle;
+};
+
 //Taken from PS2SDK
 struct EE_OsdConfigParam
 {
@@ -87,6 +97,8 @@ class EmotionEngine
 
         EE_ICacheLine icache[128];
 
+        EE_IdleLoopEntry idle_loops[64];
+
         bool wait_for_IRQ, wait_for_VU0, wait_for_interlock;
         bool branch_on;
         bool can_disassemble;
@@ -96,6 +108,7 @@ class EmotionEngine
         int deci2size;
 
         bool flush_jit_cache;
+        std::unique_ptr<EE_JIT64> jit;
 
         std::function<void(EmotionEngine&)> run_func;
 
@@ -104,8 +117,12 @@ class EmotionEngine
         void deci2call(uint32_t func, uint32_t param);
 
         void log_sifrpc(uint32_t dma_struct_ptr, int len);
+
+        uint32_t idle_loop_checksum(uint32_t start, uint32_t branch_pc);
+        bool check_idle_loop(uint32_t start, uint32_t branch_pc);
     public:
         EmotionEngine(Cop0* cp0, Cop1* fpu, Emulator* e, SubsystemInterface* sif, VectorUnit* vu0, VectorUnit* vu1);
+        ~EmotionEngine();
         static const char* REG(int id);
         static const char* SYSCALL(int id);
         void reset();
@@ -114,6 +131,7 @@ class EmotionEngine
         void run_interpreter();
         void run_jit();
         uint64_t get_cycle_count();
+        EE_JIT64& get_jit();
         uint64_t get_cycle_count_goal();
         void set_cycle_count(uint64_t value);
         void halt();
@@ -121,6 +139,7 @@ class EmotionEngine
         void print_state();
         void set_disassembly(bool dis);
         void set_run_func(std::function<void(EmotionEngine&)> func);
+        void skip_idle_loop();
 
         template <typename T> T get_gpr(int id, int offset = 0);
         template <typename T> T get_LO(int offset = 0);
@@ -9,16 +9,13 @@ DCT_Coeff::DCT_Coeff(VLC_Entry* table, int table_size, int max_bits, unsigned in
 
 }
 
-bool DCT_Coeff::peek_value(IPU_FIFO &FIFO, int bits, int &bit_count, uint32_t &result)
+//Extracts the next field of a run/level code from a window returned by IPU_FIFO::peek_window.
+//Fields past the valid bits read as zero; callers check bit_count against the valid bits at the end.
+uint32_t DCT_Coeff::window_value(uint32_t window, int bits, int &bit_count)
 {
-    if (bits + bit_count > 32)
-    {
-        Errors::die("[DCT Coeff] Bit count > 32!\n");
-    }
-    if (!FIFO.get_bits(result, bits + bit_count))
-        return false;
-
-    result &= ~(0xFFFFFFFF << bits);
+    uint32_t result = 0;
+    if (bit_count < 32)
+        result = (window << bit_count) >> (32 - bits);
     bit_count += bits;
-    return true;
+    return result;
 }
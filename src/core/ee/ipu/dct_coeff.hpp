@@ -19,7 +19,7 @@ class DCT_Coeff : public VLC_Table
         virtual bool get_runlevel_pair(IPU_FIFO& FIFO, RunLevelPair& pair, bool MPEG1) = 0;
         virtual bool get_runlevel_pair_dc(IPU_FIFO& FIFO, RunLevelPair& pair, bool MPEG1) = 0;
 
-        bool peek_value(IPU_FIFO& FIFO, int bits, int& bit_count, uint32_t& result);
+        static uint32_t window_value(uint32_t window, int bits, int& bit_count);
 };
 
 #endif // DCT_COEFF_HPP
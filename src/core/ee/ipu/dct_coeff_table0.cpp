@@ -1,8 +1,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include "dct_coeff_table0.hpp"
-
-#define printf(fmt, ...)(0)
+#include "../../trace.hpp"
 
 VLC_Entry DCT_Coeff_Table0::table[] =
 {
@@ -321,7 +320,7 @@ bool DCT_Coeff_Table0::get_end_of_block(IPU_FIFO &FIFO, uint32_t &result)
     if (!FIFO.get_bits(result, 2))
         return false;
 
-    printf("[DCT_Coeff_Table0] EOB: $%08X\n", result);
+    TRACE_DEBUG(Trace::IPU, "[DCT_Coeff_Table0] EOB: $%08X\n", result);
     result = (result == 2);
     return true;
 }
@@ -337,36 +336,32 @@ bool DCT_Coeff_Table0::get_skip_block(IPU_FIFO &FIFO)
 
 bool DCT_Coeff_Table0::get_runlevel_pair(IPU_FIFO &FIFO, RunLevelPair &pair, bool MPEG1)
 {
+    //The longest code, an MPEG-1 escape with a 16-bit level, is 28 bits, so one window
+    //holds the whole code
+    uint32_t window;
+    int bits_available = FIFO.peek_window(window);
+
     VLC_Entry entry;
-    if (!peek_symbol(FIFO, entry))
+    if (!lookup_symbol(window, bits_available, entry))
         return false;
 
     int bit_count = entry.bits;
     RunLevelPair cur_pair = runlevel_table[entry.value];
-    printf("Run level pair index: %d (Key: $%02X)\n", entry.value, entry.key);
+    TRACE_DEBUG(Trace::IPU, "Run level pair index: %d (Key: $%02X)\n", entry.value, entry.key);
     if (cur_pair.run == RUN_ESCAPE)
     {
-        uint32_t run;
-        if (!peek_value(FIFO, 6, bit_count, run))
-            return false;
-
-        pair.run = run;
+        pair.run = window_value(window, 6, bit_count);
 
         uint32_t level;
         if (MPEG1)
         {
-            if (!peek_value(FIFO, 8, bit_count, level))
-                return false;
+            level = window_value(window, 8, bit_count);
 
             if (!level)
-            {
-                if (!peek_value(FIFO, 8, bit_count, level))
-                    return false;
-            }
+                level = window_value(window, 8, bit_count);
             else if ((uint8_t)level == 128)
             {
-                if (!peek_value(FIFO, 8, bit_count, level))
-                    return false;
+                level = window_value(window, 8, bit_count);
                 level -= 256;
             }
             else if (level > 128)
@@ -374,8 +369,7 @@ bool DCT_Coeff_Table0::get_runlevel_pair(IPU_FIFO &FIFO, RunLevelPair &pair, boo
         }
         else
         {
-            if (!peek_value(FIFO, 12, bit_count, level))
-                return false;
+            level = window_value(window, 12, bit_count);
 
             if (level & 0x800)
             {
@@ -387,9 +381,7 @@ bool DCT_Coeff_Table0::get_runlevel_pair(IPU_FIFO &FIFO, RunLevelPair &pair, boo
     }
     else
     {
-        uint32_t sign = 0;
-        if (!peek_value(FIFO, 1, bit_count, sign))
-            return false;
+        uint32_t sign = window_value(window, 1, bit_count);
 
         pair.run = cur_pair.run;
         if (sign)
@@ -398,6 +390,9 @@ bool DCT_Coeff_Table0::get_runlevel_pair(IPU_FIFO &FIFO, RunLevelPair &pair, boo
             pair.level = cur_pair.level;
     }
 
+    if (bit_count > bits_available)
+        return false;
+
     FIFO.advance_stream(bit_count);
     return true;
 }
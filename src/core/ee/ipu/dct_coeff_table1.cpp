@@ -2,8 +2,7 @@
 #include <cstdlib>
 #include "dct_coeff_table1.hpp"
 #include "../../errors.hpp"
-
-#define printf(fmt, ...)(0)
+#include "../../trace.hpp"
 
 VLC_Entry DCT_Coeff_Table1::table[] =
 {
@@ -302,7 +301,7 @@ bool DCT_Coeff_Table1::get_end_of_block(IPU_FIFO &FIFO, uint32_t &result)
     if (!FIFO.get_bits(result, 4))
         return false;
 
-    printf("[DCT_Coeff_Table1] EOB: $%08X\n", result);
+    TRACE_DEBUG(Trace::IPU, "[DCT_Coeff_Table1] EOB: $%08X\n", result);
     result = (result == 6);
     return true;
 }
@@ -318,30 +317,28 @@ bool DCT_Coeff_Table1::get_skip_block(IPU_FIFO &FIFO)
 
 bool DCT_Coeff_Table1::get_runlevel_pair(IPU_FIFO &FIFO, RunLevelPair &pair, bool MPEG1)
 {
+    //An escape code with its run and level is 24 bits, so one window holds the whole code
+    uint32_t window;
+    int bits_available = FIFO.peek_window(window);
+
     VLC_Entry entry;
-    if (!peek_symbol(FIFO, entry))
+    if (!lookup_symbol(window, bits_available, entry))
         return false;
 
-    printf("Key: $%08X Value: $%08X Bits: %d\n", entry.key, entry.value, entry.bits);
+    TRACE_DEBUG(Trace::IPU, "Key: $%08X Value: $%08X Bits: %d\n", entry.key, entry.value, entry.bits);
     int bit_count = entry.bits;
     RunLevelPair cur_pair = runlevel_table[entry.value];
     if (cur_pair.run == RUN_ESCAPE)
     {
-        printf("[DCT_Coeff_Table1] RUN_ESCAPE\n");
-        uint32_t run = 0;
-        if (!peek_value(FIFO, 6, bit_count, run))
-            return false;
-
-        pair.run = run;
+        TRACE_DEBUG(Trace::IPU, "[DCT_Coeff_Table1] RUN_ESCAPE\n");
+        pair.run = window_value(window, 6, bit_count);
 
         if (MPEG1)
         {
             Errors::die("MPEG1???\n");
         }
 
-        uint32_t level = 0;
-        if (!peek_value(FIFO, 12, bit_count, level))
-            return false;
+        uint32_t level = window_value(window, 12, bit_count);
 
         if (level & 0x800)
         {
@@ -352,9 +349,7 @@ bool DCT_Coeff_Table1::get_runlevel_pair(IPU_FIFO &FIFO, RunLevelPair &pair, boo
     }
     else
     {
-        uint32_t sign = 0;
-        if (!peek_value(FIFO, 1, bit_count, sign))
-            return false;
+        uint32_t sign = window_value(window, 1, bit_count);
 
         pair.run = cur_pair.run;
         if (sign)
@@ -362,6 +357,10 @@ bool DCT_Coeff_Table1::get_runlevel_pair(IPU_FIFO &FIFO, RunLevelPair &pair, boo
         else
             pair.level = cur_pair.level;
     }
+
+    if (bit_count > bits_available)
+        return false;
+
     FIFO.advance_stream(bit_count);
     return true;
 }
@@ -3,12 +3,12 @@
 #include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <emmintrin.h>
 #include "ipu.hpp"
 #include "../dmac.hpp"
 #include "../intc.hpp"
 #include "../../errors.hpp"
-
-#define printf(fmt, ...)(0)
+#include "../../trace.hpp"
 
 /**
   * The majority of this code is based upon Play!'s implementation of the IPU.
@@ -215,6 +215,16 @@ void ImageProcessingUnit::run()
         dmac->set_DMA_request(IPU_FROM);
 }
 
+//Outside of commands, run only raises the FIFO DMA requests, which stay raised until the IPU clears them
+bool ImageProcessingUnit::is_idle()
+{
+    if (ctrl.busy)
+        return false;
+    if (can_write_FIFO() && !dmac->get_DMA_request(IPU_TO))
+        return false;
+    return !can_read_FIFO() || dmac->get_DMA_request(IPU_FROM);
+}
+
 void ImageProcessingUnit::finish_command()
 {
     ctrl.busy = false;
@@ -229,19 +239,19 @@ bool ImageProcessingUnit::process_IDEC()
         switch (idec.state)
         {
             case IDEC_STATE::ADVANCE:
-                printf("[IPU] Advance stream\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Advance stream\n");
                 if (!in_FIFO.advance_stream(command_option & 0x3F))
                     return false;
                 idec.state = IDEC_STATE::MACRO_I_TYPE;
                 break;
             case IDEC_STATE::MACRO_I_TYPE:
-                printf("[IPU] Decode macroblock I type\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Decode macroblock I type\n");
                 if (!macroblock_I_pic.get_symbol(in_FIFO, idec.macro_type))
                     return false;
                 idec.state = IDEC_STATE::DCT_TYPE;
                 break;
             case IDEC_STATE::DCT_TYPE:
-                printf("[IPU] Decode DCT\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Decode DCT\n");
                 if (idec.decodes_dct)
                 {
                     uint32_t value;
@@ -252,7 +262,7 @@ bool ImageProcessingUnit::process_IDEC()
                 idec.state = IDEC_STATE::QSC;
                 break;
             case IDEC_STATE::QSC:
-                printf("[IPU] Decode QSC\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Decode QSC\n");
                 if (idec.macro_type & 0x10)
                 {
                     if (!in_FIFO.get_bits(idec.qsc, 5))
@@ -263,7 +273,7 @@ bool ImageProcessingUnit::process_IDEC()
                 break;
             case IDEC_STATE::INIT_BDEC:
                 //We don't need to advance, and the macroblock is always intra so no need to check for a CBP.
-                printf("[IPU] Init BDEC\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Init BDEC\n");
                 bdec.state = BDEC_STATE::RESET_DC;
                 bdec.intra = true;
                 bdec.quantizer_step = idec.qsc;
@@ -276,7 +286,7 @@ bool ImageProcessingUnit::process_IDEC()
                 idec.state = IDEC_STATE::READ_BLOCK;
                 break;
             case IDEC_STATE::READ_BLOCK:
-                printf("[IPU] Read macroblock\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Read macroblock\n");
                 if (!process_BDEC())
                     return false;
                 idec.blocks_decoded++;
@@ -284,23 +294,15 @@ bool ImageProcessingUnit::process_IDEC()
                 break;
             case IDEC_STATE::INIT_CSC:
                 //BDEC outputs in RAW16. CSC works in RAW8, so we need to convert appropriately.
-                printf("[IPU] Init CSC\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Init CSC\n");
                 for (int i = 0; i < RAW_BLOCK_SIZE / 8; i++)
                 {
                     uint128_t quad = idec.temp_fifo.f.front();
                     idec.temp_fifo.f.pop_front();
 
-                    int offset = i * 8;
-
-                    for (int j = 0; j < 8; j++)
-                    {
-                        int16_t data = quad._s16[j];
-                        if (data < 0)
-                            data = 0;
-                        if (data > 255)
-                            data = 255;
-                        csc.block[offset + j] = (uint8_t)data;
-                    }
+                    //Saturating pack clamps each sample to 0-255
+                    __m128i data = _mm_loadu_si128((const __m128i*)&quad);
+                    _mm_storel_epi64((__m128i*)&csc.block[i * 8], _mm_packus_epi16(data, data));
                 }
                 csc.state = CSC_STATE::CONVERT;
                 csc.block_index = 0;
@@ -309,14 +311,14 @@ bool ImageProcessingUnit::process_IDEC()
                 idec.state = IDEC_STATE::EXEC_CSC;
                 break;
             case IDEC_STATE::EXEC_CSC:
-                printf("[IPU] Exec CSC\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Exec CSC\n");
                 if (!process_CSC())
                     return false;
                 idec.state = IDEC_STATE::CHECK_START_CODE;
                 break;
             case IDEC_STATE::CHECK_START_CODE:
             {
-                printf("[IPU] Check start code\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Check start code\n");
                 uint32_t code;
                 if (!in_FIFO.get_bits(code, 8))
                     return false;
@@ -331,7 +333,7 @@ bool ImageProcessingUnit::process_IDEC()
                 break;
             case IDEC_STATE::VALID_START_CODE:
             {
-                printf("[IPU] Validate start code\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Validate start code\n");
                 uint32_t code;
                 if (!in_FIFO.get_bits(code, 24))
                     return false;
@@ -343,7 +345,7 @@ bool ImageProcessingUnit::process_IDEC()
                 break;
             case IDEC_STATE::MACRO_INC:
             {
-                printf("[IPU] Macroblock increment\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Macroblock increment\n");
                 uint32_t inc;
                 if (!macroblock_increment.get_symbol(in_FIFO, inc))
                     return false;
@@ -353,7 +355,7 @@ bool ImageProcessingUnit::process_IDEC()
             }
                 break;
             case IDEC_STATE::DONE:
-                printf("[IPU] IDEC done!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] IDEC done!\n");
                 return true;
         }
     }
@@ -371,14 +373,14 @@ bool ImageProcessingUnit::process_BDEC()
                 bdec.state = BDEC_STATE::GET_CBP;
                 break;
             case BDEC_STATE::GET_CBP:
-                printf("[IPU] Get CBP!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Get CBP!\n");
                 if (!bdec.intra)
                 {
                     uint32_t pattern;
                     if (!cbp.get_symbol(in_FIFO, pattern))
                         return false;
                     ctrl.coded_block_pattern = pattern;
-                    printf("CBP: %d\n", ctrl.coded_block_pattern);
+                    TRACE_DEBUG(Trace::IPU, "CBP: %d\n", ctrl.coded_block_pattern);
                 }
                 else
                     ctrl.coded_block_pattern = 0x3F;
@@ -387,7 +389,7 @@ bool ImageProcessingUnit::process_BDEC()
             case BDEC_STATE::RESET_DC:
                 if (bdec.reset_dc)
                 {
-                    printf("[IPU] Reset DC!\n");
+                    TRACE_DEBUG(Trace::IPU, "[IPU] Reset DC!\n");
 
                     int16_t value;
                     switch (ctrl.intra_DC_precision)
@@ -411,7 +413,7 @@ bool ImageProcessingUnit::process_BDEC()
                 bdec.state = BDEC_STATE::BEGIN_DECODING;
                 break;
             case BDEC_STATE::BEGIN_DECODING:
-                printf("[IPU] Begin decoding block %d!\n", bdec.block_index);
+                TRACE_DEBUG(Trace::IPU, "[IPU] Begin decoding block %d!\n", bdec.block_index);
 
                 bdec.cur_block = bdec.blocks[bdec.block_index];
                 memset(bdec.cur_block, 0, sizeof(int16_t) * 64);
@@ -426,12 +428,12 @@ bool ImageProcessingUnit::process_BDEC()
 
                     if (bdec.intra && ctrl.intra_VLC_table)
                     {
-                        printf("[IPU] Use DCT coefficient table 1\n");
+                        TRACE_DEBUG(Trace::IPU, "[IPU] Use DCT coefficient table 1\n");
                         dct_coeff = &dct_coeff1;
                     }
                     else
                     {
-                        printf("[IPU] Use DCT coefficient table 0\n");
+                        TRACE_DEBUG(Trace::IPU, "[IPU] Use DCT coefficient table 0\n");
                         dct_coeff = &dct_coeff0;
                     }
 
@@ -443,14 +445,14 @@ bool ImageProcessingUnit::process_BDEC()
                 break;
             case BDEC_STATE::READ_COEFFS:
             {
-                printf("[IPU] Read coeffs!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Read coeffs!\n");
                 if (!BDEC_read_coeffs())
                     return false;
-                printf("[IPU] Inverse scan!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Inverse scan!\n");
                 inverse_scan(bdec.cur_block);
-                printf("[IPU] Dequantize!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Dequantize!\n");
                 dequantize(bdec.cur_block);
-                printf("[IPU] IDCT!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] IDCT!\n");
 
                 int16_t temp[0x40];
                 memcpy(temp, bdec.cur_block, 0x40 * sizeof(int16_t));
@@ -459,7 +461,7 @@ bool ImageProcessingUnit::process_BDEC()
             }
                 break;
             case BDEC_STATE::LOAD_NEXT_BLOCK:
-                printf("[IPU] Load next block!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Load next block!\n");
                 bdec.block_index++;
                 if (bdec.block_index == 6)
                     bdec.state = BDEC_STATE::DONE;
@@ -468,7 +470,7 @@ bool ImageProcessingUnit::process_BDEC()
                 break;
             case BDEC_STATE::DONE:
             {
-                printf("[IPU] BDEC done!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] BDEC done!\n");
                 uint128_t quad;
                 for (int i = 0; i < 8; i++)
                 {
@@ -512,7 +514,7 @@ bool ImageProcessingUnit::process_BDEC()
                     if (!bits)
                     {
                         ctrl.start_code = true;
-                        printf("[IPU] Start code detected!\n");
+                        TRACE_DEBUG(Trace::IPU, "[IPU] Start code detected!\n");
                     }
                     return true;
                 }
@@ -560,7 +562,7 @@ void ImageProcessingUnit::dequantize(int16_t *block)
                 block[0] *= 2;
                 break;
             default:
-                printf("[IPU] Dequantize: Intra DC precision == 3!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] Dequantize: Intra DC precision == 3!\n");
                 block[0] = 0;
                 break;
         }
@@ -655,44 +657,69 @@ void ImageProcessingUnit::prepare_IDCT()
     }
 }
 
+//The transform is evaluated two columns at a time with SSE2 doubles. Each lane accumulates its
+//products in the same order as the scalar mpeg2decode loops, so the output is bit-identical.
+//Coefficient rows that are entirely zero contribute nothing to either pass and are skipped.
 void ImageProcessingUnit::perform_IDCT(const int16_t* pUV, int16_t* pXY)
 {
-    int i, j, k, v;
-    double partial_product;
-    double tmp[64];
+    __m128d tmp[8][4];
+    int nonzero_rows = 0;
 
-    for (i=0; i<8; i++)
+    for (int i = 0; i < 8; i++)
     {
-        for (j=0; j<8; j++)
-        {
-            partial_product = 0.0;
+        __m128i row = _mm_loadu_si128((const __m128i*)&pUV[8 * i]);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(row, _mm_setzero_si128())) == 0xFFFF)
+            continue;
+        nonzero_rows |= 1 << i;
 
-            for (k=0; k<8; k++)
-            {
-                partial_product+= IDCT_table[k][j]*pUV[8*i+k];
-            }
+        __m128d acc[4];
+        for (int j = 0; j < 4; j++)
+            acc[j] = _mm_setzero_pd();
 
-            tmp[8*i+j] = partial_product;
+        for (int k = 0; k < 8; k++)
+        {
+            __m128d coeff = _mm_set1_pd(pUV[8 * i + k]);
+            for (int j = 0; j < 4; j++)
+                acc[j] = _mm_add_pd(acc[j], _mm_mul_pd(_mm_loadu_pd(&IDCT_table[k][j * 2]), coeff));
         }
-    }
 
-  /* Transpose operation is integrated into address mapping by switching
-     loop order of i and j */
+        for (int j = 0; j < 4; j++)
+            tmp[i][j] = acc[j];
+    }
 
-    for (j=0; j<8; j++)
+    const __m128d half = _mm_set1_pd(0.5);
+    for (int i = 0; i < 8; i++)
     {
-        for (i=0; i<8; i++)
-        {
-            partial_product = 0.0;
+        __m128d acc[4];
+        for (int j = 0; j < 4; j++)
+            acc[j] = _mm_setzero_pd();
 
-            for (k=0; k<8; k++)
-            {
-                partial_product+= IDCT_table[k][i]*tmp[8*k+j];
-            }
+        for (int k = 0; k < 8; k++)
+        {
+            if (!(nonzero_rows & (1 << k)))
+                continue;
+            __m128d coeff = _mm_set1_pd(IDCT_table[k][i]);
+            for (int j = 0; j < 4; j++)
+                acc[j] = _mm_add_pd(acc[j], _mm_mul_pd(coeff, tmp[k][j]));
+        }
 
-            v = (int) floor(partial_product+0.5);
-            pXY[8*i+j] = v;
+        //floor(x + 0.5): truncate, then step down where truncation rounded up
+        __m128i result[4];
+        for (int j = 0; j < 4; j++)
+        {
+            __m128d value = _mm_add_pd(acc[j], half);
+            __m128i trunc = _mm_cvttpd_epi32(value);
+            __m128d rounded_up = _mm_cmplt_pd(value, _mm_cvtepi32_pd(trunc));
+            result[j] = _mm_add_epi32(trunc, _mm_shuffle_epi32(_mm_castpd_si128(rounded_up), 0x08));
         }
+
+        //Large coefficients can take the result past 16 bits. Like the scalar store it wraps, so
+        //sign-extend the low halves before the signed pack.
+        __m128i lo = _mm_unpacklo_epi64(result[0], result[1]);
+        __m128i hi = _mm_unpacklo_epi64(result[2], result[3]);
+        lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+        hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+        _mm_storeu_si128((__m128i*)&pXY[8 * i], _mm_packs_epi32(lo, hi));
     }
 }
 
@@ -705,7 +732,7 @@ bool ImageProcessingUnit::BDEC_read_coeffs()
         switch (bdec.read_coeff_state)
         {
             case BDEC_Command::READ_COEFF::INIT:
-                printf("[IPU] READ_COEFF Init!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] READ_COEFF Init!\n");
                 bdec.read_diff_state = BDEC_Command::READ_DIFF::SIZE;
                 bdec.subblock_index = 0;
                 if (bdec.intra)
@@ -717,7 +744,7 @@ bool ImageProcessingUnit::BDEC_read_coeffs()
                     bdec.read_coeff_state = BDEC_Command::READ_COEFF::CHECK_END;
                 break;
             case BDEC_Command::READ_COEFF::READ_DC_DIFF:
-                printf("[IPU] READ_COEFF Read DC diffs!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] READ_COEFF Read DC diffs!\n");
                 if (!BDEC_read_diff())
                     return false;
                 bdec.cur_block[0] = (int16_t)(bdec.dc_predictor[bdec.cur_channel] + bdec.dc_diff);
@@ -725,7 +752,7 @@ bool ImageProcessingUnit::BDEC_read_coeffs()
                 bdec.read_coeff_state = BDEC_Command::READ_COEFF::CHECK_END;
                 break;
             case BDEC_Command::READ_COEFF::CHECK_END:
-                printf("[IPU] READ_COEFF Check end of block!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] READ_COEFF Check end of block!\n");
             {
                 uint32_t end = 0;
                 if (!dct_coeff->get_end_of_block(in_FIFO, end))
@@ -737,7 +764,7 @@ bool ImageProcessingUnit::BDEC_read_coeffs()
             }
                 break;
             case BDEC_Command::READ_COEFF::COEFF:
-                printf("[IPU] READ_COEFF Read coeffs!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] READ_COEFF Read coeffs!\n");
             {
                 RunLevelPair pair;
                 if (!bdec.subblock_index)
@@ -750,7 +777,7 @@ bool ImageProcessingUnit::BDEC_read_coeffs()
                     if (!dct_coeff->get_runlevel_pair(in_FIFO, pair, ctrl.MPEG1))
                         return false;
                 }
-                printf("[IPU] Run: %d Level: %d\n", pair.run, pair.level);
+                TRACE_DEBUG(Trace::IPU, "[IPU] Run: %d Level: %d\n", pair.run, pair.level);
                 bdec.subblock_index += pair.run;
 
                 if (bdec.subblock_index < 0x40)
@@ -766,7 +793,7 @@ bool ImageProcessingUnit::BDEC_read_coeffs()
             }
                 break;
             case BDEC_Command::READ_COEFF::SKIP_END:
-                printf("[IPU] READ_COEFF Skip end!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] READ_COEFF Skip end!\n");
                 if (!dct_coeff->get_skip_block(in_FIFO))
                     return false;
                 return true;
@@ -781,7 +808,7 @@ bool ImageProcessingUnit::BDEC_read_diff()
         switch (bdec.read_diff_state)
         {
             case BDEC_Command::READ_DIFF::SIZE:
-                printf("[IPU] READ_DIFF SIZE!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] READ_DIFF SIZE!\n");
                 if (bdec.cur_channel == 0)
                 {
                     if (!lum_table.get_symbol(in_FIFO, bdec.dc_size))
@@ -795,7 +822,7 @@ bool ImageProcessingUnit::BDEC_read_diff()
                 bdec.read_diff_state = BDEC_Command::READ_DIFF::DIFF;
                 break;
             case BDEC_Command::READ_DIFF::DIFF:
-                printf("[IPU] READ_DIFF DIFF!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] READ_DIFF DIFF!\n");
                 if (!bdec.dc_size)
                     bdec.dc_diff = 0;
                 else
@@ -817,21 +844,119 @@ bool ImageProcessingUnit::BDEC_read_diff()
     }
 }
 
+void ImageProcessingUnit::convert_YCbCr_to_RGB32(const uint8_t* block, uint8_t* rgb32)
+{
+    const uint8_t* lum_block = block;
+    const uint8_t* cb_block = block + 0x100;
+    const uint8_t* cr_block = block + 0x140;
+
+    //Four pixels are converted at a time. The float operations match the original per-pixel
+    //formula in order and precision, so the output is unchanged.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 bias = _mm_set1_ps(128.0f);
+    const __m128 min_color = _mm_setzero_ps();
+    const __m128 max_color = _mm_set1_ps(255.0f);
+    const __m128 th0 = _mm_set1_ps((float)TH0);
+    const __m128 th1 = _mm_set1_ps((float)TH1);
+
+    for (int i = 0; i < 16; i++)
+    {
+        //Each chroma sample covers two pixels horizontally
+        const int chroma_row = crcb_map[i * 16];
+        __m128i cb_row = _mm_loadl_epi64((const __m128i*)&cb_block[chroma_row]);
+        __m128i cr_row = _mm_loadl_epi64((const __m128i*)&cr_block[chroma_row]);
+        cb_row = _mm_unpacklo_epi8(cb_row, cb_row);
+        cr_row = _mm_unpacklo_epi8(cr_row, cr_row);
+        __m128i cb16[2] = {_mm_unpacklo_epi8(cb_row, zero), _mm_unpackhi_epi8(cb_row, zero)};
+        __m128i cr16[2] = {_mm_unpacklo_epi8(cr_row, zero), _mm_unpackhi_epi8(cr_row, zero)};
+
+        __m128i lum_row = _mm_loadu_si128((const __m128i*)&lum_block[i * 16]);
+        __m128i lum16[2] = {_mm_unpacklo_epi8(lum_row, zero), _mm_unpackhi_epi8(lum_row, zero)};
+
+        for (int j = 0; j < 4; j++)
+        {
+            __m128i lum32, cb32, cr32;
+            if (j & 0x1)
+            {
+                lum32 = _mm_unpackhi_epi16(lum16[j >> 1], zero);
+                cb32 = _mm_unpackhi_epi16(cb16[j >> 1], zero);
+                cr32 = _mm_unpackhi_epi16(cr16[j >> 1], zero);
+            }
+            else
+            {
+                lum32 = _mm_unpacklo_epi16(lum16[j >> 1], zero);
+                cb32 = _mm_unpacklo_epi16(cb16[j >> 1], zero);
+                cr32 = _mm_unpacklo_epi16(cr16[j >> 1], zero);
+            }
+
+            __m128 lum = _mm_cvtepi32_ps(lum32);
+            __m128 cb = _mm_sub_ps(_mm_cvtepi32_ps(cb32), bias);
+            __m128 cr = _mm_sub_ps(_mm_cvtepi32_ps(cr32), bias);
+
+            __m128 r = _mm_add_ps(lum, _mm_mul_ps(_mm_set1_ps(1.402f), cr));
+            __m128 g = _mm_sub_ps(lum, _mm_mul_ps(_mm_set1_ps(0.34414f), cb));
+            g = _mm_sub_ps(g, _mm_mul_ps(_mm_set1_ps(0.71414f), cr));
+            __m128 b = _mm_add_ps(lum, _mm_mul_ps(_mm_set1_ps(1.772f), cb));
+
+            r = _mm_min_ps(_mm_max_ps(r, min_color), max_color);
+            g = _mm_min_ps(_mm_max_ps(g, min_color), max_color);
+            b = _mm_min_ps(_mm_max_ps(b, min_color), max_color);
+
+            //Alpha is 0 below TH0, 0x40 below TH1, and 0x80 otherwise
+            __m128 below_th0 = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(r, th0), _mm_cmplt_ps(g, th0)), _mm_cmplt_ps(b, th0));
+            __m128 below_th1 = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(r, th1), _mm_cmplt_ps(g, th1)), _mm_cmplt_ps(b, th1));
+            __m128i alpha = _mm_sub_epi32(_mm_set1_epi32(0x80), _mm_and_si128(_mm_castps_si128(below_th1), _mm_set1_epi32(0x40)));
+            alpha = _mm_andnot_si128(_mm_castps_si128(below_th0), alpha);
+
+            __m128i color = _mm_cvttps_epi32(r);
+            color = _mm_or_si128(color, _mm_slli_epi32(_mm_cvttps_epi32(g), 8));
+            color = _mm_or_si128(color, _mm_slli_epi32(_mm_cvttps_epi32(b), 16));
+            color = _mm_or_si128(color, _mm_slli_epi32(alpha, 24));
+            _mm_storeu_si128((__m128i*)&rgb32[4 * (i * 16 + j * 4)], color);
+        }
+    }
+}
+
 void ImageProcessingUnit::convert_RGB32_to_RGB16(const uint8_t* rgb32, uint16_t* rgb16, bool dithering)
 {
+    //Dithering adds a signed offset with clamping. This is done with an unsigned saturating add of
+    //the positive offsets followed by a saturating subtract of the negative ones.
+    alignas(16) uint8_t dither_add[4][16], dither_sub[4][16];
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 16; j++)
+        {
+            const int dither = (dithering && (j & 0x3) != 3) ? dither_mtx[i][j >> 2] : 0;
+            dither_add[i][j] = std::max(dither, 0);
+            dither_sub[i][j] = std::max(-dither, 0);
+        }
+    }
+
+    const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+    const __m128i alpha_one = _mm_set1_epi32(0x40000000);
     for (int i = 0; i < 16; ++i)
     {
-        for (int j = 0; j < 16; ++j)
+        const __m128i add = _mm_load_si128((const __m128i*)dither_add[i & 3]);
+        const __m128i sub = _mm_load_si128((const __m128i*)dither_sub[i & 3]);
+        __m128i packed[4];
+        for (int j = 0; j < 4; ++j)
         {
+            __m128i color = _mm_loadu_si128((const __m128i*)&rgb32[4 * (i * 16 + j * 4)]);
+            color = _mm_subs_epu8(_mm_adds_epu8(color, add), sub);
+
             //It's worth noting that bit 30 is the alpha bit for RGB16, not bit 31.
-            const int index = j + (i * 16);
-            const int dither = dithering ? dither_mtx[i & 3][j & 3] : 0;
-            const int r = std::max(0, std::min(rgb32[4 * index] + dither, 255)) >> 3;
-            const int g = std::max(0, std::min(rgb32[4 * index + 1] + dither, 255)) >> 3;
-            const int b = std::max(0, std::min(rgb32[4 * index + 2] + dither, 255)) >> 3;
-            const int a = rgb32[4 * index + 3] == 0x40;
-            rgb16[index] = r | g  << 5 | b << 10 | a << 15;
+            __m128i r = _mm_and_si128(_mm_srli_epi32(color, 3), _mm_set1_epi32(0x1F));
+            __m128i g = _mm_and_si128(_mm_srli_epi32(color, 6), _mm_set1_epi32(0x3E0));
+            __m128i b = _mm_and_si128(_mm_srli_epi32(color, 9), _mm_set1_epi32(0x7C00));
+            __m128i a = _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(color, alpha_mask), alpha_one),
+                                      _mm_set1_epi32(0x8000));
+
+            //Sign-extend so the signed pack keeps all 16 bits
+            __m128i result = _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+            packed[j] = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
         }
+        _mm_storeu_si128((__m128i*)&rgb16[i * 16], _mm_packs_epi32(packed[0], packed[1]));
+        _mm_storeu_si128((__m128i*)&rgb16[i * 16 + 8], _mm_packs_epi32(packed[2], packed[3]));
     }
 }
 
@@ -841,23 +966,23 @@ void ImageProcessingUnit::process_VDEC()
     switch (table)
     {
         case 0:
-            printf("[IPU] MBAI\n");
+            TRACE_DEBUG(Trace::IPU, "[IPU] MBAI\n");
             VDEC_table = &macroblock_increment;
             break;
         case 1:
-            printf("[IPU] MBT\n");
+            TRACE_DEBUG(Trace::IPU, "[IPU] MBT\n");
             switch (ctrl.picture_type)
             {
                 case 0x1:
-                    printf("[IPU] I pic\n");
+                    TRACE_DEBUG(Trace::IPU, "[IPU] I pic\n");
                     VDEC_table = &macroblock_I_pic;
                     break;
                 case 0x2:
-                    printf("[IPU] P pic\n");
+                    TRACE_DEBUG(Trace::IPU, "[IPU] P pic\n");
                     VDEC_table = &macroblock_P_pic;
                     break;
                 case 0x3:
-                    printf("[IPU] B pic\n");
+                    TRACE_DEBUG(Trace::IPU, "[IPU] B pic\n");
                     VDEC_table = &macroblock_B_pic;
                     break;
                 default:
@@ -865,7 +990,7 @@ void ImageProcessingUnit::process_VDEC()
             }
             break;
         case 2:
-            printf("[IPU] MC\n");
+            TRACE_DEBUG(Trace::IPU, "[IPU] MC\n");
             VDEC_table = &motioncode;
             break;
         default:
@@ -888,7 +1013,7 @@ void ImageProcessingUnit::process_VDEC()
                     vdec_state = VDEC_STATE::DONE;
                 break;
             case VDEC_STATE::DONE:
-                printf("[IPU] VDEC done! Output: $%08X\n", command_output);
+                TRACE_DEBUG(Trace::IPU, "[IPU] VDEC done! Output: $%08X\n", command_output);
                 finish_command();
                 return;
         }
@@ -913,7 +1038,7 @@ void ImageProcessingUnit::process_FDEC()
                 break;
             case VDEC_STATE::DONE:
                 finish_command();
-                printf("[IPU] FDEC result: $%08X\n", command_output);
+                TRACE_DEBUG(Trace::IPU, "[IPU] FDEC result: $%08X\n", command_output);
                 return;
         }
     }
@@ -939,76 +1064,27 @@ bool ImageProcessingUnit::process_CSC()
                     csc.state = CSC_STATE::CONVERT;
                 else
                 {
-                    uint32_t value;
-                    if (!in_FIFO.get_bits(value, 8))
+                    int bytes = in_FIFO.read_bytes(csc.block + csc.block_index, RAW_BLOCK_SIZE - csc.block_index);
+                    if (!bytes)
                         return false;
-                    in_FIFO.advance_stream(8);
-                    csc.block[csc.block_index] = value & 0xFF;
-                    csc.block_index++;
+                    csc.block_index += bytes;
                 }
                 break;
             case CSC_STATE::CONVERT:
             {
-                uint8_t rgb32[4 * RGB_BLOCK_SIZE];
-
-                uint8_t* lum_block = csc.block;
-                uint8_t* cb_block = csc.block + 0x100;
-                uint8_t* cr_block = csc.block + 0x140;
-
-                for (int i = 0; i < 16; i++)
-                {
-                    for (int j = 0; j < 16; j++)
-                    {
-                        int index = j + (i * 16);
-                        float lum = lum_block[index];
-                        float cb = cb_block[crcb_map[index]];
-                        float cr = cr_block[crcb_map[index]];
-
-                        float r = lum + 1.402f * (cr - 128);
-                        float g = lum - 0.34414f * (cb - 128) - 0.71414f * (cr - 128);
-                        float b = lum + 1.772f * (cb - 128);
-
-                        if (r < 0)
-                            r = 0;
-                        if (r > 255)
-                            r = 255;
-                        if (g < 0)
-                            g = 0;
-                        if (g > 255)
-                            g = 255;
-                        if (b < 0)
-                            b = 0;
-                        if (b > 255)
-                            b = 255;
-
-                        uint8_t alpha;
-                        if (r < TH0 && g < TH0 && b < TH0)
-                            alpha = 0;
-                        else if (r < TH1 && g < TH1 && b < TH1)
-                            alpha = 0x40;
-                        else
-                            alpha = 0x80;
-
-                        rgb32[4 * index] = (uint8_t)r;
-                        rgb32[4 * index + 1] = (uint8_t)g;
-                        rgb32[4 * index + 2] = (uint8_t)b;
-                        rgb32[4 * index + 3] = alpha;
-                    }
-                }
+                alignas(16) uint8_t rgb32[4 * RGB_BLOCK_SIZE];
+                convert_YCbCr_to_RGB32(csc.block, rgb32);
 
                 uint128_t quad;
                 if (csc.use_RGB16)
                 {
-                    uint16_t rgb16[RGB_BLOCK_SIZE];
+                    alignas(16) uint16_t rgb16[RGB_BLOCK_SIZE];
 
                     convert_RGB32_to_RGB16(rgb32, rgb16, csc.use_dithering);
 
                     for (int i = 0; i < RGB_BLOCK_SIZE / 8; i++)
                     {
-                        for (int j = 0; j < 8; j++)
-                        {
-                            quad._u16[j] = rgb16[j + (i * 8)];
-                        }
+                        memcpy(&quad, &rgb16[i * 8], sizeof(quad));
                         out_FIFO.f.push_back(quad);
                     }
                 }
@@ -1016,16 +1092,7 @@ bool ImageProcessingUnit::process_CSC()
                 {
                     for (int i = 0; i < RGB_BLOCK_SIZE / 4; i++)
                     {
-                        for (int j = 0; j < 4; j++)
-                        {
-                            int index = 4 * (j + (i * 4));
-                            uint8_t r = rgb32[index];
-                            uint8_t g = rgb32[index + 1];
-                            uint8_t b = rgb32[index + 2];
-                            uint8_t a = rgb32[index + 3];
-                            uint32_t color = r | g << 8 | b << 16 | a << 24;
-                            quad._u32[j] = color;
-                        }
+                        memcpy(&quad, &rgb32[i * 16], sizeof(quad));
                         out_FIFO.f.push_back(quad);
                     }
                 }
@@ -1035,7 +1102,7 @@ bool ImageProcessingUnit::process_CSC()
             }
                 break;
             case CSC_STATE::DONE:
-                printf("[IPU] CSC done!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] CSC done!\n");
                 return true;
         }
     }
@@ -1061,12 +1128,10 @@ bool ImageProcessingUnit::process_PACK()
                     pack.state = PACK_STATE::CONVERT;
                 else
                 {
-                    uint32_t value;
-                    if (!in_FIFO.get_bits(value, 8))
+                    int bytes = in_FIFO.read_bytes(pack.block + pack.block_index, 4 * RGB_BLOCK_SIZE - pack.block_index);
+                    if (!bytes)
                         return false;
-                    in_FIFO.advance_stream(8);
-                    pack.block[pack.block_index] = value & 0xFF;
-                    pack.block_index++;
+                    pack.block_index += bytes;
                 }
                 break;
             case PACK_STATE::CONVERT:
@@ -1142,7 +1207,7 @@ bool ImageProcessingUnit::process_PACK()
             }
                 break;
             case PACK_STATE::DONE:
-                printf("[IPU] PACK done!\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] PACK done!\n");
                 return true;
         }
     }
@@ -1186,7 +1251,7 @@ uint32_t ImageProcessingUnit::read_BP()
     }
     reg |= in_FIFO.bit_pointer;
     reg |= fifo_size << 8;
-    printf("[IPU] Read BP: $%08X\n", reg);
+    TRACE_DEBUG(Trace::IPU, "[IPU] Read BP: $%08X\n", reg);
     return reg;
 }
 
@@ -1214,7 +1279,7 @@ uint64_t ImageProcessingUnit::read_top()
 
 void ImageProcessingUnit::write_command(uint32_t value)
 {
-    printf("[IPU] Write command: $%08X\n", value);
+    TRACE_DEBUG(Trace::IPU, "[IPU] Write command: $%08X\n", value);
     if (!ctrl.busy)
     {
         ctrl.busy = true;
@@ -1225,13 +1290,13 @@ void ImageProcessingUnit::write_command(uint32_t value)
         switch (command)
         {
             case 0x00:
-                printf("[IPU] BCLR\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] BCLR\n");
                 in_FIFO.reset();
                 in_FIFO.bit_pointer = command_option & 0x7F;
                 finish_command();
                 break;
             case 0x01:
-                printf("[IPU] IDEC\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] IDEC\n");
                 idec.state = IDEC_STATE::ADVANCE;
                 idec.macro_type = 0;
                 idec.qsc = (command_option >> 16) & 0x1F;
@@ -1240,7 +1305,7 @@ void ImageProcessingUnit::write_command(uint32_t value)
                 csc.use_RGB16 = command_option & (1 << 27);
                 break;
             case 0x02:
-                printf("[IPU] BDEC\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] BDEC\n");
                 bdec.state = BDEC_STATE::ADVANCE;
                 bdec.out_fifo = &out_FIFO;
                 ctrl.coded_block_pattern = 0x3F;
@@ -1252,42 +1317,42 @@ void ImageProcessingUnit::write_command(uint32_t value)
                 bdec.check_start_code = true;
                 break;
             case 0x03:
-                printf("[IPU] VDEC\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] VDEC\n");
                 command_decoding = true;
                 vdec_state = VDEC_STATE::ADVANCE;
                 process_VDEC();
                 break;
             case 0x04:
-                printf("[IPU] FDEC\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] FDEC\n");
                 command_decoding = true;
                 fdec_state = VDEC_STATE::ADVANCE;
                 process_FDEC();
                 break;
             case 0x05:
-                printf("[IPU] SETIQ\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] SETIQ\n");
                 bytes_left = 64;
                 setiq_state = SETIQ_STATE::ADVANCE;
                 break;
             case 0x06:
-                printf("[IPU] SETVQ\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] SETVQ\n");
                 bytes_left = 32;
                 break;
             case 0x07:
-                printf("[IPU] CSC\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] CSC\n");
                 csc.state = CSC_STATE::BEGIN;
                 csc.macroblocks = command_option & 0x7FF;
                 csc.use_RGB16 = command_option & (1 << 27);
                 csc.use_dithering = command_option & (1 << 26);
                 break;
             case 0x08:
-                printf("[IPU] PACK\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] PACK\n");
                 pack.state = PACK_STATE::BEGIN;
                 pack.macroblocks = command_option & 0x7FF;
                 pack.use_RGB16 = command_option & (1 << 27);
                 pack.use_dithering = command_option & (1 << 26);
                 break;
             case 0x09:
-                printf("[IPU] SETTH\n");
+                TRACE_DEBUG(Trace::IPU, "[IPU] SETTH\n");
                 TH0 = command_option & 0x1FF;
                 TH1 = (command_option >> 16) & 0x1FF;
                 finish_command();
@@ -1302,7 +1367,7 @@ void ImageProcessingUnit::write_command(uint32_t value)
 
 void ImageProcessingUnit::write_control(uint32_t value)
 {
-    printf("[IPU] Write control: $%08X\n", value);
+    TRACE_DEBUG(Trace::IPU, "[IPU] Write control: $%08X\n", value);
     ctrl.intra_DC_precision = (value >> 16) & 0x3;
     ctrl.alternate_scan = value & (1 << 20);
     ctrl.intra_VLC_table = value & (1 << 21);
@@ -1342,7 +1407,7 @@ uint128_t ImageProcessingUnit::read_FIFO()
 
 void ImageProcessingUnit::write_FIFO(uint128_t quad)
 {
-    printf("[IPU] Write FIFO: $%08X_%08X_%08X_%08X\n", quad._u32[3], quad._u32[2], quad._u32[1], quad._u32[0]);
+    TRACE_DEBUG(Trace::IPU, "[IPU] Write FIFO: $%08X_%08X_%08X_%08X\n", quad._u32[3], quad._u32[2], quad._u32[1], quad._u32[0]);
     
 
     //Certain games (Theme Park, Neo Contra, etc) read command output without sending a command.
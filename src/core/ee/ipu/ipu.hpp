@@ -229,6 +229,7 @@ class ImageProcessingUnit
         bool BDEC_read_coeffs();
         bool BDEC_read_diff();
 
+        void convert_YCbCr_to_RGB32(const uint8_t* block, uint8_t* rgb32);
         void convert_RGB32_to_RGB16(const uint8_t* rgb32, uint16_t *rgb16, bool dithering);
         void process_VDEC();
         void process_FDEC();
@@ -239,6 +240,7 @@ class ImageProcessingUnit
 
         void reset();
         void run();
+        bool is_idle();
 
         uint64_t read_command();
         uint32_t read_control();
@@ -252,6 +254,9 @@ class ImageProcessingUnit
         bool can_write_FIFO();
         uint128_t read_FIFO();
         void write_FIFO(uint128_t quad);
+
+        //The IPU tests compare the IDCT and CSC kernels with scalar references
+        friend class Emulator;
 };
 
 #endif // IPU_HPP
@@ -1,41 +1,65 @@
+#include <algorithm>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 #include "ipu_fifo.hpp"
 #include "../../errors.hpp"
 
-bool IPU_FIFO::get_bits(uint32_t &data, int bits)
+//MPEG is big-endian...
+static uint32_t load_be32(const uint128_t& quad, int word)
 {
-    int bits_available = (f.size() * 128) - bit_pointer;
+    uint32_t value = quad._u32[word];
+    return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+}
+
+//The reservoir holds the 64 bits starting at the current 32-bit word of the stream, so any
+//window of up to 32 bits can be extracted with a single shift
+void IPU_FIFO::refill_cache()
+{
+    int word = bit_pointer / 32;
+    uint64_t high = load_be32(f[0], word);
+    uint64_t low = 0;
+    if (word < 3)
+        low = load_be32(f[0], word + 1);
+    else if (f.size() > 1)
+        low = load_be32(f[1], 0);
+    cached_bits = (high << 32) | low;
+    bit_cache_dirty = false;
+}
 
-    if (bits_available < bits || bits_available == 0)
+int IPU_FIFO::bits_available() const
+{
+    return (f.size() * 128) - bit_pointer;
+}
+
+//Returns up to the next 32 bits of the stream, left-aligned in window, along with how many of them
+//are valid. Bits past the end of the FIFO read as zero.
+int IPU_FIFO::peek_window(uint32_t& window)
+{
+    int available = bits_available();
+    if (available <= 0)
     {
-        data = 0;
-        return false;
+        window = 0;
+        return 0;
     }
 
     if (bit_cache_dirty)
-    {
-        uint8_t temp[32];
-        *(uint128_t*)&temp[0] = f[0];
-        if (f.size() > 1)
-            *(uint128_t*)&temp[16] = f[1];
+        refill_cache();
 
-        uint8_t blorp[8];
-        int index = (bit_pointer & ~0x1F) / 8;
+    window = (uint32_t)((cached_bits << (bit_pointer % 32)) >> 32);
+    return std::min(available, 32);
+}
 
-        //MPEG is big-endian...
-        for (int i = 0; i < 8; i++)
-        {
-            int fifo_index = index + i;
-            blorp[7 - i] = temp[fifo_index];
-        }
-        bit_cache_dirty = false;
-        cached_bits = *(uint64_t*)&blorp[0];
+bool IPU_FIFO::get_bits(uint32_t &data, int bits)
+{
+    uint32_t window;
+    if (peek_window(window) < bits || !bits)
+    {
+        data = 0;
+        return false;
     }
-    int shift = 64 - (bit_pointer % 32) - bits;
-    uint64_t mask = ~0x0ULL >> (64 - bits);
-    data = (cached_bits >> shift) & mask;
 
+    data = window >> (32 - bits);
     return true;
 }
 
@@ -66,6 +90,41 @@ bool IPU_FIFO::advance_stream(uint8_t amount)
     return true;
 }
 
+//Reads up to count whole bytes from the stream and returns the number read.
+//Byte-aligned streams are copied straight out of the FIFO a quadword at a time.
+int IPU_FIFO::read_bytes(uint8_t* data, int count)
+{
+    int bytes_read = 0;
+    if (bit_pointer & 0x7)
+    {
+        uint32_t value;
+        while (bytes_read < count && get_bits(value, 8))
+        {
+            advance_stream(8);
+            data[bytes_read] = value & 0xFF;
+            bytes_read++;
+        }
+        return bytes_read;
+    }
+
+    while (bytes_read < count && f.size())
+    {
+        int offset = bit_pointer / 8;
+        int size = std::min(16 - offset, count - bytes_read);
+        memcpy(data + bytes_read, (uint8_t*)&f[0] + offset, size);
+        bytes_read += size;
+        bit_pointer += size * 8;
+        if (bit_pointer == 128)
+        {
+            bit_pointer = 0;
+            f.pop_front();
+        }
+    }
+    if (bytes_read)
+        bit_cache_dirty = true;
+    return bytes_read;
+}
+
 void IPU_FIFO::reset()
 {
     std::deque<uint128_t> empty;
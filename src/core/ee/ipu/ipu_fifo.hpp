@@ -11,8 +11,13 @@ struct IPU_FIFO
     int bit_pointer;
     uint64_t cached_bits;
     bool bit_cache_dirty;
+    void refill_cache();
+
+    int bits_available() const;
+    int peek_window(uint32_t& window);
     bool get_bits(uint32_t& data, int bits);
     bool advance_stream(uint8_t amount);
+    int read_bytes(uint8_t* data, int count);
 
     void reset();
     void byte_align();
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstdlib>
 #include <cstdio>
 #include "vlc_table.hpp"
@@ -6,31 +7,88 @@
 VLC_Table::VLC_Table(VLC_Entry* table, int table_size, int max_bits, unsigned int* index_table) :
     table(table), table_size(table_size), max_bits(max_bits), index_table(index_table)
 {
-
+    build_lookup();
 }
 
-bool VLC_Table::peek_symbol(IPU_FIFO &FIFO, VLC_Entry &entry)
+void VLC_Table::build_lookup()
 {
-    uint32_t key;
+    first_bits = std::min(max_bits, (int)FIRST_LEVEL_BITS);
+    const int second_bits = max_bits - first_bits;
+    lookup.assign(1 << first_bits, {-1, 0});
+
+    //Codes are resolved in the same order as the original bit-by-bit search: shortest first,
+    //scanning each length from its index_table position, with the first match winning
     for (int i = 0; i < max_bits; i++)
     {
         int bits = i + 1;
-        if (!FIFO.get_bits(key, bits))
-            return false;
         for (int j = index_table[i]; j < table_size; j++)
         {
             if (bits != table[j].bits)
                 break;
 
-            if (key == table[j].key)
+            uint32_t code = table[j].key << (max_bits - bits);
+            if (bits <= first_bits)
+            {
+                int first = code >> second_bits;
+                int count = 1 << (first_bits - bits);
+                for (int k = 0; k < count; k++)
+                {
+                    VLC_Lookup& slot = lookup[first + k];
+                    if (slot.entry < 0 && !slot.subtable)
+                        slot.entry = (int16_t)j;
+                }
+                continue;
+            }
+
+            int first = code >> second_bits;
+            if (lookup[first].entry >= 0)
+                continue;
+            if (!lookup[first].subtable)
             {
-                entry = table[j];
-                return true;
+                lookup[first].subtable = (uint16_t)lookup.size();
+                lookup.resize(lookup.size() + (1 << second_bits), {-1, 0});
+            }
+
+            int second = code & ((1 << second_bits) - 1);
+            int count = 1 << (max_bits - bits);
+            for (int k = 0; k < count; k++)
+            {
+                VLC_Lookup& slot = lookup[lookup[first].subtable + second + k];
+                if (slot.entry < 0)
+                    slot.entry = (int16_t)j;
             }
         }
     }
-    throw VLC_Error("VLC symbol not found");
-    return false;
+}
+
+//window holds the next bits of the stream left-aligned, of which the first bits are valid.
+//Returns false if the code needs more bits than are available.
+bool VLC_Table::lookup_symbol(uint32_t window, int bits, VLC_Entry& entry)
+{
+    if (!bits)
+        return false;
+
+    uint32_t key = window >> (32 - max_bits);
+    const VLC_Lookup* slot = &lookup[key >> (max_bits - first_bits)];
+    if (slot->subtable)
+        slot = &lookup[slot->subtable + (key & ((1 << (max_bits - first_bits)) - 1))];
+
+    if (slot->entry < 0 || table[slot->entry].bits > bits)
+    {
+        if (bits < max_bits)
+            return false;
+        throw VLC_Error("VLC symbol not found");
+    }
+
+    entry = table[slot->entry];
+    return true;
+}
+
+bool VLC_Table::peek_symbol(IPU_FIFO &FIFO, VLC_Entry &entry)
+{
+    uint32_t window;
+    int bits = FIFO.peek_window(window);
+    return lookup_symbol(window, bits, entry);
 }
 
 bool VLC_Table::get_symbol(IPU_FIFO& FIFO, uint32_t &result)
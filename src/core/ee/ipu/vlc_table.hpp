@@ -3,6 +3,7 @@
 #include <stdexcept>
 #include <cstdint>
 #include <queue>
+#include <vector>
 #include "ipu_fifo.hpp"
 
 struct VLC_Entry
@@ -12,6 +13,14 @@ struct VLC_Entry
     uint8_t bits;
 };
 
+//Decoded codes are looked up with the first FIRST_LEVEL_BITS of the stream. Longer codes point to a
+//second-level table indexed by the remaining bits up to the table's maximum code length.
+struct VLC_Lookup
+{
+    int16_t entry;
+    uint16_t subtable;
+};
+
 class VLC_Error : public std::runtime_error
 {
     using std::runtime_error::runtime_error;
@@ -23,8 +32,16 @@ class VLC_Table
         VLC_Entry* table;
         int table_size, max_bits;
         unsigned int* index_table;
+
+        constexpr static int FIRST_LEVEL_BITS = 8;
+        int first_bits;
+        std::vector<VLC_Lookup> lookup;
+
+        void build_lookup();
     protected:
         VLC_Table(VLC_Entry* table, int table_size, int max_bits, unsigned int* index_table);
+
+        bool lookup_symbol(uint32_t window, int bits, VLC_Entry& entry);
     public:
         bool peek_symbol(IPU_FIFO& FIFO, VLC_Entry& entry);
         bool get_symbol(IPU_FIFO& FIFO, uint32_t& result);
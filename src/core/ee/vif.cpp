@@ -6,8 +6,7 @@
 
 #include "../gif.hpp"
 #include "../errors.hpp"
-
-#define printf(fmt, ...)(0)
+#include "../trace.hpp"
 
 VectorInterface::VectorInterface(GraphicsInterface* gif, VectorUnit* vu, INTC* intc, DMAC* dmac, int id) :
     gif(gif), vu(vu), intc(intc), dmac(dmac), id(id)
@@ -63,7 +62,7 @@ bool VectorInterface::check_vif_stall(uint32_t value)
         //Acknowledge the stall on the next command when triggered on MARK
         if (vif_ibit_detected)
         {
-            printf("[VIF] VIF%x Stalled\n", get_id());
+            TRACE_DEBUG(Trace::VIF, "[VIF] VIF%x Stalled\n", get_id());
             vif_ibit_detected = false;
             vif_interrupt = true;
 
@@ -77,12 +76,12 @@ bool VectorInterface::check_vif_stall(uint32_t value)
         }
         if (vif_stop)
         {
-            printf("[VIF] VIF%x Stopped (Stall)\n", get_id());
+            TRACE_DEBUG(Trace::VIF, "[VIF] VIF%x Stopped (Stall)\n", get_id());
             vif_stalled |= STALL_STOP;
         }
         if (vif_forcebreak)
         {
-            printf("[VIF] VIF%x Force Break (Stall)\n", get_id());
+            TRACE_DEBUG(Trace::VIF, "[VIF] VIF%x Force Break (Stall)\n", get_id());
             vif_stalled |= STALL_FORCEBREAK;
         }
     }
@@ -212,6 +211,21 @@ void VectorInterface::update(int cycles)
     }
 }
 
+//True when update would return without changing anything: either a stall that only a register write
+//can lift, or no data to process and nothing left to wait on
+bool VectorInterface::is_idle()
+{
+    if (fifo_reverse || (vif_stalled & (STALL_DIRECT | STALL_MSKPATH3)))
+        return false;
+    if (vif_stalled)
+        return true;
+    if (FIFO.size() || internal_FIFO.size() || stall_condition_active)
+        return false;
+    if ((command & 0x60) == 0x60 || vif_ibit_detected || vif_stop || vif_forcebreak)
+        return false;
+    return vif_cmd_status == VIF_IDLE || vif_cmd_status == VIF_WAIT;
+}
+
 bool VectorInterface::process_data_word(uint32_t value)
 {
     if (command == 0)
@@ -227,20 +241,20 @@ bool VectorInterface::process_data_word(uint32_t value)
         {
             case 0x20:
                 //STMASK
-                printf("[VIF] New MASK: $%08X\n", value);
+                TRACE_DEBUG(Trace::VIF, "[VIF] New MASK: $%08X\n", value);
                 MASK = value;
                 command = 0;
                 break;
             case 0x30:
                 //STROW
-                printf("[VIF] ROW%d: $%08X\n", 4 - command_len, value);
+                TRACE_DEBUG(Trace::VIF, "[VIF] ROW%d: $%08X\n", 4 - command_len, value);
                 ROW[4 - command_len] = value;
                 if (command_len <= 1)
                     command = 0;
                 break;
             case 0x31:
                 //STCOL
-                printf("[VIF] COL%d: $%08X\n", 4 - command_len, value);
+                TRACE_DEBUG(Trace::VIF, "[VIF] COL%d: $%08X\n", 4 - command_len, value);
                 COL[4 - command_len] = value;
                 if (command_len <= 1)
                     command = 0;
@@ -319,7 +333,7 @@ void VectorInterface::decode_cmd(uint32_t value)
             command = 0;
             break;
         case 0x01:
-            printf("[VIF] Set CYCLE: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] Set CYCLE: $%08X\n", value);
             CYCLE.CL = imm & 0xFF;
             CYCLE.WL = imm >> 8;
             internal_WL = CYCLE.WL;
@@ -328,48 +342,48 @@ void VectorInterface::decode_cmd(uint32_t value)
             command = 0;
             break;
         case 0x02:
-            printf("[VIF] Set OFFSET: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] Set OFFSET: $%08X\n", value);
             OFST = value & 0x3FF;
             TOPS = BASE;
             DBF = false;
             command = 0;
             break;
         case 0x03:
-            printf("[VIF] Set BASE: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] Set BASE: $%08X\n", value);
             BASE = value & 0x3FF;
             command = 0;
             break;
         case 0x04:
-            printf("[VIF] Set ITOP: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] Set ITOP: $%08X\n", value);
             ITOPS = value & 0x3FF;
             command = 0;
             break;
         case 0x05:
-            printf("[VIF] Set MODE: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] Set MODE: $%08X\n", value);
             MODE = value & 0x3;
             command = 0;
             break;
         case 0x06:
-            printf("[VIF] MSKPATH3: %d\n", (value >> 15) & 0x1);
+            TRACE_DEBUG(Trace::VIF, "[VIF] MSKPATH3: %d\n", (value >> 15) & 0x1);
             if(gif->set_path3_vifmask((value >> 15) & 0x1))
                 vif_stalled |= STALL_MSKPATH3;
             command = 0;
             break;
         case 0x07:
-            printf("[VIF] Set MARK: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] Set MARK: $%08X\n", value);
             MARK = imm;
             mark_detected = true;
             command = 0;
             break;
         case 0x10:
-            printf("[VIF] FLUSHE\n");
+            TRACE_DEBUG(Trace::VIF, "[VIF] FLUSHE\n");
             wait_for_VU = true;
             stall_condition_active = true;
             wait_cmd_value = value;
             command = 0;
             break;
         case 0x11:
-            printf("[VIF] FLUSH\n");
+            TRACE_DEBUG(Trace::VIF, "[VIF] FLUSH\n");
             wait_for_VU = true;
             if (gif)
                 flush_stall = true;
@@ -378,7 +392,7 @@ void VectorInterface::decode_cmd(uint32_t value)
             command = 0;
             break;
         case 0x13:
-            printf("[VIF] FLUSHA\n");
+            TRACE_DEBUG(Trace::VIF, "[VIF] FLUSHA\n");
             wait_for_VU = true;
             if (gif)
             {
@@ -390,14 +404,14 @@ void VectorInterface::decode_cmd(uint32_t value)
             command = 0;
             break;
         case 0x14:
-            printf("[VIF] MSCAL\n");
+            TRACE_DEBUG(Trace::VIF, "[VIF] MSCAL\n");
             wait_for_VU = true;
             stall_condition_active = true;
             wait_cmd_value = value;
             command = 0;
             break;
         case 0x15:
-            printf("[VIF] MSCALF\n");
+            TRACE_DEBUG(Trace::VIF, "[VIF] MSCALF\n");
             wait_for_VU = true;
             if (gif)
                 flush_stall = true;
@@ -406,26 +420,26 @@ void VectorInterface::decode_cmd(uint32_t value)
             command = 0;
             break;
         case 0x17:
-            printf("[VIF] MSCNT\n");
+            TRACE_DEBUG(Trace::VIF, "[VIF] MSCNT\n");
             wait_for_VU = true;
             stall_condition_active = true;
             wait_cmd_value = value;
             command = 0;
             break;
         case 0x20:
-            printf("[VIF] Set MASK: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] Set MASK: $%08X\n", value);
             command_len++;
             break;
         case 0x30:
-            printf("[VIF] Set ROW: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] Set ROW: $%08X\n", value);
             command_len += 4;
             break;
         case 0x31:
-            printf("[VIF] Set COL: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] Set COL: $%08X\n", value);
             command_len += 4;
             break;
         case 0x4A:
-            printf("[VIF] MPG: $%08X\n", value);
+            TRACE_DEBUG(Trace::VIF, "[VIF] MPG: $%08X\n", value);
             {
                 int num = (value >> 16) & 0xFF;
                 if (!num)
@@ -446,7 +460,7 @@ void VectorInterface::decode_cmd(uint32_t value)
                 command_len += 65536;
             else
                 command_len += (imm * 4);
-            printf("[VIF] DIRECT: %d\n", command_len);
+            TRACE_DEBUG(Trace::VIF, "[VIF] DIRECT: %d\n", command_len);
             break;
         default:
             if ((command & 0x60) == 0x60)
@@ -503,7 +517,7 @@ void VectorInterface::MSCAL(uint32_t addr, uint32_t cycles)
 void VectorInterface::init_UNPACK(uint32_t value)
 {
     uint32_t data_read;
-    printf("[VIF] UNPACK: $%08X\n", value);
+    TRACE_DEBUG(Trace::VIF, "[VIF] UNPACK: $%08X\n", value);
     unpack.addr = (imm & 0x3FF) * 16;
     unpack.sign_extend = !(imm & (1 << 14));
     unpack.masked = (command >> 4) & 0x1;
@@ -952,7 +966,7 @@ bool VectorInterface::transfer_word(uint32_t value)
     if (FIFO.size() > (fifo_size - 1))
         return false;
 
-    printf("[VIF] Transfer 32bit Value: $%08X\n", value);
+    TRACE_DEBUG(Trace::VIF, "[VIF] Transfer 32bit Value: $%08X\n", value);
     FIFO.push(value);
     return true;
 }
@@ -965,7 +979,7 @@ bool VectorInterface::transfer_DMAtag(uint128_t tag)
         dmac->clear_DMA_request(id);
         return false;
     }
-    printf("[VIF] Transfer tag: $%08X_%08X_%08X_%08X\n", tag._u32[3], tag._u32[2], tag._u32[1], tag._u32[0]);
+    TRACE_DEBUG(Trace::VIF, "[VIF] Transfer tag: $%08X_%08X_%08X_%08X\n", tag._u32[3], tag._u32[2], tag._u32[1], tag._u32[0]);
     for (int i = 2; i < 4; i++)
         FIFO.push(tag._u32[i]);
     return true;
@@ -978,7 +992,7 @@ bool VectorInterface::feed_DMA(uint128_t quad)
         dmac->clear_DMA_request(id);
         return false;
     }
-    printf("[VIF] Feed DMA: $%08X_%08X_%08X_%08X\n", quad._u32[3], quad._u32[2], quad._u32[1], quad._u32[0]);
+    TRACE_DEBUG(Trace::VIF, "[VIF] Feed DMA: $%08X_%08X_%08X_%08X\n", quad._u32[3], quad._u32[2], quad._u32[1], quad._u32[0]);
     for (int i = 0; i < 4; i++)
         FIFO.push(quad._u32[i]);
     return true;
@@ -1017,7 +1031,7 @@ uint32_t VectorInterface::get_stat()
 
 uint32_t VectorInterface::get_mark()
 {
-    printf("[VIF] Get MARK: $%x\n", MARK);
+    TRACE_DEBUG(Trace::VIF, "[VIF] Get MARK: $%x\n", MARK);
     return MARK;
 }
 
@@ -1047,7 +1061,7 @@ uint32_t VectorInterface::get_err()
     reg |= VIF_ERR.mask_interrupt;
     reg |= VIF_ERR.mask_dmatag_error << 1;
     reg |= VIF_ERR.mask_vifcode_error << 2;
-    printf("[VIF] Get ERR: $%08X\n", reg);
+    TRACE_DEBUG(Trace::VIF, "[VIF] Get ERR: $%08X\n", reg);
     return reg;
 }
 
@@ -1064,7 +1078,7 @@ void VectorInterface::set_mark(uint32_t value)
 {
     MARK = value;
     mark_detected = false;
-    printf("[VIF] Set MARK: $%x\n", MARK);
+    TRACE_DEBUG(Trace::VIF, "[VIF] Set MARK: $%x\n", MARK);
 }
 
 void VectorInterface::set_err(uint32_t value)
@@ -1072,16 +1086,16 @@ void VectorInterface::set_err(uint32_t value)
     VIF_ERR.mask_interrupt = value & 0x1;
     VIF_ERR.mask_dmatag_error = value & 0x2;
     VIF_ERR.mask_vifcode_error = value & 0x4;
-    printf("[VIF] Set ERR: $%x\n", value);
+    TRACE_DEBUG(Trace::VIF, "[VIF] Set ERR: $%x\n", value);
 }
 
 void VectorInterface::set_fbrst(uint32_t value)
 {
-    printf("[VIF] Set FBRST: $%x\n", value);
+    TRACE_DEBUG(Trace::VIF, "[VIF] Set FBRST: $%x\n", value);
 
     if (value & 0x8)
     {
-        printf("[VIF] VIF%x Resumed\n", get_id());
+        TRACE_DEBUG(Trace::VIF, "[VIF] VIF%x Resumed\n", get_id());
         vif_stalled &= ~(STALL_IBIT | STALL_STOP | STALL_FORCEBREAK);
         vif_interrupt = false;
         vif_stop = false;
@@ -1089,12 +1103,12 @@ void VectorInterface::set_fbrst(uint32_t value)
     }
     if (value & 0x4)
     {
-        printf("[VIF] VIF%x Stopped\n", get_id());
+        TRACE_DEBUG(Trace::VIF, "[VIF] VIF%x Stopped\n", get_id());
         vif_stop = true;
     }
     if (value & 0x2)
     {
-        printf("VIF%d Force Break\n", id);
+        TRACE_DEBUG(Trace::VIF, "VIF%d Force Break\n", id);
         command = 0;
         command_len = 0;
         buffer_size = 0;
@@ -1108,7 +1122,7 @@ void VectorInterface::set_fbrst(uint32_t value)
     }
     if (value & 0x1)
     {
-        printf("[VIF] VIF%x Reset\n", get_id());
+        TRACE_DEBUG(Trace::VIF, "[VIF] VIF%x Reset\n", get_id());
         command = 0;
         command_len = 0;
         buffer_size = 0;
@@ -126,6 +126,7 @@ class VectorInterface
 
         void reset();
         void update(int cycles);
+        bool is_idle();
         bool transfer_word(uint32_t value);
         bool transfer_DMAtag(uint128_t tag);
         bool feed_DMA(uint128_t quad);
@@ -8,10 +8,12 @@
 #include "vu.hpp"
 #include "vu_interpreter.hpp"
 #include "vu_jit.hpp"
+#include "vu_jit64.hpp"
 #include "vu_disasm.hpp"
 
 #include "../emulator.hpp"
 #include "../errors.hpp"
+#include "../trace.hpp"
 #include "../gif.hpp"
 
 #define _x(f) f&8
@@ -37,8 +39,6 @@
 #define _Imm11_		(int32_t)(instr & 0x400 ? 0xfffffc00 | (instr & 0x3ff) : instr & 0x3ff)
 #define _UImm11_	(int32_t)(instr & 0x7ff)
 
-uint32_t VectorUnit::FBRST = 0;
-
 void VuIntBranchPipelineEntry::clear()
 {
     write_reg = 0;
@@ -66,7 +66,7 @@ VU_I VuIntBranchPipeline::get_branch_condition_reg(uint8_t reg, VU_I current_val
                 if (reg == pipeline[i].write_reg)
                 {
                     current_value = pipeline[i].old_value;
-                    printf("[VU%d] Integer branch using register from %d instructions ago (PC = 0x%x), vi%d now 0x%x!\n", vu_id, i + 1, PC, reg, current_value.s);
+                    TRACE_DEBUG(Trace::VU, "[VU%d] Integer branch using register from %d instructions ago (PC = 0x%x), vi%d now 0x%x!\n", vu_id, i + 1, PC, reg, current_value.s);
                 }
 
             }
@@ -152,6 +152,19 @@ VectorUnit::VectorUnit(int id, Emulator* e, INTC* intc, EmotionEngine* cpu, Vect
 
     MAC_flags = &MAC_pipeline[3];
     CLIP_flags = &CLIP_pipeline[3];
+
+    FBRST = 0;
+    jit = std::unique_ptr<VU_JIT64>(new VU_JIT64());
+}
+
+VectorUnit::~VectorUnit()
+{
+
+}
+
+VU_JIT64& VectorUnit::get_jit()
+{
+    return *jit;
 }
 
 void VectorUnit::reset()
@@ -456,6 +469,15 @@ void VectorUnit::run()
     }
 }
 
+//A stopped VU only catches its pipelines and cycle count up to the EE, which it can do just as well later on.
+//start_program resyncs the cycle count when it is next started.
+bool VectorUnit::is_idle()
+{
+    if (running || transferring_GIF || DIV_event_started || EFU_event_started)
+        return false;
+    return id || !is_interlocked();
+}
+
 void VectorUnit::correct_jit_pipeline(int cycles)
 {
     uint64_t stall_pipe[4];
@@ -667,7 +689,7 @@ void VectorUnit::write_reg(uint32_t addr, uint32_t data)
             set_int((addr - 0x0200) / 0x10, data);
     }
     else
-        printf("[VU0] Unrecognized write to VU1 register $%04X: $%08X\n", addr, data);
+        TRACE_WARN(Trace::VU, "[VU0] Unrecognized write to VU1 register $%04X: $%08X\n", addr, data);
 }
 
 /**
@@ -1166,16 +1188,15 @@ float VectorUnit::convert(uint32_t value)
 
 void VectorUnit::print_vectors(uint8_t a, uint8_t b)
 {
-    printf("A: ");
+    TRACE_DEBUG(Trace::VU, "A: ");
     for (int i = 0; i < 4; i++)
-        printf("%f ", gpr[a].f[i]);
-    printf("\nB: ");
+        TRACE_DEBUG(Trace::VU, "%f ", gpr[a].f[i]);
+    TRACE_DEBUG(Trace::VU, "\nB: ");
     for (int i = 0; i < 4; i++)
-        printf("%f ", gpr[b].f[i]);
-    printf("\n");
+        TRACE_DEBUG(Trace::VU, "%f ", gpr[b].f[i]);
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
-
 /**
  * Code taken from PCSX2 and adapted to DobieStation
  * https://github.com/PCSX2/pcsx2/blob/1292cd505efe7c68ab87880b4fd6809a96da703c/pcsx2/VUops.cpp#L1795
@@ -1214,7 +1235,7 @@ uint32_t VectorUnit::cfc(int index)
         case 28:
             return FBRST;
         default:
-            printf("[COP2] Unrecognized cfc2 from reg %d\n", index);
+            TRACE_WARN(Trace::VU, "[COP2] Unrecognized cfc2 from reg %d\n", index);
     }
     return 0;
 }
@@ -1223,7 +1244,7 @@ void VectorUnit::ctc(int index, uint32_t value)
 {
     if (index < 16)
     {
-        printf("[COP2] Set vi%d to $%04X\n", index, value);
+        TRACE_DEBUG(Trace::VU, "[COP2] Set vi%d to $%04X\n", index, value);
         set_int(index, value);
         return;
     }
@@ -1240,11 +1261,11 @@ void VectorUnit::ctc(int index, uint32_t value)
             break;
         case 21:
             I.u = value;
-            printf("[VU] I = %f\n", I.f);
+            TRACE_DEBUG(Trace::VU, "[VU] I = %f\n", I.f);
             break;
         case 22:
             set_Q(value);
-            printf("[VU] Q = %f\n", Q.f);
+            TRACE_DEBUG(Trace::VU, "[VU] Q = %f\n", Q.f);
             break;
         case 27:
             CMSAR0 = (uint16_t)value;
@@ -1254,10 +1275,12 @@ void VectorUnit::ctc(int index, uint32_t value)
                 soft_reset();
             if (value & 0x200)
                 other_vu->soft_reset();
+            //Only VU0 has COP2 control registers, but VU1 checks its T-bit flag in FBRST
             FBRST = value & ~0x303;
+            other_vu->FBRST = FBRST;
             break;
         default:
-            printf("[COP2] Unrecognized ctc2 of $%08X to reg %d\n", value, index);
+            TRACE_WARN(Trace::VU, "[COP2] Unrecognized ctc2 of $%08X to reg %d\n", value, index);
     }
 }
 
@@ -1304,60 +1327,59 @@ void VectorUnit::jp(uint16_t addr, bool link, uint8_t linkreg)
     }
 }
 
-#define printf(fmt, ...)(0)
 
 void VectorUnit::abs(uint32_t instr)
 {
-    printf("[VU] ABS: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ABS: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             float result = fabs(convert(gpr[_fs_].u[i]));
             set_gpr_f(_ft_, i, result);
-            printf("(%d)%f ", i, gpr[_ft_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_ft_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::add(uint32_t instr)
 {
-    printf("[VU] ADD: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ADD: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             float result = convert(gpr[_fs_].u[i]) + convert(gpr[_ft_].u[i]);
             set_gpr_f(_fd_, i, update_mac_flags(result, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::adda(uint32_t instr)
 {
-    printf("[VU] ADDA: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ADDA: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             ACC.f[i] = convert(gpr[_fs_].u[i]) + convert(gpr[_ft_].u[i]);
             ACC.f[i] = update_mac_flags(ACC.f[i], i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::addabc(uint32_t instr)
 {
-    printf("[VU] ADDAbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ADDAbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -1365,17 +1387,17 @@ void VectorUnit::addabc(uint32_t instr)
         {
             ACC.f[i] = convert(gpr[_fs_].u[i]) + op;
             ACC.f[i] = update_mac_flags(ACC.f[i], i);
-            printf("(%d)%f", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::addai(uint32_t instr)
 {
-    printf("[VU] ADDAi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ADDAi: ");
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -1383,17 +1405,17 @@ void VectorUnit::addai(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) + op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::addaq(uint32_t instr)
 {
-    printf("[VU] ADDAq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ADDAq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -1401,17 +1423,17 @@ void VectorUnit::addaq(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) + op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::addbc(uint32_t instr)
 {
-    printf("[VU] ADDbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ADDbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -1419,17 +1441,17 @@ void VectorUnit::addbc(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) + op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::addi(uint32_t instr)
 {
-    printf("[VU] ADDi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ADDi: ");
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -1437,17 +1459,17 @@ void VectorUnit::addi(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) + op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::addq(uint32_t instr)
 {
-    printf("[VU] ADDq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ADDq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -1455,12 +1477,12 @@ void VectorUnit::addq(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) + op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::b(uint32_t instr)
@@ -1468,7 +1490,7 @@ void VectorUnit::b(uint32_t instr)
     int16_t imm = instr & 0x7FF;
     imm = ((int16_t)(imm << 5)) >> 5;
     imm *= 8;
-    printf("[VU] B $%x (Imm $%x)\n", get_PC() + 16 + imm, imm);
+    TRACE_DEBUG(Trace::VU, "[VU] B $%x (Imm $%x)\n", get_PC() + 16 + imm, imm);
     branch(true, imm, false);
 }
 
@@ -1479,13 +1501,13 @@ void VectorUnit::bal(uint32_t instr)
     imm *= 8;
 
     uint8_t link_reg = (instr >> 16) & 0x1F;
-    printf("[VU] BAL $%x (Imm $%x)\n", get_PC() + 16 + imm, imm);
+    TRACE_DEBUG(Trace::VU, "[VU] BAL $%x (Imm $%x)\n", get_PC() + 16 + imm, imm);
     branch(true, imm, true, link_reg);
 }
 
 void VectorUnit::clip(uint32_t instr)
 {
-    printf("[VU] CLIP $%08X (%d, %d)\n", instr, _fs_, _ft_);
+    TRACE_DEBUG(Trace::VU, "[VU] CLIP $%08X (%d, %d)\n", instr, _fs_, _ft_);
     clip_flags <<= 6; //Move previous clipping judgments up
 
     //Compare x, y, z fields of FS with the w field of FT
@@ -1495,7 +1517,7 @@ void VectorUnit::clip(uint32_t instr)
     float y = convert(gpr[_fs_].u[1]);
     float z = convert(gpr[_fs_].u[2]);
 
-    printf("Compare: (%f, %f, %f) %f\n", x, y, z, value);
+    TRACE_DEBUG(Trace::VU, "Compare: (%f, %f, %f) %f\n", x, y, z, value);
 
     clip_flags |= (x > +value);
     clip_flags |= (x < -value) << 1;
@@ -1505,7 +1527,7 @@ void VectorUnit::clip(uint32_t instr)
     clip_flags |= (z < -value) << 5;
     clip_flags &= 0xFFFFFF;
 
-    printf("New flags: $%08X\n", clip_flags);
+    TRACE_DEBUG(Trace::VU, "New flags: $%08X\n", clip_flags);
 }
 
 void VectorUnit::div(uint32_t instr)
@@ -1533,9 +1555,9 @@ void VectorUnit::div(uint32_t instr)
         new_Q_instance.f = convert(new_Q_instance.u);
     }
     start_DIV_unit(7);
-    printf("[VU] DIV: %f\n", new_Q_instance.f);
-    printf("Reg1: %f\n", num);
-    printf("Reg2: %f\n", denom);
+    TRACE_DEBUG(Trace::VU, "[VU] DIV: %f\n", new_Q_instance.f);
+    TRACE_DEBUG(Trace::VU, "Reg1: %f\n", num);
+    TRACE_DEBUG(Trace::VU, "Reg2: %f\n", denom);
 }
 
 float VectorUnit::calculate_atan(float t)
@@ -1688,7 +1710,7 @@ void VectorUnit::ercpr(uint32_t instr)
         new_P_instance.f = 1.0f / new_P_instance.f;
 
     start_EFU_unit(12);
-    printf("[VU] ERCPR: %f (%d)\n", P.f, _fs_);
+    TRACE_DEBUG(Trace::VU, "[VU] ERCPR: %f (%d)\n", P.f, _fs_);
 }
 
 void VectorUnit::eleng(uint32_t instr)
@@ -1705,7 +1727,7 @@ void VectorUnit::eleng(uint32_t instr)
         new_P_instance.f = sqrt(new_P_instance.f);
 
     start_EFU_unit(18);
-    printf("[VU] ELENG: %f (%d)\n", P.f, _fs_);
+    TRACE_DEBUG(Trace::VU, "[VU] ELENG: %f (%d)\n", P.f, _fs_);
 }
 
 void VectorUnit::esqrt(uint32_t instr)
@@ -1720,7 +1742,7 @@ void VectorUnit::esqrt(uint32_t instr)
     new_P_instance.f = sqrt(fabs(new_P_instance.f));
 
     start_EFU_unit(12);
-    printf("[VU] ESQRT: %f (%d)\n", P.f, _fs_);
+    TRACE_DEBUG(Trace::VU, "[VU] ESQRT: %f (%d)\n", P.f, _fs_);
 }
 
 void VectorUnit::esum(uint32_t instr)
@@ -1736,7 +1758,7 @@ void VectorUnit::esum(uint32_t instr)
         new_P_instance.f += convert(gpr[_fs_].u[i]);
 
     start_EFU_unit(12);
-    printf("[VU] ESUM: %f (%d)\n", new_P_instance.f, _fs_);
+    TRACE_DEBUG(Trace::VU, "[VU] ESUM: %f (%d)\n", new_P_instance.f, _fs_);
 }
 
 void VectorUnit::erleng(uint32_t instr)
@@ -1757,7 +1779,7 @@ void VectorUnit::erleng(uint32_t instr)
     }
 
     start_EFU_unit(24);
-    printf("[VU] ERLENG: %f (%d)\n", P.f, _fs_);
+    TRACE_DEBUG(Trace::VU, "[VU] ERLENG: %f (%d)\n", P.f, _fs_);
 }
 
 void VectorUnit::ersadd(uint32_t instr)
@@ -1774,7 +1796,7 @@ void VectorUnit::ersadd(uint32_t instr)
         new_P_instance.f = 1.0f / new_P_instance.f;
 
     start_EFU_unit(18);
-    printf("[VU] ERSADD: %f (%d)\n", P.f, _fs_);
+    TRACE_DEBUG(Trace::VU, "[VU] ERSADD: %f (%d)\n", P.f, _fs_);
 }
 
 void VectorUnit::ersqrt(uint32_t instr)
@@ -1792,7 +1814,7 @@ void VectorUnit::ersqrt(uint32_t instr)
         new_P_instance.f = 1.0f / new_P_instance.f;
 
     start_EFU_unit(18);
-    printf("[VU] ERSQRT: %f (%d)\n", P.f, _fs_);
+    TRACE_DEBUG(Trace::VU, "[VU] ERSQRT: %f (%d)\n", P.f, _fs_);
 }
 
 void VectorUnit::esadd(uint32_t instr)
@@ -1807,12 +1829,12 @@ void VectorUnit::esadd(uint32_t instr)
     new_P_instance.f = pow(convert(gpr[_fs_].u[0]), 2) + pow(convert(gpr[_fs_].u[1]), 2) + pow(convert(gpr[_fs_].u[2]), 2);
 
     start_EFU_unit(11);
-    printf("[VU] ESADD: %f (%d)\n", P.f, _fs_);
+    TRACE_DEBUG(Trace::VU, "[VU] ESADD: %f (%d)\n", P.f, _fs_);
 }
 
 void VectorUnit::fcand(uint32_t value)
 {
-    printf("[VU] FCAND VI01: $%08X\n", value);
+    TRACE_DEBUG(Trace::VU, "[VU] FCAND VI01: $%08X\n", value);
     if ((*CLIP_flags & 0xFFFFFF) & (value & 0xFFFFFF))
         set_int(1, 1);
     else
@@ -1821,7 +1843,7 @@ void VectorUnit::fcand(uint32_t value)
 
 void VectorUnit::fceq(uint32_t instr)
 {
-    printf("[VU] FCEQ VI01: $%08X\n", instr);
+    TRACE_DEBUG(Trace::VU, "[VU] FCEQ VI01: $%08X\n", instr);
     if ((*CLIP_flags & 0xFFFFFF) == (instr & 0xFFFFFF))
         set_int(1, 1);
     else
@@ -1830,13 +1852,13 @@ void VectorUnit::fceq(uint32_t instr)
 
 void VectorUnit::fcget(uint32_t instr)
 {
-    printf("[VU] FCGET VI%02D\n", _it_);
+    TRACE_DEBUG(Trace::VU, "[VU] FCGET VI%02d\n", _it_);
     set_int(_it_, *CLIP_flags & 0xFFF);
 }
 
 void VectorUnit::fcor(uint32_t instr)
 {
-    printf("[VU] FCOR VI01: $%08X\n", instr & 0xFFFFFF);
+    TRACE_DEBUG(Trace::VU, "[VU] FCOR VI01: $%08X\n", instr & 0xFFFFFF);
     if (((*CLIP_flags & 0xFFFFFF) | (instr & 0xFFFFFF)) == 0xFFFFFF)
         set_int(1, 1);
     else
@@ -1845,13 +1867,13 @@ void VectorUnit::fcor(uint32_t instr)
 
 void VectorUnit::fcset(uint32_t instr)
 {
-    printf("[VU] FCSET: $%08X\n", instr & 0xFFFFFF);
+    TRACE_DEBUG(Trace::VU, "[VU] FCSET: $%08X\n", instr & 0xFFFFFF);
     clip_flags = instr & 0xFFFFFF;
 }
 
 void VectorUnit::fmeq(uint32_t instr)
 {
-    printf("[VU] FMEQ VI%02D VI%02D: $%04X\n", _it_, _is_, int_gpr[_is_].u);
+    TRACE_DEBUG(Trace::VU, "[VU] FMEQ VI%02d VI%02d: $%04X\n", _it_, _is_, int_gpr[_is_].u);
     if ((*MAC_flags & 0xFFFF) == (int_gpr[_is_].u & 0xFFFF))
         set_int(_it_, 1);
     else
@@ -1860,21 +1882,21 @@ void VectorUnit::fmeq(uint32_t instr)
 
 void VectorUnit::fmand(uint32_t instr)
 {
-    printf("[VU] FMAND VI%02D VI%02D: $%04X\n", _it_, _is_, int_gpr[_is_].u);
-    printf("MAC flags: $%08X\n", *MAC_flags);
+    TRACE_DEBUG(Trace::VU, "[VU] FMAND VI%02d VI%02d: $%04X\n", _it_, _is_, int_gpr[_is_].u);
+    TRACE_DEBUG(Trace::VU, "MAC flags: $%08X\n", (uint32_t)*MAC_flags);
     set_int(_it_, (*MAC_flags & 0xFFFF) & int_gpr[_is_].u);
 }
 
 void VectorUnit::fmor(uint32_t instr)
 {
-    printf("[VU] FMOR VI%02D VI%02D: $%04X\n", _it_, _is_, int_gpr[_is_].u);
+    TRACE_DEBUG(Trace::VU, "[VU] FMOR VI%02d VI%02d: $%04X\n", _it_, _is_, int_gpr[_is_].u);
     set_int(_it_, (*MAC_flags & 0xFFFF) | int_gpr[_is_].u);
 }
 
 void VectorUnit::fseq(uint32_t instr)
 {
     uint16_t imm = (((instr >> 21) & 0x1) << 11) | (instr & 0x7FF);
-    printf("[VU] FSEQ VI%02D: $%08X\n", _it_, imm);
+    TRACE_DEBUG(Trace::VU, "[VU] FSEQ VI%02d: $%08X\n", _it_, imm);
     if ((status & 0xFFF) == imm)
         set_int(_it_, 1);
     else
@@ -1884,7 +1906,7 @@ void VectorUnit::fseq(uint32_t instr)
 void VectorUnit::fsset(uint32_t instr)
 {
     uint16_t imm = (((instr >> 21) & 0x1) << 11) | (instr & 0x7FF);
-    printf("[VU] FSSET: $%08X\n", imm);
+    TRACE_DEBUG(Trace::VU, "[VU] FSSET: $%08X\n", imm);
     status_value = imm;
     status_pipe = 4;
 }
@@ -1892,78 +1914,78 @@ void VectorUnit::fsset(uint32_t instr)
 void VectorUnit::fsand(uint32_t instr)
 {
     uint16_t imm = (((instr >> 21) & 0x1) << 11) | (instr & 0x7FF);
-    printf("[VU] FSAND VI%02D: $%08X\n", _it_, imm);
+    TRACE_DEBUG(Trace::VU, "[VU] FSAND VI%02d: $%08X\n", _it_, imm);
     set_int(_it_, status & imm);
 }
 
 void VectorUnit::fsor(uint32_t instr)
 {
     uint16_t imm = (((instr >> 21) & 0x1) << 11) | (instr & 0x7FF);
-    printf("[VU] FSOR VI%02D: $%08X\n", _it_, imm);
+    TRACE_DEBUG(Trace::VU, "[VU] FSOR VI%02d: $%08X\n", _it_, imm);
     set_int(_it_, status | imm);
 }
 
 void VectorUnit::ftoi0(uint32_t instr)
 {
-    printf("[VU] FTOI0: ");
+    TRACE_DEBUG(Trace::VU, "[VU] FTOI0: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             gpr[_ft_].s[i] = float_to_int(convert(gpr[_fs_].u[i]));
-            printf("(%d)$%08X ", i, gpr[_ft_].s[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)$%08X ", i, gpr[_ft_].s[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::ftoi4(uint32_t instr)
 {
-    printf("[VU] FTOI4: ");
+    TRACE_DEBUG(Trace::VU, "[VU] FTOI4: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             gpr[_ft_].s[i] = float_to_int(convert(gpr[_fs_].u[i]) * (1.0f / 0.0625f));
-            printf("(%d)$%08X ", i, gpr[_ft_].s[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)$%08X ", i, gpr[_ft_].s[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::ftoi12(uint32_t instr)
 {
-    printf("[VU] FTOI12: ");
+    TRACE_DEBUG(Trace::VU, "[VU] FTOI12: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             gpr[_ft_].s[i] = float_to_int(convert(gpr[_fs_].u[i]) * (1.0f / 0.000244140625f));
-            printf("(%d)$%08X ", i, gpr[_ft_].s[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)$%08X ", i, gpr[_ft_].s[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::ftoi15(uint32_t instr)
 {
-    printf("[VU] FTOI15: ");
+    TRACE_DEBUG(Trace::VU, "[VU] FTOI15: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             gpr[_ft_].s[i] = float_to_int(convert(gpr[_fs_].u[i]) * (1.0f / 0.000030517578125f));
-            printf("(%d)$%08X ", i, gpr[_ft_].s[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)$%08X ", i, gpr[_ft_].s[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::iadd(uint32_t instr)
 {
     write_int(_id_, _is_, _it_);
     set_int(_id_, int_gpr[_is_].s + int_gpr[_it_].s);
-    printf("[VU] IADD: $%04X (%d, %d, %d)\n", int_gpr[_id_].u, _id_, _is_, _it_);
+    TRACE_DEBUG(Trace::VU, "[VU] IADD: $%04X (%d, %d, %d)\n", int_gpr[_id_].u, _id_, _is_, _it_);
 }
 
 void VectorUnit::iaddi(uint32_t instr)
@@ -1972,7 +1994,7 @@ void VectorUnit::iaddi(uint32_t instr)
     int16_t imm = ((instr >> 6) & 0x1f);
     imm = ((imm & 0x10 ? 0xfff0 : 0) | (imm & 0xf));
     set_int(_it_, int_gpr[_is_].s + imm);
-    printf("[VU] IADDI: $%04X (%d, %d, %d)\n", int_gpr[_it_].u, _it_, _is_, imm);
+    TRACE_DEBUG(Trace::VU, "[VU] IADDI: $%04X (%d, %d, %d)\n", int_gpr[_it_].u, _it_, _is_, imm);
 }
 
 void VectorUnit::iaddiu(uint32_t instr)
@@ -1980,14 +2002,14 @@ void VectorUnit::iaddiu(uint32_t instr)
     write_int(_it_, _is_);
     uint16_t imm = (((instr >> 10) & 0x7800) | (instr & 0x7ff));
     set_int(_it_, int_gpr[_is_].s + imm);
-    printf("[VU] IADDIU: $%04X (%d, %d, $%04X)\n", int_gpr[_it_].u, _it_, _is_, imm);
+    TRACE_DEBUG(Trace::VU, "[VU] IADDIU: $%04X (%d, %d, $%04X)\n", int_gpr[_it_].u, _it_, _is_, imm);
 }
 
 void VectorUnit::iand(uint32_t instr)
 {
     write_int(_id_, _is_, _it_);
     set_int(_id_, int_gpr[_is_].u & int_gpr[_it_].u);
-    printf("[VU] IAND: $%04X (%d, %d, %d)\n", int_gpr[_id_].u, _id_, _is_, _it_);
+    TRACE_DEBUG(Trace::VU, "[VU] IAND: $%04X (%d, %d, %d)\n", int_gpr[_id_].u, _id_, _is_, _it_);
 }
 
 void VectorUnit::ibeq(uint32_t instr)
@@ -2062,50 +2084,50 @@ void VectorUnit::ilw(uint32_t instr)
     write_int(_it_, _is_);
     int16_t offset = (instr & 0x400) ? (instr & 0x3FF) | 0xFC00 : (instr & 0x3FF);
     uint16_t addr = (int_gpr[_is_].s + offset) * 16;
-    printf("[VU] ILW: $%08X ($%08X)\n", addr, offset);
+    TRACE_DEBUG(Trace::VU, "[VU] ILW: $%08X ($%08X)\n", addr, offset);
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             uint32_t word = read_data<uint32_t>(addr + (i * 4));
-            printf(" $%04X ($%02X, %d, %d)", word, _field, _it_, _is_);
+            TRACE_DEBUG(Trace::VU, " $%04X ($%02X, %d, %d)", word, _field, _it_, _is_);
             set_int(_it_, word & 0xFFFF);
             break;
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::ilwr(uint32_t instr)
 {
     write_int(_it_, _is_);
     uint32_t addr = (uint32_t)int_gpr[_is_].u << 4;
-    printf("[VU] ILWR: $%08X", addr);
+    TRACE_DEBUG(Trace::VU, "[VU] ILWR: $%08X", addr);
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             uint32_t word = read_data<uint32_t>(addr + (i * 4));
-            printf(" $%04X ($%02X, %d, %d)", word, _field, _it_, _is_);
+            TRACE_DEBUG(Trace::VU, " $%04X ($%02X, %d, %d)", word, _field, _it_, _is_);
             set_int(_it_, word & 0xFFFF);
             break;
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::ior(uint32_t instr)
 {
     write_int(_id_, _is_, _it_);
     set_int(_id_, int_gpr[_is_].u | int_gpr[_it_].u);
-    printf("[VU] IOR: $%04X (%d, %d, %d)\n", int_gpr[_id_].u, _id_, _is_, _it_);
+    TRACE_DEBUG(Trace::VU, "[VU] IOR: $%04X (%d, %d, %d)\n", int_gpr[_id_].u, _id_, _is_, _it_);
 }
 
 void VectorUnit::isub(uint32_t instr)
 {
     write_int(_id_, _is_, _it_);
     set_int(_id_, int_gpr[_is_].s - int_gpr[_it_].s);
-    printf("[VU] ISUB: $%04X (%d, %d, %d)\n", int_gpr[_id_].u, _id_, _is_, _it_);
+    TRACE_DEBUG(Trace::VU, "[VU] ISUB: $%04X (%d, %d, %d)\n", int_gpr[_id_].u, _id_, _is_, _it_);
 }
 
 void VectorUnit::isubiu(uint32_t instr)
@@ -2113,14 +2135,14 @@ void VectorUnit::isubiu(uint32_t instr)
     write_int(_it_, _is_);
     uint16_t imm = ((instr >> 10) & 0x7800) | (instr & 0x7ff);
     set_int(_it_, int_gpr[_is_].s - imm);
-    printf("[VU] ISUBIU: $%04X (%d, %d, $%04X)\n", int_gpr[_it_].u, _it_, _is_, imm);
+    TRACE_DEBUG(Trace::VU, "[VU] ISUBIU: $%04X (%d, %d, $%04X)\n", int_gpr[_it_].u, _it_, _is_, imm);
 }
 
 void VectorUnit::isw(uint32_t instr)
 {
     int16_t offset = (instr & 0x400) ? (instr & 0x3FF) | 0xFC00 : (instr & 0x3FF);
     uint16_t addr = (int_gpr[_is_].s + offset) * 16;
-    printf("[VU] ISW: $%08X: $%04X ($%02X, %d, %d)\n", addr, int_gpr[_it_].u, _field, _it_, _is_);
+    TRACE_DEBUG(Trace::VU, "[VU] ISW: $%08X: $%04X ($%02X, %d, %d)\n", addr, int_gpr[_it_].u, _field, _it_, _is_);
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
@@ -2133,12 +2155,12 @@ void VectorUnit::isw(uint32_t instr)
 void VectorUnit::iswr(uint32_t instr)
 {
     uint32_t addr = (uint32_t)int_gpr[_is_].u << 4;
-    printf("[VU] ISWR to $%08X!\n", addr);
+    TRACE_DEBUG(Trace::VU, "[VU] ISWR to $%08X!\n", addr);
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
-            printf("($%02X, %d, %d)\n", _field, _it_, _is_);
+            TRACE_DEBUG(Trace::VU, "($%02X, %d, %d)\n", _field, _it_, _is_);
             write_data<uint32_t>(addr + (i * 4), int_gpr[_it_].u);
         }
     }
@@ -2146,65 +2168,65 @@ void VectorUnit::iswr(uint32_t instr)
 
 void VectorUnit::itof0(uint32_t instr)
 {
-    printf("[VU] ITOF0: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ITOF0: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             set_gpr_f(_ft_, i, (float)gpr[_fs_].s[i]);
-            printf("(%d)%f ", i, gpr[_ft_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_ft_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::itof4(uint32_t instr)
 {
-    printf("[VU] ITOF4: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ITOF4: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             gpr[_ft_].f[i] = (float)((float)gpr[_fs_].s[i] * 0.0625f);
-            printf("(%d)%f ", i, gpr[_ft_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_ft_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::itof12(uint32_t instr)
 {
-    printf("[VU] ITOF12: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ITOF12: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             gpr[_ft_].f[i] = (float)((float)gpr[_fs_].s[i] * 0.000244140625f);
-            printf("(%d)%f ", i, gpr[_ft_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_ft_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::itof15(uint32_t instr)
 {
-    printf("[VU] ITOF15: ");
+    TRACE_DEBUG(Trace::VU, "[VU] ITOF15: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             gpr[_ft_].f[i] = (float)((float)gpr[_fs_].s[i] * 0.000030517578125);
-            printf("(%d)%f ", i, gpr[_ft_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_ft_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::jr(uint32_t instr)
 {
     uint8_t addr_reg = (instr >> 11) & 0x1F;
     uint16_t addr = get_int(addr_reg) * 8;
-    printf("[VU] JR vi%d ($%x)\n", addr_reg, addr);
+    TRACE_DEBUG(Trace::VU, "[VU] JR vi%d ($%x)\n", addr_reg, addr);
     jp(addr, false);
 }
 
@@ -2215,7 +2237,7 @@ void VectorUnit::jalr(uint32_t instr)
 
     uint8_t link_reg = (instr >> 16) & 0x1F;
     // write_int(link_reg, addr_reg);
-    printf("[VU] JALR vi%d ($%x) link vi%d\n", addr_reg, addr, link_reg);
+    TRACE_DEBUG(Trace::VU, "[VU] JALR vi%d ($%x) link vi%d\n", addr_reg, addr, link_reg);
     jp(addr, true, link_reg);
 }
 
@@ -2223,22 +2245,22 @@ void VectorUnit::lq(uint32_t instr)
 {
     int16_t imm = (int16_t)((instr & 0x400) ? (instr & 0x3ff) | 0xfc00 : (instr & 0x3ff));
     uint16_t addr = (int_gpr[_is_].s + imm) * 16;
-    printf("[VU] LQ: $%08X (%d, %d, $%08X)\n", addr, _ft_, _is_, imm);
+    TRACE_DEBUG(Trace::VU, "[VU] LQ: $%08X (%d, %d, $%08X)\n", addr, _ft_, _is_, imm);
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             set_gpr_u(_ft_, i, read_data<uint32_t>(addr + (i * 4)));
-            printf("(%d)$%08X ", i, gpr[_ft_].u[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)$%08X ", i, gpr[_ft_].u[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::lqd(uint32_t instr)
 {
     write_int(_is_, _is_);
-    printf("[VU] LQD: ");
+    TRACE_DEBUG(Trace::VU, "[VU] LQD: ");
     if (_is_)
         int_gpr[_is_].u--;
     uint32_t addr = (uint32_t)int_gpr[_is_].u * 16;
@@ -2247,68 +2269,68 @@ void VectorUnit::lqd(uint32_t instr)
         if (_field & (1 << (3 - i)))
         {
             set_gpr_u(_ft_, i, read_data<uint32_t>(addr + (i * 4)));
-            printf("(%d)%f ", i, gpr[_ft_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_ft_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::lqi(uint32_t instr)
 {
     write_int(_is_, _is_);
-    printf("[VU] LQI: ");
+    TRACE_DEBUG(Trace::VU, "[VU] LQI: ");
     uint32_t addr = (uint32_t)int_gpr[_is_].u * 16;
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             set_gpr_u(_ft_, i, read_data<uint32_t>(addr + (i * 4)));
-            printf("(%d)%f ", i, gpr[_ft_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_ft_].f[i]);
         }
     }
-    printf("\n(%d: $%04X)", _is_, int_gpr[_is_]);
+    TRACE_DEBUG(Trace::VU, "\n(%d: $%04X)", _is_, int_gpr[_is_].u);
     if (_is_)
         int_gpr[_is_].u++;
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::madd(uint32_t instr)
 {
-    printf("[VU] MADD: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MADD: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             float temp = convert(ACC.u[i]) + convert(gpr[_fs_].u[i]) * convert(gpr[_ft_].u[i]);
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::madda(uint32_t instr)
 {
-    printf("[VU] MADDA: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MADDA: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             float temp = convert(ACC.u[i]) + convert(gpr[_fs_].u[i]) * convert(gpr[_ft_].u[i]);
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::maddabc(uint32_t instr)
 {
-    printf("[VU] MADDAbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MADDAbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -2316,17 +2338,17 @@ void VectorUnit::maddabc(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) + convert(gpr[_fs_].u[i]) * op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::maddai(uint32_t instr)
 {
-    printf("[VU] MADDAi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MADDAi: ");
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2334,17 +2356,17 @@ void VectorUnit::maddai(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) + convert(gpr[_fs_].u[i]) * op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::maddaq(uint32_t instr)
 {
-    printf("[VU] MADDAq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MADDAq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2352,17 +2374,17 @@ void VectorUnit::maddaq(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) + convert(gpr[_fs_].u[i]) * op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::maddbc(uint32_t instr)
 {
-    printf("[VU] MADDbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MADDbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -2370,17 +2392,17 @@ void VectorUnit::maddbc(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) + convert(gpr[_fs_].u[i]) * op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::maddi(uint32_t instr)
 {
-    printf("[VU] MADDi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MADDi: ");
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2388,17 +2410,17 @@ void VectorUnit::maddi(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) + convert(gpr[_fs_].u[i]) * op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::maddq(uint32_t instr)
 {
-    printf("[VU] MADDq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MADDq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2406,17 +2428,17 @@ void VectorUnit::maddq(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) + convert(gpr[_fs_].u[i]) * op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::max(uint32_t instr)
 {
-    printf("[VU] MAX: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MAX: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
@@ -2424,15 +2446,15 @@ void VectorUnit::max(uint32_t instr)
             int32_t op1 = gpr[_fs_].s[i];
             int32_t op2 = gpr[_ft_].s[i];
             set_gpr_s(_fd_, i, vu_max(op1, op2));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::maxi(uint32_t instr)
 {
-    printf("[VU] MAXi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MAXi: ");
     int32_t op1 = (int32_t)I.u;
     for (int i = 0; i < 4; i++)
     {
@@ -2440,15 +2462,15 @@ void VectorUnit::maxi(uint32_t instr)
         {
             int32_t op2 = gpr[_fs_].s[i];
             set_gpr_s(_fd_, i, vu_max(op1, op2));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::maxbc(uint32_t instr)
 {
-    printf("[VU] MAXbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MAXbc: ");
     int32_t op2 = gpr[_ft_].s[_bc_];
     for (int i = 0; i < 4; i++)
     {
@@ -2456,15 +2478,15 @@ void VectorUnit::maxbc(uint32_t instr)
         {
             int32_t op1 = gpr[_fs_].s[i];
             set_gpr_s(_fd_, i, vu_max(op1, op2));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::mfir(uint32_t instr)
 {
-    printf("[VU] MFIR\n");
+    TRACE_DEBUG(Trace::VU, "[VU] MFIR\n");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
@@ -2474,7 +2496,7 @@ void VectorUnit::mfir(uint32_t instr)
 
 void VectorUnit::mfp(uint32_t instr)
 {
-    printf("[VU] MFP\n");
+    TRACE_DEBUG(Trace::VU, "[VU] MFP\n");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
@@ -2484,7 +2506,7 @@ void VectorUnit::mfp(uint32_t instr)
 
 void VectorUnit::mini(uint32_t instr)
 {
-    printf("[VU] MINI: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MINI: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
@@ -2492,15 +2514,15 @@ void VectorUnit::mini(uint32_t instr)
             int32_t op1 = gpr[_fs_].s[i];
             int32_t op2 = gpr[_ft_].s[i];
             set_gpr_s(_fd_, i, vu_min(op1, op2));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::minibc(uint32_t instr)
 {
-    printf("[VU] MINIbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MINIbc: ");
     int32_t op1 = gpr[_ft_].s[_bc_];
     for (int i = 0; i < 4; i++)
     {
@@ -2508,15 +2530,15 @@ void VectorUnit::minibc(uint32_t instr)
         {
             int32_t op2 = gpr[_fs_].s[i];
             set_gpr_s(_fd_, i, vu_min(op1, op2));
-            printf("(%d)%f", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f", i, gpr[_fd_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::minii(uint32_t instr)
 {
-    printf("[VU] MINIi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MINIi: ");
     int32_t op1 = (int32_t)I.u;
     for (int i = 0; i < 4; i++)
     {
@@ -2524,15 +2546,15 @@ void VectorUnit::minii(uint32_t instr)
         {
             int32_t op2 = gpr[_fs_].s[i];
             set_gpr_s(_fd_, i, vu_min(op1, op2));
-            printf("(%d)%f", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f", i, gpr[_fd_].f[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::move(uint32_t instr)
 {
-    printf("[VU] MOVE");
+    TRACE_DEBUG(Trace::VU, "[VU] MOVE");
     if (_ft_)
     {
         for (int i = 0; i < 4; i++)
@@ -2541,12 +2563,12 @@ void VectorUnit::move(uint32_t instr)
                 set_gpr_u(_ft_, i, gpr[_fs_].u[i]);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::mr32(uint32_t instr)
 {
-    printf("[VU] MR32");
+    TRACE_DEBUG(Trace::VU, "[VU] MR32");
     uint32_t x = gpr[_fs_].u[0];
     if (_x(_field))
         set_gpr_u(_ft_, 0, gpr[_fs_].u[1]);
@@ -2556,12 +2578,12 @@ void VectorUnit::mr32(uint32_t instr)
         set_gpr_u(_ft_, 2, gpr[_fs_].u[3]);
     if (_w(_field))
         set_gpr_u(_ft_, 3, x);
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::msubabc(uint32_t instr)
 {
-    printf("[VU] MSUBAbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MSUBAbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -2569,17 +2591,17 @@ void VectorUnit::msubabc(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) - convert(gpr[_fs_].u[i]) * op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::msubai(uint32_t instr)
 {
-    printf("[VU] MSUBAi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MSUBAi: ");
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2587,17 +2609,17 @@ void VectorUnit::msubai(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) - convert(gpr[_fs_].u[i]) * op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::msubaq(uint32_t instr)
 {
-    printf("[VU] MSUBAq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MSUBAq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2605,51 +2627,51 @@ void VectorUnit::msubaq(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) - convert(gpr[_fs_].u[i]) * op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::msub(uint32_t instr)
 {
-    printf("[VU] MSUB: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MSUB: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             float temp = convert(ACC.u[i]) - convert(gpr[_fs_].u[i]) * convert(gpr[_ft_].u[i]);
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::msuba(uint32_t instr)
 {
-    printf("[VU] MSUBA: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MSUBA: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             float temp = convert(ACC.u[i]) - convert(gpr[_fs_].u[i]) * convert(gpr[_ft_].u[i]);
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::msubbc(uint32_t instr)
 {
-    printf("[VU] MSUBbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MSUBbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -2657,17 +2679,17 @@ void VectorUnit::msubbc(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) - convert(gpr[_fs_].u[i]) * op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::msubi(uint32_t instr)
 {
-    printf("[VU] MSUBi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MSUBi: ");
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2675,17 +2697,17 @@ void VectorUnit::msubi(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) - convert(gpr[_fs_].u[i]) * op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::msubq(uint32_t instr)
 {
-    printf("[VU] MSUBq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MSUBq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2693,58 +2715,58 @@ void VectorUnit::msubq(uint32_t instr)
         {
             float temp = convert(ACC.u[i]) - convert(gpr[_fs_].u[i]) * op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::mtir(uint32_t instr)
 {
     write_int(_it_);
-    printf("[VU] MTIR: %d\n", gpr[_fs_].u[_fsf_] & 0xFFFF);
+    TRACE_DEBUG(Trace::VU, "[VU] MTIR: %d\n", gpr[_fs_].u[_fsf_] & 0xFFFF);
     set_int(_it_, gpr[_fs_].u[_fsf_] & 0xFFFF);
 }
 
 void VectorUnit::mul(uint32_t instr)
 {
-    printf("[VU] MUL: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MUL: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             float result = convert(gpr[_fs_].u[i]) * convert(gpr[_ft_].u[i]);
             set_gpr_f(_fd_, i, update_mac_flags(result, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::mula(uint32_t instr)
 {
-    printf("[VU] MULA: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MULA: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             float temp = convert(gpr[_fs_].u[i]) * convert(gpr[_ft_].u[i]);
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::mulabc(uint32_t instr)
 {
-    printf("[VU] MULAbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MULAbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -2752,17 +2774,17 @@ void VectorUnit::mulabc(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) * op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::mulai(uint32_t instr)
 {
-    printf("[VU] MULAi: (%f)", I.f);
+    TRACE_DEBUG(Trace::VU, "[VU] MULAi: (%f)", I.f);
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2770,17 +2792,17 @@ void VectorUnit::mulai(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) * op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::mulaq(uint32_t instr)
 {
-    printf("[VU] MULAq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MULAq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2788,17 +2810,17 @@ void VectorUnit::mulaq(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) * op;
             ACC.f[i] = update_mac_flags(temp, i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::mulbc(uint32_t instr)
 {
-    printf("[VU] MULbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MULbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -2806,17 +2828,17 @@ void VectorUnit::mulbc(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) * op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::muli(uint32_t instr)
 {
-    printf("[VU] MULi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MULi: ");
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2824,17 +2846,17 @@ void VectorUnit::muli(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) * op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::mulq(uint32_t instr)
 {
-    printf("[VU] MULq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] MULq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -2842,12 +2864,12 @@ void VectorUnit::mulq(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) * op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::nop(uint32_t instr)
@@ -2878,7 +2900,7 @@ void VectorUnit::opmsub(uint32_t instr)
         clear_mac_flags(2);
     }*/
     clear_mac_flags(3);
-    printf("[VU] OPMSUB: %f, %f, %f\n", gpr[_fd_].f[0], gpr[_fd_].f[1], gpr[_fd_].f[2]);
+    TRACE_DEBUG(Trace::VU, "[VU] OPMSUB: %f, %f, %f\n", gpr[_fd_].f[0], gpr[_fd_].f[1], gpr[_fd_].f[2]);
 }
 
 /**
@@ -2896,7 +2918,7 @@ void VectorUnit::opmula(uint32_t instr)
     ACC.f[1] = update_mac_flags(ACC.f[1], 1);
     ACC.f[2] = update_mac_flags(ACC.f[2], 2);
     clear_mac_flags(3);
-    printf("[VU] OPMULA: %f, %f, %f\n", ACC.f[0], ACC.f[1], ACC.f[2]);
+    TRACE_DEBUG(Trace::VU, "[VU] OPMULA: %f, %f, %f\n", ACC.f[0], ACC.f[1], ACC.f[2]);
 }
 
 void VectorUnit::rget(uint32_t instr)
@@ -2908,14 +2930,14 @@ void VectorUnit::rget(uint32_t instr)
             set_gpr_u(_ft_, i, R.u);
         }
     }
-    printf("[VU] RGET: %f\n", R.f);
+    TRACE_DEBUG(Trace::VU, "[VU] RGET: %f\n", R.f);
 }
 
 void VectorUnit::rinit(uint32_t instr)
 {
     R.u = 0x3F800000;
     R.u |= gpr[_fs_].u[_fsf_] & 0x007FFFFF;
-    printf("[VU] RINIT: %f\n", R.f);
+    TRACE_DEBUG(Trace::VU, "[VU] RINIT: %f\n", R.f);
 }
 
 void VectorUnit::rnext(uint32_t instr)
@@ -2928,7 +2950,7 @@ void VectorUnit::rnext(uint32_t instr)
             set_gpr_u(_ft_, i, R.u);
         }
     }
-    printf("[VU] RNEXT: %f\n", R.f);
+    TRACE_DEBUG(Trace::VU, "[VU] RNEXT: %f\n", R.f);
 }
 
 void VectorUnit::rsqrt(uint32_t instr)
@@ -2940,7 +2962,7 @@ void VectorUnit::rsqrt(uint32_t instr)
 
     if (denom == 0.0)
     {
-        printf("[VU] RSQRT by zero!\n");
+        TRACE_DEBUG(Trace::VU, "[VU] RSQRT by zero!\n");
         status_value = 0x20;
         status_pipe = 13;
         if (num == 0.0)
@@ -2974,31 +2996,31 @@ void VectorUnit::rsqrt(uint32_t instr)
         new_Q_instance.f = convert(new_Q_instance.u);
     }
     start_DIV_unit(13);
-    printf("[VU] RSQRT: %f\n", new_Q_instance.f);
-    printf("Reg1: %f\n", gpr[_fs_].f[_fsf_]);
-    printf("Reg2: %f\n", gpr[_ft_].f[_ftf_]);
+    TRACE_DEBUG(Trace::VU, "[VU] RSQRT: %f\n", new_Q_instance.f);
+    TRACE_DEBUG(Trace::VU, "Reg1: %f\n", gpr[_fs_].f[_fsf_]);
+    TRACE_DEBUG(Trace::VU, "Reg2: %f\n", gpr[_ft_].f[_ftf_]);
 }
 
 void VectorUnit::rxor(uint32_t instr)
 {
     R.u = 0x3F800000 | ((R.u ^ gpr[_fs_].u[_fsf_]) & 0x007FFFFF);
-    printf("[VU] RXOR: %f\n", R.f);
+    TRACE_DEBUG(Trace::VU, "[VU] RXOR: %f\n", R.f);
 }
 
 void VectorUnit::sq(uint32_t instr)
 {
     int16_t imm = (int16_t)((instr & 0x400) ? (instr & 0x3ff) | 0xfc00 : (instr & 0x3ff));
     uint16_t addr = (int_gpr[_it_].s + imm) * 16;
-    printf("[VU] SQ to $%08X!\n", addr);
+    TRACE_DEBUG(Trace::VU, "[VU] SQ to $%08X!\n", addr);
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             write_data<uint32_t>(addr + (i * 4), gpr[_fs_].u[i]);
-            printf("$%08X(%d) ", gpr[_fs_].u[i], i);
+            TRACE_DEBUG(Trace::VU, "$%08X(%d) ", gpr[_fs_].u[i], i);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::sqd(uint32_t instr)
@@ -3007,32 +3029,32 @@ void VectorUnit::sqd(uint32_t instr)
     if (_it_)
         int_gpr[_it_].u--;
     uint32_t addr = (uint32_t)int_gpr[_it_].u << 4;
-    printf("[VU] SQD to $%08X!\n", addr);
+    TRACE_DEBUG(Trace::VU, "[VU] SQD to $%08X!\n", addr);
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             write_data<uint32_t>(addr + (i * 4), gpr[_fs_].u[i]);
-            printf("$%08X(%d) ", gpr[_fs_].u[i], i);
+            TRACE_DEBUG(Trace::VU, "$%08X(%d) ", gpr[_fs_].u[i], i);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::sqi(uint32_t instr)
 {
     write_int(_it_, _it_);
     uint32_t addr = (uint32_t)int_gpr[_it_].u << 4;
-    printf("[VU] SQI to $%08X!\n", addr);
+    TRACE_DEBUG(Trace::VU, "[VU] SQI to $%08X!\n", addr);
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             write_data<uint32_t>(addr + (i * 4), gpr[_fs_].u[i]);
-            printf("$%08X(%d) ", gpr[_fs_].u[i], i);
+            TRACE_DEBUG(Trace::VU, "$%08X(%d) ", gpr[_fs_].u[i], i);
         }
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
     if (_it_)
         int_gpr[_it_].u++;
 }
@@ -3049,47 +3071,47 @@ void VectorUnit::vu_sqrt(uint32_t instr)
     new_Q_instance.f = sqrt(fabs(convert(gpr[_ft_].u[_ftf_])));
     new_Q_instance.f = convert(new_Q_instance.u);
     start_DIV_unit(7);
-    printf("[VU] SQRT: %f\n", new_Q_instance.f);
-    printf("Source: %f\n", gpr[_ft_].f[_ftf_]);
+    TRACE_DEBUG(Trace::VU, "[VU] SQRT: %f\n", new_Q_instance.f);
+    TRACE_DEBUG(Trace::VU, "Source: %f\n", gpr[_ft_].f[_ftf_]);
 }
 
 void VectorUnit::sub(uint32_t instr)
 {
-    printf("[VU] SUB: ");
+    TRACE_DEBUG(Trace::VU, "[VU] SUB: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             float result = convert(gpr[_fs_].u[i]) - convert(gpr[_ft_].u[i]);
             set_gpr_f(_fd_, i, update_mac_flags(result, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::suba(uint32_t instr)
 {
-    printf("[VU] SUBA: ");
+    TRACE_DEBUG(Trace::VU, "[VU] SUBA: ");
     for (int i = 0; i < 4; i++)
     {
         if (_field & (1 << (3 - i)))
         {
             ACC.f[i] = convert(gpr[_fs_].u[i]) - convert(gpr[_ft_].u[i]);
             ACC.f[i] = update_mac_flags(ACC.f[i], i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::subabc(uint32_t instr)
 {
-    printf("[VU] SUBAbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] SUBAbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -3097,17 +3119,17 @@ void VectorUnit::subabc(uint32_t instr)
         {
             ACC.f[i] = convert(gpr[_fs_].u[i]) - op;
             ACC.f[i] = update_mac_flags(ACC.f[i], i);
-            printf("(%d)%f", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::subai(uint32_t instr)
 {
-    printf("[VU] SUBAi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] SUBAi: ");
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -3115,17 +3137,17 @@ void VectorUnit::subai(uint32_t instr)
         {
             ACC.f[i] = convert(gpr[_fs_].u[i]) - op;
             ACC.f[i] = update_mac_flags(ACC.f[i], i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::subaq(uint32_t instr)
 {
-    printf("[VU] SUBAq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] SUBAq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -3133,17 +3155,17 @@ void VectorUnit::subaq(uint32_t instr)
         {
             ACC.f[i] = convert(gpr[_fs_].u[i]) - op;
             ACC.f[i] = update_mac_flags(ACC.f[i], i);
-            printf("(%d)%f ", i, ACC.f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, ACC.f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::subbc(uint32_t instr)
 {
-    printf("[VU] SUBbc: ");
+    TRACE_DEBUG(Trace::VU, "[VU] SUBbc: ");
     float op = convert(gpr[_ft_].u[_bc_]);
     for (int i = 0; i < 4; i++)
     {
@@ -3151,17 +3173,17 @@ void VectorUnit::subbc(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) - op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::subi(uint32_t instr)
 {
-    printf("[VU] SUBi: ");
+    TRACE_DEBUG(Trace::VU, "[VU] SUBi: ");
     float op = convert(I.u);
     for (int i = 0; i < 4; i++)
     {
@@ -3169,17 +3191,17 @@ void VectorUnit::subi(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) - op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::subq(uint32_t instr)
 {
-    printf("[VU] SUBq: ");
+    TRACE_DEBUG(Trace::VU, "[VU] SUBq: ");
     float op = convert(Q.u);
     for (int i = 0; i < 4; i++)
     {
@@ -3187,12 +3209,12 @@ void VectorUnit::subq(uint32_t instr)
         {
             float temp = convert(gpr[_fs_].u[i]) - op;
             set_gpr_f(_fd_, i, update_mac_flags(temp, i));
-            printf("(%d)%f ", i, gpr[_fd_].f[i]);
+            TRACE_DEBUG(Trace::VU, "(%d)%f ", i, gpr[_fd_].f[i]);
         }
         else
             clear_mac_flags(i);
     }
-    printf("\n");
+    TRACE_DEBUG(Trace::VU, "\n");
 }
 
 void VectorUnit::waitp(uint32_t instr)
@@ -3239,13 +3261,13 @@ void VectorUnit::xgkick(uint32_t instr)
         Errors::print_warning("[VU] WARNING: XGKICK called on VU0!\n");
         return;
     }
-    printf("[VU1] XGKICK: Addr $%08X\n", (int_gpr[_is_].u & 0x3ff) * 16);
+    TRACE_DEBUG(Trace::VU, "[VU1] XGKICK: Addr $%08X\n", (int_gpr[_is_].u & 0x3ff) * 16);
 
     //If an XGKICK transfer is ongoing, completely stall the VU until the first transfer has finished.
     //Note: a real VU executes for one or two more cycles before stalling due to pipelining.
     if (transferring_GIF)
     {
-        printf("[VU1] XGKICK called during active transfer, stalling VU\n");
+        TRACE_DEBUG(Trace::VU, "[VU1] XGKICK called during active transfer, stalling VU\n");
         stalled_GIF_addr = (uint32_t)(int_gpr[_is_].u & 0x3ff) * 16;
         XGKICK_stall = true;
     }
@@ -3259,7 +3281,7 @@ void VectorUnit::xgkick(uint32_t instr)
 
 void VectorUnit::xitop(uint32_t instr)
 {
-    printf("[VU] XITOP: $%04X (%d)\n", *VIF_ITOP, _it_);
+    TRACE_DEBUG(Trace::VU, "[VU] XITOP: $%04X (%d)\n", *VIF_ITOP, _it_);
     set_int(_it_, *VIF_ITOP);
 }
 
@@ -3270,6 +3292,6 @@ void VectorUnit::xtop(uint32_t instr)
         Errors::print_warning("[VU] WARNING: XTOP called on VU0!\n");
         return;
     }
-    printf("[VU1] XTOP: $%04X (%d)\n", *VIF_TOP, _it_);
+    TRACE_DEBUG(Trace::VU, "[VU1] XTOP: $%04X (%d)\n", *VIF_TOP, _it_);
     set_int(_it_, *VIF_TOP);
 }
\ No newline at end of file
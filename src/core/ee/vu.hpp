@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <fstream>
+#include <memory>
 #include <unordered_set>
 #include "emotion.hpp"
 #include "../int128.hpp"
@@ -95,6 +96,7 @@ class VectorUnit
         INTC* intc;
         EmotionEngine* eecpu;
         VectorUnit* other_vu; //Pointer to VU1 for VU0, vice versa for VU1
+        std::unique_ptr<VU_JIT64> jit;
 
         uint64_t cycle_count; //Increments when "running" is true
         uint64_t run_event; //If less than cycle_count, the VU is allowed to run
@@ -127,7 +129,7 @@ class VectorUnit
         VU_I int_gpr[16];
 
         //Control registers
-        static uint32_t FBRST;
+        uint32_t FBRST; //Shared by both VUs, see ctc
         uint32_t CMSAR0;
         VU_GPR ACC;
         uint32_t status;
@@ -179,6 +181,7 @@ class VectorUnit
         void print_vectors(uint8_t a, uint8_t b);
     public:
         VectorUnit(int id, Emulator* e, INTC* intc, EmotionEngine* eecpu, VectorUnit* other_vu);
+        ~VectorUnit();
 
         DecodedRegs decoder;
 
@@ -229,6 +232,7 @@ class VectorUnit
         std::function<void(VectorUnit&)> run_func;
 
         bool is_running();
+        bool is_idle();
         bool stopped_by_tbit();
         bool is_dirty();
         void clear_dirty();
@@ -237,6 +241,7 @@ class VectorUnit
         uint32_t get_gpr_u(int index, int field);
         uint16_t get_int(int index);
         int get_id();
+        VU_JIT64& get_jit();
         uint64_t get_cycle_count();
         void set_gpr_f(int index, int field, float value);
         void set_gpr_u(int index, int field, uint32_t value);
@@ -3,8 +3,6 @@
 #include "vu_interpreter.hpp"
 #include "../errors.hpp"
 
-#define printf(fmt, ...)(0)
-
 #define _ft_ ((instr >> 16) & 0x1F)
 #define _fs_ ((instr >> 11) & 0x1F)
 #define _fd_ ((instr >> 6) & 0x1F)
@@ -19,7 +17,8 @@
 namespace VU_Interpreter
 {
 typedef void(VectorUnit::*vu_op)(uint32_t);
-vu_op upper_op, lower_op;
+//Latched by upper() and lower() and called right after on the same thread
+thread_local vu_op upper_op, lower_op;
 
 void call_upper(VectorUnit &vu, uint32_t instr)
 {
@@ -11,21 +11,30 @@
 namespace VU_JIT
 {
 
-VU_JIT64 jit64[2];
-
 uint16_t run(VectorUnit *vu)
 {
-    return jit64[vu->get_id()].run(*vu);
+    return vu->get_jit().run(*vu);
 }
 
 void reset(VectorUnit *vu)
 {
-    jit64[vu->get_id()].reset();
+    vu->get_jit().reset();
 }
 
 void set_current_program(uint32_t crc, VectorUnit *vu)
 {
-    jit64[vu->get_id()].set_current_program(crc);
+    vu->get_jit().set_current_program(crc);
+}
+
+uint32_t get_current_program(VectorUnit *vu)
+{
+    return vu->get_jit().get_current_program();
+}
+
+void print_fallback_counts(VectorUnit *vu)
+{
+    const char* name = vu->get_id() ? "VU1_JIT64" : "VU0_JIT64";
+    vu->get_jit().get_fallback_counters().print(name);
 }
 
 };
\ No newline at end of file
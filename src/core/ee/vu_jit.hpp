@@ -10,6 +10,8 @@ namespace VU_JIT
 uint16_t run(VectorUnit* vu);
 void reset(VectorUnit *vu);
 void set_current_program(uint32_t crc, VectorUnit *vu);
+uint32_t get_current_program(VectorUnit *vu);
+void print_fallback_counts(VectorUnit *vu);
 
 };
 
@@ -2,8 +2,10 @@
 #include <algorithm>
 
 #include "vu_jit64.hpp"
+#include "vu_disasm.hpp"
 #include "vu_interpreter.hpp"
 #include "../gif.hpp"
+#include "../jitcommon/cpuinfo.hpp"
 
 #include "../errors.hpp"
 
@@ -208,6 +210,16 @@ void VU_JIT64::reset(bool clear_cache)
     current_program = 0;
 }
 
+uint32_t VU_JIT64::get_current_program() const
+{
+    return current_program;
+}
+
+const JitFallbackCounters& VU_JIT64::get_fallback_counters() const
+{
+    return fallback_counters;
+}
+
 void VU_JIT64::set_current_program(uint32_t crc)
 {
     reset(false);
@@ -280,6 +292,20 @@ void VU_JIT64::sse_abs(REG_64 source, REG_64 dest)
     emitter.PAND_XMM_FROM_MEM(REG_64::RAX, dest);
 }
 
+void VU_JIT64::broadcast_bc(uint8_t bc, REG_64 source, REG_64 dest)
+{
+    if (!bc && HostCPU::has_avx2())
+        emitter.VBROADCASTSS(source, dest);
+    else if (HostCPU::has_avx())
+        emitter.VSHUFPS(bc, source, source, dest);
+    else
+    {
+        if (source != dest)
+            emitter.MOVAPS_REG(source, dest);
+        emitter.SHUFPS(bc, dest, dest);
+    }
+}
+
 void VU_JIT64::sse_div_check(REG_64 num, REG_64 denom, VU_R& dest)
 {
     //Division by zero check
@@ -1231,8 +1257,7 @@ void VU_JIT64::max_vector_by_scalar(VectorUnit &vu, IR::Instruction &instr)
     emitter.MOVAPS_REG(source, temp2);
     emitter.MOVAPS_REG(bc_reg, temp3);
 
-    emitter.MOVAPS_REG(bc_reg, temp);
-    emitter.SHUFPS(bc, temp, temp);
+    broadcast_bc(bc, bc_reg, temp);
 
     emitter.PMAXSD_XMM(source, temp);
     emitter.BLENDPS(field, temp, dest);
@@ -1259,7 +1284,16 @@ void VU_JIT64::max_vectors(VectorUnit &vu, IR::Instruction &instr)
     REG_64 temp2 = REG_64::XMM1;
     REG_64 temp3 = alloc_sse_temp_reg(vu);
 
-    if (op1 != op2)
+    if (op1 != op2 && HostCPU::has_avx())
+    {
+        //Where both are negative, the larger integer is the smaller float
+        emitter.VPAND(op1, op2, temp3); //mask
+        emitter.VPMINSD(op1, op2, temp2);
+        emitter.VPMAXSD(op1, op2, temp);
+        emitter.VBLENDVPS(temp3, temp, temp2, temp);
+        emitter.BLENDPS(field, temp, dest);
+    }
+    else if (op1 != op2)
     {
         emitter.MOVAPS_REG(op2, temp2);
         emitter.MOVAPS_REG(op1, temp3);
@@ -1296,8 +1330,7 @@ void VU_JIT64::min_vector_by_scalar(VectorUnit &vu, IR::Instruction &instr)
 
     emitter.MOVAPS_REG(source, temp2);
     emitter.MOVAPS_REG(bc_reg, temp3);
-    emitter.MOVAPS_REG(bc_reg, temp);
-    emitter.SHUFPS(bc, temp, temp);
+    broadcast_bc(bc, bc_reg, temp);
 
     emitter.PMINSD_XMM(source, temp);
     emitter.BLENDPS(field, temp, dest);
@@ -1324,7 +1357,16 @@ void VU_JIT64::min_vectors(VectorUnit &vu, IR::Instruction &instr)
     REG_64 temp2 = REG_64::XMM1;
     REG_64 temp3 = alloc_sse_temp_reg(vu);
 
-    if (op1 != op2)
+    if (op1 != op2 && HostCPU::has_avx())
+    {
+        //Where both are negative, the larger integer is the smaller float
+        emitter.VPAND(op1, op2, temp3); //mask
+        emitter.VPMAXSD(op1, op2, temp2);
+        emitter.VPMINSD(op1, op2, temp);
+        emitter.VBLENDVPS(temp3, temp, temp2, temp);
+        emitter.BLENDPS(field, temp, dest);
+    }
+    else if (op1 != op2)
     {
         emitter.MOVAPS_REG(op1, temp2);
         emitter.MOVAPS_REG(op2, temp3);
@@ -1357,9 +1399,14 @@ void VU_JIT64::add_vectors(VectorUnit &vu, IR::Instruction &instr)
     clamp_vfreg(field, op1);
     clamp_vfreg(field, op2);
 
-    if (op1 != temp)
-        emitter.MOVAPS_REG(op1, temp);
-    emitter.ADDPS(op2, temp);
+    if (HostCPU::has_avx())
+        emitter.VADDPS(op1, op2, temp);
+    else
+    {
+        if (op1 != temp)
+            emitter.MOVAPS_REG(op1, temp);
+        emitter.ADDPS(op2, temp);
+    }
 
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
@@ -1386,9 +1433,7 @@ void VU_JIT64::add_vector_by_scalar(VectorUnit &vu, IR::Instruction &instr)
     bc |= (bc << 6) | (bc << 4) | (bc << 2);
 
     REG_64 temp = (field != 0xF || dest == source || !instr.get_dest()) ? REG_64::XMM0 : dest;
-    if (bc_reg != temp)
-        emitter.MOVAPS_REG(bc_reg, temp);
-    emitter.SHUFPS(bc, temp, temp);
+    broadcast_bc(bc, bc_reg, temp);
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
 
@@ -1417,9 +1462,14 @@ void VU_JIT64::sub_vectors(VectorUnit &vu, IR::Instruction &instr)
     clamp_vfreg(field, op1);
     clamp_vfreg(field, op2);
 
-    if (op1 != temp)
-        emitter.MOVAPS_REG(op1, temp);
-    emitter.SUBPS(op2, temp);
+    if (HostCPU::has_avx())
+        emitter.VSUBPS(op1, op2, temp);
+    else
+    {
+        if (op1 != temp)
+            emitter.MOVAPS_REG(op1, temp);
+        emitter.SUBPS(op2, temp);
+    }
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
 
@@ -1446,8 +1496,7 @@ void VU_JIT64::sub_vector_by_scalar(VectorUnit &vu, IR::Instruction &instr)
 
     REG_64 temp = REG_64::XMM0;
     REG_64 temp2 = (field != 0xF || !instr.get_dest()) ? REG_64::XMM1 : dest;
-    emitter.MOVAPS_REG(bc_reg, temp);
-    emitter.SHUFPS(bc, temp, temp);
+    broadcast_bc(bc, bc_reg, temp);
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
 
@@ -1477,9 +1526,14 @@ void VU_JIT64::mul_vectors(VectorUnit &vu, IR::Instruction &instr)
     clamp_vfreg(field, op1);
     clamp_vfreg(field, op2);
 
-    if (op1 != temp)
-        emitter.MOVAPS_REG(op1, temp);
-    emitter.MULPS(op2, temp);
+    if (HostCPU::has_avx())
+        emitter.VMULPS(op1, op2, temp);
+    else
+    {
+        if (op1 != temp)
+            emitter.MOVAPS_REG(op1, temp);
+        emitter.MULPS(op2, temp);
+    }
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
 
@@ -1506,9 +1560,7 @@ void VU_JIT64::mul_vector_by_scalar(VectorUnit &vu, IR::Instruction &instr)
 
     REG_64 temp = (field != 0xF || !instr.get_dest() || dest == source) ? REG_64::XMM0 : dest;
 
-    if (bc_reg != temp)
-        emitter.MOVAPS_REG(bc_reg, temp);
-    emitter.SHUFPS(bc, temp, temp);
+    broadcast_bc(bc, bc_reg, temp);
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
 
@@ -1538,9 +1590,15 @@ void VU_JIT64::madd_vectors(VectorUnit &vu, IR::Instruction &instr)
     clamp_vfreg(field, op2);
     clamp_vfreg(field, acc);
 
-    if (op1 != temp)
-        emitter.MOVAPS_REG(op1, temp);
-    emitter.MULPS(op2, temp);
+    if (HostCPU::has_avx())
+        emitter.VMULPS(op1, op2, temp);
+    else
+    {
+        if (op1 != temp)
+            emitter.MOVAPS_REG(op1, temp);
+        emitter.MULPS(op2, temp);
+    }
+    //Not fused even with FMA, which would skip rounding the product and no longer match the VU
     emitter.ADDPS(acc, temp);
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
@@ -1609,9 +1667,7 @@ void VU_JIT64::madd_vector_by_scalar(VectorUnit &vu, IR::Instruction &instr)
 
     bc |= (bc << 6) | (bc << 4) | (bc << 2);
 
-    if (bc_reg != temp)
-        emitter.MOVAPS_REG(bc_reg, temp);
-    emitter.SHUFPS(bc, temp, temp);
+    broadcast_bc(bc, bc_reg, temp);
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
 
@@ -1644,8 +1700,7 @@ void VU_JIT64::madd_acc_by_scalar(VectorUnit &vu, IR::Instruction &instr)
 
     bc |= (bc << 6) | (bc << 4) | (bc << 2);
 
-    emitter.MOVAPS_REG(bc_reg, temp);
-    emitter.SHUFPS(bc, temp, temp);
+    broadcast_bc(bc, bc_reg, temp);
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
 
@@ -1721,8 +1776,7 @@ void VU_JIT64::msub_vector_by_scalar(VectorUnit &vu, IR::Instruction &instr)
 
     bc |= (bc << 6) | (bc << 4) | (bc << 2);
 
-    emitter.MOVAPS_REG(bc_reg, temp);
-    emitter.SHUFPS(bc, temp, temp);
+    broadcast_bc(bc, bc_reg, temp);
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
 
@@ -1760,8 +1814,7 @@ void VU_JIT64::msub_acc_by_scalar(VectorUnit &vu, IR::Instruction &instr)
 
     bc |= (bc << 6) | (bc << 4) | (bc << 2);
 
-    emitter.MOVAPS_REG(bc_reg, temp);
-    emitter.SHUFPS(bc, temp, temp);
+    broadcast_bc(bc, bc_reg, temp);
     set_clamping(temp, true, field);
     clamp_vfreg(field, temp);
 
@@ -3342,13 +3395,17 @@ void VU_JIT64::fallback_interpreter(VectorUnit &vu, IR::Instruction &instr)
     }
 
     uint32_t instr_word = instr.get_source();
+    bool is_upper = instr.get_field();
+
+    std::string name = is_upper ? VU_Disasm::upper(0, instr_word) : VU_Disasm::lower(0, instr_word);
+    name = name.substr(0, name.find_first_of(". "));
+    emitter.load_addr((uint64_t)fallback_counters.get_counter(name), REG_64::RAX);
+    emitter.INC64_MEM(REG_64::RAX);
 
     //VU_Interpreter::upper/lower
     prepare_abi(vu, (uint64_t)&vu);
     prepare_abi(vu, instr_word);
 
-    bool is_upper = instr.get_field();
-
     if (is_upper)
         call_abi_func((uint64_t)&interpreter_upper);
     else
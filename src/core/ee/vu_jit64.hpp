@@ -2,6 +2,7 @@
 #define VU_JIT64_HPP
 #include "../jitcommon/emitter64.hpp"
 #include "../jitcommon/ir_block.hpp"
+#include "../jitcommon/jitfallbacks.hpp"
 #include "vu_jittrans.hpp"
 #include "vu.hpp"
 
@@ -41,6 +42,7 @@ class VU_JIT64
         VUJitHeap jit_heap;
         Emitter64 emitter;
         VU_JitTranslator ir;
+        JitFallbackCounters fallback_counters;
         VUJitPrologue prologue_block;
 
         //Set to 0x7FFFFFFF, repeated four times
@@ -68,6 +70,9 @@ class VU_JIT64
 
         void clamp_vfreg(uint8_t field, REG_64 xmm_reg);
         void sse_abs(REG_64 source, REG_64 dest);
+
+        //bc is the lane index repeated in all four fields of a shuffle immediate
+        void broadcast_bc(uint8_t bc, REG_64 source, REG_64 dest);
         void sse_div_check(REG_64 num, REG_64 denom, VU_R& dest);
 
         void handle_branch(VectorUnit& vu);
@@ -205,7 +210,9 @@ class VU_JIT64
 
         void reset(bool clear_cache = true);
         void set_current_program(uint32_t crc);
+        uint32_t get_current_program() const;
         uint16_t run(VectorUnit& vu);
+        const JitFallbackCounters& get_fallback_counters() const;
 
         friend uint8_t* exec_block_vu(VU_JIT64& jit, VectorUnit& vu);
 };
@@ -1,6 +1,8 @@
+#include <algorithm>
 #include <cstring>
 #include "vu_jittrans.hpp"
 #include "vu_interpreter.hpp"
+#include "vu_disasm.hpp"
 #include "../errors.hpp"
 
 uint32_t branch_offset(uint32_t instr, uint32_t PC)
@@ -14,6 +16,7 @@ uint32_t branch_offset(uint32_t instr, uint32_t PC)
 void VU_JitTranslator::reset_instr_info()
 {
     memset(instr_info, 0, sizeof(instr_info));
+    flag_liveness_valid = false;
 }
 
 IR::Block VU_JitTranslator::translate(VectorUnit &vu, uint8_t* instr_mem, uint32_t prev_pc)
@@ -28,6 +31,8 @@ IR::Block VU_JitTranslator::translate(VectorUnit &vu, uint8_t* instr_mem, uint32
     cycles_since_xgkick_update = 0;
 
     interpreter_pass(vu, instr_mem, prev_pc);
+    if (!flag_liveness_valid)
+        flag_liveness_pass(vu, instr_mem);
     flag_pass(vu);
 
     cur_PC = vu.get_PC();
@@ -426,6 +431,33 @@ int VU_JitTranslator::is_flag_instruction(uint32_t lower_instr)
     return FlagInstr_None;
 }
 
+bool VU_JitTranslator::reads_flags(uint32_t lower_instr)
+{
+    if (lower_instr & (1 << 31))
+        return false;
+
+    switch ((lower_instr >> 25) & 0x7F)
+    {
+        //FCEQ/FCAND/FCOR/FCGET
+        case 0x10:
+        case 0x12:
+        case 0x13:
+        case 0x1C:
+        //FSEQ/FSAND/FSOR, and FSSET, which only lands in the status flags as the pipeline advances
+        case 0x14:
+        case 0x15:
+        case 0x16:
+        case 0x17:
+        //FMEQ/FMAND/FMOR
+        case 0x18:
+        case 0x1A:
+        case 0x1B:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void VU_JitTranslator::update_pipeline(VectorUnit &vu, int cycles)
 {
     for (int i = 0; i < cycles; i++)
@@ -846,6 +878,75 @@ void VU_JitTranslator::interpreter_pass(VectorUnit &vu, uint8_t *instr_mem, uint
     populate_vu_state(vu, q_pipe_delay, p_pipe_delay, end_PC);
 }
 
+/**
+ * Find the instructions a flag read or the end of the microprogram is reachable from, following
+ * branches across the whole microprogram. Blocks that can't reach either, such as a loop waiting
+ * to be reset, skip updating the flags, as nothing can observe them. Along the way, count the MAC
+ * writes in between; a MAC result followed by MAC_FLAG_DEPTH more on every path is never seen.
+ * Computed once per microprogram, as instr_info is reset whenever the program changes.
+ */
+void VU_JitTranslator::flag_liveness_pass(VectorUnit &vu, uint8_t *instr_mem)
+{
+    int count = (vu.mem_mask + 1) / 8;
+
+    memset(mac_writes_to_read, NO_FLAG_READ, sizeof(mac_writes_to_read));
+
+    //Backward branches need more passes to carry a read back to the start of the loop
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (int i = count - 1; i >= 0; i--)
+        {
+            if (!mac_writes_to_read[i])
+                continue;
+
+            uint16_t PC = (uint16_t)(i * 8);
+            uint16_t prev_PC = (PC - 8) & vu.mem_mask;
+            uint32_t upper = *(uint32_t*)&instr_mem[PC + 4];
+            uint32_t lower = *(uint32_t*)&instr_mem[PC];
+            uint32_t prev_upper = *(uint32_t*)&instr_mem[prev_PC + 4];
+            uint32_t prev_lower = *(uint32_t*)&instr_mem[prev_PC];
+            uint8_t prev_op = (uint8_t)((prev_lower >> 25) & 0x7F);
+            bool prev_has_lower = !(prev_upper & (1 << 31));
+
+            int writes;
+            if (!(upper & (1 << 31)) && reads_flags(lower))
+                writes = 0;
+            //Delay slot of the E-bit. The MAC, sticky status and clip flags carry over into the next
+            //microprogram, and VU0's can be read by the EE with CFC2, so the end counts as a read
+            else if (prev_upper & (1 << 30))
+                writes = 0;
+            //JR/JALR delay slot, the destination isn't known
+            else if (prev_has_lower && (prev_op == 0x24 || prev_op == 0x25))
+                writes = 0;
+            //The T-bit only ends the microprogram when FBRST enables it, otherwise execution carries on
+            else if (upper & (1 << 27))
+                writes = 0;
+            else
+            {
+                writes = mac_writes_to_read[(i + 1) % count];
+                if (prev_has_lower && VU_Disasm::is_branch(prev_lower))
+                {
+                    int target = (branch_offset(prev_lower, prev_PC) & vu.mem_mask) / 8;
+                    writes = std::min(writes, (int)mac_writes_to_read[target]);
+                }
+
+                if (writes != NO_FLAG_READ && updates_mac_flags(upper))
+                    writes = std::min(writes + 1, MAC_FLAG_DEPTH + 1);
+            }
+
+            if (writes < mac_writes_to_read[i])
+            {
+                mac_writes_to_read[i] = (uint8_t)writes;
+                changed = true;
+            }
+        }
+    }
+
+    flag_liveness_valid = true;
+}
+
 /**
  * Determine when MAC, clip, and status flags need to be updated.
  */
@@ -878,14 +979,22 @@ void VU_JitTranslator::flag_pass(VectorUnit &vu)
             }
         }
 
+        //Whether a flag read can follow, in this block or any block reachable from it
+        uint8_t writes_to_read = mac_writes_to_read[i / 8];
+        bool flags_observable = writes_to_read != NO_FLAG_READ;
+
+        //Later MAC writes overwrite this result on every path before it can be read
+        if (instr_info[i].has_mac_result && writes_to_read > MAC_FLAG_DEPTH)
+            flags_observable = false;
+
         //Update the flags at the end of the block ready for the next block in case of flag read instruction
-        if (i >= (end_PC - 32) || final_mac_instance_found == false)
+        if (flags_observable && (i >= (end_PC - 32) || final_mac_instance_found == false))
         {
             needs_update = true;
         }
 
         //Update the flags at the beginning of a block also, I'm scared of subroutines checking flags
-        if (i <= (start_pc + 32))
+        if (flags_observable && i <= (start_pc + 32))
         {
             needs_update = true;
         }
@@ -908,7 +1017,7 @@ void VU_JitTranslator::flag_pass(VectorUnit &vu)
         }
 
         //Always update for clip instructions also, probably not needed but just in case
-        if (instr_info[i].has_clip_result)
+        if (flags_observable && instr_info[i].has_clip_result)
         {
             needs_update = true;
         }
@@ -73,17 +73,28 @@ class VU_JitTranslator
         uint16_t end_PC;
         uint16_t cur_PC;
 
+        //MAC flag results are overwritten once this many later MAC-writing ops have gone down the pipeline
+        static constexpr int MAC_FLAG_DEPTH = 4;
+        static constexpr uint8_t NO_FLAG_READ = 0xFF;
+
+        //Per instruction of the microprogram, the fewest MAC writes (its own included, capped at
+        //MAC_FLAG_DEPTH + 1) on any path from there to a flag read. NO_FLAG_READ if none is reachable.
+        uint8_t mac_writes_to_read[1024 * 2];
+        bool flag_liveness_valid = false;
+
         int fdiv_pipe_cycles(uint32_t lower_instr);
         int efu_pipe_cycles(uint32_t lower_instr);
         int is_flag_instruction(uint32_t lower_instr);
         bool updates_mac_flags(uint32_t upper_instr);
         bool updates_mac_flags_special(uint32_t upper_instr);
+        bool reads_flags(uint32_t lower_instr);
 
         void update_pipeline(VectorUnit &vu, int cycles);
         void handle_vu_stalls(VectorUnit &vu, uint16_t PC, uint32_t lower, int &q_pipe_delay, int &p_pipe_delay);
         void analyze_FMAC_stalls(VectorUnit &vu, uint16_t PC);
         void populate_vu_state(VectorUnit &vu, int q_pipe_delay, int p_pipe_delay, uint16_t PC);
         void interpreter_pass(VectorUnit& vu, uint8_t *instr_mem, uint32_t prev_pc);
+        void flag_liveness_pass(VectorUnit& vu, uint8_t *instr_mem);
         void flag_pass(VectorUnit& vu);
 
         void fallback_interpreter(IR::Instruction& instr, uint32_t instr_word, bool is_upper);
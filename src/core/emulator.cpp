@@ -5,9 +5,11 @@
 #include <sstream>
 #include "emulator.hpp"
 #include "errors.hpp"
+#include "trace.hpp"
 
 #include "ee/vu_jit.hpp"
 #include "ee/ee_jit.hpp"
+#include "jitcommon/cpuinfo.hpp"
 
 /* Notes of timings from PS2*/
 /*
@@ -36,6 +38,9 @@ EE Cycles Per Frame between 5926400 & 5926912
 #define HBLANK_CYCLES 18742
 #define GS_VBLANK_DELAY 65622 //CSR FIELD swap/vblank happens ~65622 cycles after the INTC VBLANK_START event
 
+#define SOUND_SAMPLE_CYCLES (768 * 8) //48 kHz
+#define SOUND_BATCH_SAMPLES 64
+
 //These constants are used for the fast boot hack for .isos
 #define EELOAD_START 0x82000
 #define EELOAD_SIZE 0x20000
@@ -46,7 +51,7 @@ Emulator::Emulator() :
     cpu(&cp0, &fpu, this, &sif, &vu0, &vu1),
     dmac(&cpu, this, &gif, &ipu, &sif, &vif0, &vif1, &vu0, &vu1),
     gif(&gs, &dmac),
-    gs(&intc),
+    gs(&intc, &trace_clock),
     iop(this),
     iop_dma(&iop_intc, &cdvd, &sif, &sio2, &spu, &spu2),
     iop_intc(&iop),
@@ -55,8 +60,8 @@ Emulator::Emulator() :
     ipu(&intc, &dmac),
     timers(&intc, &scheduler),
     sio2(&iop_intc, &pad, &memcard),
-    spu(1, &iop_intc, &iop_dma),
-    spu2(2, &iop_intc, &iop_dma),
+    spu(1, &iop_intc, &iop_dma, &spu_shared),
+    spu2(2, &iop_intc, &iop_dma, &spu_shared),
     firewire(&iop_intc, &iop_dma),
     vif0(nullptr, &vu0, &intc, &dmac, 0),
     vif1(&gif, &vu1, &intc, &dmac, 1),
@@ -71,15 +76,26 @@ Emulator::Emulator() :
     ELF_file = nullptr;
     ELF_size = 0;
     gsdump_single_frame = false;
+    trace_clock = 0;
+    HostCPU::print_features();
     ee_log.open("ee_log.txt", std::ios::out);
     set_ee_mode(CPU_MODE::DONT_CARE);
     set_vu0_mode(CPU_MODE::DONT_CARE);
     set_vu1_mode(CPU_MODE::DONT_CARE);
-    spu.gaussianConstructTable();
+    SPU::gaussianConstructTable();
+    spu.set_sync_callback([this] { catch_up_sound(); });
+    spu2.set_sync_callback([this] { catch_up_sound(); });
+    spu2.set_output_stream(&audio_stream);
+    audio_sink = nullptr;
 }
 
 Emulator::~Emulator()
 {
+    EE_JIT::print_fallback_counts(&cpu);
+    VU_JIT::print_fallback_counts(&vu0);
+    VU_JIT::print_fallback_counts(&vu1);
+
+    set_audio_sink(nullptr);
     if (ee_log.is_open())
         ee_log.close();
     delete[] RDRAM;
@@ -91,6 +107,14 @@ Emulator::~Emulator()
 
 void Emulator::run()
 {
+    Trace::set_guest_clock(&trace_clock);
+
+    //Waits for this frame's turn, and drops its rasterization if the host is falling behind.
+    //GS dumps need every frame.
+    pacer.set_speed_factor(audio_stream.get_pacing_factor());
+    frame_skipped = pacer.begin_frame() && !gsdump_running;
+    gs.set_skip_draws(frame_skipped);
+
     gs.start_frame();
     VBLANK_sent = false;
     const int originalRounding = fegetround();
@@ -128,30 +152,77 @@ void Emulator::run()
     
     while (!frame_ended)
     {
-        int ee_cycles = scheduler.calculate_run_cycles();
+        if (profiler.is_sample_due())
+            sample_profiler();
+
+        int ee_cycles = scheduler.calculate_run_cycles(devices_idle());
         int bus_cycles = scheduler.get_bus_run_cycles();
         int iop_cycles = scheduler.get_iop_run_cycles();
         scheduler.update_cycle_counts();
 
+        //Trace records are stamped with the EE cycle the slice started at
+        trace_clock.store(cpu.get_cycle_count(), std::memory_order_relaxed);
         cpu.run(ee_cycles);
-        iop_dma.run(iop_cycles);
-        iop.run(iop_cycles);
+        profiler.lap(GuestProfiler::EE);
 
-        dmac.run(bus_cycles);
-        ipu.run();
-        vif0.update(bus_cycles);
-        vif1.update(bus_cycles);
-        gif.run(bus_cycles);
+        //Devices with nothing to do sleep until a register write or DMA request gives them work.
+        //Anything the CPUs started during this slice is picked up here, before the next one.
+        if (!iop_dma.is_idle())
+            iop_dma.run(iop_cycles);
+        iop.run(iop_cycles);
+        profiler.lap(GuestProfiler::IOP);
+
+        if (!dmac.is_idle())
+            dmac.run(bus_cycles);
+        if (!ipu.is_idle())
+            ipu.run();
+        if (!vif0.is_idle())
+            vif0.update(bus_cycles);
+        if (!vif1.is_idle())
+            vif1.update(bus_cycles);
+        if (!gif.is_idle())
+            gif.run(bus_cycles);
+        profiler.lap(GuestProfiler::DEVICES);
         
         //VU's run at EE speed, however both maintain their own speed
-        vu0.run_func(vu0);
-        vu1.run_func(vu1);
+        if (!vu0.is_idle())
+            vu0.run_func(vu0);
+        profiler.lap(GuestProfiler::VU0);
+        if (!vu1.is_idle())
+            vu1.run_func(vu1);
+        profiler.lap(GuestProfiler::VU1);
 
         scheduler.process_events();
+        profiler.lap(GuestProfiler::EVENTS);
     }
+    pacer.end_emulation();
+    pacer.set_gs_time(gs.get_last_frame_busy_us());
     fesetround(originalRounding);
 }
 
+void Emulator::sample_profiler()
+{
+    GuestProfilerSample sample;
+    sample.ee_pc = cpu.get_PC();
+    sample.ee_ra = cpu.get_gpr<uint32_t>(31);
+    sample.iop_pc = iop.get_PC();
+    VectorUnit* vus[] = {&vu0, &vu1};
+    for (int i = 0; i < 2; i++)
+    {
+        sample.vu_running[i] = vus[i]->is_running();
+        sample.vu_pc[i] = vus[i]->get_PC();
+        sample.vu_program[i] = VU_JIT::get_current_program(vus[i]);
+    }
+    sample.gs_draw_state = gs.get_last_draw_state();
+    profiler.add_sample(sample);
+}
+
+bool Emulator::devices_idle()
+{
+    return iop_dma.is_idle() && dmac.is_idle() && ipu.is_idle() && vif0.is_idle() && vif1.is_idle() &&
+           gif.is_idle() && vu0.is_idle() && vu1.is_idle();
+}
+
 void Emulator::reset()
 {
     save_requested = false;
@@ -159,6 +230,9 @@ void Emulator::reset()
     gsdump_requested = false;
     ee_stdout = "";
     frames = 0;
+    frame_skipped = false;
+    pacer.reset();
+    pacer.set_target_fps((double)Scheduler::EE_CLOCKRATE / CYCLES_PER_FRAME);
     skip_BIOS_hack = NONE;
     if (!RDRAM)
         RDRAM = new uint8_t[1024 * 1024 * 32];
@@ -202,7 +276,7 @@ void Emulator::reset()
     vu1.reset();
     VU_JIT::reset(&vu0);
     VU_JIT::reset(&vu1);
-    EE_JIT::reset(true);
+    EE_JIT::reset(&cpu, true);
 
     MCH_DRD = 0;
     MCH_RICM = 0;
@@ -222,14 +296,16 @@ void Emulator::reset()
     gs_vblank_event_id = scheduler.register_function([this](uint64_t param) { GS_vblank_event(); });
 
     scheduler.add_event(hblank_event_id, HBLANK_CYCLES);
+    next_sound_sample = SOUND_SAMPLE_CYCLES;
+    syncing_sound = false;
     start_sound_sample_event();
 }
 
 void Emulator::print_state()
 {
-    printf("---EE STATE\n");
+    TRACE_INFO(Trace::CORE, "---EE STATE\n");
     cpu.print_state();
-    printf("---IOP STATE\n");
+    TRACE_INFO(Trace::CORE, "---IOP STATE\n");
     iop.print_state();
 }
 
@@ -247,13 +323,15 @@ void Emulator::GS_vblank_event()
 
 void Emulator::vblank_start()
 {
-    gs.render_CRT();
+    //A skipped frame isn't scanned out, the frontend keeps showing the last one
+    if (!frame_skipped)
+        gs.render_CRT();
     VBLANK_sent = true;
     gs.set_VBLANK_irq(true);
     timers.gate(true, true);
     cdvd.vsync();
     //cpu.set_disassembly(frames >= 223 && frames < 225);
-    printf("VSYNC FRAMES: %d\n", frames);
+    TRACE_INFO(Trace::CORE, "VSYNC FRAMES: %d\n", frames);
     iop_intc.assert_irq(0);
     scheduler.add_event(gs_vblank_event_id, GS_VBLANK_DELAY);
 }
@@ -273,15 +351,51 @@ void Emulator::cdvd_event()
     cdvd.handle_N_command();
 }
 
+//The SPUs are run in batches of samples. Reads and writes from the IOP and DMA catch them up first,
+//so only the IRQ needs the event to run on every sample.
 void Emulator::start_sound_sample_event()
 {
-    scheduler.add_event(spu_event_id, 768 * 8);
+    int64_t samples = spu.IRQ_enabled() ? 1 : SOUND_BATCH_SAMPLES;
+    sound_event_time = next_sound_sample + (samples - 1) * SOUND_SAMPLE_CYCLES;
+    int64_t delta = std::max(sound_event_time - scheduler.get_ee_cycles(), (int64_t)0);
+    sound_event_id = scheduler.add_event(spu_event_id, delta);
+}
+
+//Enabling the IRQ in the middle of a batch must not delay it to the end of the batch
+void Emulator::update_sound_batch()
+{
+    if (spu.IRQ_enabled() && sound_event_time > next_sound_sample)
+    {
+        scheduler.delete_event(sound_event_id);
+        start_sound_sample_event();
+    }
+}
+
+void Emulator::sync_sound(int64_t time)
+{
+    if (syncing_sound)
+        return;
+
+    syncing_sound = true;
+    while (next_sound_sample <= time)
+    {
+        spu.gen_sample();
+        spu2.gen_sample();
+        next_sound_sample += SOUND_SAMPLE_CYCLES;
+    }
+    syncing_sound = false;
+}
+
+//The scheduler has already advanced to the end of the slice being run, so only samples due before
+//the slice started would have been generated by now
+void Emulator::catch_up_sound()
+{
+    sync_sound(scheduler.get_slice_start_cycles());
 }
 
 void Emulator::gen_sound_sample()
 {
-    spu.gen_sample();
-    spu2.gen_sample();
+    sync_sound(scheduler.get_ee_cycles());
     start_sound_sample_event();
 }
 
@@ -308,6 +422,42 @@ uint32_t* Emulator::get_framebuffer()
     return gs.get_framebuffer();
 }
 
+void Emulator::set_frame_queue_depth(int depth)
+{
+    gs.set_frame_queue_depth(depth);
+}
+
+void Emulator::set_frame_limit(bool limited)
+{
+    pacer.set_throttled(limited);
+}
+
+void Emulator::set_max_frameskip(int frames)
+{
+    pacer.set_max_frameskip(frames);
+}
+
+FramePacerStats Emulator::get_frame_stats()
+{
+    return pacer.get_stats();
+}
+
+void Emulator::start_profiler(int interval_us)
+{
+    profiler.clear();
+    profiler.start(interval_us);
+}
+
+void Emulator::stop_profiler()
+{
+    profiler.stop();
+}
+
+bool Emulator::write_profile(const char* path)
+{
+    return profiler.write_collapsed(path);
+}
+
 void Emulator::get_resolution(int &w, int &h)
 {
     gs.get_resolution(w, h);
@@ -348,7 +498,7 @@ void Emulator::fast_boot()
         {
             if (!strcmp((char*)&RDRAM[str], "rom0:OSDSYS"))
             {
-                printf("OSDSYS string found at $%08X\n", str);
+                TRACE_INFO(Trace::CORE, "OSDSYS string found at $%08X\n", str);
                 strcpy((char*)&RDRAM[str], path.c_str());
             }
         }
@@ -375,7 +525,7 @@ void Emulator::set_ee_mode(CPU_MODE mode)
             break;
     }
 
-    EE_JIT::reset(true);
+    EE_JIT::reset(&cpu, true);
 }
 
 void Emulator::set_vu0_mode(CPU_MODE mode)
@@ -422,10 +572,10 @@ void Emulator::load_ELF(const uint8_t *ELF, uint32_t size)
 {
     if (ELF[0] != 0x7F || ELF[1] != 'E' || ELF[2] != 'L' || ELF[3] != 'F')
     {
-        printf("Invalid elf\n");
+        TRACE_WARN(Trace::CORE, "Invalid elf\n");
         return;
     }
-    printf("Valid elf\n");
+    TRACE_INFO(Trace::CORE, "Valid elf\n");
     delete[] ELF_file;
     ELF_file = new uint8_t[size];
     ELF_size = size;
@@ -441,7 +591,7 @@ void Emulator::load_memcard(int port, const char *name)
 {
     //TODO: handle port setting. Currently it's ignored and treated as Port 0
     if (!memcard.open(name))
-        printf("Failed to open memcard %s\n", name);
+        TRACE_WARN(Trace::CORE, "Failed to open memcard %s\n", name);
 }
 
 std::string Emulator::get_serial()
@@ -455,7 +605,7 @@ void Emulator::execute_ELF()
     {
         Errors::die("[Emulator] ELF not loaded!\n");
     }
-    printf("[Emulator] Loading ELF into memory...\n");
+    TRACE_INFO(Trace::CORE, "[Emulator] Loading ELF into memory...\n");
     uint32_t e_entry = *(uint32_t*)&ELF_file[0x18];
     uint32_t e_phoff = *(uint32_t*)&ELF_file[0x1C];
     uint32_t e_shoff = *(uint32_t*)&ELF_file[0x20];
@@ -463,12 +613,12 @@ void Emulator::execute_ELF()
     uint16_t e_shnum = *(uint16_t*)&ELF_file[0x30];
     uint16_t e_shstrndx = *(uint16_t*)&ELF_file[0x32];
 
-    printf("Entry: $%08X\n", e_entry);
-    printf("Program header start: $%08X\n", e_phoff);
-    printf("Section header start: $%08X\n", e_shoff);
-    printf("Program header entries: %d\n", e_phnum);
-    printf("Section header entries: %d\n", e_shnum);
-    printf("Section header names index: %d\n", e_shstrndx);
+    TRACE_INFO(Trace::CORE, "Entry: $%08X\n", e_entry);
+    TRACE_INFO(Trace::CORE, "Program header start: $%08X\n", e_phoff);
+    TRACE_INFO(Trace::CORE, "Section header start: $%08X\n", e_shoff);
+    TRACE_INFO(Trace::CORE, "Program header entries: %d\n", e_phnum);
+    TRACE_INFO(Trace::CORE, "Section header entries: %d\n", e_shnum);
+    TRACE_INFO(Trace::CORE, "Section header names index: %d\n", e_shstrndx);
 
     for (unsigned int i = e_phoff; i < e_phoff + (e_phnum * 0x20); i += 0x20)
     {
@@ -476,13 +626,13 @@ void Emulator::execute_ELF()
         uint32_t p_paddr = *(uint32_t*)&ELF_file[i + 0xC];
         uint32_t p_filesz = *(uint32_t*)&ELF_file[i + 0x10];
         uint32_t p_memsz = *(uint32_t*)&ELF_file[i + 0x14];
-        printf("\nProgram header\n");
-        printf("p_type: $%08X\n", *(uint32_t*)&ELF_file[i]);
-        printf("p_offset: $%08X\n", p_offset);
-        printf("p_vaddr: $%08X\n", *(uint32_t*)&ELF_file[i + 0x8]);
-        printf("p_paddr: $%08X\n", p_paddr);
-        printf("p_filesz: $%08X\n", p_filesz);
-        printf("p_memsz: $%08X\n", p_memsz);
+        TRACE_INFO(Trace::CORE, "\nProgram header\n");
+        TRACE_INFO(Trace::CORE, "p_type: $%08X\n", *(uint32_t*)&ELF_file[i]);
+        TRACE_INFO(Trace::CORE, "p_offset: $%08X\n", p_offset);
+        TRACE_INFO(Trace::CORE, "p_vaddr: $%08X\n", *(uint32_t*)&ELF_file[i + 0x8]);
+        TRACE_INFO(Trace::CORE, "p_paddr: $%08X\n", p_paddr);
+        TRACE_INFO(Trace::CORE, "p_filesz: $%08X\n", p_filesz);
+        TRACE_INFO(Trace::CORE, "p_memsz: $%08X\n", p_memsz);
 
         int mem_w = p_paddr;
         for (unsigned int file_w = p_offset; file_w < (p_offset + p_filesz); file_w += 4)
@@ -555,7 +705,7 @@ uint8_t Emulator::read8(uint32_t address)
         case 0x1F402018:
             return cdvd.read_S_data();
     }
-    printf("Unrecognized read8 at physical addr $%08X\n", address);
+    TRACE_WARN(Trace::CORE, "Unrecognized read8 at physical addr $%08X\n", address);
     return 0;
 }
 
@@ -584,7 +734,7 @@ uint16_t Emulator::read16(uint32_t address)
         case 0x1A000006:
             return 1;
     }
-    printf("Unrecognized read16 at physical addr $%08X\n", address);
+    TRACE_WARN(Trace::CORE, "Unrecognized read16 at physical addr $%08X\n", address);
     return 0;
 }
 
@@ -648,7 +798,7 @@ uint32_t Emulator::read32(uint32_t address)
             //printf("\nRead32 INTC_STAT: $%08X", intc.read_stat());
             return intc.read_stat();
         case 0x1000F010:
-            printf("Read32 INTC_MASK: $%08X\n", intc.read_mask());
+            TRACE_DEBUG(Trace::EE, "Read32 INTC_MASK: $%08X\n", intc.read_mask());
             return intc.read_mask();
         case 0x1000F130:
             return 0;
@@ -661,7 +811,7 @@ uint32_t Emulator::read32(uint32_t address)
         case 0x1000F230:
             return sif.get_smflag();
         case 0x1000F240:
-            printf("[EE] Read BD4: $%08X\n", sif.get_control() | 0xF0000102);
+            TRACE_DEBUG(Trace::EE, "[EE] Read BD4: $%08X\n", sif.get_control() | 0xF0000102);
             return sif.get_control() | 0xF0000102;
         case 0x1000F430:
             //printf("Read from MCH_RICM\n");
@@ -695,7 +845,7 @@ uint32_t Emulator::read32(uint32_t address)
         case 0x1000F520:
             return dmac.read_master_disable();
     }
-    printf("Unrecognized read32 at physical addr $%08X\n", address);
+    TRACE_WARN(Trace::CORE, "Unrecognized read32 at physical addr $%08X\n", address);
     return 0;
 }
 
@@ -728,7 +878,7 @@ uint64_t Emulator::read64(uint32_t address)
         case 0x10002030:
             return ipu.read_top();
     }
-    printf("Unrecognized read64 at physical addr $%08X\n", address);
+    TRACE_WARN(Trace::CORE, "Unrecognized read64 at physical addr $%08X\n", address);
     return 0;
 }
 
@@ -746,7 +896,7 @@ uint128_t Emulator::read128(uint32_t address)
     if (address == 0x10005000)
         return std::get<0>(vif1.readFIFO());
 
-    printf("Unrecognized read128 at physical addr $%08X\n", address);
+    TRACE_WARN(Trace::CORE, "Unrecognized read128 at physical addr $%08X\n", address);
     return uint128_t::from_u32(0);
 }
 
@@ -826,10 +976,10 @@ void Emulator::write16(uint32_t address, uint16_t value)
     }
     if (address >= 0x1A000000 && address < 0x1FC00000)
     {
-        printf("[EE] Unrecognized write16 to IOP addr $%08X of $%04X\n", address, value);
+        TRACE_WARN(Trace::EE, "[EE] Unrecognized write16 to IOP addr $%08X of $%04X\n", address, value);
         return;
     }
-    printf("Unrecognized write16 at physical addr $%08X of $%04X\n", address, value);
+    TRACE_WARN(Trace::CORE, "Unrecognized write16 at physical addr $%08X of $%04X\n", address, value);
 }
 
 void Emulator::write32(uint32_t address, uint32_t value)
@@ -857,7 +1007,7 @@ void Emulator::write32(uint32_t address, uint32_t value)
     }
     if (address >= 0x1A000000 && address < 0x1FC00000)
     {
-        printf("[EE] Unrecognized write32 to IOP addr $%08X of $%08X\n", address, value);
+        TRACE_WARN(Trace::EE, "[EE] Unrecognized write32 to IOP addr $%08X of $%08X\n", address, value);
         return;
     }
     if (address >= 0x11000000 && address < 0x11004000)
@@ -923,11 +1073,11 @@ void Emulator::write32(uint32_t address, uint32_t value)
             vif1.transfer_word(value);
             return;
         case 0x1000F000:
-            printf("Write32 INTC_STAT: $%08X\n", value);
+            TRACE_DEBUG(Trace::EE, "Write32 INTC_STAT: $%08X\n", value);
             intc.write_stat(value);
             return;
         case 0x1000F010:
-            printf("Write32 INTC_MASK: $%08X\n", value);
+            TRACE_DEBUG(Trace::EE, "Write32 INTC_MASK: $%08X\n", value);
             intc.write_mask(value);
             return;
         case 0x1000F200:
@@ -936,15 +1086,15 @@ void Emulator::write32(uint32_t address, uint32_t value)
         case 0x1000F210:
             return;
         case 0x1000F220:
-            printf("[EE] Write32 msflag: $%08X\n", value);
+            TRACE_DEBUG(Trace::EE, "[EE] Write32 msflag: $%08X\n", value);
             sif.set_msflag(value);
             return;
         case 0x1000F230:
-            printf("[EE] Write32 smflag: $%08X\n", value);
+            TRACE_DEBUG(Trace::EE, "[EE] Write32 smflag: $%08X\n", value);
             sif.reset_smflag(value);
             return;
         case 0x1000F240:
-            printf("[EE] Write BD4: $%08X\n", value);
+            TRACE_DEBUG(Trace::EE, "[EE] Write BD4: $%08X\n", value);
             sif.set_control_EE(value);
             return;
         case 0x1000F430:
@@ -1057,7 +1207,7 @@ void Emulator::ee_kputs(uint32_t param)
     if (param > 1024 * 1024 * 32)
         return;
     param = *(uint32_t*)&RDRAM[param];
-    printf("Param: $%08X\n", param);
+    TRACE_DEBUG(Trace::CORE, "Param: $%08X\n", param);
     char c;
     do
     {
@@ -1141,7 +1291,7 @@ uint8_t Emulator::iop_read8(uint32_t address)
     }
     if (address >= iop_scratchpad_start && address < iop_scratchpad_start + 0x400)
         return iop_scratchpad[address & 0x3FF];
-    printf("Unrecognized IOP read8 from physical addr $%08X\n", address);
+    TRACE_WARN(Trace::CORE, "Unrecognized IOP read8 from physical addr $%08X\n", address);
     return 0;
 }
 
@@ -1220,7 +1370,7 @@ uint16_t Emulator::iop_read16(uint32_t address)
     }
     if (address >= iop_scratchpad_start && address < iop_scratchpad_start + 0x400)
         return *(uint16_t*)&iop_scratchpad[address & 0x3FF];
-    printf("Unrecognized IOP read16 from physical addr $%08X\n", address);
+    TRACE_WARN(Trace::CORE, "Unrecognized IOP read16 from physical addr $%08X\n", address);
     return 0;
 }
 
@@ -1243,7 +1393,7 @@ uint32_t Emulator::iop_read32(uint32_t address)
         case 0x1D000030:
             return sif.get_smflag();
         case 0x1D000040:
-            printf("[IOP] Read BD4: $%08X\n", sif.get_control() | 0xF0000002);
+            TRACE_DEBUG(Trace::IOP, "[IOP] Read BD4: $%08X\n", sif.get_control() | 0xF0000002);
             return sif.get_control() | 0xF0000002;
         case 0x1F801070:
             return iop_intc.read_istat();
@@ -1351,7 +1501,7 @@ void Emulator::iop_write8(uint32_t address, uint8_t value)
             cdvd.write_N_data(value);
             return;
         case 0x1F402006:
-            printf("[CDVD] Write to mode: $%02X\n", value);
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] Write to mode: $%02X\n", value);
             return;
         case 0x1F402007:
             cdvd.write_BREAK();
@@ -1378,7 +1528,7 @@ void Emulator::iop_write8(uint32_t address, uint8_t value)
             //Register intended to be displayed on an external 7 segment display
             //Used to indicate how far along the boot process is
             IOP_POST = value;
-            printf("[IOP] POST: $%02X\n", value);
+            TRACE_DEBUG(Trace::IOP, "[IOP] POST: $%02X\n", value);
             return;
     }
     if (address >= iop_scratchpad_start && address < iop_scratchpad_start + 0x400)
@@ -1400,11 +1550,13 @@ void Emulator::iop_write16(uint32_t address, uint16_t value)
     if ((address >= 0x1F900000 && address < 0x1F900400) || (address >= 0x1F900760 && address < 0x1F900788))
     {
         spu.write16(address, value);
+        update_sound_batch();
         return;
     }
     if (address >= 0x1F900400 && address < 0x1F900800)
     {
         spu2.write16(address, value);
+        update_sound_batch();
         return;
     }
     switch (address)
@@ -1558,18 +1710,18 @@ void Emulator::iop_write32(uint32_t address, uint32_t value)
             sif.reset_msflag(value);
             return;
         case 0x1D000030:
-            printf("[IOP] Set smflag: $%08X\n", value);
+            TRACE_DEBUG(Trace::IOP, "[IOP] Set smflag: $%08X\n", value);
             sif.set_smflag(value);
             return;
         case 0x1D000040:
-            printf("[IOP] Write BD4: $%08X\n", value);
+            TRACE_DEBUG(Trace::IOP, "[IOP] Write BD4: $%08X\n", value);
             sif.set_control_IOP(value);
             return;
         case 0x1F801010:
-            printf("[IOP] SIF2/GPU SSBUS: $%08X\n", value);
+            TRACE_DEBUG(Trace::IOP, "[IOP] SIF2/GPU SSBUS: $%08X\n", value);
             return;
         case 0x1F801014:
-            printf("[IOP] SPU SSBUS: $%08X\n", value);
+            TRACE_DEBUG(Trace::IOP, "[IOP] SPU SSBUS: $%08X\n", value);
             return;
         case 0x1F801070:
             iop_intc.write_istat(value);
@@ -1738,7 +1890,7 @@ void Emulator::iop_write32(uint32_t address, uint32_t value)
     }
     if (address == 0xFFFE0144)
     {
-        printf("[IOP] Scratchpad start: $%08X\n", value);
+        TRACE_DEBUG(Trace::IOP, "[IOP] Scratchpad start: $%08X\n", value);
         iop_scratchpad_start = value;
         return;
     }
@@ -1756,7 +1908,7 @@ void Emulator::iop_ksprintf()
     uint32_t arg_pointer = iop.get_gpr(7);
 
     uint32_t width;
-    printf("[IOP Debug] ksprintf: %s\n", (char*)&IOP_RAM[msg_pointer]);
+    TRACE_INFO(Trace::IOP, "[IOP Debug] ksprintf: %s\n", (char*)&IOP_RAM[msg_pointer]);
     while (IOP_RAM[msg_pointer])
     {
         char c = IOP_RAM[msg_pointer];
@@ -1781,12 +1933,12 @@ void Emulator::iop_ksprintf()
                     break;
                 case 'd':
                     ee_log << *(int32_t*)&IOP_RAM[arg_pointer];
-                    printf("[IOP Debug] %d\n", *(uint32_t*)&IOP_RAM[arg_pointer]);
+                    TRACE_INFO(Trace::IOP, "[IOP Debug] %d\n", *(uint32_t*)&IOP_RAM[arg_pointer]);
                     break;
                 case 'x':
                 case 'X':
                     ee_log << std::hex << *(uint32_t*)&IOP_RAM[arg_pointer];
-                    printf("[IOP Debug] $%08X\n", *(uint32_t*)&IOP_RAM[arg_pointer]);
+                    TRACE_INFO(Trace::IOP, "[IOP Debug] $%08X\n", *(uint32_t*)&IOP_RAM[arg_pointer]);
                     break;
                 default:
                     break;
@@ -1807,19 +1959,19 @@ void Emulator::iop_puts()
     //printf("[IOP] ($%08X, $%08X) puts: ", pointer, len);
     /*for (int i = 4; i < 8; i++)
     {
-        printf("$%08X", iop.get_gpr(i));
+        TRACE_INFO(Trace::IOP, "$%08X", iop.get_gpr(i));
     }*/
 
     //Little sanity check to prevent crashing the emulator
     if (len >= 2048)
     {
-        printf("[IOP] puts len over 2048!\n");
+        TRACE_WARN(Trace::IOP, "[IOP] puts len over 2048!\n");
         len = 2048;
     }
     while (len)
     {
         ee_log << IOP_RAM[pointer & 0x1FFFFF];
-        printf("puts: %c\n", IOP_RAM[pointer & 0x1FFFFF]);
+        TRACE_INFO(Trace::IOP, "puts: %c\n", IOP_RAM[pointer & 0x1FFFFF]);
         pointer++;
         len--;
     }
@@ -1837,6 +1989,28 @@ void Emulator::set_wav_output(bool state)
     spu2.wav_output = state;
 }
 
+void Emulator::set_audio_sink(AudioSink* sink)
+{
+    if (audio_sink)
+        audio_sink->close();
+
+    //The sink's thread is closed and deactivating waits out the SPU's push, so neither side of the ring is running
+    audio_stream.set_active(false);
+    audio_stream.reset();
+    audio_sink = sink;
+
+    if (audio_sink)
+    {
+        audio_stream.set_active(true);
+        audio_sink->open(&audio_stream);
+    }
+}
+
+AudioStream& Emulator::get_audio_stream()
+{
+    return audio_stream;
+}
+
 void Emulator::request_gsdump_toggle()
 {
     gsdump_requested = true;
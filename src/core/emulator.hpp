@@ -20,9 +20,13 @@
 #include "iop/memcard.hpp"
 #include "iop/sio2.hpp"
 #include "iop/spu/spu.hpp"
+#include "audio/audiosink.hpp"
+#include "audio/audiostream.hpp"
 #include "iop/firewire.hpp"
 
 #include "int128.hpp"
+#include "framepacer.hpp"
+#include "guestprofiler.hpp"
 #include "gs.hpp"
 #include "gif.hpp"
 #include "sif.hpp"
@@ -46,6 +50,7 @@ class Emulator
 {
     private:
         std::atomic_bool save_requested, load_requested, gsdump_requested, gsdump_single_frame, gsdump_running;
+        Trace::GuestClock trace_clock;
         std::string save_state_path;
         int frames;
         Cop0 cp0;
@@ -67,12 +72,19 @@ class Emulator
         Scheduler scheduler;
         SIO2 sio2;
         SPU spu, spu2;
+        SPU_SharedRegs spu_shared;
+        AudioStream audio_stream;
+        AudioSink* audio_sink;
         SubsystemInterface sif;
         VectorInterface vif0, vif1;
         VectorUnit vu0, vu1;
 
         int vblank_start_id, vblank_end_id, spu_event_id, hblank_event_id, gs_vblank_event_id;
 
+        int64_t next_sound_sample, sound_event_time;
+        uint64_t sound_event_id;
+        bool syncing_sound;
+
         bool VBLANK_sent;
         bool cop2_interlock, vu_interlock;
 
@@ -103,7 +115,15 @@ class Emulator
 
         void iop_IRQ_check(uint32_t new_stat, uint32_t new_mask);
         void start_sound_sample_event();
-
+        void update_sound_batch();
+        void sync_sound(int64_t time);
+        void catch_up_sound();
+        bool devices_idle();
+        void sample_profiler();
+
+        FramePacer pacer;
+        GuestProfiler profiler;
+        bool frame_skipped;
         bool frame_ended;
     public:
         Emulator();
@@ -127,6 +147,13 @@ class Emulator
         std::string get_serial();
         void execute_ELF();
         uint32_t* get_framebuffer();
+        void set_frame_queue_depth(int depth);
+        void set_frame_limit(bool limited);
+        void set_max_frameskip(int frames);
+        FramePacerStats get_frame_stats();
+        void start_profiler(int interval_us);
+        void stop_profiler();
+        bool write_profile(const char* path);
         void get_resolution(int& w, int& h);
         void get_inner_resolution(int& w, int& h);
 
@@ -174,9 +201,19 @@ class Emulator
         void iop_puts();
 
         void test_iop();
+        void test_ee_mmi();
+        void test_ee_loop();
+        void test_gs_sprite();
+        void test_ipu_convert();
+        void test_jit_profiler();
+        void test_vu_flag_liveness();
         GraphicsSynthesizer& get_gs();//used for gs dumps
 
         void set_wav_output(bool state);
+
+        //The sink is owned by the caller and must outlive its use here, or be replaced with nullptr
+        void set_audio_sink(AudioSink* sink);
+        AudioStream& get_audio_stream();
 };
 
 #endif // EMULATOR_HPP
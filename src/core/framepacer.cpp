@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <thread>
+#include "framepacer.hpp"
+
+static double to_ms(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+FramePacer::FramePacer() : target_fps(60.0), speed_factor(1.0), throttled(true), max_frameskip(0)
+{
+    reset();
+}
+
+void FramePacer::reset()
+{
+    started = false;
+    skipping = false;
+    skipped_in_row = 0;
+    avg_frame_ms = 0.0;
+    stats = {};
+}
+
+void FramePacer::set_target_fps(double fps)
+{
+    target_fps = fps;
+}
+
+void FramePacer::set_speed_factor(double factor)
+{
+    speed_factor = factor;
+}
+
+void FramePacer::set_throttled(bool throttled)
+{
+    this->throttled = throttled;
+}
+
+void FramePacer::set_max_frameskip(int frames)
+{
+    max_frameskip = std::max(frames, 0);
+}
+
+double FramePacer::get_frame_budget_ms() const
+{
+    return 1000.0 / (target_fps * speed_factor);
+}
+
+void FramePacer::throttle()
+{
+    auto period = std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double, std::milli>(get_frame_budget_ms()));
+    deadline += period;
+
+    //Running late by less than a frame is made up over the next frames. Any later than that and
+    //we start again from now rather than racing to catch up.
+    auto now = clock::now();
+    if (now > deadline + period)
+    {
+        deadline = now;
+        return;
+    }
+
+    //Sleeps can overshoot by a millisecond or so, so the end of the wait is spent yielding
+    const auto spin_time = std::chrono::milliseconds(1);
+    if (deadline - now > spin_time)
+        std::this_thread::sleep_for(deadline - now - spin_time);
+    while (clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+bool FramePacer::begin_frame()
+{
+    auto now = clock::now();
+    if (started)
+    {
+        //Everything since the last frame started: emulation, waiting on the GS and presenting
+        stats.frame_ms = to_ms(now - frame_start);
+        avg_frame_ms += (stats.frame_ms - avg_frame_ms) * 0.25;
+
+        if (throttled)
+            throttle();
+
+        now = clock::now();
+        stats.fps = 1000.0 / std::max(to_ms(now - frame_start), 0.001);
+        stats.frames++;
+    }
+    else
+    {
+        deadline = now;
+        started = true;
+    }
+    frame_start = now;
+
+    bool over_budget = avg_frame_ms > get_frame_budget_ms();
+    skipping = throttled && over_budget && skipped_in_row < max_frameskip;
+    if (skipping)
+    {
+        skipped_in_row++;
+        stats.skipped_frames++;
+    }
+    else
+        skipped_in_row = 0;
+    return skipping;
+}
+
+void FramePacer::end_emulation()
+{
+    stats.emu_ms = to_ms(clock::now() - frame_start);
+}
+
+void FramePacer::set_gs_time(uint32_t us)
+{
+    stats.gs_ms = us / 1000.0;
+}
+
+FramePacerStats FramePacer::get_stats() const
+{
+    return stats;
+}
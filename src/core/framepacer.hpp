@@ -0,0 +1,73 @@
+#ifndef FRAMEPACER_HPP
+#define FRAMEPACER_HPP
+#include <chrono>
+#include <cstdint>
+
+struct FramePacerStats
+{
+    double fps; //Of the last frame, as seen by the host
+    double frame_ms; //Host time spent on the last frame, not counting throttling
+    double emu_ms; //Time spent emulating the last frame, not counting waits on the GS
+    double gs_ms; //Time the GS thread was busy with the last frame it finished
+    uint64_t frames;
+    uint64_t skipped_frames;
+};
+
+/**
+Paces emulation to the speed of the emulated display. Emulator::run calls begin_frame before
+each frame, which throttles to the frame's deadline and decides whether the GS should skip
+drawing it. Frames are only skipped while the host can't keep up, and never more than
+max_frameskip in a row. A skipped frame still runs every GS register write and transfer,
+only the primitives aren't rasterized and it isn't scanned out.
+
+Everything here runs on the emulator thread.
+**/
+
+class FramePacer
+{
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        double target_fps;
+        double speed_factor;
+        bool throttled;
+        int max_frameskip;
+
+        clock::time_point frame_start, deadline;
+        bool started;
+
+        bool skipping;
+        int skipped_in_row;
+
+        //Smoothed so one slow frame doesn't start a run of skips
+        double avg_frame_ms;
+
+        FramePacerStats stats;
+
+        double get_frame_budget_ms() const;
+        void throttle();
+    public:
+        FramePacer();
+
+        void reset();
+
+        void set_target_fps(double fps);
+
+        //Scales the target, e.g. to keep emulation in step with the audio clock
+        void set_speed_factor(double factor);
+
+        //Unthrottled runs as fast as the host allows, for benchmarking
+        void set_throttled(bool throttled);
+
+        //0 disables frame skipping
+        void set_max_frameskip(int frames);
+
+        //Returns true if the frame that is starting should not be drawn
+        bool begin_frame();
+        void end_emulation();
+        void set_gs_time(uint32_t us);
+
+        FramePacerStats get_stats() const;
+};
+
+#endif // FRAMEPACER_HPP
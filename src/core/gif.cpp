@@ -314,6 +314,12 @@ void GraphicsInterface::run(int cycles)
     }
 }
 
+//run only drains the PATH3 FIFO, and releases PATH3 once it is masked
+bool GraphicsInterface::is_idle()
+{
+    return fifo_empty() && path3_done();
+}
+
 bool GraphicsInterface::set_path3_vifmask(int value)
 {
     //printf("GIF PATH3Mask VIF set to %d\n", value);
@@ -60,6 +60,7 @@ class GraphicsInterface
         GraphicsInterface(GraphicsSynthesizer* gs, DMAC* dmac);
         void reset();
         void run(int cycles);
+        bool is_idle();
 
         bool fifo_full();
         bool fifo_empty();
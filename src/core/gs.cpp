@@ -13,39 +13,47 @@ in/out of the GS, mostly with the GIF but also with the privileged
 registers.
 **/
 
-GraphicsSynthesizer::GraphicsSynthesizer(INTC* intc) 
-    : intc(intc), frame_complete(false),
-    output_buffer1(nullptr), output_buffer2(nullptr)
+GraphicsSynthesizer::GraphicsSynthesizer(INTC* intc, const Trace::GuestClock* trace_clock)
+    : intc(intc), frame_complete(false), gs_download_buffer(nullptr), queue_depth(2),
+    frames_queued(0), frames_completed(0), presented_slot(-1), gs_thread(trace_clock)
 {
+    for (int i = 0; i <= MAX_FRAME_QUEUE_DEPTH; i++)
+        frame_slots[i].buffer = nullptr;
 }
 
 GraphicsSynthesizer::~GraphicsSynthesizer()
 {
+    current_lock = std::unique_lock<std::mutex>();
     gs_thread.exit();
 
-    delete[] output_buffer1;
-    delete[] output_buffer2;
+    for (int i = 0; i <= MAX_FRAME_QUEUE_DEPTH; i++)
+        delete[] frame_slots[i].buffer;
     delete[] gs_download_buffer;
 }
 
 void GraphicsSynthesizer::reset()
 {
+    current_lock = std::unique_lock<std::mutex>();
     gs_thread.reset();
 
-    if (!output_buffer1)
-        output_buffer1 = new uint32_t[1920 * 1280];
-
-    if (!output_buffer2)
-        output_buffer2 = new uint32_t[1920 * 1280];
+    for (int i = 0; i <= MAX_FRAME_QUEUE_DEPTH; i++)
+    {
+        if (!frame_slots[i].buffer)
+            frame_slots[i].buffer = new uint32_t[1920 * 1280];
+    }
 
     if (!gs_download_buffer)
         gs_download_buffer = new uint128_t[(2048 * 2048) / 4];
 
-    gs_download_qwc = 0;
     gs_download_addr = 0;
-
-    current_lock = std::unique_lock<std::mutex>();
-    using_first_buffer = true;
+    download_fence.quads_written = 0;
+    download_fence.complete = true;
+
+    frames_queued = 0;
+    frames_completed = 0;
+    presented_slot = -1;
+    skipping_draws = false;
+    last_frame_busy_us = 0;
     frame_count = 0;
     set_CRT(false, 0x2, false);
     reg.reset(false);
@@ -71,35 +79,101 @@ void GraphicsSynthesizer::set_CRT(bool interlaced, uint8_t mode, bool frame_mode
     gs_thread.send_message({ GSCommand::set_crt_t, payload });
 }
 
-uint32_t* GraphicsSynthesizer::get_framebuffer()
+//Overrides the deinterlacing picked from SMODE2 when forced is set
+void GraphicsSynthesizer::set_deinterlace_method(DeinterlaceMethod method, bool forced)
 {
-    uint32_t* out;
-    GSReturnMessage data;
+    GSMessagePayload payload;
+    payload.deinterlace_payload = { method, forced };
+
+    gs_thread.send_message({ GSCommand::set_deinterlace_t, payload });
+}
+
+int GraphicsSynthesizer::get_slot_count() const
+{
+    return queue_depth + 1;
+}
 
+//A depth of 1 presents every frame as soon as it's rendered, which is the old lockstep behaviour.
+//Each step past that lets the EE run one more frame ahead of the GS at the cost of a frame of latency.
+void GraphicsSynthesizer::set_frame_queue_depth(int depth)
+{
+    //Slots are assigned modulo the slot count, so nothing may be in flight when it changes
+    finish_frames();
+    queue_depth = std::max(1, std::min(depth, (int)MAX_FRAME_QUEUE_DEPTH));
+    frames_queued = 0;
+    frames_completed = 0;
+}
+
+void GraphicsSynthesizer::wait_for_oldest_frame()
+{
+    GSReturnMessage data;
     gs_thread.wait_for_return(GSReturn::render_complete_t, data);
-    
-    if (using_first_buffer)
-    {
-        while (!output_buffer1_mutex.try_lock())
-        {
-            printf("[GS] buffer 1 lock failed!\n");
-            std::this_thread::yield();
-        }
-        current_lock = std::unique_lock<std::mutex>(output_buffer1_mutex, std::adopt_lock);
-        out = output_buffer1;
-    }
-    else
-    {
-        while (!output_buffer2_mutex.try_lock())
-        {
-            printf("[GS] buffer 2 lock failed!\n");
-            std::this_thread::yield();
-        }
-        current_lock = std::unique_lock<std::mutex>(output_buffer2_mutex, std::adopt_lock);
-        out = output_buffer2;
-    }
-    using_first_buffer = !using_first_buffer;
-    return out;
+    last_frame_busy_us = data.payload.frame_payload.busy_us;
+    frames_completed++;
+}
+
+//Register writes and transfers are still processed while skipping, only rasterization is dropped
+void GraphicsSynthesizer::set_skip_draws(bool skip)
+{
+    if (skip == skipping_draws)
+        return;
+
+    skipping_draws = skip;
+    GSMessagePayload payload;
+    payload.skip_draws_payload = { skip };
+    gs_thread.send_message({ GSCommand::set_skip_draws_t, payload });
+}
+
+//Disabling the row-at-a-time sprite path draws every sprite a pixel at a time
+void GraphicsSynthesizer::set_sprite_spans(bool enabled)
+{
+    GSMessagePayload payload;
+    payload.sprite_spans_payload = { enabled };
+    gs_thread.send_message({ GSCommand::set_sprite_spans_t, payload });
+}
+
+//How long the GS thread spent on the last frame to come back from it
+uint32_t GraphicsSynthesizer::get_last_frame_busy_us() const
+{
+    return last_frame_busy_us;
+}
+
+uint64_t GraphicsSynthesizer::get_last_draw_state() const
+{
+    return gs_thread.get_last_draw_state();
+}
+
+void GraphicsSynthesizer::present(int slot)
+{
+    if (slot == presented_slot && current_lock.owns_lock())
+        return;
+
+    current_lock = std::unique_lock<std::mutex>();
+
+    //Scanout holds the slot until it has finished writing it
+    while (!frame_slots[slot].mutex.try_lock())
+        std::this_thread::yield();
+    current_lock = std::unique_lock<std::mutex>(frame_slots[slot].mutex, std::adopt_lock);
+    presented_slot = slot;
+}
+
+uint32_t* GraphicsSynthesizer::get_framebuffer()
+{
+    while (frames_queued - frames_completed >= (uint64_t)queue_depth)
+        wait_for_oldest_frame();
+
+    if (!frames_completed)
+        return nullptr;
+
+    present((frames_completed - 1) % get_slot_count());
+    return frame_slots[presented_slot].buffer;
+}
+
+//Fence for anything that needs the GS thread to have caught up with the EE, such as save states
+void GraphicsSynthesizer::finish_frames()
+{
+    while (frames_queued > frames_completed)
+        wait_for_oldest_frame();
 }
 
 void GraphicsSynthesizer::set_CSR_FIFO(uint8_t value)
@@ -168,12 +242,23 @@ void GraphicsSynthesizer::assert_FINISH()
 
 void GraphicsSynthesizer::render_CRT()
 {
-    GSMessagePayload payload;
+    //Only block when the queue is full, e.g. when frames are being queued faster than they're presented
+    while (frames_queued - frames_completed >= (uint64_t)queue_depth)
+        wait_for_oldest_frame();
 
-    if (using_first_buffer)
-        payload.render_payload = { output_buffer1, &output_buffer1_mutex };
-    else
-        payload.render_payload = { output_buffer2, &output_buffer2_mutex };
+    int slot = frames_queued % get_slot_count();
+
+    //Frames that were never presented can push the queue round onto the displayed slot
+    if (slot == presented_slot)
+        current_lock = std::unique_lock<std::mutex>();
+
+    GSFrameSlot& frame = frame_slots[slot];
+    reg.get_inner_resolution(frame.inner_w, frame.inner_h);
+    reg.get_resolution(frame.final_w, frame.final_h);
+    frames_queued++;
+
+    GSMessagePayload payload;
+    payload.render_payload = { frame.buffer, &frame.mutex };
 
     gs_thread.send_message({ GSCommand::render_crt_t, payload });
     gs_thread.wake_thread();
@@ -181,12 +266,14 @@ void GraphicsSynthesizer::render_CRT()
 
 uint32_t* GraphicsSynthesizer::render_partial_frame(uint16_t& width, uint16_t& height)
 {
-    GSMessagePayload payload;
+    finish_frames();
 
-    if (using_first_buffer)
-        payload.render_payload = { output_buffer1, &output_buffer1_mutex };
-    else
-        payload.render_payload = { output_buffer2, &output_buffer2_mutex };
+    //Any slot other than the displayed one is free once the queue has drained
+    int slot = (presented_slot + 1) % get_slot_count();
+    current_lock = std::unique_lock<std::mutex>();
+
+    GSMessagePayload payload;
+    payload.render_payload = { frame_slots[slot].buffer, &frame_slots[slot].mutex };
     
     gs_thread.send_message({ GSCommand::memdump_t,payload });
     gs_thread.wake_thread();
@@ -196,28 +283,31 @@ uint32_t* GraphicsSynthesizer::render_partial_frame(uint16_t& width, uint16_t& h
     width = data.payload.xy_payload.x;
     height = data.payload.xy_payload.y;
 
-    if (using_first_buffer)
-    {
-        using_first_buffer = false;
-        current_lock = std::unique_lock<std::mutex>(output_buffer1_mutex);
-        return output_buffer1;
-    }
-    else
-    {
-        using_first_buffer = true;
-        current_lock = std::unique_lock<std::mutex>(output_buffer2_mutex);
-        return output_buffer2;
-    }
+    present(slot);
+    return frame_slots[slot].buffer;
 }
 
+//Resolutions are those of the frame last returned by get_framebuffer, which may be behind the registers
 void GraphicsSynthesizer::get_resolution(int &w, int &h)
 {
-    reg.get_resolution(w, h);
+    if (presented_slot < 0)
+        reg.get_resolution(w, h);
+    else
+    {
+        w = frame_slots[presented_slot].final_w;
+        h = frame_slots[presented_slot].final_h;
+    }
 }
 
 void GraphicsSynthesizer::get_inner_resolution(int &w, int &h)
 {
-    reg.get_inner_resolution(w, h);
+    if (presented_slot < 0)
+        reg.get_inner_resolution(w, h);
+    else
+    {
+        w = frame_slots[presented_slot].inner_w;
+        h = frame_slots[presented_slot].inner_h;
+    }
 }
 
 void GraphicsSynthesizer::write64(uint32_t addr, uint64_t value)
@@ -341,6 +431,8 @@ void GraphicsSynthesizer::set_XYZF(uint32_t x, uint32_t y, uint32_t z, uint8_t f
 
 void GraphicsSynthesizer::load_state(std::ifstream &state)
 {
+    finish_frames();
+
     GSMessagePayload payload;
     payload.load_state_payload = {&state};
     gs_thread.send_message({ GSCommand::load_state_t, payload });
@@ -353,6 +445,8 @@ void GraphicsSynthesizer::load_state(std::ifstream &state)
 
 void GraphicsSynthesizer::save_state(std::ofstream &state)
 {
+    finish_frames();
+
     GSMessagePayload payload;
     payload.save_state_payload = {&state};
 
@@ -386,23 +480,23 @@ void GraphicsSynthesizer::wake_gs_thread()
 void GraphicsSynthesizer::request_gs_download()
 {
     GSMessagePayload payload;
-    GSReturnMessage return_packet;
 
-    payload.download_payload = { gs_download_buffer, &download_mutex };
+    //The previous download may still be streaming into the buffer, so it must finish before we reuse it
+    wait_for_download();
+
+    gs_download_addr = 0;
+    download_fence.quads_written.store(0, std::memory_order_relaxed);
+    download_fence.complete.store(false, std::memory_order_release);
+
+    payload.download_payload = { gs_download_buffer, &download_fence };
     gs_thread.send_message({ GSCommand::request_local_host_tx, payload });
     gs_thread.wake_thread();
+}
 
-    gs_thread.wait_for_return(GSReturn::local_host_transfer, return_packet);
-
-    while (!download_mutex.try_lock())
-    {
-        printf("[GS] buffer 1 lock failed!\n");
+void GraphicsSynthesizer::wait_for_download()
+{
+    while (!download_fence.complete.load(std::memory_order_acquire))
         std::this_thread::yield();
-    }
-    std::lock_guard<std::mutex> lock(download_mutex, std::adopt_lock);
-
-    gs_download_addr = 0;
-    gs_download_qwc = return_packet.payload.download_payload.quad_count;
 }
 
 std::tuple<uint128_t, bool>GraphicsSynthesizer::read_gs_download()
@@ -410,14 +504,24 @@ std::tuple<uint128_t, bool>GraphicsSynthesizer::read_gs_download()
     bool have_data;
     uint128_t quad_data;
 
-    if (gs_download_qwc)
+    //Only stall the EE when the DMAC has caught up with what the GS thread has produced so far
+    uint32_t quads_written = download_fence.quads_written.load(std::memory_order_acquire);
+    while (gs_download_addr >= quads_written && !download_fence.complete.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+        quads_written = download_fence.quads_written.load(std::memory_order_acquire);
+    }
+
+    //The transfer may have completed between the two loads above
+    quads_written = download_fence.quads_written.load(std::memory_order_acquire);
+
+    if (gs_download_addr < quads_written)
     {
         quad_data._u64[0] = gs_download_buffer[gs_download_addr]._u64[0];
         quad_data._u64[1] = gs_download_buffer[gs_download_addr]._u64[1];
         have_data = true;
 
         gs_download_addr++;
-        gs_download_qwc--;
     }
     else
     {
@@ -427,4 +531,3 @@ std::tuple<uint128_t, bool>GraphicsSynthesizer::read_gs_download()
     }
     return std::make_tuple(quad_data, have_data);
 }
-
@@ -8,32 +8,60 @@
 
 class INTC;
 
+//One finished frame on its way out of the GS thread
+struct GSFrameSlot
+{
+    uint32_t* buffer;
+    std::mutex mutex;
+    int inner_w, inner_h;
+    int final_w, final_h;
+};
+
 class GraphicsSynthesizer
 {
+    public:
+        constexpr static int MAX_FRAME_QUEUE_DEPTH = 3;
     private:
         INTC* intc;
         bool frame_complete;
         int frame_count;
-        uint32_t* output_buffer1;
-        uint32_t* output_buffer2;//double buffered to prevent mutex lock
         uint128_t* gs_download_buffer;
-        uint32_t gs_download_qwc;
         uint32_t gs_download_addr;
-        std::mutex output_buffer1_mutex, output_buffer2_mutex, download_mutex;
-        bool using_first_buffer;
+        GSDownloadFence download_fence;
+
+        //Frames are queued to the GS thread at VBLANK and only presented once up to queue_depth newer
+        //frames are behind them, so the EE can run ahead while the GS finishes the previous frames.
+        //One extra slot holds the frame being displayed.
+        GSFrameSlot frame_slots[MAX_FRAME_QUEUE_DEPTH + 1];
+        int queue_depth;
+        uint64_t frames_queued, frames_completed;
+        int presented_slot;
         std::unique_lock<std::mutex> current_lock;
 
+        bool skipping_draws;
+        uint32_t last_frame_busy_us;
+
+        int get_slot_count() const;
+        void wait_for_oldest_frame();
+        void present(int slot);
+
         GS_REGISTERS reg;
 
         GraphicsSynthesizerThread gs_thread;
     public:
-        GraphicsSynthesizer(INTC* intc);
+        GraphicsSynthesizer(INTC* intc, const Trace::GuestClock* trace_clock);
         ~GraphicsSynthesizer();
 
         void reset();
         void start_frame();
         bool is_frame_complete() const;
+        void set_frame_queue_depth(int depth);
         uint32_t* get_framebuffer();
+        void finish_frames();
+        void set_skip_draws(bool skip);
+        void set_sprite_spans(bool enabled);
+        uint32_t get_last_frame_busy_us() const;
+        uint64_t get_last_draw_state() const;
         void render_CRT();
         uint32_t* render_partial_frame(uint16_t& width, uint16_t& height);
         void get_resolution(int& w, int& h);
@@ -49,6 +77,7 @@ class GraphicsSynthesizer
         void assert_VSYNC();
 
         void set_CRT(bool interlaced, uint8_t mode, bool frame_mode);
+        void set_deinterlace_method(DeinterlaceMethod method, bool forced);
 
         uint32_t get_busdir();
         uint32_t read32_privileged(uint32_t addr);
@@ -71,6 +100,7 @@ class GraphicsSynthesizer
         void wake_gs_thread();
 
         void request_gs_download();
+        void wait_for_download();
         std::tuple<uint128_t, bool>read_gs_download();
 };
 #endif // GS_HPP
@@ -1,8 +1,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include "gscontext.hpp"
-
-#define printf(fmt, ...)(0)
+#include "trace.hpp"
 
 void GSContext::reset()
 {
@@ -44,17 +43,17 @@ void GSContext::set_tex0(uint64_t value)
         tex0.CLUT_offset = ((value >> 56) & 0x1F) * 16 * 2;
     tex0.CLUT_control = (uint8_t)((value >> 61) & 0x7);
 
-    printf("TEX0: $%08X_%08X\n", value >> 32, value & 0xFFFFFFFF);
-    printf("Tex base: $%08X\n", tex0.texture_base);
-    printf("Buffer width: %d\n", tex0.width);
-    printf("Tex format: $%02X\n", tex0.format);
-    printf("Tex width: %d Height: %d\n", tex0.tex_width, tex0.tex_height);
-    printf("Use alpha: %d\n", tex0.use_alpha);
-    printf("Color function: $%02X\n", tex0.color_function);
-    printf("CLUT base: $%08X\n", tex0.CLUT_base);
-    printf("CLUT format: $%02X\n", tex0.CLUT_format);
-    printf("Use CSM2: %d\n", tex0.use_CSM2);
-    printf("CLUT offset: $%08X\n", tex0.CLUT_offset);
+    TRACE_DEBUG(Trace::GS, "TEX0: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
+    TRACE_DEBUG(Trace::GS, "Tex base: $%08X\n", tex0.texture_base);
+    TRACE_DEBUG(Trace::GS, "Buffer width: %d\n", tex0.width);
+    TRACE_DEBUG(Trace::GS, "Tex format: $%02X\n", tex0.format);
+    TRACE_DEBUG(Trace::GS, "Tex width: %d Height: %d\n", tex0.tex_width, tex0.tex_height);
+    TRACE_DEBUG(Trace::GS, "Use alpha: %d\n", tex0.use_alpha);
+    TRACE_DEBUG(Trace::GS, "Color function: $%02X\n", tex0.color_function);
+    TRACE_DEBUG(Trace::GS, "CLUT base: $%08X\n", tex0.CLUT_base);
+    TRACE_DEBUG(Trace::GS, "CLUT format: $%02X\n", tex0.CLUT_format);
+    TRACE_DEBUG(Trace::GS, "Use CSM2: %d\n", tex0.use_CSM2);
+    TRACE_DEBUG(Trace::GS, "CLUT offset: $%08X\n", tex0.CLUT_offset);
 }
 
 void GSContext::set_tex1(uint64_t value)
@@ -83,11 +82,11 @@ void GSContext::set_tex2(uint64_t value)
         tex0.CLUT_offset = ((value >> 56) & 0x1F) * 16 * 2;
     tex0.CLUT_control = (uint8_t)((value >> 61) & 0x7);
 
-    printf("TEX2: $%08X_%08X\n", value >> 32, value);
-    printf("CLUT base: $%08X\n", tex0.CLUT_base);
-    printf("CLUT format: $%02X\n", tex0.CLUT_format);
-    printf("Use CSM2: %d\n", tex0.use_CSM2);
-    printf("CLUT offset: $%08X\n", tex0.CLUT_offset);
+    TRACE_DEBUG(Trace::GS, "TEX2: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
+    TRACE_DEBUG(Trace::GS, "CLUT base: $%08X\n", tex0.CLUT_base);
+    TRACE_DEBUG(Trace::GS, "CLUT format: $%02X\n", tex0.CLUT_format);
+    TRACE_DEBUG(Trace::GS, "Use CSM2: %d\n", tex0.use_CSM2);
+    TRACE_DEBUG(Trace::GS, "CLUT offset: $%08X\n", tex0.CLUT_offset);
 }
 
 void GSContext::set_clamp(uint64_t value)
@@ -98,14 +97,14 @@ void GSContext::set_clamp(uint64_t value)
     clamp.max_u = (value >> 14) & 0x3FF;
     clamp.min_v = (value >> 24) & 0x3FF;
     clamp.max_v = (value >> 34) & 0x3FF;
-    printf("CLAMP: $%08X_%08X\n", value >> 32, value);
+    TRACE_DEBUG(Trace::GS, "CLAMP: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
 }
 
 void GSContext::set_xyoffset(uint64_t value)
 {
     xyoffset.x = value & 0xFFFF;
     xyoffset.y = (value >> 32) & 0xFFFF;
-    printf("XYOFFSET: $%08X_%08X\n", value >> 32, value & 0xFFFFFFFF);
+    TRACE_DEBUG(Trace::GS, "XYOFFSET: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
 }
 
 void GSContext::set_miptbl1(uint64_t value)
@@ -137,8 +136,8 @@ void GSContext::set_scissor(uint64_t value)
     scissor.x2 = ((value >> 16) & 0x7FF) << 4;
     scissor.y1 = ((value >> 32) & 0x7FF) << 4;
     scissor.y2 = ((value >> 48) & 0x7FF) << 4;
-    printf("SCISSOR: $%08X_%08X\n", value >> 32, value & 0xFFFFFFFF);
-    printf("Coords: (%d, %d), (%d, %d)\n", scissor.x1, scissor.y1, scissor.x2, scissor.y2);
+    TRACE_DEBUG(Trace::GS, "SCISSOR: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
+    TRACE_DEBUG(Trace::GS, "Coords: (%d, %d), (%d, %d)\n", scissor.x1, scissor.y1, scissor.x2, scissor.y2);
 }
 
 void GSContext::set_alpha(uint64_t value)
@@ -148,7 +147,7 @@ void GSContext::set_alpha(uint64_t value)
     alpha.spec_C = (value >> 4) & 0x3;
     alpha.spec_D = (value >> 6) & 0x3;
     alpha.fixed_alpha = (value >> 32) & 0xFF;
-    printf("ALPHA: $%08X_%08X\n", value >> 32, value & 0xFFFFFFFF);
+    TRACE_DEBUG(Trace::GS, "ALPHA: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
 }
 
 void GSContext::set_test(uint64_t value)
@@ -161,7 +160,7 @@ void GSContext::set_test(uint64_t value)
     test.dest_alpha_method = value & (1 << 15);
     test.depth_test = value & (1 << 16);
     test.depth_method = (value >> 17) & 0x3;
-    printf("TEST: $%08X\n", value & 0xFFFFFFFF);
+    TRACE_DEBUG(Trace::GS, "TEST: $%08X\n", (uint32_t)value);
 }
 
 void GSContext::set_frame(uint64_t value)
@@ -170,9 +169,9 @@ void GSContext::set_frame(uint64_t value)
     frame.width = ((value >> 16) & 0x3F) * 64;
     frame.format = (value >> 24) & 0x3F;
     frame.mask = (uint32_t)(value >> 32);
-    printf("FRAME: $%08X_%08X\n", value >> 32, value & 0xFFFFFFFF);
-    printf("Width: %d\n", frame.width);
-    printf("Format: %d\n", frame.format);
+    TRACE_DEBUG(Trace::GS, "FRAME: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
+    TRACE_DEBUG(Trace::GS, "Width: %d\n", frame.width);
+    TRACE_DEBUG(Trace::GS, "Format: %d\n", frame.format);
 
     // confirmed by hw test
     // in the event that a z format is specified for FRAME
@@ -192,9 +191,9 @@ void GSContext::set_zbuf(uint64_t value)
     zbuf.base_pointer = (value & 0x1FF) * 2048 * 4;
     zbuf.format = ((value >> 24) & 0xF) | 0x30;
     zbuf.no_update = (value >> 32) & 0x1;
-    printf("ZBUF: $%08X_%08X\n", value >> 32, value & 0xFFFFFFFF);
-    printf("Base pointer: $%08X\n", zbuf.base_pointer);
-    printf("Format: $%02X\n", zbuf.format);
+    TRACE_DEBUG(Trace::GS, "ZBUF: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
+    TRACE_DEBUG(Trace::GS, "Base pointer: $%08X\n", zbuf.base_pointer);
+    TRACE_DEBUG(Trace::GS, "Format: $%02X\n", zbuf.format);
 
     // confirmed by hw test
     // in the event that a z format is specified for FRAME
@@ -0,0 +1,522 @@
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+#include "gsscanout.hpp"
+#include "gsthread.hpp"
+#include "errors.hpp"
+
+using namespace std;
+
+GSScanout::GSScanout()
+    : pending(false), started(false), busy(false), quit(false), target(nullptr), target_mutex(nullptr),
+      forced_deinterlace(BOB_DEINTERLACE), deinterlace_forced(false)
+{
+    memset(&reg, 0, sizeof(reg));
+}
+
+GSScanout::~GSScanout()
+{
+    exit();
+}
+
+void GSScanout::reset()
+{
+    exit();
+
+    if (!mem)
+        mem = std::unique_ptr<uint8_t[]>(new uint8_t[1024 * 1024 * 4]);
+    if (!screen_buffer)
+        screen_buffer = std::unique_ptr<uint32_t[]>(new uint32_t[2048 * 2048]);
+
+    memset(screen_buffer.get(), 0, sizeof(uint32_t) * 2048 * 2048);
+
+    pending = false;
+    started = false;
+    busy = false;
+    quit = false;
+    thread = std::thread(&GSScanout::worker_loop, this);
+}
+
+void GSScanout::exit()
+{
+    if (thread.joinable())
+    {
+        {
+            std::unique_lock<std::mutex> lk(state_mutex);
+            quit = true;
+        }
+        notifier.notify_all();
+        thread.join();
+    }
+}
+
+void GSScanout::set_deinterlace_method(DeinterlaceMethod method, bool forced)
+{
+    wait_for_idle();
+    forced_deinterlace = method;
+    deinterlace_forced = forced;
+}
+
+void GSScanout::wait_for_idle()
+{
+    std::unique_lock<std::mutex> lk(state_mutex);
+    notifier.wait(lk, [this] { return !busy; });
+}
+
+void GSScanout::submit(const uint8_t* local_mem, const GS_REGISTERS& regs, uint32_t* target, std::mutex* target_mutex)
+{
+    //Only one frame can be in flight as the snapshot is reused
+    wait_for_idle();
+
+    //Errors thrown on the scanout thread can't reach the emulator, so catch bad formats while we're still on the GS thread
+    const DISPFB* fbs[2] = { &regs.DISPFB1, &regs.DISPFB2 };
+    const bool enabled[2] = { regs.PMODE.circuit1, regs.PMODE.circuit2 };
+    for (int i = 0; i < 2; i++)
+    {
+        if (!enabled[i])
+            continue;
+
+        switch (fbs[i]->format)
+        {
+            case 0x0:
+            case 0x1:
+            case 0x2:
+            case 0xA:
+                break;
+            default:
+                Errors::die("Unknown framebuffer format (%x)", fbs[i]->format);
+        }
+    }
+
+    //Only the pages scanout reads are copied, the rest of the snapshot is never looked at
+    if (regs.PMODE.circuit1)
+        copy_display_pages(local_mem, regs.DISPFB1, regs.DISPLAY1);
+    if (regs.PMODE.circuit2)
+        copy_display_pages(local_mem, regs.DISPFB2, regs.DISPLAY2);
+    reg = regs;
+
+    std::unique_lock<std::mutex> lk(state_mutex);
+    this->target = target;
+    this->target_mutex = target_mutex;
+    pending = true;
+    started = false;
+    busy = true;
+    notifier.notify_all();
+
+    //Don't return until the worker owns the output buffer, otherwise the EE could grab it first
+    notifier.wait(lk, [this] { return started; });
+}
+
+/**
+  * Copies every page a read circuit can touch into the snapshot. DISPFB buffers always start on a
+  * page, and the last line read is at most the display height plus the field offset below the first.
+  **/
+void GSScanout::copy_display_pages(const uint8_t* local_mem, const DISPFB& dispfb, const DISPLAY& display)
+{
+    if (display.width <= 0 || display.height <= 0)
+        return;
+
+    const uint32_t PAGE_SIZE = 8192;
+    const uint32_t PAGE_COUNT = (1024 * 1024 * 4) / PAGE_SIZE;
+    uint32_t page_height = (dispfb.format == 0x0 || dispfb.format == 0x1) ? 32 : 64;
+    uint32_t width = dispfb.width / 64;
+    uint32_t base = dispfb.frame_base * 4 / PAGE_SIZE;
+
+    uint32_t y_end = dispfb.y + display.height;
+    uint32_t x_end = dispfb.x + display.width - 1;
+    uint32_t first = base + (dispfb.y / page_height) * width + (dispfb.x >> 6);
+    uint32_t last = base + (y_end / page_height) * width + (x_end >> 6);
+    uint32_t count = std::min(last - first + 1, PAGE_COUNT);
+
+    first %= PAGE_COUNT;
+    uint32_t before_wrap = std::min(count, PAGE_COUNT - first);
+    memcpy(&mem[first * PAGE_SIZE], &local_mem[first * PAGE_SIZE], before_wrap * PAGE_SIZE);
+    memcpy(&mem[0], &local_mem[0], (count - before_wrap) * PAGE_SIZE);
+}
+
+void GSScanout::worker_loop()
+{
+    while (true)
+    {
+        uint32_t* output;
+        std::mutex* output_mutex;
+        {
+            std::unique_lock<std::mutex> lk(state_mutex);
+            notifier.wait(lk, [this] { return pending || quit; });
+            if (quit)
+                return;
+            pending = false;
+            output = target;
+            output_mutex = target_mutex;
+        }
+
+        while (!output_mutex->try_lock())
+            std::this_thread::yield();
+        std::lock_guard<std::mutex> lock(*output_mutex, std::adopt_lock);
+
+        {
+            std::unique_lock<std::mutex> lk(state_mutex);
+            started = true;
+        }
+        notifier.notify_all();
+
+        render_CRT(output);
+
+        {
+            std::unique_lock<std::mutex> lk(state_mutex);
+            busy = false;
+        }
+        notifier.notify_all();
+    }
+}
+
+/**
+  * Reads a row of a display buffer, unswizzling a whole block row at a time.
+  * Aligned 8 pixel groups of PSMCT32/24 and 16 pixel groups of PSMCT16/16S never cross a block,
+  * so the address is only calculated once per group and the columns are gathered with SSE2.
+  **/
+void GSScanout::read_line(const DISPFB& dispfb, uint32_t x, uint32_t y, int32_t count, uint32_t* out)
+{
+    uint32_t block = (dispfb.frame_base * 4) / 256;
+    uint32_t width = dispfb.width / 64;
+    const uint8_t* local_mem = mem.get();
+    int32_t i = 0;
+
+    switch (dispfb.format)
+    {
+        case 0x0:
+        case 0x1:
+        {
+            const __m128i alpha_mask = _mm_set1_epi32(dispfb.format == 0x1 ? 0xFF000000 : 0);
+            while (i < count)
+            {
+                uint32_t fb_x = x + i;
+                if (!(fb_x & 0x7) && count - i >= 8)
+                {
+                    const uint8_t* row = &local_mem[addr_PSMCT32(block, width, fb_x, y)];
+                    __m128i lo = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)row),
+                                                    _mm_loadl_epi64((const __m128i*)(row + 16)));
+                    __m128i hi = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(row + 32)),
+                                                    _mm_loadl_epi64((const __m128i*)(row + 48)));
+                    _mm_storeu_si128((__m128i*)&out[i], _mm_or_si128(lo, alpha_mask));
+                    _mm_storeu_si128((__m128i*)&out[i + 4], _mm_or_si128(hi, alpha_mask));
+                    i += 8;
+                }
+                else
+                {
+                    uint32_t color = *(const uint32_t*)&local_mem[addr_PSMCT32(block, width, fb_x, y)];
+                    if (dispfb.format == 0x1)
+                        color = (color & 0xFFFFFF) | (0xFF << 24);
+                    out[i] = color;
+                    i++;
+                }
+            }
+            break;
+        }
+        case 0x2:
+        case 0xA:
+        {
+            auto addr_func = (dispfb.format == 0x2) ? addr_PSMCT16 : addr_PSMCT16S;
+            const __m128i low_mask = _mm_set1_epi32(0xFFFF);
+            const __m128i r_mask = _mm_set1_epi32(0xF8);
+            const __m128i g_mask = _mm_set1_epi32(0xF800);
+            const __m128i b_mask = _mm_set1_epi32(0xF80000);
+            const __m128i a_mask = _mm_set1_epi32(0x80000000);
+
+            //Vectorized convert_color_up
+            auto expand = [&](__m128i c)
+            {
+                __m128i r = _mm_and_si128(_mm_slli_epi32(c, 3), r_mask);
+                __m128i g = _mm_and_si128(_mm_slli_epi32(c, 6), g_mask);
+                __m128i b = _mm_and_si128(_mm_slli_epi32(c, 9), b_mask);
+                __m128i a = _mm_and_si128(_mm_slli_epi32(c, 16), a_mask);
+                return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+            };
+
+            while (i < count)
+            {
+                uint32_t fb_x = x + i;
+                if (!(fb_x & 0xF) && count - i >= 16)
+                {
+                    //Halfwords within a block row are interleaved as 0, 8, 1, 9, 2, 10...
+                    const uint8_t* row = &local_mem[addr_func(block, width, fb_x, y)];
+                    __m128i a = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)row),
+                                                   _mm_loadl_epi64((const __m128i*)(row + 16)));
+                    __m128i b = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(row + 32)),
+                                                   _mm_loadl_epi64((const __m128i*)(row + 48)));
+                    _mm_storeu_si128((__m128i*)&out[i], expand(_mm_and_si128(a, low_mask)));
+                    _mm_storeu_si128((__m128i*)&out[i + 4], expand(_mm_and_si128(b, low_mask)));
+                    _mm_storeu_si128((__m128i*)&out[i + 8], expand(_mm_srli_epi32(a, 16)));
+                    _mm_storeu_si128((__m128i*)&out[i + 12], expand(_mm_srli_epi32(b, 16)));
+                    i += 16;
+                }
+                else
+                {
+                    out[i] = convert_color_up(*(const uint16_t*)&local_mem[addr_func(block, width, fb_x, y)]);
+                    i++;
+                }
+            }
+            break;
+        }
+    }
+}
+
+//Alpha blends circuit 1 over circuit 2, four pixels at a time
+void GSScanout::blend_line(const uint32_t* line1, const uint32_t* line2, uint32_t* out, int32_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i max_alpha = _mm_set1_epi32(0xFF);
+    const __m128i inv_alpha = _mm_set1_epi16(0xFF);
+    const __m128i opaque = _mm_set1_epi32(0xFF000000);
+    const __m128i fixed_alpha = _mm_set1_epi32(reg.PMODE.ALP);
+    int32_t i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i c1 = _mm_loadu_si128((const __m128i*)&line1[i]);
+        __m128i c2 = _mm_loadu_si128((const __m128i*)&line2[i]);
+
+        __m128i alpha;
+        if (reg.PMODE.use_ALP)
+            alpha = fixed_alpha;
+        else
+            alpha = _mm_min_epi16(_mm_slli_epi32(_mm_srli_epi32(c1, 24), 1), max_alpha);
+
+        //Spread each pixel's alpha across its four 16-bit channels
+        alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+        __m128i alpha_lo = _mm_unpacklo_epi32(alpha, alpha);
+        __m128i alpha_hi = _mm_unpackhi_epi32(alpha, alpha);
+
+        //c1 * alpha + c2 * (0xFF - alpha) never exceeds 0xFF * 0xFF, so it fits in 16 bits
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(c1, zero), alpha_lo),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(c2, zero), _mm_sub_epi16(inv_alpha, alpha_lo)));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(c1, zero), alpha_hi),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(c2, zero), _mm_sub_epi16(inv_alpha, alpha_hi)));
+        lo = _mm_srli_epi16(lo, 8);
+        hi = _mm_srli_epi16(hi, 8);
+
+        _mm_storeu_si128((__m128i*)&out[i], _mm_or_si128(_mm_packus_epi16(lo, hi), opaque));
+    }
+
+    for (; i < count; i++)
+    {
+        uint32_t output1 = line1[i];
+        uint32_t output2 = line2[i];
+        uint32_t alpha;
+
+        if (reg.PMODE.use_ALP)
+            alpha = reg.PMODE.ALP;
+        else
+            alpha = (output1 >> 24) * 2;
+
+        if (alpha > 0xFF)
+            alpha = 0xFF;
+
+        uint32_t r = (((output1 & 0xFF) * alpha) + ((output2 & 0xFF) * (0xFF - alpha))) >> 8;
+        uint32_t g = ((((output1 >> 8) & 0xFF) * alpha) + (((output2 >> 8) & 0xFF) * (0xFF - alpha))) >> 8;
+        uint32_t b = ((((output1 >> 16) & 0xFF) * alpha) + (((output2 >> 16) & 0xFF) * (0xFF - alpha))) >> 8;
+
+        out[i] = 0xFF000000 | r | (g << 8) | (b << 16);
+    }
+}
+
+void GSScanout::compose_line(int32_t y, int32_t width, int32_t fb_offset, int32_t y_increment, int32_t frame_line_increment,
+                             int32_t display1_xoffset, int32_t display1_yoffset,
+                             int32_t display2_xoffset, int32_t display2_yoffset)
+{
+    bool enable_circuit1 = reg.PMODE.circuit1 && y >= display1_yoffset && y < (display1_yoffset + reg.DISPLAY1.height);
+    bool enable_circuit2 = reg.PMODE.circuit2 && y >= display2_yoffset && y < (display2_yoffset + reg.DISPLAY2.height);
+
+    int32_t x1_start = min(display1_xoffset, width);
+    int32_t x1_end = min(display1_xoffset + reg.DISPLAY1.width, width);
+    int32_t x2_start = min(display2_xoffset, width);
+    int32_t x2_end = min(display2_xoffset + reg.DISPLAY2.width, width);
+
+    //Circuit 2 falls back to the background colour wherever it isn't displayed
+    fill(line2.begin(), line2.begin() + width, reg.BGCOLOR);
+    fill(out_line.begin(), out_line.begin() + width, 0xFF000000);
+
+    if (enable_circuit2 && x2_end > x2_start)
+    {
+        if (!reg.PMODE.blend_with_bg)
+        {
+            int32_t pixel_y = y - display2_yoffset;
+            int32_t scaled_y = (int32_t)reg.DISPFB2.y + fb_offset + ((pixel_y >> (y_increment - 1)) << (frame_line_increment - 1));
+            read_line(reg.DISPFB2, reg.DISPFB2.x + (x2_start - display2_xoffset), scaled_y,
+                      x2_end - x2_start, &line2[x2_start]);
+        }
+
+        //If Circuit 1 is disabled, we can skip alpha blending on Circuit 2
+        //Some games (like Devil May Cry) will use Circuit 2 with an ALP of 255, making it effectively blank.
+        //However we think that on real hardware it will either skip the blending or duplicate Circuit 2 in the Circuit 1 output
+        //which effectively means output2 is outputted at full alpha
+        //Downhill Domination also has a dark screen if you do not follow this behaviour.  ALP 128 only circuit 2
+        for (int32_t x = x2_start; x < x2_end; x++)
+            out_line[x] = line2[x] | 0xFF000000;
+    }
+
+    if (enable_circuit1 && x1_end > x1_start)
+    {
+        int32_t pixel_y = y - display1_yoffset;
+        int32_t scaled_y = (int32_t)reg.DISPFB1.y + fb_offset + ((pixel_y >> (y_increment - 1)) << (frame_line_increment - 1));
+        read_line(reg.DISPFB1, reg.DISPFB1.x + (x1_start - display1_xoffset), scaled_y,
+                  x1_end - x1_start, &line1[x1_start]);
+        blend_line(&line1[x1_start], &line2[x1_start], &out_line[x1_start], x1_end - x1_start);
+    }
+}
+
+void GSScanout::render_CRT(uint32_t* target)
+{
+    int32_t width;
+    int32_t height;
+    int32_t y_increment = 1;
+    int32_t start_scanline = 0;
+    int32_t frame_line_increment = 1;
+    int32_t fb_offset = 0;
+    int32_t display1_yoffset = 0;
+    int32_t display1_xoffset = 0;
+    int32_t display2_yoffset = 0;
+    int32_t display2_xoffset = 0;
+    bool field_offset = !reg.CSR.is_odd_frame;
+    DeinterlaceMethod deinterlace_method = deinterlace_forced ? forced_deinterlace : reg.deinterlace_method;
+
+    //Get overall picture height, largest will likely cover whole screen
+    if (reg.PMODE.circuit1 && reg.PMODE.circuit2)
+    {
+        height = max(reg.DISPLAY1.height, reg.DISPLAY2.height);
+        width = max(reg.DISPLAY1.width, reg.DISPLAY2.width);
+    }
+    else if (reg.PMODE.circuit1)
+    {
+        height = reg.DISPLAY1.height;
+        width = reg.DISPLAY1.width;
+    }
+    else if (reg.PMODE.circuit2) //Makai Kingdom, SH2, GT4, True Crime needs to take its display information from Display2
+    {
+        height = reg.DISPLAY2.height;
+        width = reg.DISPLAY2.width;
+    }
+    else
+        return;
+
+    if (width <= 0 || height <= 0)
+        return;
+
+    //Calculate DISPLAY offsets
+    if (reg.PMODE.circuit1 && reg.PMODE.circuit2)
+    {
+        if ((reg.DISPLAY1.x - reg.DISPLAY2.x) < 0)
+            display2_xoffset = reg.DISPLAY2.x - reg.DISPLAY1.x;
+        else if ((reg.DISPLAY1.x - reg.DISPLAY2.x) > 0)
+            display1_xoffset = reg.DISPLAY1.x - reg.DISPLAY2.x;
+
+        if ((reg.DISPLAY1.y - reg.DISPLAY2.y) < 0)
+            display2_yoffset = reg.DISPLAY2.y - reg.DISPLAY1.y;
+        else if ((reg.DISPLAY1.y - reg.DISPLAY2.y) > 0)
+            display1_yoffset = reg.DISPLAY1.y - reg.DISPLAY2.y;
+    }
+
+    //TODO - Find out why some games double their height
+    //Examples are Pool Paradise, Silent Hill 2
+    //Makai Kingdom + Disgaea go the other way and half their height, but this is ok
+    //Resident Evil 4 has it's height just slightly higher than width (pseudo widescreen), so we need to be careful to check that
+    //height 511 magy 1 width 2562 magx 6 actual width 427 dx 656 dy 73 Interlaced 1 Frame 0 --- Resident Evil 4 (strangely cut off, broken with PCRTC change)
+    //height 896 magy 1 width 2560 magx 5 actual width 512 dx 652 dy 50 Interlaced 1 Frame 0 --- Silent Hill 2
+    //height 960 magy 1 width 2560 magx 4 actual width 640 dx 636 dy 42 Interlaced 1 Frame 0 --- Pool Paradise
+    //height 224 magy 1 width 2560 magx 4 actual width 640 dx 636 dy 25 Interlaced 0 Frame 1 --- Makai
+
+    //Check for extremely high heights, slightly higher heights are ok as they are a sort of widescreen resolution
+    if (height >= (width * 1.3))
+        height = height / 2;
+
+    if (reg.SMODE2.interlaced)
+    {
+        if (deinterlace_method != BOB_DEINTERLACE)
+        {
+            y_increment = 2;
+            //We use !reg.CSR.is_odd_frame here because frames are counted from 1,2,3 etc, not 0, 1, 2, so the first frame is always odd
+            start_scanline = field_offset;
+
+            if (!reg.SMODE2.frame_mode)
+            {
+                frame_line_increment = 2;
+                fb_offset = field_offset;
+            }
+        }
+    }
+
+    if ((int32_t)line1.size() < width)
+    {
+        line1.resize(width);
+        line2.resize(width);
+        out_line.resize(width);
+    }
+
+    const size_t row_size = width * sizeof(uint32_t);
+
+    for (int32_t y = start_scanline; y < height; y += y_increment)
+    {
+        compose_line(y, width, fb_offset, y_increment, frame_line_increment,
+                     display1_xoffset, display1_yoffset, display2_xoffset, display2_yoffset);
+
+        uint32_t* line = out_line.data();
+
+        if (!reg.SMODE2.interlaced)
+        {
+            memcpy(&target[y * width], line, row_size);
+            continue;
+        }
+
+        //The other field's line in the output, which weave and blend fill from the previous field
+        int32_t other_y = field_offset ? y - 1 : y + 1;
+
+        switch (deinterlace_method)
+        {
+            case BOB_DEINTERLACE:
+                if (reg.SMODE2.frame_mode)
+                {
+                    memcpy(&target[(y * 2) * width], line, row_size);
+                    memcpy(&target[((y * 2) + 1) * width], line, row_size);
+                }
+                else
+                    memcpy(&target[y * width], line, row_size);
+                break;
+            case BLEND_SCANLINE_DEINTERLACE:
+            {
+                //Average each line with the neighbouring line of the last field to hide combing
+                memcpy(&screen_buffer[y * width], line, row_size);
+                if (other_y < 0)
+                {
+                    memcpy(&target[y * width], line, row_size);
+                    break;
+                }
+
+                const uint32_t* other = &screen_buffer[other_y * width];
+                int32_t x = 0;
+                for (; x + 4 <= width; x += 4)
+                {
+                    __m128i blended = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)&line[x]),
+                                                   _mm_loadu_si128((const __m128i*)&other[x]));
+                    _mm_storeu_si128((__m128i*)&target[(y * width) + x], blended);
+                    _mm_storeu_si128((__m128i*)&target[(other_y * width) + x], blended);
+                }
+                for (; x < width; x++)
+                {
+                    uint32_t blended = 0;
+                    for (int shift = 0; shift < 32; shift += 8)
+                        blended |= ((((line[x] >> shift) & 0xFF) + ((other[x] >> shift) & 0xFF) + 1) >> 1) << shift;
+                    target[(y * width) + x] = blended;
+                    target[(other_y * width) + x] = blended;
+                }
+                break;
+            }
+            default: //No Deinterlacing (weave)
+                memcpy(&screen_buffer[y * width], line, row_size);
+                memcpy(&target[y * width], line, row_size);
+                if (other_y >= 0)
+                    memcpy(&target[other_y * width], &screen_buffer[other_y * width], row_size);
+                break;
+        }
+    }
+}
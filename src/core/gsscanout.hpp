@@ -0,0 +1,60 @@
+#ifndef GSSCANOUT_HPP
+#define GSSCANOUT_HPP
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "gsregisters.hpp"
+
+/**
+The PCRTC stage of the GS. Merges the two read circuits into the output buffer
+on its own thread, working from a snapshot of local memory so the GS thread can
+start rasterizing the next frame while scanout is still running.
+**/
+
+class GSScanout
+{
+    private:
+        std::thread thread;
+        std::mutex state_mutex;
+        std::condition_variable notifier;
+        bool pending, started, busy, quit;
+
+        //Snapshot taken when the frame is submitted
+        std::unique_ptr<uint8_t[]> mem;
+        GS_REGISTERS reg;
+        uint32_t* target;
+        std::mutex* target_mutex;
+
+        DeinterlaceMethod forced_deinterlace;
+        bool deinterlace_forced;
+
+        //Last field, kept for weave/blend deinterlacing
+        std::unique_ptr<uint32_t[]> screen_buffer;
+
+        std::vector<uint32_t> line1, line2, out_line;
+
+        void worker_loop();
+        void copy_display_pages(const uint8_t* local_mem, const DISPFB& dispfb, const DISPLAY& display);
+        void render_CRT(uint32_t* target);
+        void compose_line(int32_t y, int32_t width, int32_t fb_offset, int32_t y_increment, int32_t frame_line_increment,
+                          int32_t display1_xoffset, int32_t display1_yoffset,
+                          int32_t display2_xoffset, int32_t display2_yoffset);
+        void read_line(const DISPFB& dispfb, uint32_t x, uint32_t y, int32_t count, uint32_t* out);
+        void blend_line(const uint32_t* line1, const uint32_t* line2, uint32_t* out, int32_t count);
+    public:
+        GSScanout();
+        ~GSScanout();
+
+        void reset();
+        void exit();
+
+        //GS thread only
+        void submit(const uint8_t* local_mem, const GS_REGISTERS& regs, uint32_t* target, std::mutex* target_mutex);
+        void wait_for_idle();
+        void set_deinterlace_method(DeinterlaceMethod method, bool forced);
+};
+
+#endif // GSSCANOUT_HPP
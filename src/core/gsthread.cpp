@@ -4,10 +4,13 @@
 #include <cstring>
 #include <cmath>
 #include <fstream>
+#include <mutex>
+#include <emmintrin.h>
 
 #include "gsthread.hpp"
 #include "gsmem.hpp"
 #include "errors.hpp"
+#include "trace.hpp"
 
 using namespace std;
 
@@ -22,8 +25,7 @@ static SwizzleTable<32,64,64> page_PSMCT16Z;
 static SwizzleTable<32,64,64> page_PSMCT16SZ;
 static SwizzleTable<32,64,128> page_PSMCT8;
 static SwizzleTable<32,128,128> page_PSMCT4;
-
-#define printf(fmt, ...)(0)
+static once_flag swizzle_tables_built;
 
 #define GS_JIT
 
@@ -75,12 +77,47 @@ float interpolate_f(int32_t x, float u1, int32_t x1, float u2, int32_t x2)
 const unsigned int GraphicsSynthesizerThread::max_vertices[8] = {1, 2, 2, 3, 3, 3, 2, 0};
 constexpr REG_64 GraphicsSynthesizerThread::abi_args[4];
 
-GraphicsSynthesizerThread::GraphicsSynthesizerThread()
+GraphicsSynthesizerThread::GraphicsSynthesizerThread(const Trace::GuestClock* trace_clock)
     : frame_complete(false), local_mem(nullptr), jit_draw_pixel_block("GS-pixel"), jit_tex_lookup_block("GS-texture"),
-    emitter_dp(&jit_draw_pixel_block),
-      emitter_tex(&jit_tex_lookup_block)
+    jit_sprite_row_block("GS-sprite"), emitter_dp(&jit_draw_pixel_block),
+      emitter_tex(&jit_tex_lookup_block), emitter_sprite(&jit_sprite_row_block), trace_clock(trace_clock)
+{
+    //The swizzling tables are read-only once built, so every instance shares them
+    call_once(swizzle_tables_built, &GraphicsSynthesizerThread::init_swizzle_tables, this);
+
+    //Initialize lookup table used for LOD calculation
+    for (int i = 0; i < 32768; i++)
+    {
+        uint32_t value = i * 0x10000;
+        int exp = (value >> 23) & 0xFF;
+        float calculation;
+        if (exp == 0)
+        {
+            //arbitrary "large" value
+            calculation = 1000.0;
+        }
+        else if (exp == 0xFF)
+        {
+            //arbitrary large negative value - do this to prevent NaNs
+            calculation = -1000.0;
+        }
+        else
+            calculation = log2(1.0f / *(float*)&value);
+
+        //L has four possible values, so we need four different shifts
+        log2_lookup[i][0] = calculation;
+        log2_lookup[i][1] = ldexp(calculation, 1);
+        log2_lookup[i][2] = ldexp(calculation, 2);
+        log2_lookup[i][3] = ldexp(calculation, 3);
+    }
+
+    jit_draw_pixel_heap.flush_all_blocks();
+    jit_tex_lookup_heap.flush_all_blocks();
+    jit_sprite_row_heap.flush_all_blocks();
+}
+
+void GraphicsSynthesizerThread::init_swizzle_tables()
 {
-    //Initialize swizzling tables
     for (int block = 0; block < 32; block++)
     {
         for (int y = 0; y < 32; y++)
@@ -117,35 +154,6 @@ GraphicsSynthesizerThread::GraphicsSynthesizerThread()
                 page_PSMCT4.get(block,y,x) = (blockid_PSMCT4(block, 0, x, y) << 9) + columnTable4[y & 15][x & 31];
         }
     }
-
-    //Initialize lookup table used for LOD calculation
-    for (int i = 0; i < 32768; i++)
-    {
-        uint32_t value = i * 0x10000;
-        int exp = (value >> 23) & 0xFF;
-        float calculation;
-        if (exp == 0)
-        {
-            //arbitrary "large" value
-            calculation = 1000.0;
-        }
-        else if (exp == 0xFF)
-        {
-            //arbitrary large negative value - do this to prevent NaNs
-            calculation = -1000.0;
-        }
-        else
-            calculation = log2(1.0f / *(float*)&value);
-
-        //L has four possible values, so we need four different shifts
-        log2_lookup[i][0] = calculation;
-        log2_lookup[i][1] = ldexp(calculation, 1);
-        log2_lookup[i][2] = ldexp(calculation, 2);
-        log2_lookup[i][3] = ldexp(calculation, 3);
-    }
-
-    jit_draw_pixel_heap.flush_all_blocks();
-    jit_tex_lookup_heap.flush_all_blocks();
 }
 
 GraphicsSynthesizerThread::~GraphicsSynthesizerThread()
@@ -155,7 +163,7 @@ GraphicsSynthesizerThread::~GraphicsSynthesizerThread()
 
 void GraphicsSynthesizerThread::wait_for_return(GSReturn type, GSReturnMessage &data)
 {
-    printf("[GS] Waiting for return\n");
+    TRACE_DEBUG(Trace::GS, "[GS] Waiting for return\n");
 
     while (true)
     {
@@ -179,7 +187,7 @@ void GraphicsSynthesizerThread::wait_for_return(GSReturn type, GSReturnMessage &
                 {
                     //Last message in the queue, so we don't want this one so we need to sleep
                     return_queue->push(data); //Put it back on the queue, something else probably wants it
-                    printf("[GS] Waiting for return message, pushed last message on to queue type %d expecting %d\n", data.type, type);
+                    TRACE_DEBUG(Trace::GS, "[GS] Waiting for return message, pushed last message on to queue type %d expecting %d\n", data.type, type);
                     std::unique_lock<std::mutex> lk(data_mutex);
                     notifier.wait(lk, [this] {return recieve_data; });
                     recieve_data = false;
@@ -191,7 +199,7 @@ void GraphicsSynthesizerThread::wait_for_return(GSReturn type, GSReturnMessage &
         }
         else
         {
-            printf("[GS] No Messages, waiting for return message\n");
+            TRACE_DEBUG(Trace::GS, "[GS] No Messages, waiting for return message\n");
             std::unique_lock<std::mutex> lk(data_mutex);
             notifier.wait(lk, [this] {return recieve_data;});
             recieve_data = false;
@@ -208,7 +216,7 @@ void GraphicsSynthesizerThread::send_message(GSMessage message)
 
 void GraphicsSynthesizerThread::wake_thread()
 {
-    printf("[GS] Waking GS Thread\n");
+    TRACE_DEBUG(Trace::GS, "[GS] Waking GS Thread\n");
     std::unique_lock<std::mutex> lk(data_mutex);
     notifier.notify_one();
 }
@@ -224,11 +232,14 @@ void GraphicsSynthesizerThread::exit()
         wake_thread();
         thread.join();
     }
+    scanout.exit();
 }
 
 void GraphicsSynthesizerThread::event_loop()
 {
-    printf("[GS_t] Starting GS Thread\n");
+    //Stamp trace records with the cycle the EE has reached, not the frame this thread is drawing
+    Trace::set_guest_clock(trace_clock);
+    TRACE_DEBUG(Trace::GS, "[GS_t] Starting GS Thread\n");
 
     bool gsdump_recording = false;
     ofstream gsdump_file;
@@ -244,6 +255,9 @@ void GraphicsSynthesizerThread::event_loop()
                 if (gsdump_recording)
                     gsdump_file.write((char*)&data, sizeof(data));
 
+                if (hwreg_staged && !(data.type == write64_t && data.payload.write64_payload.addr == 0x54))
+                    flush_HWREG_staging();
+
                 switch (data.type)
                 {
                     case write64_t:
@@ -307,17 +321,18 @@ void GraphicsSynthesizerThread::event_loop()
                     }
                     case render_crt_t:
                     {
+                        //Scanout runs on its own thread from a snapshot of local memory,
+                        //so we can carry on with the next frame as soon as it owns the buffer
                         auto p = data.payload.render_payload;
+                        scanout.submit(local_mem, reg, p.target, p.target_mutex);
 
-                        while (!p.target_mutex->try_lock())
-                        {
-                            printf("[GS_t] buffer lock failed!\n");
-                            std::this_thread::yield();
-                        }
-                        std::lock_guard<std::mutex> lock(*p.target_mutex, std::adopt_lock);
-                        render_CRT(p.target);
+                        auto now = std::chrono::steady_clock::now();
+                        busy_time += now - busy_start;
+                        busy_start = now;
                         GSReturnMessagePayload return_payload;
-                        return_payload.no_payload = { 0 };
+                        return_payload.frame_payload.busy_us = (uint32_t)std::chrono::duration_cast<
+                                std::chrono::microseconds>(busy_time).count();
+                        busy_time = std::chrono::steady_clock::duration::zero();
                         return_queue->push({ GSReturn::render_complete_t,return_payload });
                         std::unique_lock<std::mutex> lk(data_mutex);
                         recieve_data = true;
@@ -342,7 +357,7 @@ void GraphicsSynthesizerThread::event_loop()
 
                         while (!p.target_mutex->try_lock())
                         {
-                            printf("[GS_t] buffer lock failed!\n");
+                            TRACE_DEBUG(Trace::GS, "[GS_t] buffer lock failed!\n");
                             std::this_thread::yield();
                         }
                         std::lock_guard<std::mutex> lock(*p.target_mutex, std::adopt_lock);
@@ -381,10 +396,10 @@ void GraphicsSynthesizerThread::event_loop()
                     }
                     case gsdump_t:
                     {
-                        printf("gs dump! ");
+                        TRACE_DEBUG(Trace::GS, "gs dump! ");
                         if (!gsdump_recording)
                         {
-                            printf("(start)\n");
+                            TRACE_DEBUG(Trace::GS, "(start)\n");
                             gsdump_file.open("gsdump.gsd", ios::out | ios::binary);
                             if (!gsdump_file.is_open())
                                 Errors::die("gs dump file failed to open");
@@ -394,28 +409,31 @@ void GraphicsSynthesizerThread::event_loop()
                         }
                         else
                         {
-                            printf("(end)\n");
+                            TRACE_DEBUG(Trace::GS, "(end)\n");
                             gsdump_file.close();
                             gsdump_recording = false;
                         }
                         break;
                     }
+                    case set_deinterlace_t:
+                    {
+                        auto p = data.payload.deinterlace_payload;
+                        scanout.set_deinterlace_method(p.method, p.forced);
+                        break;
+                    }
+                    case set_skip_draws_t:
+                        skip_draws = data.payload.skip_draws_payload.skip;
+                        break;
+                    case set_sprite_spans_t:
+                        sprite_spans = data.payload.sprite_spans_payload.enabled;
+                        break;
                     case request_local_host_tx:
                     {
+                        //No return message here - the EE side streams the result from the fence as it fills
                         auto p = data.payload.download_payload;
-
-                        while (!p.target_mutex->try_lock())
-                        {
-                            printf("[GS_t] buffer lock failed!\n");
-                            std::this_thread::yield();
-                        }
-                        std::lock_guard<std::mutex> lock(*p.target_mutex, std::adopt_lock);
-                        GSReturnMessagePayload return_payload;
-                        return_payload.download_payload.quad_count = local_to_host(p.target);
-                        return_queue->push({ GSReturn::local_host_transfer, return_payload });
-                        std::unique_lock<std::mutex> lk(data_mutex);
-                        recieve_data = true;
-                        notifier.notify_one();
+                        download_fence = p.fence;
+                        local_to_host(p.target, p.fence);
+                        download_fence = nullptr;
                         break;
                     }
                     default:
@@ -424,15 +442,23 @@ void GraphicsSynthesizerThread::event_loop()
             }
             else
             {
-                printf("GS Thread: No messages waiting, going to sleep\n");
-                std::unique_lock<std::mutex> lk(data_mutex);
-                notifier.wait(lk, [this] {return send_data;});
-                send_data = false;
+                TRACE_DEBUG(Trace::GS, "GS Thread: No messages waiting, going to sleep\n");
+                busy_time += std::chrono::steady_clock::now() - busy_start;
+                {
+                    std::unique_lock<std::mutex> lk(data_mutex);
+                    notifier.wait(lk, [this] {return send_data;});
+                    send_data = false;
+                }
+                busy_start = std::chrono::steady_clock::now();
             }
         }
     }
     catch (Emulation_error &e)
     {
+        //Don't leave the EE waiting on a download that will never finish
+        if (download_fence)
+            download_fence->complete.store(true, std::memory_order_release);
+
         GSReturnMessagePayload return_payload;
         char* copied_string = new char[ERROR_STRING_MAX_LENGTH];
         strncpy(copied_string, e.what(), ERROR_STRING_MAX_LENGTH);
@@ -443,6 +469,11 @@ void GraphicsSynthesizerThread::event_loop()
     }
 }
 
+uint64_t GraphicsSynthesizerThread::get_last_draw_state() const
+{
+    return last_draw_state.load(std::memory_order_relaxed);
+}
+
 void GraphicsSynthesizerThread::reset()
 {
     exit();
@@ -451,8 +482,15 @@ void GraphicsSynthesizerThread::reset()
         local_mem = new uint8_t[1024 * 1024 * 4];
 
     pixels_transferred = 0;
+    hwreg_staged = 0;
+    download_fence = nullptr;
     num_vertices = 0;
     frame_count = 0;
+    skip_draws = false;
+    sprite_spans = true;
+    last_draw_state = 0;
+    busy_start = std::chrono::steady_clock::now();
+    busy_time = std::chrono::steady_clock::duration::zero();
 
     COLCLAMP = true;
     SCANMSK = 0;
@@ -467,18 +505,24 @@ void GraphicsSynthesizerThread::reset()
     PRIM.reset();
     PRMODE.reset();
 
+    memset(clut_cache, 0, sizeof(clut_cache));
+    clut_expanded_valid = false;
+    update_clut_expansion();
+
     jit_draw_pixel_func = nullptr;
     jit_tex_lookup_func = nullptr;
+    jit_sprite_row_func = nullptr;
     jit_draw_pixel_prologue = nullptr;
     jit_tex_lookup_prologue = nullptr;
 
     jit_tex_lookup_heap.flush_all_blocks();
     jit_draw_pixel_heap.flush_all_blocks();
+    jit_sprite_row_heap.flush_all_blocks();
 
     recompile_tex_lookup_prologue();
     recompile_draw_pixel_prologue();
 
-    memset(screen_buffer, 0, sizeof(screen_buffer));
+    scanout.reset();
 
     message_queue = std::make_unique<gs_fifo>();
     return_queue = std::make_unique<gs_return_fifo>();
@@ -543,233 +587,6 @@ uint16_t convert_color_down(uint32_t col)
     return (uint16_t)(r | (g << 5) | (b << 10) | (a << 15));
 }
 
-//Calculates DISPLAY bounding box
-bool GraphicsSynthesizerThread::is_in_display(DISPLAY &display, int32_t x_start, int32_t y_start, int32_t x, int32_t y)
-{
-    //Inside X
-    if (x >= x_start && x < (x_start + display.width))
-    {
-        //Inside Y
-        if (y >= y_start && y < (y_start + display.height))
-        {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-uint32_t GraphicsSynthesizerThread::get_CRT_color(DISPFB &dispfb, int32_t x, int32_t y)
-{
-    switch (dispfb.format)
-    {
-        case 0x0:
-            return read_PSMCT32_block(dispfb.frame_base * 4, dispfb.width, x, y);
-        case 0x1://PSMCT24
-            return (read_PSMCT32_block(dispfb.frame_base * 4, dispfb.width, x, y) & 0xFFFFFF) | (0xff << 24);
-        case 0x2:
-            return convert_color_up(read_PSMCT16_block(dispfb.frame_base * 4, dispfb.width, x, y));
-        case 0xA:
-            return convert_color_up(read_PSMCT16S_block(dispfb.frame_base * 4, dispfb.width, x, y));
-        default:
-            Errors::die("Unknown framebuffer format (%x)", dispfb.format);
-    }
-}
-
-void GraphicsSynthesizerThread::render_CRT(uint32_t* target)
-{
-    int32_t width;
-    int32_t height;
-    int32_t y_increment = 1;
-    int32_t start_scanline = 0;
-    int32_t frame_line_increment = 1;
-    int32_t fb_offset = 0;
-    int32_t display1_yoffset = 0;
-    int32_t display1_xoffset = 0;
-    int32_t display2_yoffset = 0;
-    int32_t display2_xoffset = 0;
-    bool enable_circuit1 = true;
-    bool enable_circuit2 = true;
-    bool field_offset = !reg.CSR.is_odd_frame;
-    
-    //Get overall picture height, largest will likely cover whole screen
-    if (reg.PMODE.circuit1 && reg.PMODE.circuit2)
-    {
-        height = max(reg.DISPLAY1.height, reg.DISPLAY2.height);
-        width = max(reg.DISPLAY1.width, reg.DISPLAY2.width);
-    }
-    else if (reg.PMODE.circuit1)
-    {
-        height = reg.DISPLAY1.height;
-        width = reg.DISPLAY1.width;
-    }
-    else if (reg.PMODE.circuit2) //Makai Kingdom, SH2, GT4, True Crime needs to take its display information from Display2
-    {
-        height = reg.DISPLAY2.height;
-        width = reg.DISPLAY2.width;
-    }
-    else
-        return;
-
-    //Calculate DISPLAY offsets
-    if (reg.PMODE.circuit1 && reg.PMODE.circuit2)
-    {
-        if ((reg.DISPLAY1.x - reg.DISPLAY2.x) < 0)
-            display2_xoffset = reg.DISPLAY2.x - reg.DISPLAY1.x;
-        else if ((reg.DISPLAY1.x - reg.DISPLAY2.x) > 0)
-            display1_xoffset = reg.DISPLAY1.x - reg.DISPLAY2.x;
-
-        if ((reg.DISPLAY1.y - reg.DISPLAY2.y) < 0)
-            display2_yoffset = reg.DISPLAY2.y - reg.DISPLAY1.y;
-        else if ((reg.DISPLAY1.y - reg.DISPLAY2.y) > 0)
-            display1_yoffset = reg.DISPLAY1.y - reg.DISPLAY2.y;
-    }
-
-    //TODO - Find out why some games double their height
-    //Examples are Pool Paradise, Silent Hill 2
-    //Makai Kingdom + Disgaea go the other way and half their height, but this is ok
-    //Resident Evil 4 has it's height just slightly higher than width (pseudo widescreen), so we need to be careful to check that
-    //height 511 magy 1 width 2562 magx 6 actual width 427 dx 656 dy 73 Interlaced 1 Frame 0 --- Resident Evil 4 (strangely cut off, broken with PCRTC change)
-    //height 896 magy 1 width 2560 magx 5 actual width 512 dx 652 dy 50 Interlaced 1 Frame 0 --- Silent Hill 2
-    //height 960 magy 1 width 2560 magx 4 actual width 640 dx 636 dy 42 Interlaced 1 Frame 0 --- Pool Paradise
-    //height 224 magy 1 width 2560 magx 4 actual width 640 dx 636 dy 25 Interlaced 0 Frame 1 --- Makai
-
-    //Check for extremely high heights, slightly higher heights are ok as they are a sort of widescreen resolution
-    if (height >= (width * 1.3))
-        height = height / 2;
-
-    if (reg.SMODE2.interlaced)
-    {
-        if (reg.deinterlace_method != BOB_DEINTERLACE)
-        {
-            y_increment = 2;
-            //We use !reg.CSR.is_odd_frame here because frames are counted from 1,2,3 etc, not 0, 1, 2, so the first frame is always odd
-            start_scanline = field_offset;
-
-            if (!reg.SMODE2.frame_mode)
-            {
-                frame_line_increment = 2;
-                fb_offset = field_offset;
-            }
-        }
-    }
-
-    for (int y = start_scanline; y < height; y += y_increment)
-    {
-        for (int x = 0; x < width; x++)
-        {
-            int32_t pixel_x = x;
-            int32_t pixel_y = y;
-            int32_t pixel_x_disp1 = pixel_x - display1_xoffset;
-            int32_t pixel_x_disp2 = pixel_x - display2_xoffset;
-            int32_t pixel_y_disp1 = pixel_y - display1_yoffset;
-            int32_t pixel_y_disp2 = pixel_y - display2_yoffset;
-
-            //Calculate Frame buffer Coordinates
-            int32_t scaled_x1 = (int32_t)reg.DISPFB1.x + pixel_x_disp1;
-            int32_t scaled_x2 = (int32_t)reg.DISPFB2.x + pixel_x_disp2;
-            int32_t scaled_y1 = (int32_t)reg.DISPFB1.y + fb_offset + ((pixel_y_disp1 >> (y_increment - 1)) << (frame_line_increment - 1));
-            int32_t scaled_y2 = (int32_t)reg.DISPFB2.y + fb_offset + ((pixel_y_disp2 >> (y_increment - 1)) << (frame_line_increment - 1));
-
-            //Disable the outputs if the x, y are not in the display bounding box
-            enable_circuit1 = reg.PMODE.circuit1 && is_in_display(reg.DISPLAY1, display1_xoffset, display1_yoffset, pixel_x, pixel_y);
-            enable_circuit2 = reg.PMODE.circuit2 && is_in_display(reg.DISPLAY2, display2_xoffset, display2_yoffset, pixel_x, pixel_y);
-
-            uint32_t output1 = enable_circuit1 ? get_CRT_color(reg.DISPFB1, scaled_x1, scaled_y1) : 0;
-            uint32_t output2 = enable_circuit2 ? get_CRT_color(reg.DISPFB2, scaled_x2, scaled_y2) : reg.BGCOLOR;
-
-            if (reg.PMODE.blend_with_bg)
-                output2 = reg.BGCOLOR;
-
-            uint32_t r = 0, g = 0, b = 0;
-            uint32_t r1, g1, b1, r2, g2, b2;
-            uint32_t final_color;
-
-            //If Circuit 1 is disabled, we can skip alpha blending on Circuit 2
-            //Some games (like Devil May Cry) will use Circuit 2 with an ALP of 255, making it effectively blank.
-            //However we think that on real hardware it will either skip the blending or duplicate Circuit 2 in the Circuit 1 output
-            //which effectively means output2 is outputted at full alpha
-            //Downhill Domination also has a dark screen if you do not follow this behaviour.  ALP 128 only circuit 2
-            if (enable_circuit1)
-            {
-                uint32_t alpha;
-
-                if (reg.PMODE.use_ALP)
-                    alpha = reg.PMODE.ALP;
-                else
-                    alpha = (output1 >> 24) * 2;
-
-                if (alpha > 0xFF)
-                    alpha = 0xFF;
-
-                r1 = output1 & 0xFF; r2 = output2 & 0xFF;
-                g1 = (output1 >> 8) & 0xFF; g2 = (output2 >> 8) & 0xFF;
-                b1 = (output1 >> 16) & 0xFF; b2 = (output2 >> 16) & 0xFF;
-
-                r = ((r1 * alpha) + (r2 * (0xFF - alpha))) >> 8;
-                if (r > 0xFF)
-                    r = 0xFF;
-
-                g = ((g1 * alpha) + (g2 * (0xFF - alpha))) >> 8;
-                if (g > 0xFF)
-                    g = 0xFF;
-
-                b = ((b1 * alpha) + (b2 * (0xFF - alpha))) >> 8;
-                if (b > 0xFF)
-                    b = 0xFF;
-            }
-            else if(enable_circuit2)
-            {
-                r = output2 & 0xFF;
-                g = (output2 >> 8) & 0xFF;
-                b = (output2 >> 16) & 0xFF;
-            }
-
-            final_color = 0xFF000000 | r | (g << 8) | (b << 16);
-
-            if (reg.SMODE2.interlaced)
-            {
-                switch (reg.deinterlace_method)
-                {
-                    case BOB_DEINTERLACE:
-                    {
-                        if (reg.SMODE2.frame_mode)
-                        {
-                            pixel_y *= 2;
-                            target[pixel_x + (pixel_y * width)] = final_color;
-                            target[pixel_x + ((pixel_y + 1)* width)] = final_color;
-                        }
-                        else
-                        {
-                            target[pixel_x + (pixel_y * width)] = final_color;
-                        }
-                        break;
-                    }
-                    default: //No Deinterlacing
-                    {
-                        screen_buffer[pixel_x + (pixel_y * width)] = final_color;
-
-                        target[pixel_x + (pixel_y * width)] = final_color;
-
-                        if (reg.SMODE2.interlaced)
-                        {
-                            if (!field_offset)
-                                target[pixel_x + ((pixel_y + 1) * width)] = screen_buffer[pixel_x + ((pixel_y + 1) * width)];
-                            else if (pixel_y > 0)
-                                target[pixel_x + ((pixel_y - 1) * width)] = screen_buffer[pixel_x + ((pixel_y - 1) * width)];
-                        }
-                        break;
-                    }
-                }
-            }
-            else
-            {
-                target[pixel_x + (pixel_y * width)] = final_color;
-            }
-        }
-    }
-}
-
 void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
 {
     if (reg.write64(addr, value))
@@ -798,7 +615,7 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
 
             PRIM.fix_fragment_value = value & (1 << 10);
             num_vertices = 0;
-            printf("[GS_t] PRIM: $%08X\n", value);
+            TRACE_DEBUG(Trace::GS, "[GS_t] PRIM: $%08X\n", (uint32_t)value);
             update_draw_pixel_state();
             update_tex_lookup_state();
             break;
@@ -814,7 +631,7 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
 
             uint32_t q = (uint32_t)(value >> 32) & ~0xFF;
             RGBAQ.q = *(float*)&q;
-            printf("[GS_t] RGBAQ: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
+            TRACE_DEBUG(Trace::GS, "[GS_t] RGBAQ: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
         }
             break;
         case 0x0002:
@@ -825,12 +642,12 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
             uint32_t t = (value >> 32) & 0xFFFFFF00;
             ST.t = *(float*)&t;
         }
-            printf("ST: (%f, %f)\n", ST.s, ST.t);
+            TRACE_DEBUG(Trace::GS, "ST: (%f, %f)\n", ST.s, ST.t);
             break;
         case 0x0003:
             UV.u = (uint16_t)value & 0x3FFF;
             UV.v = (uint16_t)(value >> 16) & 0x3FFF;
-            printf("UV: ($%04X, $%04X)\n", UV.u, UV.v);
+            TRACE_DEBUG(Trace::GS, "UV: ($%04X, $%04X)\n", UV.u, UV.v);
             break;
         case 0x0004:
             //XYZF2
@@ -918,7 +735,7 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
             context2.set_xyoffset(value);
             break;
         case 0x001A:
-            printf("PRMODECNT: $%08X\n", value);
+            TRACE_DEBUG(Trace::GS, "PRMODECNT: $%08X\n", (uint32_t)value);
             {
                 if (value & 0x1)
                     current_PRMODE = &PRIM;
@@ -934,7 +751,7 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
             update_tex_lookup_state();
             break;
         case 0x001B:
-            printf("PRMODE: $%08X\n", value);
+            TRACE_DEBUG(Trace::GS, "PRMODE: $%08X\n", (uint32_t)value);
             PRMODE.gourand_shading = value & (1 << 3);
             PRMODE.texture_mapping = value & (1 << 4);
             PRMODE.fog = value & (1 << 5);
@@ -959,10 +776,10 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
             TEXCLUT.width = (value & 0x3F) * 64;
             TEXCLUT.x = ((value >> 6) & 0x3F) * 16;
             TEXCLUT.y = (value >> 12) & 0x3FF;
-            printf("TEXCLUT: $%08X\n", value);
-            printf("Width: %d\n", TEXCLUT.width);
-            printf("X: %d\n", TEXCLUT.x);
-            printf("Y: %d\n", TEXCLUT.y);
+            TRACE_DEBUG(Trace::GS, "TEXCLUT: $%08X\n", (uint32_t)value);
+            TRACE_DEBUG(Trace::GS, "Width: %d\n", TEXCLUT.width);
+            TRACE_DEBUG(Trace::GS, "X: %d\n", TEXCLUT.x);
+            TRACE_DEBUG(Trace::GS, "Y: %d\n", TEXCLUT.y);
             break;
         case 0x0022:
             SCANMSK = value & 0x3;
@@ -981,20 +798,21 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
             context2.set_miptbl2(value);
             break;
         case 0x003B:
-            printf("TEXA: $%08X_%08X\n", value >> 32, value);
+            TRACE_DEBUG(Trace::GS, "TEXA: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
             TEXA.alpha0 = value & 0xFF;
             TEXA.trans_black = value & (1 << 15);
             TEXA.alpha1 = (value >> 32) & 0xFF;
+            update_clut_expansion();
             update_tex_lookup_state();
             break;
         case 0x003D:
-            printf("FOGCOL: $%08X\n", value);
+            TRACE_DEBUG(Trace::GS, "FOGCOL: $%08X\n", (uint32_t)value);
             FOGCOL.r = value & 0xFF;
             FOGCOL.g = (value >> 8) & 0xFF;
             FOGCOL.b = (value >> 16) & 0xFF;
             break;
         case 0x003F:
-            printf("TEXFLUSH\n");
+            TRACE_DEBUG(Trace::GS, "TEXFLUSH\n");
             break;
         case 0x0040:
             context1.set_scissor(value);
@@ -1042,7 +860,7 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
                 update_draw_pixel_state();
             break;
         case 0x0049:
-            printf("[GS_t] PABE: $%02X\n", value);
+            TRACE_DEBUG(Trace::GS, "[GS_t] PABE: $%02X\n", (uint32_t)value);
             PABE = value & 0x1;
             update_draw_pixel_state();
             break;
@@ -1083,7 +901,7 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
             BITBLTBUF.dest_base = ((value >> 32) & 0x3FFF) * 64 * 4;
             BITBLTBUF.dest_width = ((value >> 48) & 0x3F) * 64;
             BITBLTBUF.dest_format = (value >> 56) & 0x3F;
-            printf("BITBLTBUF: $%08X_%08X\n", value >> 32, value);
+            TRACE_DEBUG(Trace::GS, "BITBLTBUF: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
             break;
         case 0x0051:
             TRXPOS.source_x = value & 0x7FF;
@@ -1091,12 +909,12 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
             TRXPOS.dest_x = (value >> 32) & 0x7FF;
             TRXPOS.dest_y = (value >> 48) & 0x7FF;
             TRXPOS.trans_order = (value >> 59) & 0x3;
-            printf("TRXPOS: $%08X_%08X\n", value >> 32, value);
+            TRACE_DEBUG(Trace::GS, "TRXPOS: $%08X_%08X\n", (uint32_t)(value >> 32), (uint32_t)value);
             break;
         case 0x0052:
             TRXREG.width = value & 0xFFF;
             TRXREG.height = (value >> 32) & 0xFFF;
-            printf("TRXREG (%d, %d)\n", TRXREG.width, TRXREG.height);
+            TRACE_DEBUG(Trace::GS, "TRXREG (%d, %d)\n", TRXREG.width, TRXREG.height);
             break;
         case 0x0053:
             TRXDIR = value & 0x3;
@@ -1104,16 +922,16 @@ void GraphicsSynthesizerThread::write64(uint32_t addr, uint64_t value)
             if (TRXDIR != 3)
             {
                 pixels_transferred = 0;
-                printf("Transfer started!\n");
-                printf("Src base: $%08X\n", BITBLTBUF.source_base);
-                printf("Dest base: $%08X\n", BITBLTBUF.dest_base);
-                printf("Src TRXPOS: (%d, %d)\n", TRXPOS.source_x, TRXPOS.source_y);
-                printf("Dest TRXPOS: (%d, %d)\n", TRXPOS.dest_x, TRXPOS.dest_y);
-                printf("TRXREG (%d, %d)\n", TRXREG.width, TRXREG.height);
-                printf("Src Format: $%02X\n", BITBLTBUF.source_format);
-                printf("Dest Format: $%02X\n", BITBLTBUF.dest_format);
-                printf("Src Width: %d\n", BITBLTBUF.source_width);
-                printf("Dest Width: %d\n", BITBLTBUF.dest_width);
+                TRACE_DEBUG(Trace::GS, "Transfer started!\n");
+                TRACE_DEBUG(Trace::GS, "Src base: $%08X\n", BITBLTBUF.source_base);
+                TRACE_DEBUG(Trace::GS, "Dest base: $%08X\n", BITBLTBUF.dest_base);
+                TRACE_DEBUG(Trace::GS, "Src TRXPOS: (%d, %d)\n", TRXPOS.source_x, TRXPOS.source_y);
+                TRACE_DEBUG(Trace::GS, "Dest TRXPOS: (%d, %d)\n", TRXPOS.dest_x, TRXPOS.dest_y);
+                TRACE_DEBUG(Trace::GS, "TRXREG (%d, %d)\n", TRXREG.width, TRXREG.height);
+                TRACE_DEBUG(Trace::GS, "Src Format: $%02X\n", BITBLTBUF.source_format);
+                TRACE_DEBUG(Trace::GS, "Dest Format: $%02X\n", BITBLTBUF.dest_format);
+                TRACE_DEBUG(Trace::GS, "Src Width: %d\n", BITBLTBUF.source_width);
+                TRACE_DEBUG(Trace::GS, "Dest Width: %d\n", BITBLTBUF.dest_width);
                 TRXPOS.int_dest_x = TRXPOS.dest_x;
                 TRXPOS.int_source_x = TRXPOS.source_x;
                 TRXPOS.int_dest_y = TRXPOS.dest_y;
@@ -1152,14 +970,14 @@ void GraphicsSynthesizerThread::set_ST(uint32_t s, uint32_t t)
 {
     ST.s = *(float*)&s;
     ST.t = *(float*)&t;
-    printf("ST: (%f, %f) ($%08X $%08X)\n", ST.s, ST.t, s, t);
+    TRACE_DEBUG(Trace::GS, "ST: (%f, %f) ($%08X $%08X)\n", ST.s, ST.t, s, t);
 }
 
 void GraphicsSynthesizerThread::set_UV(uint16_t u, uint16_t v)
 {
     UV.u = u;
     UV.v = v;
-    printf("UV: ($%04X, $%04X)\n", UV.u, UV.v);
+    TRACE_DEBUG(Trace::GS, "UV: ($%04X, $%04X)\n", UV.u, UV.v);
 }
 
 void GraphicsSynthesizerThread::set_XYZ(uint32_t x, uint32_t y, uint32_t z, bool drawing_kick)
@@ -1391,55 +1209,247 @@ void GraphicsSynthesizerThread::write_PSMCT4_block(uint32_t base, uint32_t width
     local_mem[addr] = (uint8_t)((local_mem[addr] & (0xf0 >> shift)) | ((value & 0x0f) << shift));
 }
 
-//The "vertex kick" is the name given to the process of placing a vertex in the vertex queue.
-//If drawing_kick is true, and enough vertices are available, then the polygon is rendered.
-void GraphicsSynthesizerThread::vertex_kick(bool drawing_kick)
+/**
+  * Block row kernels for transfers.
+  * A block row is 8 pixels for 32-bit formats, 16 for 16 and 8-bit, and 32 for 4-bit. Every pixel of an aligned
+  * block row is inside the same block, so the page/block address is calculated once and the rest of the row comes
+  * from the column tables. 32-bit and 16-bit rows are (un)swizzled with SSE2 shuffles.
+  **/
+int GraphicsSynthesizerThread::block_row_width(uint8_t format)
 {
-    for (int i = num_vertices; i > 0; i--)
-        vtx_queue[i] = vtx_queue[i - 1];
-    current_vtx.rgbaq = RGBAQ;
-    current_vtx.uv = UV;
-    current_vtx.s = ST.s;
-    current_vtx.t = ST.t;
-    current_vtx.fog = (uint8_t)FOG;
-    vtx_queue[0] = current_vtx;
-    //printf("Vkick: (%d, %d, %d)\n", current_vtx.x, current_vtx.y, current_vtx.z);
+    switch (format)
+    {
+        case 0x00:
+        case 0x30:
+            return 8;
+        case 0x02:
+        case 0x0A:
+        case 0x32:
+        case 0x3A:
+        case 0x13:
+            return 16;
+        case 0x14:
+            return 32;
+        default:
+            return 0;
+    }
+}
 
-    num_vertices++;
-    bool request_draw_kick = false;
-    switch (prim_type)
+int GraphicsSynthesizerThread::block_row_bytes(uint8_t format)
+{
+    switch (format)
     {
-        case 0: //Point
-            num_vertices--;
-            request_draw_kick = true;
+        case 0x13:
+        case 0x14:
+            return 16;
+        default:
+            return 32;
+    }
+}
+
+void GraphicsSynthesizerThread::read_block_row(uint8_t format, uint32_t base, uint32_t width, uint32_t x, uint32_t y,
+                                               uint8_t* dest)
+{
+    uint32_t block = base / 256;
+    width /= 64;
+
+    switch (format)
+    {
+        case 0x00:
+        case 0x30:
+        {
+            //Pairs of pixels are stored together, one pair per column quarter
+            uint32_t addr = (format == 0x00) ? addr_PSMCT32(block, width, x, y) : addr_PSMCT32Z(block, width, x, y);
+            const uint8_t* row = &local_mem[addr];
+            __m128i lo = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)row),
+                                            _mm_loadl_epi64((const __m128i*)(row + 16)));
+            __m128i hi = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(row + 32)),
+                                            _mm_loadl_epi64((const __m128i*)(row + 48)));
+            _mm_storeu_si128((__m128i*)dest, lo);
+            _mm_storeu_si128((__m128i*)(dest + 16), hi);
             break;
-        case 1: //Line
-            if (num_vertices == 2)
-            {
-                num_vertices = 0;
-                request_draw_kick = true;
-            }
+        }
+        case 0x02:
+        case 0x0A:
+        case 0x32:
+        case 0x3A:
+        {
+            uint32_t addr;
+            if (format == 0x02)
+                addr = addr_PSMCT16(block, width, x, y);
+            else if (format == 0x0A)
+                addr = addr_PSMCT16S(block, width, x, y);
+            else if (format == 0x32)
+                addr = addr_PSMCT16Z(block, width, x, y);
+            else
+                addr = addr_PSMCT16SZ(block, width, x, y);
+
+            //Halfwords are interleaved as 0, 8, 1, 9, 2, 10...
+            const uint8_t* row = &local_mem[addr];
+            __m128i a = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)row),
+                                           _mm_loadl_epi64((const __m128i*)(row + 16)));
+            __m128i b = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)(row + 32)),
+                                           _mm_loadl_epi64((const __m128i*)(row + 48)));
+            a = _mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 1, 2, 0));
+            a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3, 1, 2, 0));
+            a = _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm_shufflelo_epi16(b, _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm_shufflehi_epi16(b, _MM_SHUFFLE(3, 1, 2, 0));
+            b = _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_storeu_si128((__m128i*)dest, _mm_unpacklo_epi64(a, b));
+            _mm_storeu_si128((__m128i*)(dest + 16), _mm_unpackhi_epi64(a, b));
             break;
-        case 2: //LineStrip
-            if (num_vertices == 2)
-            {
-                num_vertices--;
-                request_draw_kick = true;
-            }
+        }
+        case 0x13:
+        {
+            uint32_t addr = addr_PSMCT8(block, width, x, y);
+            const uint8_t* columns = columnTable8[y & 0xF];
+            for (int i = 0; i < 16; i++)
+                dest[i] = local_mem[(addr + columns[i] - columns[0]) & 0x003FFFFF];
             break;
-        case 3: //Triangle
-            if (num_vertices == 3)
+        }
+        case 0x14:
+        {
+            uint32_t addr = addr_PSMCT4(block, width, x, y);
+            const uint16_t* columns = columnTable4[y & 0xF];
+            for (int i = 0; i < 32; i += 2)
             {
-                num_vertices = 0;
-                request_draw_kick = true;
+                uint32_t addr_lo = (addr + columns[i] - columns[0]) & 0x007FFFFF;
+                uint32_t addr_hi = (addr + columns[i + 1] - columns[0]) & 0x007FFFFF;
+                uint8_t lo = (local_mem[addr_lo >> 1] >> ((addr_lo & 1) << 2)) & 0xF;
+                uint8_t hi = (local_mem[addr_hi >> 1] >> ((addr_hi & 1) << 2)) & 0xF;
+                dest[i >> 1] = (uint8_t)(lo | (hi << 4));
             }
             break;
-        case 4: //TriangleStrip
-            if (num_vertices == 3)
-            {
-                num_vertices--;
-                request_draw_kick = true;
-            }
+        }
+        default:
+            Errors::die("[GS_t] No block row kernel for format $%02X", format);
+    }
+}
+
+void GraphicsSynthesizerThread::write_block_row(uint8_t format, uint32_t base, uint32_t width, uint32_t x, uint32_t y,
+                                                const uint8_t* src)
+{
+    uint32_t block = base / 256;
+    width /= 64;
+
+    switch (format)
+    {
+        case 0x00:
+        case 0x30:
+        {
+            uint32_t addr = (format == 0x00) ? addr_PSMCT32(block, width, x, y) : addr_PSMCT32Z(block, width, x, y);
+            uint8_t* row = &local_mem[addr];
+            __m128i lo = _mm_loadu_si128((const __m128i*)src);
+            __m128i hi = _mm_loadu_si128((const __m128i*)(src + 16));
+            _mm_storel_epi64((__m128i*)row, lo);
+            _mm_storel_epi64((__m128i*)(row + 16), _mm_srli_si128(lo, 8));
+            _mm_storel_epi64((__m128i*)(row + 32), hi);
+            _mm_storel_epi64((__m128i*)(row + 48), _mm_srli_si128(hi, 8));
+            break;
+        }
+        case 0x02:
+        case 0x0A:
+        case 0x32:
+        case 0x3A:
+        {
+            uint32_t addr;
+            if (format == 0x02)
+                addr = addr_PSMCT16(block, width, x, y);
+            else if (format == 0x0A)
+                addr = addr_PSMCT16S(block, width, x, y);
+            else if (format == 0x32)
+                addr = addr_PSMCT16Z(block, width, x, y);
+            else
+                addr = addr_PSMCT16SZ(block, width, x, y);
+
+            uint8_t* row = &local_mem[addr];
+            __m128i lo = _mm_loadu_si128((const __m128i*)src);
+            __m128i hi = _mm_loadu_si128((const __m128i*)(src + 16));
+            __m128i a = _mm_unpacklo_epi16(lo, hi);
+            __m128i b = _mm_unpackhi_epi16(lo, hi);
+            _mm_storel_epi64((__m128i*)row, a);
+            _mm_storel_epi64((__m128i*)(row + 16), _mm_srli_si128(a, 8));
+            _mm_storel_epi64((__m128i*)(row + 32), b);
+            _mm_storel_epi64((__m128i*)(row + 48), _mm_srli_si128(b, 8));
+            break;
+        }
+        case 0x13:
+        {
+            uint32_t addr = addr_PSMCT8(block, width, x, y);
+            const uint8_t* columns = columnTable8[y & 0xF];
+            for (int i = 0; i < 16; i++)
+                local_mem[(addr + columns[i] - columns[0]) & 0x003FFFFF] = src[i];
+            break;
+        }
+        case 0x14:
+        {
+            uint32_t addr = addr_PSMCT4(block, width, x, y);
+            const uint16_t* columns = columnTable4[y & 0xF];
+            for (int i = 0; i < 32; i++)
+            {
+                uint32_t pixel_addr = (addr + columns[i] - columns[0]) & 0x007FFFFF;
+                uint8_t value = (src[i >> 1] >> ((i & 1) << 2)) & 0xF;
+                int shift = (pixel_addr & 1) << 2;
+                pixel_addr >>= 1;
+                local_mem[pixel_addr] = (uint8_t)((local_mem[pixel_addr] & (0xf0 >> shift)) | (value << shift));
+            }
+            break;
+        }
+        default:
+            Errors::die("[GS_t] No block row kernel for format $%02X", format);
+    }
+}
+
+//The "vertex kick" is the name given to the process of placing a vertex in the vertex queue.
+//If drawing_kick is true, and enough vertices are available, then the polygon is rendered.
+void GraphicsSynthesizerThread::vertex_kick(bool drawing_kick)
+{
+    for (int i = num_vertices; i > 0; i--)
+        vtx_queue[i] = vtx_queue[i - 1];
+    current_vtx.rgbaq = RGBAQ;
+    current_vtx.uv = UV;
+    current_vtx.s = ST.s;
+    current_vtx.t = ST.t;
+    current_vtx.fog = (uint8_t)FOG;
+    vtx_queue[0] = current_vtx;
+    //printf("Vkick: (%d, %d, %d)\n", current_vtx.x, current_vtx.y, current_vtx.z);
+
+    num_vertices++;
+    bool request_draw_kick = false;
+    switch (prim_type)
+    {
+        case 0: //Point
+            num_vertices--;
+            request_draw_kick = true;
+            break;
+        case 1: //Line
+            if (num_vertices == 2)
+            {
+                num_vertices = 0;
+                request_draw_kick = true;
+            }
+            break;
+        case 2: //LineStrip
+            if (num_vertices == 2)
+            {
+                num_vertices--;
+                request_draw_kick = true;
+            }
+            break;
+        case 3: //Triangle
+            if (num_vertices == 3)
+            {
+                num_vertices = 0;
+                request_draw_kick = true;
+            }
+            break;
+        case 4: //TriangleStrip
+            if (num_vertices == 3)
+            {
+                num_vertices--;
+                request_draw_kick = true;
+            }
             break;
         case 5: //TriangleFan
             if (num_vertices == 3)
@@ -1468,10 +1478,12 @@ void GraphicsSynthesizerThread::vertex_kick(bool drawing_kick)
 
 void GraphicsSynthesizerThread::render_primitive()
 {
-    // ignore nop draw
-    if (current_ctx->scissor.empty())
+    // ignore nop draw, and everything in a frame that's being skipped
+    if (skip_draws || current_ctx->scissor.empty())
         return;
 
+    last_draw_state.store(draw_pixel_state, std::memory_order_relaxed);
+
 #ifdef GS_JIT
     jit_draw_pixel_func = get_jitted_draw_pixel(draw_pixel_state);
     //No need to recompile tex_lookup if texture mapping is disabled. TEX0 can contain bad data
@@ -2001,8 +2013,8 @@ void GraphicsSynthesizerThread::render_point()
     if (v1.x < current_ctx->scissor.x1 || v1.x > current_ctx->scissor.x2 ||
         v1.y < current_ctx->scissor.y1 || v1.y > current_ctx->scissor.y2)
         return;
-    printf("[GS_t] Rendering point!\n");
-    printf("Coords: (%d, %d, %d)\n", v1.x >> 4, v1.y >> 4, v1.z);
+    TRACE_DEBUG(Trace::GS, "[GS_t] Rendering point!\n");
+    TRACE_DEBUG(Trace::GS, "Coords: (%d, %d, %d)\n", v1.x >> 4, v1.y >> 4, v1.z);
     TexLookupInfo tex_info;
     tex_info.new_lookup = true;
     
@@ -2052,7 +2064,7 @@ void GraphicsSynthesizerThread::render_point()
 
 void GraphicsSynthesizerThread::render_line()
 {
-    printf("[GS_t] Rendering line!\n");
+    TRACE_DEBUG(Trace::GS, "[GS_t] Rendering line!\n");
     Vertex v1 = vtx_queue[1]; v1.to_relative(current_ctx->xyoffset);
     Vertex v2 = vtx_queue[0]; v2.to_relative(current_ctx->xyoffset);
 
@@ -2069,7 +2081,7 @@ void GraphicsSynthesizerThread::render_line()
         swap(v1.x, v1.y);
         swap(v2.x, v2.y);
         is_steep = true;
-        printf("Steep\n");
+        TRACE_DEBUG(Trace::GS, "Steep\n");
         min_x = min_y;
         max_x = max_y;
     }
@@ -2089,7 +2101,7 @@ void GraphicsSynthesizerThread::render_line()
     tex_info.tex_height = current_ctx->tex0.tex_height;
     float q = vtx_queue[0].rgbaq.q;
 
-    printf("Coords: (%d, %d, %d) (%d, %d, %d)\n", v1.x >> 4, v1.y >> 4, v1.z, v2.x >> 4, v2.y >> 4, v2.z);
+    TRACE_DEBUG(Trace::GS, "Coords: (%d, %d, %d) (%d, %d, %d)\n", v1.x >> 4, v1.y >> 4, v1.z, v2.x >> 4, v2.y >> 4, v2.z);
 
     for (int32_t x = min_x; x < max_x; x += 0x10)
     {
@@ -2548,7 +2560,7 @@ void GraphicsSynthesizerThread::render_half_triangle(float x0, float x1, int y0,
 
 void GraphicsSynthesizerThread::render_triangle()
 {
-    printf("[GS_t] Rendering triangle!\n");
+    TRACE_DEBUG(Trace::GS, "[GS_t] Rendering triangle!\n");
 
     Vertex v1 = vtx_queue[2]; v1.to_relative(current_ctx->xyoffset);
     Vertex v2 = vtx_queue[1]; v2.to_relative(current_ctx->xyoffset);
@@ -2794,7 +2806,7 @@ void GraphicsSynthesizerThread::render_triangle()
 
 void GraphicsSynthesizerThread::render_sprite()
 {
-    printf("[GS_t] Rendering sprite!\n");
+    TRACE_DEBUG(Trace::GS, "[GS_t] Rendering sprite!\n");
     Vertex v1 = vtx_queue[1]; v1.to_relative(current_ctx->xyoffset);
     Vertex v2 = vtx_queue[0]; v2.to_relative(current_ctx->xyoffset);
     TexLookupInfo tex_info;
@@ -2808,78 +2820,702 @@ void GraphicsSynthesizerThread::render_sprite()
 
     calculate_LOD(tex_info);
 
-    //Automatic scissoring test
-    const int32_t min_y = ((std::max(std::min(v1.y, v2.y), (int32_t)current_ctx->scissor.y1) + 8) >> 4) << 4;
-    const int32_t min_x = ((std::max(std::min(v1.x, v2.x), (int32_t)current_ctx->scissor.x1) + 8) >> 4) << 4;
-    const int32_t max_y = ((std::min(std::max(v1.y, v2.y), (int32_t)current_ctx->scissor.y2 + 0x10) + 8) >> 4) << 4;
-    const int32_t max_x = ((std::min(std::max(v1.x, v2.x), (int32_t)current_ctx->scissor.x2 + 0x10) + 8) >> 4) << 4;
+    //Automatic scissoring test
+    const int32_t min_y = ((std::max(std::min(v1.y, v2.y), (int32_t)current_ctx->scissor.y1) + 8) >> 4) << 4;
+    const int32_t min_x = ((std::max(std::min(v1.x, v2.x), (int32_t)current_ctx->scissor.x1) + 8) >> 4) << 4;
+    const int32_t max_y = ((std::min(std::max(v1.y, v2.y), (int32_t)current_ctx->scissor.y2 + 0x10) + 8) >> 4) << 4;
+    const int32_t max_x = ((std::min(std::max(v1.x, v2.x), (int32_t)current_ctx->scissor.x2 + 0x10) + 8) >> 4) << 4;
+
+    TRACE_DEBUG(Trace::GS, "Coords: (%d, %d) (%d, %d)\n", min_x >> 4, min_y >> 4, max_x >> 4, max_y >> 4);
+
+    float pix_t = interpolate_f(min_y, v1.t, v1.y, v2.t, v2.y);
+    int32_t pix_v = (int32_t)interpolate(min_y, v1.uv.v, v1.y, v2.uv.v, v2.y) << 16;
+    float pix_s_init = interpolate_f(min_x, v1.s, v1.x, v2.s, v2.x);
+    int32_t pix_u_init = (int32_t)interpolate(min_x, v1.uv.u, v1.x, v2.uv.u, v2.x) << 16;
+
+    float pix_t_step = stepsize(v1.t, v1.y, v2.t, v2.y, 0x10);
+    int32_t pix_v_step = stepsize((int32_t)v1.uv.v, v1.y, (int32_t)v2.uv.v, v2.y, 0x100000);
+    float pix_s_step = stepsize(v1.s, v1.x, v2.s, v2.x, 0x10);
+    int32_t pix_u_step = stepsize((int32_t)v1.uv.u, v1.x, (int32_t)v2.uv.u, v2.x, 0x100000);
+
+    bool tmp_tex = current_PRMODE->texture_mapping;
+    bool tmp_st = !current_PRMODE->use_UV;//allow for loop unswitching
+
+    //Common sprites are drawn a row at a time: texels are fetched in row order and the
+    //framebuffer is updated one block row at a time
+    if (sprite_spans && min_x < max_x && can_draw_sprite_span(tex_info, max_x >> 4, max_y >> 4))
+    {
+#ifdef GS_JIT
+        jit_sprite_row_func = (GSSpriteRowFunc)get_jitted_sprite_row(draw_pixel_state);
+#endif
+        const int32_t x_start = min_x >> 4;
+        const int32_t x_end = max_x >> 4;
+        const int32_t count = x_end - x_start;
+        int16_t (*row)[4] = &sprite_colors[x_start & (block_row_width(current_ctx->frame.format) - 1)];
+
+        if (!tmp_tex)
+        {
+            for (int32_t i = 0; i < count; i++)
+            {
+                row[i][0] = tex_info.vtx_color.r;
+                row[i][1] = tex_info.vtx_color.g;
+                row[i][2] = tex_info.vtx_color.b;
+                row[i][3] = tex_info.vtx_color.a;
+            }
+        }
+
+        tex_info.fog = v2.fog;
+        for (int32_t y = min_y; y < max_y; y += 0x10)
+        {
+            //SCANMSK prohibits drawing on even or odd y-coordinates
+            bool masked = (SCANMSK == 2 && !((y >> 4) & 0x1)) || (SCANMSK == 3 && ((y >> 4) & 0x1));
+            if (tmp_tex && !masked)
+            {
+                float pix_s = pix_s_init;
+                int32_t pix_u = pix_u_init;
+                int16_t last_u = 0, last_v = 0;
+                uint32_t texel = 0;
+                for (int32_t i = 0; i < count; i++)
+                {
+                    int16_t u, v;
+                    if (tmp_st)
+                    {
+                        pix_v = (uint32_t)(((pix_t / v2.rgbaq.q) * tex_info.tex_height) * 16.0);
+                        pix_u = (uint32_t)(((pix_s / v2.rgbaq.q) * tex_info.tex_width) * 16.0);
+                        u = (int16_t)pix_u;
+                        v = (int16_t)pix_v;
+                    }
+                    else
+                    {
+                        u = (int16_t)(pix_u >> 16) >> tex_info.mipmap_level;
+                        v = (int16_t)(pix_v >> 16) >> tex_info.mipmap_level;
+                    }
+                    u >>= 4;
+                    v >>= 4;
+                    wrap_tex_coords(u, v, tex_info);
+
+                    //Scaled sprites repeat texels along the row
+                    if (!i || u != last_u || v != last_v)
+                        texel = read_texel(u, v, tex_info);
+                    last_u = u;
+                    last_v = v;
+
+                    row[i][0] = texel & 0xFF;
+                    row[i][1] = (texel >> 8) & 0xFF;
+                    row[i][2] = (texel >> 16) & 0xFF;
+                    row[i][3] = texel >> 24;
+
+                    pix_s += pix_s_step;
+                    pix_u += pix_u_step;
+                }
+                shade_sprite_texels(row, count, tex_info);
+            }
+
+            if (!masked)
+                draw_sprite_row(y >> 4, x_start, x_end, v2.z);
+
+            pix_t += pix_t_step;
+            pix_v += pix_v_step;
+        }
+        return;
+    }
+
+    for (int32_t y = min_y; y < max_y; y += 0x10)
+    {
+        float pix_s = pix_s_init;
+        int32_t pix_u = pix_u_init;
+        for (int32_t x = min_x; x < max_x; x += 0x10)
+        {
+            if (tmp_tex)
+            {
+                tex_info.fog = v2.fog;
+                if (tmp_st)
+                {
+                    pix_v = (uint32_t)(((pix_t / v2.rgbaq.q) * tex_info.tex_height) * 16.0);
+                    pix_u = (uint32_t)(((pix_s / v2.rgbaq.q) * tex_info.tex_width) * 16.0);
+#ifdef GS_JIT
+                    jit_tex_lookup_prologue((int16_t)pix_u, (int16_t)pix_v, &tex_info);
+#else
+                    tex_lookup(pix_u, pix_v, tex_info);
+#endif
+                }
+                else
+                {
+#ifdef GS_JIT
+                    jit_tex_lookup_prologue((int16_t)(pix_u >> 16), (int16_t)(pix_v >> 16), &tex_info);
+#else
+                    tex_lookup(pix_u >> 16, pix_v >> 16, tex_info);
+#endif
+                }
+
+#ifdef GS_JIT
+                jit_draw_pixel_prologue(x, y, v2.z, tex_info.tex_color);
+#else
+                draw_pixel(x, y, v2.z, tex_info.tex_color);
+#endif
+            }
+            else
+            {
+#ifdef GS_JIT
+                jit_draw_pixel_prologue(x, y, v2.z, tex_info.vtx_color);
+#else
+                draw_pixel(x, y, v2.z, tex_info.vtx_color);
+#endif
+            }
+            pix_s += pix_s_step;
+            pix_u += pix_u_step;
+        }
+        pix_t += pix_t_step;
+        pix_v += pix_v_step;
+    }
+}
+
+//Conservative range of 8KB pages a buffer can touch within [0, max_x) x [0, max_y)
+static void buffer_page_range(uint32_t base, uint32_t width, uint8_t format, uint32_t max_x, uint32_t max_y,
+                              uint32_t& first, uint32_t& last)
+{
+    uint32_t page_width = 64, page_height = 32;
+    uint32_t row_pages = width / 64;
+    switch (format)
+    {
+        case 0x02:
+        case 0x0A:
+        case 0x32:
+        case 0x3A:
+            page_height = 64;
+            break;
+        case 0x13:
+            page_width = 128;
+            page_height = 64;
+            row_pages = width / 128;
+            break;
+        case 0x14:
+            page_width = 128;
+            page_height = 128;
+            row_pages = width / 128;
+            break;
+    }
+
+    uint32_t cols = std::max((max_x + page_width - 1) / page_width, 1U);
+    uint32_t rows = std::max((max_y + page_height - 1) / page_height, 1U);
+
+    //The base need not be page aligned, so the last page may spill into the next one
+    first = base / 8192;
+    last = first + (rows - 1) * row_pages + cols;
+}
+
+static bool pages_overlap(uint32_t a_first, uint32_t a_last, uint32_t b_first, uint32_t b_last)
+{
+    //Anything wrapping around the end of local memory is treated as overlapping
+    if (a_last >= 512 || b_last >= 512)
+        return true;
+    return a_first <= b_last && b_first <= a_last;
+}
+
+static uint8_t zbuf_row_format(uint8_t format)
+{
+    //PSMZ24 shares the PSMZ32 layout; the upper byte is preserved on writes
+    return (format == 0x31) ? 0x30 : format;
+}
+
+bool GraphicsSynthesizerThread::can_draw_sprite_span(const TexLookupInfo& info, int32_t max_x, int32_t max_y)
+{
+    const TEST& test = current_ctx->test;
+    const uint8_t frame_format = current_ctx->frame.format;
+
+    switch (frame_format)
+    {
+        case 0x00:
+        case 0x02:
+        case 0x0A:
+        case 0x30:
+        case 0x32:
+        case 0x3A:
+            break;
+        default:
+            return false;
+    }
+
+    if (test.dest_alpha_test)
+        return false;
+
+    //RGB_ONLY needs a per-pixel alpha source, leave it to draw_pixel
+    if (test.alpha_test && test.alpha_method != 1 && test.alpha_fail_method == 3)
+        return false;
+
+    bool uses_zbuf = false;
+    if (test.depth_test)
+    {
+        if (test.depth_method == 0)
+            return false;
+        uses_zbuf = test.depth_method != 1 || !current_ctx->zbuf.no_update;
+    }
+
+    const uint8_t z_format = zbuf_row_format(current_ctx->zbuf.format);
+    if (uses_zbuf && block_row_width(z_format) != block_row_width(frame_format))
+        return false;
+
+    //Pixels of a row are read and written together, so buffers feeding each other must take the slow path
+    uint32_t frame_first, frame_last, z_first = 0, z_last = 0;
+    buffer_page_range(current_ctx->frame.base_pointer, current_ctx->frame.width, frame_format,
+                      max_x, max_y, frame_first, frame_last);
+    if (uses_zbuf)
+    {
+        buffer_page_range(current_ctx->zbuf.base_pointer, current_ctx->frame.width, z_format,
+                          max_x, max_y, z_first, z_last);
+        if (pages_overlap(frame_first, frame_last, z_first, z_last))
+            return false;
+    }
+
+    if (current_PRMODE->texture_mapping)
+    {
+        if (uses_bilinear_filter(info))
+            return false;
+
+        const CLAMP& clamp = current_ctx->clamp;
+        uint32_t tex_x, tex_y;
+        if (clamp.wrap_s < 2)
+            tex_x = info.tex_width;
+        else if (clamp.wrap_s == 2)
+            tex_x = (std::max(clamp.min_u, clamp.max_u) >> info.mipmap_level) + 1;
+        else
+            tex_x = ((clamp.min_u | clamp.max_u) >> info.mipmap_level) + 1;
+
+        if (clamp.wrap_t < 2)
+            tex_y = info.tex_height;
+        else if (clamp.wrap_t == 2)
+            tex_y = (std::max(clamp.min_v, clamp.max_v) >> info.mipmap_level) + 1;
+        else
+            tex_y = ((clamp.min_v | clamp.max_v) >> info.mipmap_level) + 1;
+
+        uint32_t tex_first, tex_last;
+        buffer_page_range(info.tex_base, info.buffer_width, current_ctx->tex0.format, tex_x, tex_y, tex_first, tex_last);
+        if (pages_overlap(tex_first, tex_last, frame_first, frame_last))
+            return false;
+        if (uses_zbuf && pages_overlap(tex_first, tex_last, z_first, z_last))
+            return false;
+    }
+
+    return true;
+}
+
+//Applies the texture function and fog to a row of texels, two pixels at a time
+void GraphicsSynthesizerThread::shade_sprite_texels(int16_t (*row)[4], int count, const TexLookupInfo& info)
+{
+    const RGBAQ_REG& vtx = info.vtx_color;
+    const __m128i vtx_color = _mm_set_epi16(vtx.a, vtx.b, vtx.g, vtx.r, vtx.a, vtx.b, vtx.g, vtx.r);
+    const __m128i highlight = _mm_set_epi16(0, vtx.a, vtx.a, vtx.a, 0, vtx.a, vtx.a, vtx.a);
+    const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    const __m128i max_color = _mm_set1_epi16(0xFF);
+
+    const uint16_t fog = info.fog;
+    const uint16_t fog2 = 0xFF - info.fog;
+    const __m128i fog_factor = _mm_set1_epi16(fog);
+    const __m128i fog_color = _mm_set_epi16(0, (fog2 * FOGCOL.b) >> 8, (fog2 * FOGCOL.g) >> 8, (fog2 * FOGCOL.r) >> 8,
+                                            0, (fog2 * FOGCOL.b) >> 8, (fog2 * FOGCOL.g) >> 8, (fog2 * FOGCOL.r) >> 8);
+
+    const bool use_alpha = current_ctx->tex0.use_alpha;
+    const uint8_t color_function = current_ctx->tex0.color_function;
+    const bool use_fog = current_PRMODE->fog;
+
+    for (int i = 0; i < count; i += 2)
+    {
+        __m128i tex = _mm_loadu_si128((const __m128i*)row[i]);
+
+        //Texels and vertex colors are 8-bit, so the product fits in an unsigned 16-bit lane.
+        //A vertex color of 0x80 leaves the texel untouched, as multiply_tex_color does.
+        __m128i product = _mm_min_epi16(_mm_srli_epi16(_mm_mullo_epi16(tex, vtx_color), 7), max_color);
+
+        __m128i rgb, alpha;
+        switch (color_function)
+        {
+            case 0: //Modulate
+                rgb = product;
+                alpha = use_alpha ? product : vtx_color;
+                break;
+            case 1: //Decal
+                rgb = tex;
+                alpha = use_alpha ? tex : vtx_color;
+                break;
+            case 2: //Highlight
+                //Saturates like the texture lookup JIT, so every color written is 8-bit
+                rgb = _mm_min_epi16(_mm_add_epi16(product, highlight), max_color);
+                alpha = use_alpha ? _mm_min_epi16(_mm_add_epi16(tex, vtx_color), max_color) : vtx_color;
+                break;
+            default: //Highlight2
+                rgb = _mm_min_epi16(_mm_add_epi16(product, highlight), max_color);
+                alpha = use_alpha ? tex : vtx_color;
+                break;
+        }
+
+        if (use_fog)
+        {
+            rgb = _mm_srli_epi16(_mm_mullo_epi16(rgb, fog_factor), 8);
+            rgb = _mm_add_epi16(rgb, fog_color);
+        }
+
+        __m128i color = _mm_or_si128(_mm_andnot_si128(alpha_lanes, rgb), _mm_and_si128(alpha_lanes, alpha));
+        _mm_storeu_si128((__m128i*)row[i], color);
+    }
+}
+
+//Expands a row of PSMCT16 pixels into RGBA32 the way lookup_frame_color does
+static void expand_16bit_row(const uint16_t* in, uint32_t* out, int count)
+{
+    const __m128i five_bits = _mm_set1_epi16(0x1F);
+    for (int i = 0; i < count; i += 8)
+    {
+        __m128i c = _mm_loadu_si128((const __m128i*)&in[i]);
+        __m128i r = _mm_slli_epi16(_mm_and_si128(c, five_bits), 3);
+        __m128i g = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(c, 5), five_bits), 3);
+        __m128i b = _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(c, 10), five_bits), 3);
+        __m128i a = _mm_slli_epi16(_mm_srli_epi16(c, 15), 7);
+        __m128i rg = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+        __m128i ba = _mm_or_si128(b, _mm_slli_epi16(a, 8));
+        _mm_storeu_si128((__m128i*)&out[i], _mm_unpacklo_epi16(rg, ba));
+        _mm_storeu_si128((__m128i*)&out[i + 4], _mm_unpackhi_epi16(rg, ba));
+    }
+}
+
+//Inverse of expand_16bit_row, matching convert_color_down
+static void pack_16bit_row(const uint32_t* in, uint16_t* out, int count)
+{
+    const __m128i five_bits = _mm_set1_epi32(0x1F);
+    for (int i = 0; i < count; i += 8)
+    {
+        __m128i packed[2];
+        for (int j = 0; j < 2; j++)
+        {
+            __m128i c = _mm_loadu_si128((const __m128i*)&in[i + j * 4]);
+            __m128i r = _mm_and_si128(_mm_srli_epi32(c, 3), five_bits);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(c, 11), five_bits);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(c, 19), five_bits);
+            __m128i a = _mm_srli_epi32(c, 31);
+            __m128i color = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 5)),
+                                         _mm_or_si128(_mm_slli_epi32(b, 10), _mm_slli_epi32(a, 15)));
+
+            //Sign extend so the saturating pack keeps the top bit
+            packed[j] = _mm_srai_epi32(_mm_slli_epi32(color, 16), 16);
+        }
+        _mm_storeu_si128((__m128i*)&out[i], _mm_packs_epi32(packed[0], packed[1]));
+    }
+}
+
+void GraphicsSynthesizerThread::draw_sprite_row(int32_t y, int32_t x_start, int32_t x_end, uint32_t z)
+{
+    const TEST& test = current_ctx->test;
+    const uint8_t frame_format = current_ctx->frame.format;
+    const uint8_t z_format = zbuf_row_format(current_ctx->zbuf.format);
+    const uint32_t width = current_ctx->frame.width;
+    const int row_width = block_row_width(frame_format);
+    const bool frame_16bit = row_width == 16;
+    const int32_t first_x = x_start & ~(row_width - 1);
+
+    const bool read_z = test.depth_test && test.depth_method != 1;
+    const bool write_z = test.depth_test && !current_ctx->zbuf.no_update;
+    if (current_ctx->zbuf.format == 0x31)
+        z = std::min(z, 0xFFFFFFU);
+    else if (row_width == 16)
+        z = std::min(z, 0xFFFFU);
+
+    //Dither offsets for the two pixel pairs of every group of four, RGB lanes only
+    int16_t dither[2][8];
+    for (int i = 0; i < 4; i++)
+    {
+        uint8_t value = dither_mtx[y % 4][i];
+        int16_t amount = (value & 0x4) ? -((value & 0x3) + 1) : (value & 0x3);
+        int16_t* lanes = &dither[i >> 1][(i & 1) * 4];
+        lanes[0] = lanes[1] = lanes[2] = amount;
+        lanes[3] = 0;
+    }
+
+    uint32_t frame_row[16], z_row[16], colors[16];
+    bool update_frame[32], update_z[32];
+
+    for (int32_t x = first_x; x < x_end; x += row_width)
+    {
+        const int16_t (*src)[4] = &sprite_colors[x - first_x];
+        bool any_frame = false, any_z = false;
+
+        if (read_z || write_z)
+            read_block_row(z_format, current_ctx->zbuf.base_pointer, width, x, y, (uint8_t*)z_row);
+
+        for (int i = 0; i < row_width; i++)
+        {
+            bool inside = x + i >= x_start && x + i < x_end;
+            bool frame_lane = inside;
+            bool z_lane = inside && write_z;
+
+            if (inside && test.alpha_test)
+            {
+                int16_t alpha = src[i][3];
+                bool pass = true;
+                switch (test.alpha_method)
+                {
+                    case 0:
+                        pass = false;
+                        break;
+                    case 2:
+                        pass = alpha < test.alpha_ref;
+                        break;
+                    case 3:
+                        pass = alpha <= test.alpha_ref;
+                        break;
+                    case 4:
+                        pass = alpha == test.alpha_ref;
+                        break;
+                    case 5:
+                        pass = alpha >= test.alpha_ref;
+                        break;
+                    case 6:
+                        pass = alpha > test.alpha_ref;
+                        break;
+                    case 7:
+                        pass = alpha != test.alpha_ref;
+                        break;
+                }
+
+                if (!pass)
+                {
+                    switch (test.alpha_fail_method)
+                    {
+                        case 0:
+                            frame_lane = z_lane = false;
+                            break;
+                        case 1:
+                            z_lane = false;
+                            break;
+                        case 2:
+                            frame_lane = false;
+                            break;
+                    }
+                }
+            }
+
+            if (inside && read_z && (frame_lane || z_lane))
+            {
+                uint32_t old_z;
+                if (row_width == 16)
+                    old_z = ((uint16_t*)z_row)[i];
+                else if (current_ctx->zbuf.format == 0x31)
+                    old_z = z_row[i] & 0xFFFFFF;
+                else
+                    old_z = z_row[i];
+
+                bool pass = (test.depth_method == 2) ? z >= old_z : z > old_z;
+                if (!pass)
+                    frame_lane = z_lane = false;
+            }
+
+            update_frame[i] = frame_lane;
+            update_z[i] = z_lane;
+            any_frame |= frame_lane;
+            any_z |= z_lane;
+        }
+
+        if (any_frame)
+        {
+            read_block_row(frame_format, current_ctx->frame.base_pointer, width, x, y, (uint8_t*)frame_row);
+            if (frame_16bit)
+                expand_16bit_row((uint16_t*)frame_row, colors, row_width);
+            else
+                memcpy(colors, frame_row, sizeof(uint32_t) * row_width);
+
+#ifdef GS_JIT
+            jit_sprite_row_func(&src[0][0], colors, &dither[0][0]);
+#else
+            blend_sprite_block_row(&src[0][0], colors, &dither[0][0]);
+#endif
+
+            if (frame_16bit)
+            {
+                uint16_t packed[16];
+                pack_16bit_row(colors, packed, row_width);
+                for (int i = 0; i < row_width; i++)
+                {
+                    if (update_frame[i])
+                        ((uint16_t*)frame_row)[i] = packed[i];
+                }
+            }
+            else
+            {
+                for (int i = 0; i < row_width; i++)
+                {
+                    if (update_frame[i])
+                        frame_row[i] = colors[i];
+                }
+            }
+            write_block_row(frame_format, current_ctx->frame.base_pointer, width, x, y, (uint8_t*)frame_row);
+        }
+
+        if (any_z)
+        {
+            for (int i = 0; i < row_width; i++)
+            {
+                if (!update_z[i])
+                    continue;
+                if (row_width == 16)
+                    ((uint16_t*)z_row)[i] = z;
+                else if (current_ctx->zbuf.format == 0x31)
+                    z_row[i] = (z_row[i] & 0xFF000000) | z;
+                else
+                    z_row[i] = z;
+            }
+            write_block_row(z_format, current_ctx->zbuf.base_pointer, width, x, y, (uint8_t*)z_row);
+        }
+    }
+}
+
+//Per-pixel color pipeline of draw_pixel over one block row: alpha blending, dithering,
+//clamping, FBA and FBMASK. colors holds the framebuffer as RGBA32 on entry and the result on exit.
+void GraphicsSynthesizerThread::blend_sprite_block_row(const int16_t* src, uint32_t* colors, const int16_t* dither)
+{
+    const ALPHA& alpha = current_ctx->alpha;
+    const bool blend = current_PRMODE->alpha_blend;
+    const int count = block_row_width(current_ctx->frame.format);
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    const __m128i alpha_msb = _mm_set_epi16(0x80, 0, 0, 0, 0x80, 0, 0, 0);
+    const __m128i alpha_low = _mm_set_epi16(0xFF, 0, 0, 0, 0xFF, 0, 0, 0);
+    const __m128i fba = current_ctx->FBA ? alpha_msb : zero;
+    const __m128i byte_mask = _mm_set1_epi16(0xFF);
+    const __m128i fixed_alpha = _mm_set1_epi16(alpha.fixed_alpha);
+    const __m128i frame_mask = _mm_set1_epi32(current_ctx->frame.mask);
+
+    for (int i = 0; i < count; i += 4)
+    {
+        __m128i result[2];
+        for (int j = 0; j < 2; j++)
+        {
+            __m128i source = _mm_loadu_si128((const __m128i*)&src[(i + j * 2) * 4]);
+            __m128i color = source;
+
+            if (blend)
+            {
+                __m128i frame = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)&colors[i + j * 2]), zero);
+                __m128i a = (alpha.spec_A == 0) ? source : (alpha.spec_A == 1) ? frame : zero;
+                __m128i b = (alpha.spec_B == 0) ? source : (alpha.spec_B == 1) ? frame : zero;
+                __m128i d = (alpha.spec_D == 0) ? source : (alpha.spec_D == 1) ? frame : zero;
+                __m128i c;
+                if (alpha.spec_C == 0)
+                    c = _mm_shufflehi_epi16(_mm_shufflelo_epi16(source, 0xFF), 0xFF);
+                else if (alpha.spec_C == 1)
+                    c = _mm_shufflehi_epi16(_mm_shufflelo_epi16(frame, 0xFF), 0xFF);
+                else
+                    c = fixed_alpha;
+
+                //((A - B) * C) >> 7 needs 32-bit intermediates
+                __m128i diff = _mm_sub_epi16(a, b);
+                __m128i lo = _mm_mullo_epi16(diff, c);
+                __m128i hi = _mm_mulhi_epi16(diff, c);
+                __m128i product_lo = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 7);
+                __m128i product_hi = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 7);
+                __m128i blended = _mm_add_epi16(_mm_packs_epi32(product_lo, product_hi), d);
+
+                if (PABE)
+                {
+                    //PABE - MSB of source alpha must be set to enable alpha blending
+                    __m128i enabled = _mm_cmpeq_epi16(_mm_and_si128(source, alpha_msb), alpha_msb);
+                    enabled = _mm_shufflehi_epi16(_mm_shufflelo_epi16(enabled, 0xFF), 0xFF);
+                    blended = _mm_or_si128(_mm_and_si128(enabled, blended), _mm_andnot_si128(enabled, source));
+                }
+                color = blended;
+            }
+
+            if (DTHE)
+                color = _mm_add_epi16(color, _mm_loadu_si128((const __m128i*)&dither[j * 8]));
+
+            //Without COLCLAMP only the low 8 bits are kept; the pack below saturates otherwise
+            if (!COLCLAMP)
+                color = _mm_and_si128(color, byte_mask);
+
+            __m128i src_alpha = _mm_or_si128(_mm_and_si128(source, alpha_low), fba);
+            result[j] = _mm_or_si128(_mm_andnot_si128(alpha_lanes, color), src_alpha);
+        }
+
+        __m128i final_color = _mm_packus_epi16(result[0], result[1]);
+        __m128i frame = _mm_loadu_si128((const __m128i*)&colors[i]);
+        final_color = _mm_or_si128(_mm_andnot_si128(frame_mask, final_color), _mm_and_si128(frame_mask, frame));
+        _mm_storeu_si128((__m128i*)&colors[i], final_color);
+    }
+}
+
+bool GraphicsSynthesizerThread::can_stage_HWREG()
+{
+    if (!TRXREG.width || !TRXREG.height)
+        return false;
+
+    switch (BITBLTBUF.dest_format)
+    {
+        case 0x00:
+        case 0x02:
+        case 0x0A:
+        case 0x13:
+        case 0x14:
+            break;
+        default:
+            return false;
+    }
+
+    int row_width = block_row_width(BITBLTBUF.dest_format);
+    if (TRXPOS.int_dest_x % row_width)
+        return false;
 
-    printf("Coords: (%d, %d) (%d, %d)\n", min_x >> 4, min_y >> 4, max_x >> 4, max_y >> 4);
+    return (int)TRXREG.width - (pixels_transferred % TRXREG.width) >= row_width;
+}
 
-    float pix_t = interpolate_f(min_y, v1.t, v1.y, v2.t, v2.y);
-    int32_t pix_v = (int32_t)interpolate(min_y, v1.uv.v, v1.y, v2.uv.v, v2.y) << 16;
-    float pix_s_init = interpolate_f(min_x, v1.s, v1.x, v2.s, v2.x);
-    int32_t pix_u_init = (int32_t)interpolate(min_x, v1.uv.u, v1.x, v2.uv.u, v2.x) << 16;
+void GraphicsSynthesizerThread::write_HWREG(uint64_t data)
+{
+    //Uploads that line up with block rows are staged and swizzled one block row at a time.
+    //Everything else (and unaligned edges) goes through the per-pixel path.
+    if (!hwreg_staged && !can_stage_HWREG())
+    {
+        write_HWREG_pixels(data);
+        return;
+    }
 
-    float pix_t_step = stepsize(v1.t, v1.y, v2.t, v2.y, 0x10);
-    int32_t pix_v_step = stepsize((int32_t)v1.uv.v, v1.y, (int32_t)v2.uv.v, v2.y, 0x100000);
-    float pix_s_step = stepsize(v1.s, v1.x, v2.s, v2.x, 0x10);
-    int32_t pix_u_step = stepsize((int32_t)v1.uv.u, v1.x, (int32_t)v2.uv.u, v2.x, 0x100000);
+    hwreg_staging[hwreg_staged++] = data;
+    if (hwreg_staged * 8 < block_row_bytes(BITBLTBUF.dest_format))
+        return;
 
-    bool tmp_tex = current_PRMODE->texture_mapping;
-    bool tmp_st = !current_PRMODE->use_UV;//allow for loop unswitching
+    int row_width = block_row_width(BITBLTBUF.dest_format);
+    write_block_row(BITBLTBUF.dest_format, BITBLTBUF.dest_base, BITBLTBUF.dest_width,
+                    TRXPOS.int_dest_x, TRXPOS.int_dest_y, (uint8_t*)hwreg_staging);
+    hwreg_staged = 0;
 
-    for (int32_t y = min_y; y < max_y; y += 0x10)
+    pixels_transferred += row_width;
+    TRXPOS.int_dest_x += row_width;
+    if (pixels_transferred % TRXREG.width == 0)
     {
-        float pix_s = pix_s_init;
-        int32_t pix_u = pix_u_init;
-        for (int32_t x = min_x; x < max_x; x += 0x10)
-        {
-            if (tmp_tex)
-            {
-                tex_info.fog = v2.fog;
-                if (tmp_st)
-                {
-                    pix_v = (uint32_t)(((pix_t / v2.rgbaq.q) * tex_info.tex_height) * 16.0);
-                    pix_u = (uint32_t)(((pix_s / v2.rgbaq.q) * tex_info.tex_width) * 16.0);
-#ifdef GS_JIT
-                    jit_tex_lookup_prologue((int16_t)pix_u, (int16_t)pix_v, &tex_info);
-#else
-                    tex_lookup(pix_u, pix_v, tex_info);
-#endif
-                }
-                else
-                {
-#ifdef GS_JIT
-                    jit_tex_lookup_prologue((int16_t)(pix_u >> 16), (int16_t)(pix_v >> 16), &tex_info);
-#else
-                    tex_lookup(pix_u >> 16, pix_v >> 16, tex_info);
-#endif
-                }
+        TRXPOS.int_dest_x = TRXPOS.dest_x;
+        TRXPOS.int_dest_y++;
+    }
 
-#ifdef GS_JIT
-                jit_draw_pixel_prologue(x, y, v2.z, tex_info.tex_color);
-#else
-                draw_pixel(x, y, v2.z, tex_info.tex_color);
-#endif
-            }
-            else
-            {
-#ifdef GS_JIT
-                jit_draw_pixel_prologue(x, y, v2.z, tex_info.vtx_color);
-#else
-                draw_pixel(x, y, v2.z, tex_info.vtx_color);
-#endif
-            }
-            pix_s += pix_s_step;
-            pix_u += pix_u_step;
-        }
-        pix_t += pix_t_step;
-        pix_v += pix_v_step;
+    //Coordinates wrap at 2048 pixels
+    TRXPOS.int_dest_x %= 2048;
+    TRXPOS.int_dest_y %= 2048;
+
+    int max_pixels = TRXREG.width * TRXREG.height;
+    if (pixels_transferred >= max_pixels)
+    {
+        //Deactivate the transmisssion
+        TRACE_DEBUG(Trace::GS, "[GS_t] HWREG transfer ended\n");
+        TRXDIR = 3;
+        pixels_transferred = 0;
     }
 }
 
-void GraphicsSynthesizerThread::write_HWREG(uint64_t data)
+//A partially staged block row has to be written out before anything else can see local memory
+void GraphicsSynthesizerThread::flush_HWREG_staging()
+{
+    int staged = hwreg_staged;
+    hwreg_staged = 0;
+    for (int i = 0; i < staged; i++)
+        write_HWREG_pixels(hwreg_staging[i]);
+}
+
+void GraphicsSynthesizerThread::write_HWREG_pixels(uint64_t data)
 {
     int ppd = 0; //pixels per doubleword (64-bits)
 
@@ -3057,29 +3693,33 @@ void GraphicsSynthesizerThread::write_HWREG(uint64_t data)
     if (pixels_transferred >= max_pixels)
     {
         //Deactivate the transmisssion
-        printf("[GS_t] HWREG transfer ended\n");
+        TRACE_DEBUG(Trace::GS, "[GS_t] HWREG transfer ended\n");
         TRXDIR = 3;
         pixels_transferred = 0;
     }
 }
 
-uint32_t GraphicsSynthesizerThread::local_to_host(uint128_t *target)
+void GraphicsSynthesizerThread::local_to_host(uint128_t *target, GSDownloadFence* fence)
 {
     int ppd = 0; //pixels per doubleword (64-bits)
     uint32_t return_qwc = 0;
     target[0]._u64[0] = 0;
     target[0]._u64[1] = 0;
-    printf("[GS_t] Local to Host transfer started\n");
+    TRACE_DEBUG(Trace::GS, "[GS_t] Local to Host transfer started\n");
 
     if (TRXDIR == 3)
-        return return_qwc;
+    {
+        fence->complete.store(true, std::memory_order_release);
+        return;
+    }
 
     //Invalid transfer if no height/width has been set
     if (TRXREG.width == 0 || TRXREG.height == 0)
     {
         TRXDIR = 3;
         pixels_transferred = 0;
-        return return_qwc;
+        fence->complete.store(true, std::memory_order_release);
+        return;
     }
 
     switch (BITBLTBUF.source_format)
@@ -3121,9 +3761,34 @@ uint32_t GraphicsSynthesizerThread::local_to_host(uint128_t *target)
     }
    
     int max_pixels = TRXREG.width * TRXREG.height;
+    int row_width = block_row_width(BITBLTBUF.source_format);
 
     while (pixels_transferred < max_pixels)
     {
+        //Whole block rows are unswizzled straight into the download buffer
+        if (row_width && !(TRXPOS.int_source_x % row_width) &&
+            (int)TRXREG.width - (pixels_transferred % TRXREG.width) >= row_width)
+        {
+            read_block_row(BITBLTBUF.source_format, BITBLTBUF.source_base, BITBLTBUF.source_width,
+                           TRXPOS.int_source_x, TRXPOS.int_source_y, (uint8_t*)&target[return_qwc]);
+
+            pixels_transferred += row_width;
+            TRXPOS.int_source_x += row_width;
+            if (pixels_transferred % TRXREG.width == 0)
+            {
+                TRXPOS.int_source_x = TRXPOS.source_x;
+                TRXPOS.int_source_y++;
+            }
+
+            //Coordinates wrap at 2048 pixels
+            TRXPOS.int_source_x %= 2048;
+            TRXPOS.int_source_y %= 2048;
+
+            return_qwc += block_row_bytes(BITBLTBUF.source_format) / 16;
+            fence->quads_written.store(return_qwc, std::memory_order_release);
+            continue;
+        }
+
         uint64_t data = 0;
         for (int datapart = 0; datapart < 2; datapart++)
         {
@@ -3210,14 +3875,17 @@ uint32_t GraphicsSynthesizerThread::local_to_host(uint128_t *target)
             data = 0;
         }
         return_qwc++;
+
+        //Publish each quadword as soon as it's ready so the DMAC can start draining the transfer
+        fence->quads_written.store(return_qwc, std::memory_order_release);
     }
 
     //Deactivate the transmisssion
-    printf("[GS_t] Local to Host transfer ended\n");
+    TRACE_DEBUG(Trace::GS, "[GS_t] Local to Host transfer ended\n");
     TRXDIR = 3;
     pixels_transferred = 0;
 
-    return return_qwc;
+    fence->complete.store(true, std::memory_order_release);
 }
 
 void GraphicsSynthesizerThread::unpack_PSMCT24(uint64_t data, int offset, bool z_format)
@@ -3311,10 +3979,10 @@ uint64_t GraphicsSynthesizerThread::pack_PSMCT24(bool z_format)
 
 void GraphicsSynthesizerThread::local_to_local()
 {
-    printf("[GS_t] Local to local transfer\n");
-    printf("(%d, %d) -> (%d, %d)\n", TRXPOS.source_x, TRXPOS.source_y, TRXPOS.dest_x, TRXPOS.dest_y);
-    printf("Trans order: %d\n", TRXPOS.trans_order);
-    printf("Source: $%08X Dest: $%08X\n", BITBLTBUF.source_base, BITBLTBUF.dest_base);
+    TRACE_DEBUG(Trace::GS, "[GS_t] Local to local transfer\n");
+    TRACE_DEBUG(Trace::GS, "(%d, %d) -> (%d, %d)\n", TRXPOS.source_x, TRXPOS.source_y, TRXPOS.dest_x, TRXPOS.dest_y);
+    TRACE_DEBUG(Trace::GS, "Trans order: %d\n", TRXPOS.trans_order);
+    TRACE_DEBUG(Trace::GS, "Source: $%08X Dest: $%08X\n", BITBLTBUF.source_base, BITBLTBUF.dest_base);
     int max_pixels = TRXREG.width * TRXREG.height;
 
     uint16_t dest_start_x = 0, src_start_x = 0;
@@ -3370,8 +4038,47 @@ void GraphicsSynthesizerThread::local_to_local()
             Errors::die("[GS_t] Unrecognized local-to-local transmission order $%02X", TRXPOS.trans_order);
     }
 
+    //Raw copies between formats with the same pixel size can move whole block rows at once
+    int row_width = 0;
+    if (x_step > 0 && block_row_width(BITBLTBUF.source_format) == block_row_width(BITBLTBUF.dest_format) &&
+        block_row_bytes(BITBLTBUF.source_format) == block_row_bytes(BITBLTBUF.dest_format) &&
+        BITBLTBUF.source_format != 0x32 && BITBLTBUF.source_format != 0x3A && BITBLTBUF.dest_format != 0x32)
+    {
+        row_width = block_row_width(BITBLTBUF.source_format);
+    }
+
     while (pixels_transferred < max_pixels)
     {
+        if (row_width && !(TRXPOS.int_source_x % row_width) && !(TRXPOS.int_dest_x % row_width) &&
+            (int)TRXREG.width - (pixels_transferred % TRXREG.width) >= row_width)
+        {
+            uint8_t row[32];
+            read_block_row(BITBLTBUF.source_format, BITBLTBUF.source_base, BITBLTBUF.source_width,
+                           TRXPOS.int_source_x, TRXPOS.int_source_y, row);
+            write_block_row(BITBLTBUF.dest_format, BITBLTBUF.dest_base, BITBLTBUF.dest_width,
+                            TRXPOS.int_dest_x, TRXPOS.int_dest_y, row);
+
+            pixels_transferred += row_width;
+            TRXPOS.int_source_x += row_width;
+            TRXPOS.int_dest_x += row_width;
+
+            if (pixels_transferred % TRXREG.width == 0)
+            {
+                TRXPOS.int_source_x = src_start_x;
+                TRXPOS.int_source_y += y_step;
+
+                TRXPOS.int_dest_x = dest_start_x;
+                TRXPOS.int_dest_y += y_step;
+            }
+
+            //Coordinates wrap at 2048 pixels
+            TRXPOS.int_source_x %= 2048;
+            TRXPOS.int_source_y %= 2048;
+            TRXPOS.int_dest_x %= 2048;
+            TRXPOS.int_dest_y %= 2048;
+            continue;
+        }
+
         uint32_t data;
         switch (BITBLTBUF.source_format)
         {
@@ -3629,10 +4336,20 @@ void GraphicsSynthesizerThread::calculate_LOD(TexLookupInfo &info)
     }
 }
 
-void GraphicsSynthesizerThread::tex_lookup(int16_t u, int16_t v, TexLookupInfo& info)
+bool GraphicsSynthesizerThread::uses_bilinear_filter(const TexLookupInfo& info)
 {
-    bool bilinear_filter = false;
+    if (info.tex_height < 8 || info.tex_width < 8)
+        return false;
+
+    if (current_ctx->tex1.filter_larger && info.LOD < 0.0)
+        return true;
 
+    //Bilinear filtering is used when set to 1 or 4 and above
+    return (current_ctx->tex1.filter_smaller == 0x1 || current_ctx->tex1.filter_smaller >= 4) && info.LOD >= 0.0;
+}
+
+void GraphicsSynthesizerThread::tex_lookup(int16_t u, int16_t v, TexLookupInfo& info)
+{
     //If UV is being used and MIPMAP is enabled, we need to bring down the UV size too
     if (current_PRMODE->use_UV)
     {
@@ -3640,17 +4357,7 @@ void GraphicsSynthesizerThread::tex_lookup(int16_t u, int16_t v, TexLookupInfo&
         v >>= info.mipmap_level;
     }
 
-    if (info.tex_height >= 8 && info.tex_width >= 8)
-    {
-        if (current_ctx->tex1.filter_larger && info.LOD < 0.0)
-            bilinear_filter = true;
-
-        //Bilinear filtering is used when set to 1 or 4 and above
-        if ((current_ctx->tex1.filter_smaller == 0x1 || current_ctx->tex1.filter_smaller >= 4) && info.LOD >= 0.0)
-            bilinear_filter = true;
-    }
-
-    if (bilinear_filter)
+    if (uses_bilinear_filter(info))
     {
         RGBAQ_REG a, b, c, d;
         int16_t uu = (u - 8) >> 4;
@@ -3701,18 +4408,18 @@ void GraphicsSynthesizerThread::tex_lookup(int16_t u, int16_t v, TexLookupInfo&
             info.tex_color.b = info.srctex_color.b;
             break;
         case 2: //Highlight
-            info.tex_color.r = multiply_tex_color(info.srctex_color.r, info.vtx_color.r) + info.vtx_color.a;
-            info.tex_color.g = multiply_tex_color(info.srctex_color.g, info.vtx_color.g) + info.vtx_color.a;
-            info.tex_color.b = multiply_tex_color(info.srctex_color.b, info.vtx_color.b) + info.vtx_color.a;
+            info.tex_color.r = (int16_t)std::min(multiply_tex_color(info.srctex_color.r, info.vtx_color.r) + info.vtx_color.a, 0xFF);
+            info.tex_color.g = (int16_t)std::min(multiply_tex_color(info.srctex_color.g, info.vtx_color.g) + info.vtx_color.a, 0xFF);
+            info.tex_color.b = (int16_t)std::min(multiply_tex_color(info.srctex_color.b, info.vtx_color.b) + info.vtx_color.a, 0xFF);
             if (!current_ctx->tex0.use_alpha)
                 info.tex_color.a = info.vtx_color.a;
             else
-                info.tex_color.a = info.srctex_color.a + info.vtx_color.a;
+                info.tex_color.a = (int16_t)std::min(info.srctex_color.a + info.vtx_color.a, 0xFF);
             break;
         case 3: //Highlight2
-            info.tex_color.r = multiply_tex_color(info.srctex_color.r, info.vtx_color.r) + info.vtx_color.a;
-            info.tex_color.g = multiply_tex_color(info.srctex_color.g, info.vtx_color.g) + info.vtx_color.a;
-            info.tex_color.b = multiply_tex_color(info.srctex_color.b, info.vtx_color.b) + info.vtx_color.a;
+            info.tex_color.r = (int16_t)std::min(multiply_tex_color(info.srctex_color.r, info.vtx_color.r) + info.vtx_color.a, 0xFF);
+            info.tex_color.g = (int16_t)std::min(multiply_tex_color(info.srctex_color.g, info.vtx_color.g) + info.vtx_color.a, 0xFF);
+            info.tex_color.b = (int16_t)std::min(multiply_tex_color(info.srctex_color.b, info.vtx_color.b) + info.vtx_color.a, 0xFF);
             if (!current_ctx->tex0.use_alpha)
                 info.tex_color.a = info.vtx_color.a;
             else
@@ -3733,6 +4440,27 @@ void GraphicsSynthesizerThread::tex_lookup(int16_t u, int16_t v, TexLookupInfo&
 }
 
 void GraphicsSynthesizerThread::tex_lookup_int(int16_t u, int16_t v, TexLookupInfo& info, bool forced_lookup)
+{
+    wrap_tex_coords(u, v, info);
+
+    if (!info.new_lookup && !forced_lookup)
+    {
+        //if it's the same texture position, we already have the info, no need to look it up again
+        if (u == info.lastu && v == info.lastv)
+            return;
+    }
+    info.lastu = u;
+    info.lastv = v;
+    info.new_lookup = forced_lookup; //If we're forcing a lookup, it's bilinear filtering, so the src will get polluted
+
+    uint32_t color = read_texel(u, v, info);
+    info.srctex_color.r = color & 0xFF;
+    info.srctex_color.g = (color >> 8) & 0xFF;
+    info.srctex_color.b = (color >> 16) & 0xFF;
+    info.srctex_color.a = color >> 24;
+}
+
+void GraphicsSynthesizerThread::wrap_tex_coords(int16_t& u, int16_t& v, const TexLookupInfo& info)
 {
     switch (current_ctx->clamp.wrap_s)
     {
@@ -3777,156 +4505,104 @@ void GraphicsSynthesizerThread::tex_lookup_int(int16_t u, int16_t v, TexLookupIn
             v = (v & (current_ctx->clamp.min_v >> info.mipmap_level)) | (current_ctx->clamp.max_v >> info.mipmap_level);
             break;
     }
+}
 
-    if (!info.new_lookup && !forced_lookup)
-    {
-        //if it's the same texture position, we already have the info, no need to look it up again
-        if (u == info.lastu && v == info.lastv)
-            return;
-    }
-    info.lastu = u;
-    info.lastv = v;
-    info.new_lookup = forced_lookup; //If we're forcing a lookup, it's bilinear filtering, so the src will get polluted
-
+//Returns the texel at an already wrapped coordinate in RGBA8 format
+uint32_t GraphicsSynthesizerThread::read_texel(int16_t u, int16_t v, const TexLookupInfo& info)
+{
     uint32_t tex_base = info.tex_base;
     uint32_t width = info.buffer_width;
     switch (current_ctx->tex0.format)
     {
         case 0x00:
-        {
-            uint32_t color = read_PSMCT32_block(tex_base, width, u, v);
-            info.srctex_color.r = color & 0xFF;
-            info.srctex_color.g = (color >> 8) & 0xFF;
-            info.srctex_color.b = (color >> 16) & 0xFF;
-            info.srctex_color.a = color >> 24;
-        }
-            break;
+            return read_PSMCT32_block(tex_base, width, u, v);
         case 0x01:
         {
-            uint32_t color = read_PSMCT32_block(tex_base, width, u, v);
-            info.srctex_color.r = color & 0xFF;
-            info.srctex_color.g = (color >> 8) & 0xFF;
-            info.srctex_color.b = (color >> 16) & 0xFF;
-
-            if (!(color & 0xFFFFFF) && TEXA.trans_black)
-                info.srctex_color.a = 0;
-            else
-                info.srctex_color.a = TEXA.alpha0;
+            uint32_t color = read_PSMCT32_block(tex_base, width, u, v) & 0xFFFFFF;
+            if (!color && TEXA.trans_black)
+                return color;
+            return color | (TEXA.alpha0 << 24);
         }
-            break;
         case 0x02:
         {
             uint16_t color = read_PSMCT16_block(tex_base, width, u, v);
-            info.srctex_color.r = (color & 0x1F) << 3;
-            info.srctex_color.g = ((color >> 5) & 0x1F) << 3;
-            info.srctex_color.b = ((color >> 10) & 0x1F) << 3;
-            info.srctex_color.a = get_16bit_alpha(color);
+            return convert_16bit_texel(color);
         }
-            break;
         case 0x09: //Invalid format??? FFX uses it
-            info.srctex_color.r = 0;
-            info.srctex_color.g = 0;
-            info.srctex_color.b = 0;
-            info.srctex_color.a = 0;
-            break;
+            return 0;
         case 0x0A:
         {
             uint16_t color = read_PSMCT16S_block(tex_base, width, u, v);
-            info.srctex_color.r = (color & 0x1F) << 3;
-            info.srctex_color.g = ((color >> 5) & 0x1F) << 3;
-            info.srctex_color.b = ((color >> 10) & 0x1F) << 3;
-            info.srctex_color.a = get_16bit_alpha(color);
+            return convert_16bit_texel(color);
         }
-            break;
         case 0x13:
         {
             uint8_t entry = read_PSMCT8_block(tex_base, width, u, v);
             if (current_ctx->tex0.use_CSM2)
-                clut_CSM2_lookup(entry, info.srctex_color);
-            else
-                clut_lookup(entry, info.srctex_color);
+                return clut_CSM2_lookup(entry);
+            return clut_lookup(entry);
         }
-            break;
         case 0x14:
         {
             uint8_t entry = read_PSMCT4_block(tex_base, width, u, v);
             if (current_ctx->tex0.use_CSM2)
-                clut_CSM2_lookup(entry, info.srctex_color);
-            else
-                clut_lookup(entry, info.srctex_color);
+                return clut_CSM2_lookup(entry);
+            return clut_lookup(entry);
         }
-            break;
         case 0x1B:
         {
             uint8_t entry = read_PSMCT32_block(tex_base, width, u, v) >> 24;
             if (current_ctx->tex0.use_CSM2)
-                clut_CSM2_lookup(entry, info.srctex_color);
-            else
-                clut_lookup(entry, info.srctex_color);
+                return clut_CSM2_lookup(entry);
+            return clut_lookup(entry);
         }
-            break;
         case 0x24:
         {
             //printf("[GS_t] Format $24: Read from $%08X\n", tex_base + (coord << 2));
             uint8_t entry = (read_PSMCT32_block(tex_base, width, u, v) >> 24) & 0xF;
             if (current_ctx->tex0.use_CSM2)
-                clut_CSM2_lookup(entry, info.srctex_color);
-            else
-                clut_lookup(entry, info.srctex_color);
-            break;
+                return clut_CSM2_lookup(entry);
+            return clut_lookup(entry);
         }
-            break;
         case 0x2C:
         {
             uint8_t entry = read_PSMCT32_block(tex_base, width, u, v) >> 28;
             if (current_ctx->tex0.use_CSM2)
-                clut_CSM2_lookup(entry, info.srctex_color);
-            else
-                clut_lookup(entry, info.srctex_color);
+                return clut_CSM2_lookup(entry);
+            return clut_lookup(entry);
         }
-            break;
         case 0x30:
-        {
-            uint32_t color = read_PSMCT32Z_block(tex_base, width, u, v);
-            info.srctex_color.r = color & 0xFF;
-            info.srctex_color.g = (color >> 8) & 0xFF;
-            info.srctex_color.b = (color >> 16) & 0xFF;
-            info.srctex_color.a = color >> 24;
-        }
-            break;
+            return read_PSMCT32Z_block(tex_base, width, u, v);
         case 0x31:
         {
-            uint32_t color = read_PSMCT32Z_block(tex_base, width, u, v);
-            info.srctex_color.r = color & 0xFF;
-            info.srctex_color.g = (color >> 8) & 0xFF;
-            info.srctex_color.b = (color >> 16) & 0xFF;
-            if (!(color & 0xFFFFFF) && TEXA.trans_black)
-                info.srctex_color.a = 0;
-            else
-                info.srctex_color.a = TEXA.alpha0;
+            uint32_t color = read_PSMCT32Z_block(tex_base, width, u, v) & 0xFFFFFF;
+            if (!color && TEXA.trans_black)
+                return color;
+            return color | (TEXA.alpha0 << 24);
         }
-            break;
         case 0x32:
         {
             uint16_t color = read_PSMCT16Z_block(tex_base, width, u, v);
-            info.srctex_color.r = (color & 0x1F) << 3;
-            info.srctex_color.g = ((color >> 5) & 0x1F) << 3;
-            info.srctex_color.b = ((color >> 10) & 0x1F) << 3;
-            info.srctex_color.a = get_16bit_alpha(color);
+            return convert_16bit_texel(color);
         }
-            break;
         case 0x3A:
         {
             uint16_t color = read_PSMCT16SZ_block(tex_base, width, u, v);
-            info.srctex_color.r = (color & 0x1F) << 3;
-            info.srctex_color.g = ((color >> 5) & 0x1F) << 3;
-            info.srctex_color.b = ((color >> 10) & 0x1F) << 3;
-            info.srctex_color.a = get_16bit_alpha(color);
+            return convert_16bit_texel(color);
         }
-            break;
         default:
             Errors::die("[GS_t] Unrecognized texture format $%02X\n", current_ctx->tex0.format);
     }
+    return 0;
+}
+
+uint32_t GraphicsSynthesizerThread::convert_16bit_texel(uint16_t color)
+{
+    uint32_t r = (color & 0x1F) << 3;
+    uint32_t g = ((color >> 5) & 0x1F) << 3;
+    uint32_t b = ((color >> 10) & 0x1F) << 3;
+    uint32_t a = get_16bit_alpha(color);
+    return r | (g << 8) | (b << 16) | (a << 24);
 }
 
 void GraphicsSynthesizerThread::recompile_tex_lookup_prologue()
@@ -3970,7 +4646,7 @@ void GraphicsSynthesizerThread::recompile_tex_lookup_prologue()
             insert_block(~0ULL, &jit_tex_lookup_block)->code_start;
 }
 
-void GraphicsSynthesizerThread::clut_lookup(uint8_t entry, RGBAQ_REG &tex_color)
+uint32_t GraphicsSynthesizerThread::clut_lookup(uint8_t entry)
 {
     uint32_t clut_addr = current_ctx->tex0.CLUT_offset;
 
@@ -3979,38 +4655,21 @@ void GraphicsSynthesizerThread::clut_lookup(uint8_t entry, RGBAQ_REG &tex_color)
         //PSMCT32
         case 0x00:
         case 0x01:
-        {
-            uint32_t color = *(uint32_t*)&clut_cache[(clut_addr + (entry << 2)) & 0x3FF];
-            tex_color.r = color & 0xFF;
-            tex_color.g = (color >> 8) & 0xFF;
-            tex_color.b = (color >> 16) & 0xFF;
-            tex_color.a = color >> 24;
-        }
-            break;
+            return *(uint32_t*)&clut_cache[(clut_addr + (entry << 2)) & 0x3FF];
         //PSMCT16
         case 0x02:
         //PSMCT16S
         case 0x0A:
-        {
-            uint16_t color = *(uint16_t*)&clut_cache[(clut_addr + (entry << 1)) & 0x3FF];
-            tex_color.r = (color & 0x1F) << 3;
-            tex_color.g = ((color >> 5) & 0x1F) << 3;
-            tex_color.b = ((color >> 10) & 0x1F) << 3;
-            tex_color.a = get_16bit_alpha(color);
-        }
-            break;
+            return clut_expanded[((clut_addr + (entry << 1)) & 0x3FF) >> 1];
         default:
             Errors::die("[GS_t] Unrecognized CLUT format $%02X\n", current_ctx->tex0.CLUT_format);
     }
+    return 0;
 }
 
-void GraphicsSynthesizerThread::clut_CSM2_lookup(uint8_t entry, RGBAQ_REG &tex_color)
+uint32_t GraphicsSynthesizerThread::clut_CSM2_lookup(uint8_t entry)
 {
-    uint16_t color = *(uint16_t*)&clut_cache[entry << 1];
-    tex_color.r = (color & 0x1F) << 3;
-    tex_color.g = ((color >> 5) & 0x1F) << 3;
-    tex_color.b = ((color >> 10) & 0x1F) << 3;
-    tex_color.a = get_16bit_alpha(color);
+    return clut_expanded[entry];
 }
 
 void GraphicsSynthesizerThread::reload_clut(GSContext& context)
@@ -4066,7 +4725,7 @@ void GraphicsSynthesizerThread::reload_clut(GSContext& context)
 
     if (reload)
     {
-        printf("[GS_t] Reloading CLUT cache!\n");
+        TRACE_DEBUG(Trace::GS, "[GS_t] Reloading CLUT cache!\n");
 
         uint32_t cache_addr = context.tex0.CLUT_offset;
         uint32_t offset = (context.tex0.CLUT_offset / (context.tex0.CLUT_format ? 2 : 4));
@@ -4132,9 +4791,28 @@ void GraphicsSynthesizerThread::reload_clut(GSContext& context)
 
             cache_addr &= 0x3FF;
         }
+
+        update_clut_expansion();
     }
 }
 
+void GraphicsSynthesizerThread::update_clut_expansion()
+{
+    //Games commonly reload the same palette every draw, so the expansion is only redone
+    //when the raw cache or the TEXA fields it depends on actually changed
+    if (clut_expanded_valid && clut_texa.alpha0 == TEXA.alpha0 && clut_texa.alpha1 == TEXA.alpha1 &&
+            clut_texa.trans_black == TEXA.trans_black &&
+            !memcmp(clut_expanded_source, clut_cache, sizeof(clut_cache)))
+        return;
+
+    for (int i = 0; i < 512; i++)
+        clut_expanded[i] = convert_16bit_texel(*(uint16_t*)&clut_cache[i << 1]);
+
+    memcpy(clut_expanded_source, clut_cache, sizeof(clut_cache));
+    clut_texa = TEXA;
+    clut_expanded_valid = true;
+}
+
 void GraphicsSynthesizerThread::update_draw_pixel_state()
 {
     draw_pixel_state = 0;
@@ -4154,16 +4832,16 @@ void GraphicsSynthesizerThread::update_draw_pixel_state()
     draw_pixel_state |= (uint64_t)current_ctx->alpha.spec_B << 29UL;
     draw_pixel_state |= (uint64_t)current_ctx->alpha.spec_C << 31UL;
     draw_pixel_state |= (uint64_t)current_ctx->alpha.spec_D << 33UL;
-    draw_pixel_state |= (uint64_t)DTHE << 34UL;
-    draw_pixel_state |= (uint64_t)COLCLAMP << 35UL;
-    draw_pixel_state |= (uint64_t)current_ctx->zbuf.format << 36UL;
-    draw_pixel_state |= (uint64_t)SCANMSK << 42UL;
-    draw_pixel_state |= (uint64_t)current_ctx->zbuf.no_update << 44UL;
-    draw_pixel_state |= (uint64_t)current_ctx->alpha.fixed_alpha << 45UL;
-    draw_pixel_state |= (uint64_t)(current_PRMODE == &PRIM) << 53UL;
-    draw_pixel_state |= (uint64_t)(current_ctx == &context1) << 54UL;
-    draw_pixel_state |= (uint64_t)(current_ctx->frame.mask != 0) << 55UL;
-    draw_pixel_state |= (uint64_t)(current_ctx->FBA) << 56UL;
+    draw_pixel_state |= (uint64_t)DTHE << 35UL;
+    draw_pixel_state |= (uint64_t)COLCLAMP << 36UL;
+    draw_pixel_state |= (uint64_t)current_ctx->zbuf.format << 37UL;
+    draw_pixel_state |= (uint64_t)SCANMSK << 43UL;
+    draw_pixel_state |= (uint64_t)current_ctx->zbuf.no_update << 45UL;
+    draw_pixel_state |= (uint64_t)current_ctx->alpha.fixed_alpha << 46UL;
+    draw_pixel_state |= (uint64_t)(current_PRMODE == &PRIM) << 54UL;
+    draw_pixel_state |= (uint64_t)(current_ctx == &context1) << 55UL;
+    draw_pixel_state |= (uint64_t)(current_ctx->frame.mask != 0) << 56UL;
+    draw_pixel_state |= (uint64_t)(current_ctx->FBA) << 57UL;
 }
 
 void GraphicsSynthesizerThread::update_tex_lookup_state()
@@ -4193,18 +4871,29 @@ uint8_t* GraphicsSynthesizerThread::get_jitted_draw_pixel(uint64_t state)
     GSPixelJitBlockRecord* found_block = jit_draw_pixel_heap.find_block(state);
     if (!found_block)
     {
-        printf("[GS_t] RECOMPILING DRAW PIXEL %llX\n", state);
+        TRACE_DEBUG(Trace::GS, "[GS_t] RECOMPILING DRAW PIXEL %llX\n", (unsigned long long)state);
         found_block = recompile_draw_pixel(state);
     }
     return (uint8_t*)found_block->code_start;
 }
 
+uint8_t* GraphicsSynthesizerThread::get_jitted_sprite_row(uint64_t state)
+{
+    GSPixelJitBlockRecord* found_block = jit_sprite_row_heap.find_block(state);
+    if (!found_block)
+    {
+        TRACE_DEBUG(Trace::GS, "[GS_t] RECOMPILING SPRITE ROW %llX\n", (unsigned long long)state);
+        found_block = recompile_sprite_row(state);
+    }
+    return (uint8_t*)found_block->code_start;
+}
+
 uint8_t* GraphicsSynthesizerThread::get_jitted_tex_lookup(uint64_t state)
 {
     GSTextureJitBlockRecord* found_block = jit_tex_lookup_heap.find_block(state);
     if (!found_block)
     {
-        printf("[GS_t] RECOMPILING TEX LOOKUP %llX\n", state);
+        TRACE_DEBUG(Trace::GS, "[GS_t] RECOMPILING TEX LOOKUP %llX\n", (unsigned long long)state);
         found_block = recompile_tex_lookup(state);
     }
     return (uint8_t*)found_block->code_start;
@@ -4480,6 +5169,162 @@ GSPixelJitBlockRecord* GraphicsSynthesizerThread::recompile_draw_pixel(uint64_t
     return jit_draw_pixel_heap.insert_block(state, &jit_draw_pixel_block);
 }
 
+//JIT version of blend_sprite_block_row, specialized on the draw pixel state.
+//Only caller-saved registers are used, so no stack frame is needed.
+GSPixelJitBlockRecord* GraphicsSynthesizerThread::recompile_sprite_row(uint64_t state)
+{
+    jit_sprite_row_block.clear();
+
+    const REG_64 src = abi_args[0];
+    const REG_64 colors = abi_args[1];
+    const REG_64 dither = abi_args[2];
+    const ALPHA& alpha = current_ctx->alpha;
+
+    //Each row holds two pixels' worth of 16-bit lanes
+    alignas(16) const static uint16_t constants[][8] =
+    {
+        {0, 0, 0, 0x80, 0, 0, 0, 0x80},                    //Alpha MSB
+        {0, 0, 0, 0xFF, 0, 0, 0, 0xFF},                    //Alpha low byte
+        {0xFFFF, 0xFFFF, 0xFFFF, 0, 0xFFFF, 0xFFFF, 0xFFFF, 0}, //RGB lanes
+        {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},  //Byte mask
+    };
+
+    //R10 = constants, R11 = FBMASK
+    emitter_sprite.load_addr((uint64_t)&constants, R10);
+    if (current_ctx->frame.mask)
+    {
+        emitter_sprite.load_addr((uint64_t)&current_ctx->frame.mask, RAX);
+        emitter_sprite.MOV32_FROM_MEM(RAX, R11);
+    }
+
+    int pixels = block_row_width(current_ctx->frame.format);
+    for (int pair = 0; pair < pixels / 2; pair++)
+    {
+        uint32_t src_offset = pair * 16;
+        uint32_t color_offset = pair * 8;
+
+        //XMM0 = source color, two pixels of 16-bit components
+        emitter_sprite.MOVUPS_FROM_MEM(src, XMM0, src_offset);
+
+        if (current_PRMODE->alpha_blend)
+        {
+            //XMM1 = frame color
+            emitter_sprite.MOV64_FROM_MEM(colors, RAX, color_offset);
+            emitter_sprite.MOVQ_TO_XMM(RAX, XMM1);
+            emitter_sprite.PMOVZX8_TO_16(XMM1, XMM1);
+
+            //XMM3 = A - B
+            switch (alpha.spec_A)
+            {
+                case 0:
+                    emitter_sprite.MOVAPS_REG(XMM0, XMM3);
+                    break;
+                case 1:
+                    emitter_sprite.MOVAPS_REG(XMM1, XMM3);
+                    break;
+                default:
+                    emitter_sprite.PXOR_XMM(XMM3, XMM3);
+                    break;
+            }
+            if (alpha.spec_B == 0)
+                emitter_sprite.PSUBW(XMM0, XMM3);
+            else if (alpha.spec_B == 1)
+                emitter_sprite.PSUBW(XMM1, XMM3);
+
+            //XMM2 = C, broadcast to every component of its pixel
+            switch (alpha.spec_C)
+            {
+                case 0:
+                    emitter_sprite.PSHUFLW(0xFF, XMM0, XMM2);
+                    emitter_sprite.PSHUFHW(0xFF, XMM2, XMM2);
+                    break;
+                case 1:
+                    emitter_sprite.PSHUFLW(0xFF, XMM1, XMM2);
+                    emitter_sprite.PSHUFHW(0xFF, XMM2, XMM2);
+                    break;
+                default:
+                    emitter_sprite.MOV32_REG_IMM(alpha.fixed_alpha, RAX);
+                    emitter_sprite.MOVD_TO_XMM(RAX, XMM2);
+                    emitter_sprite.PSHUFLW(0, XMM2, XMM2);
+                    emitter_sprite.PSHUFD(0, XMM2, XMM2);
+                    break;
+            }
+
+            //((A - B) * C) >> 7, one pixel per 32-bit register
+            emitter_sprite.PSHUFD(0xEE, XMM3, XMM4);
+            emitter_sprite.PSHUFD(0xEE, XMM2, XMM5);
+            emitter_sprite.PMOVSX16_TO_32(XMM3, XMM3);
+            emitter_sprite.PMOVSX16_TO_32(XMM4, XMM4);
+            emitter_sprite.PMOVSX16_TO_32(XMM2, XMM2);
+            emitter_sprite.PMOVSX16_TO_32(XMM5, XMM5);
+            emitter_sprite.PMULLD(XMM2, XMM3);
+            emitter_sprite.PMULLD(XMM5, XMM4);
+            emitter_sprite.PSRAD(7, XMM3);
+            emitter_sprite.PSRAD(7, XMM4);
+            emitter_sprite.PACKSSDW(XMM4, XMM3);
+
+            if (alpha.spec_D == 0)
+                emitter_sprite.PADDW(XMM0, XMM3);
+            else if (alpha.spec_D == 1)
+                emitter_sprite.PADDW(XMM1, XMM3);
+
+            if (PABE)
+            {
+                //Pixels without the alpha MSB set keep the source color
+                emitter_sprite.MOVAPS_REG(XMM0, XMM4);
+                emitter_sprite.PAND_XMM_FROM_MEM(R10, XMM4, 0x00);
+                emitter_sprite.MOVAPS_FROM_MEM(R10, XMM2, 0x00);
+                emitter_sprite.PCMPEQW_XMM(XMM2, XMM4);
+                emitter_sprite.PSHUFLW(0xFF, XMM4, XMM4);
+                emitter_sprite.PSHUFHW(0xFF, XMM4, XMM4);
+                emitter_sprite.PAND_XMM(XMM4, XMM3);
+                emitter_sprite.PANDN_XMM(XMM0, XMM4);
+                emitter_sprite.POR_XMM(XMM4, XMM3);
+            }
+        }
+        else
+            emitter_sprite.MOVAPS_REG(XMM0, XMM3);
+
+        if (DTHE)
+        {
+            emitter_sprite.MOVUPS_FROM_MEM(dither, XMM2, (pair & 0x1) * 16);
+            emitter_sprite.PADDW(XMM2, XMM3);
+        }
+
+        if (!COLCLAMP)
+            emitter_sprite.PAND_XMM_FROM_MEM(R10, XMM3, 0x30);
+
+        //Replace alpha with the low byte of the source alpha, plus FBA
+        emitter_sprite.PAND_XMM_FROM_MEM(R10, XMM3, 0x20);
+        emitter_sprite.MOVAPS_REG(XMM0, XMM4);
+        emitter_sprite.PAND_XMM_FROM_MEM(R10, XMM4, 0x10);
+        emitter_sprite.POR_XMM(XMM4, XMM3);
+        if (current_ctx->FBA)
+            emitter_sprite.POR_XMM_FROM_MEM(R10, XMM3, 0x00);
+
+        emitter_sprite.PACKUSWB(XMM3, XMM3);
+
+        if (current_ctx->frame.mask)
+        {
+            //color = (color & ~mask) | (frame_color & mask)
+            emitter_sprite.MOV64_FROM_MEM(colors, RAX, color_offset);
+            emitter_sprite.MOVQ_TO_XMM(RAX, XMM4);
+            emitter_sprite.MOVD_TO_XMM(R11, XMM2);
+            emitter_sprite.PSHUFD(0, XMM2, XMM2);
+            emitter_sprite.PAND_XMM(XMM2, XMM4);
+            emitter_sprite.PANDN_XMM(XMM3, XMM2);
+            emitter_sprite.POR_XMM(XMM2, XMM4);
+            emitter_sprite.MOVAPS_REG(XMM4, XMM3);
+        }
+
+        emitter_sprite.MOVQ_FROM_XMM(XMM3, RAX);
+        emitter_sprite.MOV64_TO_MEM(RAX, colors, color_offset);
+    }
+
+    emitter_sprite.RET();
+    return jit_sprite_row_heap.insert_block(state, &jit_sprite_row_block);
+}
+
 void GraphicsSynthesizerThread::recompile_alpha_test()
 {
     //If the condition is NEVER, do not compare and just proceed with the failure condition
@@ -4702,7 +5547,7 @@ void GraphicsSynthesizerThread::recompile_depth_test()
 
 void GraphicsSynthesizerThread::recompile_alpha_blend()
 {
-    printf("Alpha blend: %d %d %d %d\n", current_ctx->alpha.spec_A, current_ctx->alpha.spec_B,
+    TRACE_DEBUG(Trace::GS, "Alpha blend: %d %d %d %d\n", current_ctx->alpha.spec_A, current_ctx->alpha.spec_B,
            current_ctx->alpha.spec_C, current_ctx->alpha.spec_D);
 
     uint8_t* pabe_fail_end = nullptr;
@@ -5272,10 +6117,13 @@ GSTextureJitBlockRecord* GraphicsSynthesizerThread::recompile_tex_lookup(uint64_
     }
     else if (current_ctx->tex0.color_function == 2)
     {
-        //tex_color.a += vtx_color.a
-        //TODO: clamp
+        //tex_color.a = min(tex_color.a + vtx_color.a, 0xFF)
         emitter_tex.ADD64_REG(RSI, RCX);
         emitter_tex.SHR64_REG_IMM(48, RCX);
+        emitter_tex.CMP32_IMM(0xFF, RCX);
+        uint8_t* no_clamp = emitter_tex.JCC_NEAR_DEFERRED(ConditionCode::L);
+        emitter_tex.MOV32_REG_IMM(0xFF, RCX);
+        emitter_tex.set_jump_dest(no_clamp);
         emitter_tex.MOV16_TO_MEM(RCX, R14, sizeof(RGBAQ_REG) + (sizeof(uint16_t) * 3));
     }
     else if (current_ctx->tex0.color_function == 3)
@@ -5330,14 +6178,14 @@ void GraphicsSynthesizerThread::recompile_clut_lookup()
             break;
         case 0x02:
         case 0x0A:
+            //Index the pre-expanded palette: clut_expanded[((offset + (index << 1)) & 0x3FF) >> 1]
+            emitter_tex.load_addr((uint64_t)&clut_expanded, RAX);
             emitter_tex.SHL32_REG_IMM(1, RDI);
             emitter_tex.ADD32_REG(RDI, RCX);
-            emitter_tex.AND32_REG_IMM(0x3FF, RCX);
+            emitter_tex.AND32_REG_IMM(0x3FE, RCX);
+            emitter_tex.SHL32_REG_IMM(1, RCX);
             emitter_tex.ADD64_REG(RCX, RAX);
             emitter_tex.MOV32_FROM_MEM(RAX, RAX);
-            emitter_tex.AND32_EAX(0xFFFF);
-
-            recompile_convert_16bit_tex(RAX, RCX, RDI);
             break;
         default:
             Errors::die("[GS JIT] Unrecognized CLUT format $%02X", current_ctx->tex0.CLUT_format);
@@ -5346,14 +6194,11 @@ void GraphicsSynthesizerThread::recompile_clut_lookup()
 
 void GraphicsSynthesizerThread::recompile_csm2_lookup()
 {
-    //color = *(uint16_t*)&clut_cache[index << 1]
-    emitter_tex.load_addr((uint64_t)&clut_cache, RAX);
-    emitter_tex.SHL32_REG_IMM(1, RDI);
+    //color = clut_expanded[index]
+    emitter_tex.load_addr((uint64_t)&clut_expanded, RAX);
+    emitter_tex.SHL32_REG_IMM(2, RDI);
     emitter_tex.ADD64_REG(RDI, RAX);
     emitter_tex.MOV32_FROM_MEM(RAX, RAX);
-    emitter_tex.AND32_EAX(0xFFFF);
-
-    recompile_convert_16bit_tex(RAX, RDI, RSI);
 }
 
 void GraphicsSynthesizerThread::recompile_convert_16bit_tex(REG_64 color, REG_64 temp, REG_64 temp2)
@@ -5458,6 +6303,8 @@ void GraphicsSynthesizerThread::load_state(ifstream *state)
     state->read((char*)&current_vtx, sizeof(current_vtx));
     state->read((char*)&vtx_queue, sizeof(vtx_queue));
     state->read((char*)&num_vertices, sizeof(num_vertices));
+
+    update_clut_expansion();
 }
 
 void GraphicsSynthesizerThread::save_state(ofstream *state)
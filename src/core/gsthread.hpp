@@ -1,5 +1,7 @@
 #ifndef GSTHREAD_HPP
 #define GSTHREAD_HPP
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <thread>
 #include <mutex>
@@ -8,8 +10,10 @@
 #include <memory>
 #include "gscontext.hpp"
 #include "gsregisters.hpp"
+#include "gsscanout.hpp"
 #include "circularFIFO.hpp"
 #include "int128.hpp"
+#include "trace.hpp"
 
 #include "jitcommon/emitter64.hpp"
 
@@ -29,13 +33,24 @@ struct SwizzleTable
     uint32_t data[XS*YS*ZS];
 };
 
+//Progress of a local->host transfer, published by the GS thread as quadwords are produced.
+//The EE side only blocks once it has consumed everything published so far.
+struct GSDownloadFence
+{
+    std::atomic<uint32_t> quads_written;
+    std::atomic<bool> complete;
+
+    GSDownloadFence() : quads_written(0), complete(true) {}
+};
+
 //Commands sent from the main thread to the GS thread.
 enum GSCommand:uint8_t 
 {
     write64_t, write64_privileged_t, write32_privileged_t,
     set_rgba_t, set_st_t, set_uv_t, set_xyz_t, set_xyzf_t, set_crt_t,
     render_crt_t, assert_finish_t, assert_hblank_t, assert_vsync_t, swap_field_t, memdump_t, die_t,
-    save_state_t, load_state_t, gsdump_t, request_local_host_tx,
+    save_state_t, load_state_t, gsdump_t, request_local_host_tx, set_deinterlace_t, set_skip_draws_t,
+    set_sprite_spans_t,
 };
 
 union GSMessagePayload 
@@ -92,9 +107,22 @@ union GSMessagePayload
     struct
     {
         uint128_t* target;
-        std::mutex* target_mutex;
+        GSDownloadFence* fence;
     } download_payload;
     struct
+    {
+        DeinterlaceMethod method;
+        bool forced;
+    } deinterlace_payload;
+    struct
+    {
+        bool skip;
+    } skip_draws_payload;
+    struct
+    {
+        bool enabled;
+    } sprite_spans_payload;
+    struct
     {
         std::ofstream* state;
     } save_state_payload;
@@ -122,7 +150,6 @@ enum GSReturn :uint8_t
     save_state_done_t,
     load_state_done_t,
     gsdump_render_partial_done_t,
-    local_host_transfer,
 };
 
 union GSReturnMessagePayload
@@ -137,13 +164,12 @@ union GSReturnMessagePayload
     } xy_payload;
     struct
     {
-        uint8_t BLANK;
-    } no_payload;//C++ doesn't like the empty struct
+        uint32_t busy_us; //Time the GS thread spent on the frame, not counting time asleep
+    } frame_payload;
     struct
     {
-        uint32_t quad_count;
-    } download_payload;
-
+        uint8_t BLANK;
+    } no_payload;//C++ doesn't like the empty struct
 };
 
 struct GSReturnMessage
@@ -264,6 +290,8 @@ uint32_t addr_PSMCT16SZ(uint32_t block, uint32_t width, uint32_t x, uint32_t y);
 uint32_t addr_PSMCT8(uint32_t block, uint32_t width, uint32_t x, uint32_t y);
 uint32_t addr_PSMCT4(uint32_t block, uint32_t width, uint32_t x, uint32_t y);
 
+uint32_t convert_color_up(uint16_t col);
+
 struct VertexF
 {
     union {
@@ -343,6 +371,7 @@ struct VertexF
 
 typedef void (*GSDrawPixelPrologue)(int32_t x, int32_t y, uint32_t z, RGBAQ_REG& color);
 typedef void (*GSTexLookupPrologue)(int16_t u, int16_t v, TexLookupInfo* info);
+typedef void (*GSSpriteRowFunc)(const int16_t* src, uint32_t* colors, const int16_t* dither);
 
 class GraphicsSynthesizerThread
 {
@@ -366,12 +395,23 @@ class GraphicsSynthesizerThread
 
         bool frame_complete;
         int frame_count;
+        bool skip_draws;
+        bool sprite_spans;
+        std::chrono::steady_clock::time_point busy_start;
+        std::chrono::steady_clock::duration busy_time;
         uint8_t* local_mem;
         uint8_t CRT_mode;
-        uint32_t screen_buffer[2048 * 2048];
         uint8_t clut_cache[1024];
         uint32_t CBP0, CBP1;
 
+        //clut_cache viewed as 16-bit entries, pre-expanded to RGBA8 with TEXA applied.
+        //Rebuilt only when the cache contents or TEXA change, compared against a snapshot of the
+        //cache it was built from.
+        uint32_t clut_expanded[512];
+        uint8_t clut_expanded_source[1024];
+        TEXA_REG clut_texa;
+        bool clut_expanded_valid;
+
         //CSR/IMR stuff - to be merged into structs
 
         GS_IMR IMR;
@@ -379,14 +419,20 @@ class GraphicsSynthesizerThread
         GSContext context1, context2;
         GSContext* current_ctx;
 
-        JitBlock jit_draw_pixel_block, jit_tex_lookup_block;
-        Emitter64 emitter_dp, emitter_tex;
+        JitBlock jit_draw_pixel_block, jit_tex_lookup_block, jit_sprite_row_block;
+        Emitter64 emitter_dp, emitter_tex, emitter_sprite;
 
         GSPixelJitHeap jit_draw_pixel_heap;
         GSTextureJitHeap jit_tex_lookup_heap;
+        GSPixelJitHeap jit_sprite_row_heap;
 
         uint8_t* jit_draw_pixel_func;
         uint8_t* jit_tex_lookup_func;
+        GSSpriteRowFunc jit_sprite_row_func;
+
+        //Source colors of the sprite row being drawn, as 16-bit RGBA. Padded so a row can start
+        //anywhere inside its first block row.
+        int16_t sprite_colors[2048 + 64][4];
 
         GSTexLookupPrologue jit_tex_lookup_prologue;
         GSDrawPixelPrologue jit_draw_pixel_prologue;
@@ -413,18 +459,25 @@ class GraphicsSynthesizerThread
         uint64_t draw_pixel_state;
         uint64_t tex_lookup_state;
 
+        //draw_pixel_state of the last primitive drawn, read by the emu thread's profiler
+        std::atomic<uint64_t> last_draw_state;
+
         BITBLTBUF_REG BITBLTBUF;
         TRXPOS_REG TRXPOS;
         TRXREG_REG TRXREG;
         uint8_t TRXDIR;
         uint8_t BUSDIR;
         int pixels_transferred;
+        uint64_t hwreg_staging[4];
+        int hwreg_staged;
+        GSDownloadFence* download_fence;
 
         //Used for unpacking PSMCT24
         uint32_t PSMCT24_color;
         int PSMCT24_unpacked_count;
 
         GS_REGISTERS reg;
+        GSScanout scanout;
 
         Vertex current_vtx;
         Vertex vtx_queue[3];
@@ -441,6 +494,7 @@ class GraphicsSynthesizerThread
         void event_loop();
 
         //Swizzling routines
+        void init_swizzle_tables();
         uint32_t blockid_PSMCT32(uint32_t block, uint32_t width, uint32_t x, uint32_t y);
         uint32_t blockid_PSMCT32Z(uint32_t block, uint32_t width, uint32_t x, uint32_t y);
         uint32_t blockid_PSMCT16(uint32_t block, uint32_t width, uint32_t x, uint32_t y);
@@ -475,9 +529,14 @@ class GraphicsSynthesizerThread
         void calculate_LOD(TexLookupInfo& info);
         void tex_lookup(int16_t u, int16_t v, TexLookupInfo& info);
         void tex_lookup_int(int16_t u, int16_t v, TexLookupInfo& info, bool forced_lookup = false);
-        void clut_lookup(uint8_t entry, RGBAQ_REG& tex_color);
-        void clut_CSM2_lookup(uint8_t entry, RGBAQ_REG& tex_color);
+        bool uses_bilinear_filter(const TexLookupInfo& info);
+        void wrap_tex_coords(int16_t& u, int16_t& v, const TexLookupInfo& info);
+        uint32_t read_texel(int16_t u, int16_t v, const TexLookupInfo& info);
+        uint32_t convert_16bit_texel(uint16_t color);
+        uint32_t clut_lookup(uint8_t entry);
+        uint32_t clut_CSM2_lookup(uint8_t entry);
         void reload_clut(GSContext& context);
+        void update_clut_expansion();
         void update_draw_pixel_state();
         void update_tex_lookup_state();
         uint8_t* get_jitted_draw_pixel(uint64_t state);
@@ -510,8 +569,21 @@ class GraphicsSynthesizerThread
         void render_half_triangle(float x0, float x1, int y0, int y1, VertexF& x_step, VertexF& y_step, VertexF& init,
                 float step_x0, float step_x1, float scx1, float scx2, TexLookupInfo& tex_info);
         void render_sprite();
+        bool can_draw_sprite_span(const TexLookupInfo& info, int32_t max_x, int32_t max_y);
+        void shade_sprite_texels(int16_t (*row)[4], int count, const TexLookupInfo& info);
+        void draw_sprite_row(int32_t y, int32_t x_start, int32_t x_end, uint32_t z);
+        void blend_sprite_block_row(const int16_t* src, uint32_t* colors, const int16_t* dither);
+        uint8_t* get_jitted_sprite_row(uint64_t state);
+        GSPixelJitBlockRecord* recompile_sprite_row(uint64_t state);
+        int block_row_width(uint8_t format);
+        int block_row_bytes(uint8_t format);
+        void read_block_row(uint8_t format, uint32_t base, uint32_t width, uint32_t x, uint32_t y, uint8_t* dest);
+        void write_block_row(uint8_t format, uint32_t base, uint32_t width, uint32_t x, uint32_t y, const uint8_t* src);
+        bool can_stage_HWREG();
         void write_HWREG(uint64_t data);
-        uint32_t local_to_host(uint128_t *target);
+        void write_HWREG_pixels(uint64_t data);
+        void flush_HWREG_staging();
+        void local_to_host(uint128_t *target, GSDownloadFence* fence);
         void unpack_PSMCT24(uint64_t data, int offset, bool z_format);
         uint64_t pack_PSMCT24(bool z_format);
         void local_to_local();
@@ -519,9 +591,6 @@ class GraphicsSynthesizerThread
         int32_t orient2D(const Vertex &v1, const Vertex &v2, const Vertex &v3);
         void memdump(uint32_t* target, uint16_t& width, uint16_t& height);
 
-        bool is_in_display(DISPLAY& display, int32_t x_start, int32_t y_start, int32_t x, int32_t y);
-        uint32_t get_CRT_color(DISPFB& dispfb, int32_t x, int32_t y);
-        void render_CRT(uint32_t* target);
 
         void write64(uint32_t addr, uint64_t value);
 
@@ -533,14 +602,17 @@ class GraphicsSynthesizerThread
 
         void load_state(std::ifstream* state);
         void save_state(std::ofstream* state);
+
+        const Trace::GuestClock* trace_clock;
     public:
-        GraphicsSynthesizerThread();
+        GraphicsSynthesizerThread(const Trace::GuestClock* trace_clock);
         ~GraphicsSynthesizerThread();
         
         // safe to access from emu thread
         void send_message(GSMessage message);
         void wake_thread();
         void wait_for_return(GSReturn type, GSReturnMessage &data);
+        uint64_t get_last_draw_state() const;
         void reset();
         void exit();
 };
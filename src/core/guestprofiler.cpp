@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include "guestprofiler.hpp"
+#include "errors.hpp"
+
+static const char* SECTION_NAMES[GuestProfiler::SECTION_COUNT] =
+{
+    "EE", "IOP", "DMA_VIF_GIF_IPU", "VU0", "VU1", "events"
+};
+
+GuestProfiler::GuestProfiler() : quit(false), interval_us(1000), sample_due(false), timing_slice(false)
+{
+    clear();
+}
+
+GuestProfiler::~GuestProfiler()
+{
+    stop();
+}
+
+void GuestProfiler::start(int interval_us)
+{
+    stop();
+    this->interval_us = std::max(interval_us, 1);
+    quit = false;
+    timer_thread = std::thread(&GuestProfiler::timer_loop, this);
+}
+
+void GuestProfiler::stop()
+{
+    if (timer_thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex);
+            quit = true;
+        }
+        timer_notifier.notify_one();
+        timer_thread.join();
+    }
+    sample_due = false;
+    timing_slice = false;
+}
+
+bool GuestProfiler::is_running() const
+{
+    return timer_thread.joinable();
+}
+
+void GuestProfiler::clear()
+{
+    stacks.clear();
+    sample_count = 0;
+    for (int i = 0; i < SECTION_COUNT; i++)
+        section_time[i] = clock::duration::zero();
+}
+
+void GuestProfiler::timer_loop()
+{
+    std::unique_lock<std::mutex> lock(timer_mutex);
+    while (!quit)
+    {
+        timer_notifier.wait_for(lock, std::chrono::microseconds(interval_us));
+        sample_due.store(true, std::memory_order_relaxed);
+    }
+}
+
+void GuestProfiler::add_stack(const char* fmt, ...)
+{
+    char stack[64];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(stack, sizeof(stack), fmt, args);
+    va_end(args);
+    stacks[stack]++;
+}
+
+void GuestProfiler::add_sample(const GuestProfilerSample& sample)
+{
+    sample_due.store(false, std::memory_order_relaxed);
+    sample_count++;
+
+    add_stack("EE;%08X;%08X", sample.ee_ra - 8, sample.ee_pc);
+    add_stack("IOP;%08X", sample.iop_pc);
+    for (int i = 0; i < 2; i++)
+    {
+        if (sample.vu_running[i])
+            add_stack("VU%d;%08X;%04X", i, sample.vu_program[i], sample.vu_pc[i]);
+        else
+            add_stack("VU%d;stopped", i);
+    }
+    add_stack("GS;%016llX", (unsigned long long)sample.gs_draw_state);
+
+    timing_slice = true;
+    lap_start = clock::now();
+}
+
+void GuestProfiler::record_lap(Section section)
+{
+    clock::time_point now = clock::now();
+    section_time[section] += now - lap_start;
+    lap_start = now;
+
+    //Sections are lapped in order, so the last one ends the timed slice
+    if (section == SECTION_COUNT - 1)
+        timing_slice = false;
+}
+
+uint64_t GuestProfiler::get_sample_count() const
+{
+    return sample_count;
+}
+
+bool GuestProfiler::write_collapsed(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+    {
+        Errors::print_warning("[Profiler] Failed to open %s\n", path);
+        return false;
+    }
+    for (auto& stack : stacks)
+        fprintf(file, "%s %llu\n", stack.first.c_str(), (unsigned long long)stack.second);
+    fclose(file);
+
+    std::string host_path = std::string(path) + ".host";
+    file = fopen(host_path.c_str(), "w");
+    if (!file)
+    {
+        Errors::print_warning("[Profiler] Failed to open %s\n", host_path.c_str());
+        return false;
+    }
+    for (int i = 0; i < SECTION_COUNT; i++)
+    {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(section_time[i]).count();
+        fprintf(file, "host;%s %llu\n", SECTION_NAMES[i], (unsigned long long)us);
+    }
+    fclose(file);
+    return true;
+}
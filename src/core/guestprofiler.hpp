@@ -0,0 +1,103 @@
+#ifndef GUESTPROFILER_HPP
+#define GUESTPROFILER_HPP
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+struct GuestProfilerSample
+{
+    uint32_t ee_pc, ee_ra;
+    uint32_t iop_pc;
+    bool vu_running[2];
+    uint32_t vu_pc[2];
+    uint32_t vu_program[2]; //CRC of the loaded microprogram, as used in VUBlockState
+    uint64_t gs_draw_state; //draw_pixel_state of the last primitive the GS thread drew
+};
+
+/**
+Sampling profiler for guest code. A timer thread asks for a sample at a fixed host interval, and
+Emulator::run takes it between scheduler slices, where the guest state is consistent. With the
+EE JIT, the PC there is always the start of a block, so samples count per JIT block.
+
+Each sample becomes one collapsed stack per unit, so a flamegraph shows the EE, IOP, VUs and GS
+side by side:
+    EE;<caller>;<pc>       the caller is $ra - 8, a guess that only holds in leaf functions
+    IOP;<pc>
+    VU1;<program>;<pc>     or VU1;stopped
+    GS;<draw state>
+
+The slice following each sample is timed per subsystem, which estimates where host time goes
+without timing every slice.
+**/
+
+class GuestProfiler
+{
+    public:
+        enum Section
+        {
+            EE,
+            IOP,
+            DEVICES,
+            VU0,
+            VU1,
+            EVENTS,
+            SECTION_COUNT
+        };
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        std::thread timer_thread;
+        std::mutex timer_mutex;
+        std::condition_variable timer_notifier;
+        bool quit;
+        int interval_us;
+
+        std::atomic<bool> sample_due;
+
+        bool timing_slice;
+        clock::time_point lap_start;
+        clock::duration section_time[SECTION_COUNT];
+
+        std::unordered_map<std::string, uint64_t> stacks;
+        uint64_t sample_count;
+
+        void timer_loop();
+        void add_stack(const char* fmt, ...);
+        void record_lap(Section section);
+    public:
+        GuestProfiler();
+        ~GuestProfiler();
+
+        void start(int interval_us);
+        void stop();
+        bool is_running() const;
+        void clear();
+
+        bool is_sample_due() const;
+        void add_sample(const GuestProfilerSample& sample);
+        void lap(Section section);
+
+        uint64_t get_sample_count() const;
+
+        //Writes the guest stacks in the collapsed format flamegraph.pl takes, and the host time per
+        //subsystem to <path>.host in the same format, in microseconds
+        bool write_collapsed(const char* path);
+};
+
+inline bool GuestProfiler::is_sample_due() const
+{
+    return sample_due.load(std::memory_order_relaxed);
+}
+
+inline void GuestProfiler::lap(Section section)
+{
+    if (timing_slice)
+        record_lap(section);
+}
+
+#endif // GUESTPROFILER_HPP
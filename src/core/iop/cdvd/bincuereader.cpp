@@ -36,6 +36,8 @@ size_t BinCueReader::read(uint8_t* buff, size_t bytes)
 
 void BinCueReader::seek(size_t pos, std::ios::seekdir whence)
 {
+    //A read past the end of the disc mustn't leave the stream unusable for later reads
+    bin_file.clear();
     bin_file.seekg(pos * 0x930);
 }
 
@@ -49,3 +51,8 @@ size_t BinCueReader::get_size()
     bin_file.seekg(0, std::ios::end);
     return bin_file.tellg();
 }
+
+size_t BinCueReader::get_sector_size()
+{
+    return 0x930;
+}
@@ -16,6 +16,7 @@ class BinCueReader : public CDVD_Container
 
         bool is_open();
         size_t get_size();
+        size_t get_sector_size();
 };
 
 #endif // BINCUEREADER_HPP
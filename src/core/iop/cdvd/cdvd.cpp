@@ -3,20 +3,21 @@
 #include <string>
 #include "bincuereader.hpp"
 #include "cdvd.hpp"
-//#include "cso_reader.hpp"
+#include "cso_reader.hpp"
 #include "iso_reader.hpp"
-//#include "chd_reader.hpp"
+#include "chd_reader.hpp"
 
 #include "../iop_dma.hpp"
 #include "../iop_intc.hpp"
 
 #include "../../errors.hpp"
+#include "../../trace.hpp"
 #include "../../scheduler.hpp"
 
 using namespace std;
 
 //Values from PCSX2 - subject to change
-static uint64_t IOP_CLOCK = 36864000;
+static const uint64_t IOP_CLOCK = 36864000;
 static const int PSX_CD_READSPEED = 153600;
 static const int PSX_DVD_READSPEED = 1382400;
 
@@ -41,6 +42,7 @@ CDVD_Drive::CDVD_Drive(IOP_INTC* intc, IOP_DMA* dma, Scheduler* scheduler) :
 
 CDVD_Drive::~CDVD_Drive()
 {
+    read_ahead.stop();
     if (container)
         container->close();
 }
@@ -49,6 +51,7 @@ void CDVD_Drive::reset()
 {
     speed = 4;
     current_sector = 0;
+    container_sector = 0;
     cycle_count = 0;
     last_read = 0;
     drive_status = STOPPED;
@@ -196,7 +199,7 @@ uint32_t CDVD_Drive::read_to_RAM(uint8_t *RAM, uint32_t bytes)
 
 void CDVD_Drive::handle_N_command()
 {
-    printf("CDVD event!\n");
+    TRACE_DEBUG(Trace::CDVD, "CDVD event!\n");
     switch (active_N_command)
     {
         case NCOMMAND::SEEK:
@@ -239,7 +242,7 @@ void CDVD_Drive::handle_N_command()
             add_event(get_block_timing(N_command != 0x06));
             break;
         case NCOMMAND::BREAK:
-            printf("[CDVD] Break issued\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] Break issued\n");
             drive_status = PAUSED;
             active_N_command = NCOMMAND::NONE;
             N_status = 0x4E;
@@ -258,18 +261,22 @@ void CDVD_Drive::handle_N_command()
 
 bool CDVD_Drive::load_disc(const char *name, CDVD_CONTAINER a_container)
 {
+    //The old container must not be replaced while the read-ahead thread is using it,
+    //and a failed load mustn't leave it pointing at the destroyed one
+    read_ahead.reset();
+
     //container = a_container;
     switch (a_container)
     {
         case CDVD_CONTAINER::ISO:
             container = std::unique_ptr<CDVD_Container>(new ISO_Reader());
             break;
-        /*case CDVD_CONTAINER::CISO:
+        case CDVD_CONTAINER::CISO:
             container = std::unique_ptr<CDVD_Container>(new CSO_Reader());
             break;
         case CDVD_CONTAINER::CHD:
             container = std::unique_ptr<CDVD_Container>(new CHD_Reader());
-            break;*/
+            break;
         case CDVD_CONTAINER::BIN_CUE:
             container = std::unique_ptr<CDVD_Container>(new BinCueReader());
             break;
@@ -279,27 +286,26 @@ bool CDVD_Drive::load_disc(const char *name, CDVD_CONTAINER a_container)
     }
     if (!container->open(name)) // No Filename, No disc.
     {
-        printf("No Disk Inserted \n");
+        TRACE_DEBUG(Trace::CDVD, "No Disk Inserted \n");
         disc_type = CDVD_DISC_NONE;
         return false;
     }
 
     file_size = container->get_size();
+    read_ahead.start(container.get(), file_size / container->get_sector_size());
 
-    printf("[CDVD] Disc size: %lu bytes\n", file_size);
-    printf("[CDVD] Locating Primary Volume Descriptor\n");
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Disc size: %lu bytes\n", file_size);
+    TRACE_INFO(Trace::CDVD, "[CDVD] Locating Primary Volume Descriptor\n");
     uint8_t type = 0;
     int sector = 0x0F;
     while (type != 1)
     {
         sector++;
-        container->seek(sector, std::ios::beg);
-        container->read(&type, sizeof(uint8_t));
+        read_ahead.read(sector, &type, sizeof(uint8_t));
     }
-    printf("[CDVD] Primary Volume Descriptor found at sector %d\n", sector);
+    TRACE_INFO(Trace::CDVD, "[CDVD] Primary Volume Descriptor found at sector %d\n", sector);
 
-    container->seek(sector, std::ios::beg);
-    container->read(pvd_sector, 2048);
+    read_ahead.read(sector, pvd_sector, 2048);
 
     uint32_t path_table_sector = *(uint32_t*)&pvd_sector[140];
     uint64_t volume_size = *(uint32_t*)&pvd_sector[80];
@@ -308,9 +314,9 @@ bool CDVD_Drive::load_disc(const char *name, CDVD_CONTAINER a_container)
 
     root_location = *(uint32_t*)&pvd_sector[156 + 2];
     root_len = *(uint32_t*)&pvd_sector[156 + 10];
-    printf("[CDVD] Root dir len: %d\n", *(uint16_t*)&pvd_sector[156]);
-    printf("[CDVD] Extent loc: $%08lX\n", root_location * LBA);
-    printf("[CDVD] Extent len: $%08lX\n", root_len);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Root dir len: %d\n", *(uint16_t*)&pvd_sector[156]);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Extent loc: $%08lX\n", root_location * LBA);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Extent len: $%08lX\n", root_len);
 
     // Detecting disc type by abitrary variables
     // 650MB (681574400 bytes) is the maximum disc size for CD's
@@ -327,14 +333,14 @@ bool CDVD_Drive::load_disc(const char *name, CDVD_CONTAINER a_container)
     }
     else if (char* temp = (char*)read_file("PSX.EXE;1", cnf_size))
     {
-        printf("PlayStation 1 CD Detected \n");
+        TRACE_INFO(Trace::CDVD, "PlayStation 1 CD Detected \n");
         disc_type = CDVD_DISC_PSCD;        
         delete[] temp;
         return true;
     }
     else 
     {
-        printf("Non PlayStation Disc inserted \n");
+        TRACE_INFO(Trace::CDVD, "Non PlayStation Disc inserted \n");
         disc_type = CDVD_DISC_ILL;
         return true;
     }
@@ -345,46 +351,50 @@ bool CDVD_Drive::load_disc(const char *name, CDVD_CONTAINER a_container)
     {
         if ((volume_size * LBA) <= 681574400 || path_table_sector != 257)
         {
-            printf("PlayStation 2 CD Detected \n");
+            TRACE_INFO(Trace::CDVD, "PlayStation 2 CD Detected \n");
             disc_type = CDVD_DISC_PS2CD;
             return true;
         }
         else
         {
-            printf("PlayStation 2 DVD Detected \n");
+            TRACE_INFO(Trace::CDVD, "PlayStation 2 DVD Detected \n");
             disc_type = CDVD_DISC_PS2DVD;
             return true;
         }
     }    
     else if (cnf.find("BOOT") != std::string::npos)
     {
-        printf("PlayStation 1 CD Detected \n");
+        TRACE_INFO(Trace::CDVD, "PlayStation 1 CD Detected \n");
         disc_type = CDVD_DISC_PSCD;
         return true;   
     }
     else
     {
-        printf("Non PlayStation Disc inserted \n");
+        TRACE_INFO(Trace::CDVD, "Non PlayStation Disc inserted \n");
         disc_type = CDVD_DISC_ILL;
         return true;
     }
 
-    printf("%s Detected\n", disc_type == CDVD_DISC_PS2CD ? "CD" : "DVD");
-    printf("[CDVD] PVD LBA: $%08X\n", LBA);
+    TRACE_INFO(Trace::CDVD, "%s Detected\n", disc_type == CDVD_DISC_PS2CD ? "CD" : "DVD");
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] PVD LBA: $%08X\n", LBA);
 
     return true;
 }
 
+CDVD_ReadStats CDVD_Drive::get_read_stats()
+{
+    return read_ahead.get_stats();
+}
+
 uint8_t* CDVD_Drive::read_file(string name, uint32_t& file_size)
 {
     uint8_t* root_extent = new uint8_t[root_len];
-    container->seek(root_location, std::ios::beg);
-    container->read(root_extent, root_len);
+    read_ahead.read(root_location, root_extent, root_len);
     uint32_t bytes = 0;
     uint64_t file_location = 0;
     uint8_t* file;
     file_size = 0;
-    printf("[CDVD] Finding %s...\n", name.c_str());
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Finding %s...\n", name.c_str());
     while (bytes < root_len)
     {
         uint64_t directory_len = root_extent[bytes + 32];
@@ -401,15 +411,14 @@ uint8_t* CDVD_Drive::read_file(string name, uint32_t& file_size)
             }
             if (match)
             {
-                printf("[CDVD] Match found!\n");
+                TRACE_DEBUG(Trace::CDVD, "[CDVD] Match found!\n");
                 file_location = *(uint32_t*)&root_extent[bytes + 2];
                 file_size = *(uint32_t*)&root_extent[bytes + 10];
-                printf("[CDVD] Location: $%08lX\n", file_location);
-                printf("[CDVD] Size: $%08X\n", file_size);
+                TRACE_DEBUG(Trace::CDVD, "[CDVD] Location: $%08lX\n", file_location);
+                TRACE_DEBUG(Trace::CDVD, "[CDVD] Size: $%08X\n", file_size);
 
                 file = new uint8_t[file_size];
-                container->seek(file_location, std::ios::beg);
-                container->read(file, file_size);
+                read_ahead.read(file_location, file, file_size);
                 delete[] root_extent;
                 return file;
             }
@@ -423,14 +432,14 @@ uint8_t* CDVD_Drive::read_file(string name, uint32_t& file_size)
 
 uint8_t CDVD_Drive::read_N_command()
 {
-    printf("[CDVD] Read N_command: $%02X\n", N_command);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read N_command: $%02X\n", N_command);
     return N_command;
 }
 
 uint8_t CDVD_Drive::read_disc_type()
 {
     //Not sure what the exact limit is. We'll just go with 1 GB for now.
-    printf("[CDVD] Read disc type\n");
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read disc type\n");
     return disc_type;
 }
 
@@ -442,13 +451,13 @@ uint8_t CDVD_Drive::read_N_status()
 
 uint8_t CDVD_Drive::read_S_status()
 {
-    printf("[CDVD] Read S_status: $%02X\n", S_status);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read S_status: $%02X\n", S_status);
     return S_status;
 }
 
 uint8_t CDVD_Drive::read_S_command()
 {
-    printf("[CDVD] Read S_command: $%02X\n", S_command);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read S_command: $%02X\n", S_command);
     return S_command;
 }
 
@@ -457,7 +466,7 @@ uint8_t CDVD_Drive::read_S_data()
     if (S_out_params <= 0)
         return 0;
     uint8_t value = S_outdata[S_params];
-    printf("[CDVD] Read S data: $%02X\n", value);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read S data: $%02X\n", value);
     S_params++;
     S_out_params--;
     if (S_out_params == 0)
@@ -470,7 +479,7 @@ uint8_t CDVD_Drive::read_S_data()
 
 uint8_t CDVD_Drive::read_ISTAT()
 {
-    printf("[CDVD] Read ISTAT: $%02X\n", ISTAT);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read ISTAT: $%02X\n", ISTAT);
     return ISTAT;
 }
 
@@ -516,7 +525,7 @@ void CDVD_Drive::send_N_command(uint8_t value)
             N_command_dvdread();
             break;
         case 0x09:
-            printf("[CDVD] GetTOC\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] GetTOC\n");
             N_command_gettoc();
             break;
         case 0x0C:
@@ -525,7 +534,7 @@ void CDVD_Drive::send_N_command(uint8_t value)
                     (N_command_params[4]<<8) |
                     (N_command_params[5]<<16) |
                     (N_command_params[6]<<24);
-            printf("[CDVD] ReadKey: $%08X\n", arg);
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] ReadKey: $%08X\n", arg);
             N_command_readkey(arg);
         }
             break;
@@ -537,13 +546,13 @@ void CDVD_Drive::send_N_command(uint8_t value)
 
 uint8_t CDVD_Drive::read_drive_status()
 {
-    printf("[CDVD] Read drive status: $%02X\n", drive_status);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read drive status: $%02X\n", drive_status);
     return drive_status;
 }
 
 void CDVD_Drive::write_N_data(uint8_t value)
 {
-    printf("[CDVD] Write NDATA: $%02X\n", value);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Write NDATA: $%02X\n", value);
     if (N_params > 10)
     {
         Errors::die("[CDVD] Excess NDATA params!\n");
@@ -557,7 +566,7 @@ void CDVD_Drive::write_N_data(uint8_t value)
 
 void CDVD_Drive::write_BREAK()
 {
-    printf("[CDVD] Write BREAK\n");
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Write BREAK\n");
     if (active_N_command == NCOMMAND::NONE || active_N_command == NCOMMAND::BREAK)
         return;
 
@@ -569,7 +578,7 @@ void CDVD_Drive::write_BREAK()
 
 void CDVD_Drive::send_S_command(uint8_t value)
 {
-    printf("[CDVD] Send S command: $%02X\n", value);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Send S command: $%02X\n", value);
     S_status &= ~0x40;
     S_command = value;
     switch (value)
@@ -578,12 +587,12 @@ void CDVD_Drive::send_S_command(uint8_t value)
             S_command_sub(S_command_params[0]);
             break;
         case 0x05:
-            printf("[CDVD] Media Change?\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] Media Change?\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x08:
-            printf("[CDVD] ReadClock\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] ReadClock\n");
             prepare_S_outdata(8);
             S_outdata[0] = 0;
             S_outdata[1] = itob(rtc.second);
@@ -595,7 +604,7 @@ void CDVD_Drive::send_S_command(uint8_t value)
             S_outdata[7] = itob(rtc.year);
             break;
         case 0x09:
-            printf("[CDVD] WriteClock\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] WriteClock\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             rtc.second = S_command_params[0];
@@ -607,7 +616,7 @@ void CDVD_Drive::send_S_command(uint8_t value)
             break;
         case 0x12:
         {
-            printf("[CDVD] sceCdReadILinkId\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] sceCdReadILinkId\n");
             uint8_t iLinkID[9] = { 0x00, 0xAC, 0xFF, 0xFF, 0xFF, 0xFF, 0xB9, 0x86, 0x00 };
             prepare_S_outdata(9);
             for (int i = 0; i < 9; i++)
@@ -615,28 +624,28 @@ void CDVD_Drive::send_S_command(uint8_t value)
         }
             break;
         case 0x13:
-            printf("[CDVD] sceCdWriteILinkId\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] sceCdWriteILinkId\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x15:
-            printf("[CDVD] ForbidDVD\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] ForbidDVD\n");
             prepare_S_outdata(1);
             S_outdata[0] = 5;
             break;
         case 0x17:
-            printf("[CDVD] ReadILinkModel\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] ReadILinkModel\n");
             prepare_S_outdata(9);
             for (int i = 0; i < 9; i++)
                 S_outdata[i] = 0;
             break;
         case 0x1A:
-            printf("[CDVD] BootCertify\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] BootCertify\n");
             prepare_S_outdata(1);
             S_outdata[0] = 1; //means OK according to PCSX2
             break;
         case 0x1B:
-            printf("[CDVD] CancelPwOffReady\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] CancelPwOffReady\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
@@ -649,18 +658,18 @@ void CDVD_Drive::send_S_command(uint8_t value)
             S_outdata[4] = 0x00;
             break;
         case 0x22:
-            printf("[CDVD] CdReadWakeupTime\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] CdReadWakeupTime\n");
             prepare_S_outdata(10);
             for (int i = 0; i < 10; i++)
                 S_outdata[i] = 0;
             break;
         case 0x24:
-            printf("[CDVD] CdRCBypassCtrl\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] CdRCBypassCtrl\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x36: //Stub until we have MEC and NVM file support
-            printf("[CDVD] GetRegionParams\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] GetRegionParams\n");
             prepare_S_outdata(15);
             //This is basically what PCSX2 returns on a blank NVM/MEC file
             S_outdata[0] = 0;
@@ -673,48 +682,48 @@ void CDVD_Drive::send_S_command(uint8_t value)
                 S_outdata[i] = 0;
             break;
         case 0x40:
-            printf("[CDVD] OpenConfig\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] OpenConfig\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x41:
-            printf("[CDVD] ReadConfig\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] ReadConfig\n");
             prepare_S_outdata(16);
             for (int i = 0; i < 16; i++)
                 S_outdata[i] = 0;
             break;
         case 0x42:
-            printf("[CDVD] WriteConfig\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] WriteConfig\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x43:
-            printf("[CDVD] CloseConfig\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] CloseConfig\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x80:
-            printf("[CDVD] MECHACON_auth_0x80\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x80\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x81:
-            printf("[CDVD] MECHACON_auth_0x81\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x81\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x82:
-            printf("[CDVD] MECHACON_auth_0x82\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x82\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x83:
-            printf("[CDVD] MECHACON_auth_0x83\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x83\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x84:
-            printf("[CDVD] MECHACON_auth_0x84\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x84\n");
             prepare_S_outdata(1+8+4);
             S_outdata[0] = 0;
 
@@ -733,7 +742,7 @@ void CDVD_Drive::send_S_command(uint8_t value)
             S_outdata[12] = 0x9b;
             break;
         case 0x85:
-            printf("[CDVD] MECHACON_auth_0x85\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x85\n");
             prepare_S_outdata(1+4+8);
             S_outdata[0] = 0;
 
@@ -752,22 +761,22 @@ void CDVD_Drive::send_S_command(uint8_t value)
             S_outdata[12] = 0xa3;
             break;
         case 0x86:
-            printf("[CDVD] MECHACON_auth_0x86\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x86\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x87:
-            printf("[CDVD] MECHACON_auth_0x87\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x87\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x88:
-            printf("[CDVD] MECHACON_auth_0x88\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x88\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
         case 0x8F:
-            printf("[CDVD] MECHACON_auth_0x8F\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] MECHACON_auth_0x8F\n");
             prepare_S_outdata(1);
             S_outdata[0] = 0;
             break;
@@ -778,7 +787,7 @@ void CDVD_Drive::send_S_command(uint8_t value)
 
 void CDVD_Drive::write_S_data(uint8_t value)
 {
-    printf("[CDVD] Write SDATA: $%02X (%d)\n", value, S_params);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Write SDATA: $%02X (%d)\n", value, S_params);
     if (S_params > 15)
     {
         Errors::die("[CDVD] Excess SDATA params!\n");
@@ -813,34 +822,34 @@ void CDVD_Drive::start_seek()
         //1/3 of a second
         cycles_to_seek = IOP_CLOCK / 3;
         //cycles_to_seek = 1000000;
-        printf("[CDVD] Spinning\n");
+        TRACE_DEBUG(Trace::CDVD, "[CDVD] Spinning\n");
         is_spinning = true;
     }
     else
     {
-        printf("[CDVD] Seeking\n");
+        TRACE_DEBUG(Trace::CDVD, "[CDVD] Seeking\n");
         bool is_DVD = N_command != 0x06;
         int delta = abs((int)current_sector - (int)sector_pos);
-        printf("[CDVD] Seek delta: %d\n", delta);
+        TRACE_DEBUG(Trace::CDVD, "[CDVD] Seek delta: %d\n", delta);
         if ((is_DVD && delta < 16) || (!is_DVD && delta < 8))
         {
-            printf("[CDVD] Contiguous read\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] Contiguous read\n");
             cycles_to_seek = get_block_timing(is_DVD) * delta;
             if (!delta)
             {
                 drive_status = READING | SPINNING;
-                printf("Instant read!\n");
+                TRACE_DEBUG(Trace::CDVD, "Instant read!\n");
             }
         }
         else if ((is_DVD && delta < 14764) || (!is_DVD && delta < 4371))
         {
             cycles_to_seek = (IOP_CLOCK * 30) / 1000;
-            printf("[CDVD] Fast seek\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] Fast seek\n");
         }
         else
         {
             cycles_to_seek = (IOP_CLOCK * 100) / 1000;
-            printf("[CDVD] Full seek\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] Full seek\n");
         }
     }
 
@@ -862,7 +871,9 @@ void CDVD_Drive::start_seek()
     if (seek_to > block_count)
         Errors::print_warning("[CDVD] Invalid sector read $%08X (max size: $%08X)", seek_to, block_count);
 
-    container->seek(seek_to, std::ios::beg);
+    //Reads continue from wherever the seek went, and the host can start on them while the seek is emulated
+    container_sector = seek_to;
+    read_ahead.prefetch(container_sector, sectors_left);
 
     add_event(cycles_to_seek);
 }
@@ -883,7 +894,7 @@ void CDVD_Drive::N_command_read()
             block_size = 2048;
     }
     speed = 24;
-    printf("[CDVD] Read; Seek pos: %lu, Sectors: %lu\n", sector_pos, sectors_left);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read; Seek pos: %lu, Sectors: %lu\n", sector_pos, sectors_left);
     start_seek();
     active_N_command = NCOMMAND::READ_SEEK;
 }
@@ -892,8 +903,8 @@ void CDVD_Drive::N_command_dvdread()
 {
     sector_pos = *(uint32_t*)&N_command_params[0];
     sectors_left = *(uint32_t*)&N_command_params[4];
-    printf("[CDVD] ReadDVD; Seek pos: %lu, Sectors: %lu\n", sector_pos, sectors_left);
-    printf("Last read: %lu cycles ago\n", cycle_count - last_read);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] ReadDVD; Seek pos: %lu, Sectors: %lu\n", sector_pos, sectors_left);
+    TRACE_DEBUG(Trace::CDVD, "Last read: %lu cycles ago\n", cycle_count - last_read);
     last_read = cycle_count;
     speed = 4;
     block_size = 2064;
@@ -903,7 +914,7 @@ void CDVD_Drive::N_command_dvdread()
 
 void CDVD_Drive::N_command_gettoc()
 {
-    printf("[CDVD] Get TOC\n");
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Get TOC\n");
     sectors_left = 0;
     block_size = 2064;
     read_bytes_left = 2064;
@@ -1017,14 +1028,17 @@ void CDVD_Drive::decrypt_mechacon_sector()
 
 void CDVD_Drive::read_CD_sector()
 {
-    printf("[CDVD] Read CD sector - Sector: %lu Size: %lu\n", current_sector, block_size);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read CD sector - Sector: %lu Size: %lu\n", current_sector, block_size);
     switch (block_size)
     {
         case 2340:
             fill_CDROM_sector();
             break;
+        case 2048:
+            read_ahead.read_sector(container_sector, read_buffer);
+            break;
         default:
-            container->read(read_buffer, block_size);
+            read_ahead.read(container_sector, read_buffer, block_size);
             break;
     }
 
@@ -1032,6 +1046,7 @@ void CDVD_Drive::read_CD_sector()
 
     read_bytes_left = block_size;
     current_sector++;
+    container_sector++;
     sectors_left--;
     dma->set_DMA_request(IOP_CDVD);
 }
@@ -1046,7 +1061,7 @@ void CDVD_Drive::fill_CDROM_sector()
     uint32_t seconds = read_sector / 75;
     uint32_t fragments = read_sector - (seconds * 75);
 
-    printf("Minutes: %d Seconds: %d Fragments: %d\n", minutes, seconds, fragments);
+    TRACE_DEBUG(Trace::CDVD, "Minutes: %d Seconds: %d Fragments: %d\n", minutes, seconds, fragments);
 
     memset(temp_buffer, 0, 2340);
     for (int i = 0x1; i < 0xB; i++)
@@ -1055,14 +1070,14 @@ void CDVD_Drive::fill_CDROM_sector()
     temp_buffer[0xD] = itob(seconds);
     temp_buffer[0xE] = itob(fragments);
     temp_buffer[0xF] = 1;
-    container->read(&temp_buffer[0x10 + 0x8], 2048);
+    read_ahead.read_sector(container_sector, &temp_buffer[0x10 + 0x8]);
 
     memcpy(read_buffer, temp_buffer + 0xC, 2340);
 }
 
 void CDVD_Drive::read_DVD_sector()
 {
-    printf("[CDVD] Read DVD sector - Sector: %lu Size: %lu\n", current_sector, block_size);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Read DVD sector - Sector: %lu Size: %lu\n", current_sector, block_size);
 
     int layer_num;
     uint32_t lsn;
@@ -1092,7 +1107,7 @@ void CDVD_Drive::read_DVD_sector()
     read_buffer[9] = 0;
     read_buffer[10] = 0;
     read_buffer[11] = 0;
-    container->read(&read_buffer[12], 2048);
+    read_ahead.read_sector(container_sector, &read_buffer[12]);
     read_buffer[2060] = 0;
     read_buffer[2061] = 0;
     read_buffer[2062] = 0;
@@ -1102,6 +1117,7 @@ void CDVD_Drive::read_DVD_sector()
 
     read_bytes_left = 2064;
     current_sector++;
+    container_sector++;
     sectors_left--;
 
     dma->set_DMA_request(IOP_CDVD);
@@ -1130,7 +1146,7 @@ void CDVD_Drive::S_command_sub(uint8_t func)
     switch (func)
     {
         case 0x00:
-            printf("[CDVD] GetMecaconVersion\n");
+            TRACE_DEBUG(Trace::CDVD, "[CDVD] GetMecaconVersion\n");
             prepare_S_outdata(4);
             *(uint32_t*)&S_outdata[0] = 0x00020603;
             break;
@@ -1141,13 +1157,13 @@ void CDVD_Drive::S_command_sub(uint8_t func)
 
 void CDVD_Drive::write_ISTAT(uint8_t value)
 {
-    printf("[CDVD] Write ISTAT: $%02X\n", value);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Write ISTAT: $%02X\n", value);
     ISTAT &= ~value;
 }
 
 void CDVD_Drive::write_mecha_decode(uint8_t value)
 {
-    printf("[CDVD] Write Mechacon Decode Value: $%02X\n", value);
+    TRACE_DEBUG(Trace::CDVD, "[CDVD] Write Mechacon Decode Value: $%02X\n", value);
     mecha_decode = value;
 }
 
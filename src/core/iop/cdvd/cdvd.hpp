@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <string.h>
 #include "cdvd_container.hpp"
+#include "cdvd_readahead.hpp"
 
 class IOP_INTC;
 class IOP_DMA;
@@ -77,6 +78,7 @@ class CDVD_Drive
         IOP_DMA* dma;
         CDVD_DISC_TYPE disc_type;
         std::unique_ptr<CDVD_Container> container;
+        CDVD_ReadAhead read_ahead;
         size_t file_size;
         Scheduler* scheduler;
         int read_bytes_left;
@@ -88,6 +90,7 @@ class CDVD_Drive
         uint64_t root_len;
 
         uint64_t current_sector;
+        uint64_t container_sector; //Differs from current_sector when a negative sector was seeked
         uint64_t sector_pos;
         uint64_t sectors_left;
         uint64_t block_size;
@@ -151,6 +154,7 @@ class CDVD_Drive
         uint32_t read_to_RAM(uint8_t* RAM, uint32_t bytes);
         uint8_t* read_file(std::string name, uint32_t& file_size);
         bool load_disc(const char* name, CDVD_CONTAINER container);
+        CDVD_ReadStats get_read_stats();
 
         uint8_t read_drive_status();
         uint8_t read_N_command();
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cstring>
+#include "cdvd_blockcache.hpp"
+
+CDVD_BlockCache::CDVD_BlockCache() : block_size(0), block_count(0), read_ahead(0), last_block(UINT32_MAX), quit(false)
+{
+
+}
+
+CDVD_BlockCache::~CDVD_BlockCache()
+{
+    stop();
+}
+
+int CDVD_BlockCache::default_worker_count()
+{
+    //Leave room for the emulator's own threads
+    int cores = (int)std::thread::hardware_concurrency();
+    return std::max(1, std::min(3, cores - 3));
+}
+
+void CDVD_BlockCache::start(size_t block_size, uint32_t block_count, size_t cache_bytes,
+                            int worker_count, int read_ahead, DecodeFunc decode)
+{
+    stop();
+
+    this->block_size = block_size;
+    this->block_count = block_count;
+    this->read_ahead = read_ahead;
+    this->decode = decode;
+
+    //The cache must at least hold everything being read ahead, or workers would evict each other's blocks
+    size_t slot_count = std::max(cache_bytes / block_size, (size_t)read_ahead * 2 + 2);
+    storage.reset(new uint8_t[slot_count * block_size]);
+    free_slots.clear();
+    for (size_t i = 0; i < slot_count; i++)
+        free_slots.push_back(slot_count - 1 - i);
+    entries.clear();
+    lru.clear();
+    pending.clear();
+    queued.clear();
+    in_flight.clear();
+    last_block = UINT32_MAX;
+    caller_buffer.resize(block_size);
+
+    quit = false;
+    for (int i = 1; i <= worker_count; i++)
+        workers.emplace_back(&CDVD_BlockCache::worker_loop, this, i);
+}
+
+void CDVD_BlockCache::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        quit = true;
+    }
+    work_notifier.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+void CDVD_BlockCache::worker_loop(int context)
+{
+    std::vector<uint8_t> buffer(block_size);
+    std::unique_lock<std::mutex> lock(cache_mutex);
+    while (true)
+    {
+        work_notifier.wait(lock, [this] { return quit || !pending.empty(); });
+        if (quit)
+            return;
+
+        uint32_t block = pending.front();
+        pending.pop_front();
+        queued.erase(block);
+        if (entries.count(block) || in_flight.count(block))
+            continue;
+
+        in_flight.insert(block);
+        lock.unlock();
+        bool success = decode(context, block, buffer.data());
+        lock.lock();
+
+        in_flight.erase(block);
+        if (success)
+            insert(block, buffer.data());
+        done_notifier.notify_all();
+    }
+}
+
+//Must be called with cache_mutex held
+void CDVD_BlockCache::insert(uint32_t block, const uint8_t* data)
+{
+    size_t slot;
+    if (free_slots.size())
+    {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }
+    else
+    {
+        uint32_t victim = lru.back();
+        lru.pop_back();
+        slot = entries[victim].slot;
+        entries.erase(victim);
+    }
+
+    std::memcpy(&storage[slot * block_size], data, block_size);
+    lru.push_front(block);
+    entries[block] = {slot, lru.begin()};
+}
+
+//Must be called with cache_mutex held
+void CDVD_BlockCache::queue_read_ahead(uint32_t block)
+{
+    //Anything still queued from before a jump is no longer worth decoding
+    if (block != last_block + 1 && block != last_block)
+    {
+        pending.clear();
+        queued.clear();
+    }
+    last_block = block;
+
+    bool added = false;
+    uint32_t end = (uint32_t)std::min((uint64_t)block + read_ahead + 1, (uint64_t)block_count);
+    for (uint32_t i = block + 1; i < end; i++)
+    {
+        if (entries.count(i) || in_flight.count(i) || queued.count(i))
+            continue;
+        pending.push_back(i);
+        queued.insert(i);
+        added = true;
+    }
+
+    if (added)
+        work_notifier.notify_all();
+}
+
+bool CDVD_BlockCache::read(uint32_t block, size_t offset, uint8_t* dst, size_t bytes)
+{
+    std::unique_lock<std::mutex> lock(cache_mutex);
+    while (true)
+    {
+        auto entry = entries.find(block);
+        if (entry != entries.end())
+        {
+            lru.splice(lru.begin(), lru, entry->second.lru_pos);
+            std::memcpy(dst, &storage[entry->second.slot * block_size + offset], bytes);
+            queue_read_ahead(block);
+            return true;
+        }
+
+        //Waiting for a worker that's already on it beats decoding the block twice
+        if (!in_flight.count(block))
+            break;
+        done_notifier.wait(lock);
+    }
+
+    in_flight.insert(block);
+    queue_read_ahead(block);
+    lock.unlock();
+
+    bool success = decode(0, block, caller_buffer.data());
+
+    lock.lock();
+    in_flight.erase(block);
+    if (success)
+    {
+        insert(block, caller_buffer.data());
+        std::memcpy(dst, &caller_buffer[offset], bytes);
+    }
+    done_notifier.notify_all();
+    return success;
+}
+
+void CDVD_BlockCache::prefetch(uint32_t block, uint32_t count)
+{
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    pending.clear();
+    queued.clear();
+    last_block = block - 1;
+
+    uint32_t end = (uint32_t)std::min((uint64_t)block + std::min(count, (uint32_t)read_ahead), (uint64_t)block_count);
+    for (uint32_t i = block; i < end; i++)
+    {
+        if (entries.count(i) || in_flight.count(i))
+            continue;
+        pending.push_back(i);
+        queued.insert(i);
+    }
+    work_notifier.notify_all();
+}
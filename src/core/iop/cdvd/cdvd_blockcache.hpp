@@ -0,0 +1,77 @@
+#ifndef CDVD_BLOCKCACHE_HPP
+#define CDVD_BLOCKCACHE_HPP
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+LRU cache of decompressed blocks for the compressed disc containers, with a small pool of
+workers that decompress the blocks after the one being read before they're asked for.
+
+The decode function is given a context index so each thread can use its own decoder state:
+0 is the thread calling read, 1 to worker_count are the workers. Only one thread may be in
+read at a time, which the containers already guarantee.
+**/
+
+class CDVD_BlockCache
+{
+    public:
+        typedef std::function<bool(int context, uint32_t block, uint8_t* out)> DecodeFunc;
+    private:
+        struct Entry
+        {
+            size_t slot;
+            std::list<uint32_t>::iterator lru_pos;
+        };
+
+        size_t block_size;
+        uint32_t block_count;
+        int read_ahead;
+        DecodeFunc decode;
+
+        std::mutex cache_mutex;
+        std::condition_variable work_notifier, done_notifier;
+
+        std::unique_ptr<uint8_t[]> storage;
+        std::vector<size_t> free_slots;
+        std::unordered_map<uint32_t, Entry> entries;
+        std::list<uint32_t> lru; //Most recently used at the front
+
+        std::deque<uint32_t> pending;
+        std::unordered_set<uint32_t> queued, in_flight;
+        uint32_t last_block;
+
+        std::vector<uint8_t> caller_buffer;
+
+        std::vector<std::thread> workers;
+        bool quit;
+
+        void worker_loop(int context);
+        void insert(uint32_t block, const uint8_t* data);
+        void queue_read_ahead(uint32_t block);
+    public:
+        CDVD_BlockCache();
+        ~CDVD_BlockCache();
+
+        void start(size_t block_size, uint32_t block_count, size_t cache_bytes,
+                   int worker_count, int read_ahead, DecodeFunc decode);
+        void stop();
+
+        //Copies part of a block, decompressing it on the calling thread if no worker has it yet
+        bool read(uint32_t block, size_t offset, uint8_t* dst, size_t bytes);
+
+        //Queues blocks for the workers without waiting for them
+        void prefetch(uint32_t block, uint32_t count);
+
+        static int default_worker_count();
+};
+
+#endif // CDVD_BLOCKCACHE_HPP
@@ -6,13 +6,25 @@
 class CDVD_Container
 {
     public:
+        virtual ~CDVD_Container() {}
+
         virtual bool open(std::string name) = 0;
         virtual void close() = 0;
         virtual size_t read(uint8_t* buff, size_t bytes) = 0;
         virtual void seek(size_t pos, std::ios::seekdir whence) = 0;
 
+        //Containers that keep the image in memory can hand out sectors in place. Returns nullptr
+        //when the range isn't available that way, in which case seek and read have to be used.
+        virtual const uint8_t* map(size_t sector, size_t bytes) { return nullptr; }
+
+        //Hint that count sectors starting at sector are about to be read
+        virtual void will_read(size_t sector, size_t count) {}
+
         virtual bool is_open() = 0;
         virtual size_t get_size() = 0;
+
+        //Bytes each sector takes up in the image, including any raw headers and error correction
+        virtual size_t get_sector_size() { return 2048; }
 };
 
 #endif // CDVD_CONTAINER_HPP
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include "cdvd_readahead.hpp"
+
+CDVD_ReadAhead::CDVD_ReadAhead() :
+    container(nullptr),
+    sector_count(0),
+    mapped(false),
+    container_next(UINT64_MAX),
+    quit(false),
+    cache(new uint8_t[CACHE_SECTORS * SECTOR_SIZE]),
+    fetch_pos(0),
+    fetch_end(0),
+    request_end(0),
+    hits(0),
+    misses(0),
+    miss_latency_us(0),
+    max_miss_latency_us(0)
+{
+    std::fill(tags, tags + CACHE_SECTORS, 0);
+}
+
+CDVD_ReadAhead::~CDVD_ReadAhead()
+{
+    stop();
+}
+
+void CDVD_ReadAhead::start(CDVD_Container* container, uint64_t sector_count)
+{
+    stop();
+
+    this->container = container;
+    this->sector_count = sector_count;
+    mapped = container->map(0, SECTOR_SIZE) != nullptr;
+    container_next = UINT64_MAX;
+    std::fill(tags, tags + CACHE_SECTORS, 0);
+    fetch_pos = fetch_end = request_end = 0;
+
+    //Mapped sectors are already in memory, a miss outside the mapping is read on the calling thread
+    if (mapped)
+        return;
+
+    quit = false;
+    thread = std::thread(&CDVD_ReadAhead::worker_loop, this);
+}
+
+void CDVD_ReadAhead::stop()
+{
+    if (thread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            quit = true;
+        }
+        notifier.notify_one();
+        thread.join();
+    }
+}
+
+void CDVD_ReadAhead::reset()
+{
+    stop();
+
+    container = nullptr;
+    sector_count = 0;
+    mapped = false;
+    container_next = UINT64_MAX;
+    std::fill(tags, tags + CACHE_SECTORS, 0);
+    fetch_pos = fetch_end = request_end = 0;
+}
+
+void CDVD_ReadAhead::worker_loop()
+{
+    uint8_t buff[SECTOR_SIZE];
+    std::unique_lock<std::mutex> lock(cache_mutex);
+    while (true)
+    {
+        notifier.wait(lock, [this] { return quit || fetch_pos < fetch_end; });
+        if (quit)
+            return;
+
+        uint64_t sector = fetch_pos;
+        if (tags[sector % CACHE_SECTORS] == sector + 1)
+        {
+            fetch_pos++;
+            continue;
+        }
+
+        lock.unlock();
+        {
+            std::lock_guard<std::mutex> container_lock(container_mutex);
+            fetch(sector, buff);
+        }
+        lock.lock();
+
+        //A new prefetch may have moved the window while the lock was dropped
+        if (fetch_pos == sector)
+        {
+            store(sector, buff);
+            fetch_pos++;
+        }
+    }
+}
+
+//Must be called with container_mutex held
+void CDVD_ReadAhead::fetch(uint64_t sector, uint8_t* buff)
+{
+    std::memset(buff, 0, SECTOR_SIZE);
+    if (sector != container_next)
+        container->seek(sector, std::ios::beg);
+    container->read(buff, SECTOR_SIZE);
+    container_next = sector + 1;
+}
+
+void CDVD_ReadAhead::store(uint64_t sector, const uint8_t* buff)
+{
+    std::memcpy(&cache[(sector % CACHE_SECTORS) * SECTOR_SIZE], buff, SECTOR_SIZE);
+    tags[sector % CACHE_SECTORS] = sector + 1;
+}
+
+//Keeps the read-ahead window a bounded distance past what the drive has consumed, so the
+//worker never overwrites a slot that is still ahead of the drive
+void CDVD_ReadAhead::advance_window(uint64_t consumed)
+{
+    fetch_end = std::min(request_end, consumed + READ_AHEAD);
+    fetch_pos = std::max(fetch_pos, consumed);
+}
+
+void CDVD_ReadAhead::prefetch(uint64_t sector, uint64_t count)
+{
+    if (!container)
+        return;
+
+    container->will_read(sector, std::min(sector + count, sector_count) - std::min(sector, sector_count));
+    if (mapped)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        request_end = std::min(sector + count, sector_count);
+        fetch_pos = sector;
+        advance_window(sector);
+    }
+    notifier.notify_one();
+}
+
+void CDVD_ReadAhead::read_sector(uint64_t sector, uint8_t* buff)
+{
+    if (!container)
+    {
+        std::memset(buff, 0, SECTOR_SIZE);
+        return;
+    }
+
+    if (mapped)
+    {
+        if (const uint8_t* data = container->map(sector, SECTOR_SIZE))
+        {
+            std::memcpy(buff, data, SECTOR_SIZE);
+            hits++;
+            return;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        if (tags[sector % CACHE_SECTORS] == sector + 1)
+        {
+            std::memcpy(buff, &cache[(sector % CACHE_SECTORS) * SECTOR_SIZE], SECTOR_SIZE);
+            hits++;
+            advance_window(sector + 1);
+            notifier.notify_one();
+            return;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> container_lock(container_mutex);
+        fetch(sector, buff);
+    }
+    uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+    misses++;
+    miss_latency_us += latency;
+    if (latency > max_miss_latency_us)
+        max_miss_latency_us = latency;
+
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        store(sector, buff);
+        advance_window(sector + 1);
+    }
+    notifier.notify_one();
+}
+
+size_t CDVD_ReadAhead::read(uint64_t sector, uint8_t* buff, size_t bytes)
+{
+    if (!container)
+        return 0;
+
+    std::lock_guard<std::mutex> container_lock(container_mutex);
+    container->seek(sector, std::ios::beg);
+    size_t result = container->read(buff, bytes);
+    container_next = UINT64_MAX;
+    return result;
+}
+
+CDVD_ReadStats CDVD_ReadAhead::get_stats()
+{
+    CDVD_ReadStats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.miss_latency_us = miss_latency_us;
+    stats.max_miss_latency_us = max_miss_latency_us;
+    return stats;
+}
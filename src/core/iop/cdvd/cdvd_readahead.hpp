@@ -0,0 +1,76 @@
+#ifndef CDVD_READAHEAD_HPP
+#define CDVD_READAHEAD_HPP
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "cdvd_container.hpp"
+
+struct CDVD_ReadStats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t miss_latency_us; //Total time the emulator waited on host I/O
+    uint64_t max_miss_latency_us;
+};
+
+/**
+Reads disc sectors on a background thread ahead of the drive. The drive announces where a
+read command will go as soon as it starts seeking, so by the time the emulated seek and
+block timings have passed the data is normally already in the cache. A miss falls back to
+reading on the calling thread. All container access goes through here so the container is
+never used from two threads at once.
+**/
+
+class CDVD_ReadAhead
+{
+    private:
+        constexpr static int SECTOR_SIZE = 2048;
+        constexpr static int CACHE_SECTORS = 512;
+        constexpr static int READ_AHEAD = 256;
+
+        CDVD_Container* container;
+        uint64_t sector_count;
+        bool mapped; //The container serves sectors from memory and does its own read-ahead
+        std::mutex container_mutex;
+        uint64_t container_next; //Sector the container is positioned at, to skip redundant seeks
+
+        std::thread thread;
+        std::mutex cache_mutex;
+        std::condition_variable notifier;
+        bool quit;
+
+        //Direct-mapped. A tag holds the sector number plus one, zero is an empty slot.
+        std::unique_ptr<uint8_t[]> cache;
+        uint64_t tags[CACHE_SECTORS];
+
+        uint64_t fetch_pos, fetch_end, request_end;
+
+        std::atomic<uint64_t> hits, misses, miss_latency_us, max_miss_latency_us;
+
+        void worker_loop();
+        void fetch(uint64_t sector, uint8_t* buff);
+        void store(uint64_t sector, const uint8_t* buff);
+        void advance_window(uint64_t consumed);
+    public:
+        CDVD_ReadAhead();
+        ~CDVD_ReadAhead();
+
+        void start(CDVD_Container* container, uint64_t sector_count);
+        void stop();
+
+        //Stops and forgets the container, reads then return nothing until the next start
+        void reset();
+
+        void prefetch(uint64_t sector, uint64_t count);
+        void read_sector(uint64_t sector, uint8_t* buff);
+
+        //Uncached, for reads that aren't whole sectors such as the filesystem lookups
+        size_t read(uint64_t sector, uint8_t* buff, size_t bytes);
+
+        CDVD_ReadStats get_stats();
+};
+
+#endif // CDVD_READAHEAD_HPP
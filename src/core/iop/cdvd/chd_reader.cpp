@@ -1,30 +1,56 @@
 #include "chd_reader.hpp"
-#include <cassert>
+#include <algorithm>
 #include <cstring>
 
+CHD_Reader::~CHD_Reader()
+{
+    close();
+}
+
 bool CHD_Reader::open(std::string name)
 {
+    close();
+
     chd_error err = chd_open(name.c_str(), CHD_OPEN_READ, nullptr, &m_file);
     if (err != CHDERR_NONE)
     {
         fprintf(stderr, "chd: chd_open: %s\n", chd_error_string(err));
+        m_file = nullptr;
         return false;
     }
 
     m_header = chd_get_header(m_file);
     m_size = m_header->logicalbytes;
-    m_buf = std::make_unique<uint8_t[]>(m_header->hunkbytes);
 
     find_offset();
 
-    // read first hunk in advance
-    err = chd_read(m_file, 0, m_buf.get());
+    int workers = CDVD_BlockCache::default_worker_count();
+    for (int i = 0; i < workers; i++)
+    {
+        chd_file* file;
+        if (chd_open(name.c_str(), CHD_OPEN_READ, nullptr, &file) != CHDERR_NONE)
+            break;
+        m_worker_files.push_back(file);
+    }
+
+    //Decompressed hunks are cached and the next 256 KB decompressed ahead of the reader
+    m_cache.start(m_header->hunkbytes, m_header->totalhunks, 32 * 1024 * 1024, (int)m_worker_files.size(),
+                  std::max(2u, (256 * 1024) / m_header->hunkbytes),
+                  [this](int context, uint32_t hunk, uint8_t* out) { return decode_hunk(context, hunk, out); });
+
+    return true;
+}
+
+//Runs on the block cache's workers as well as the reading thread
+bool CHD_Reader::decode_hunk(int context, uint32_t hunk, uint8_t* out)
+{
+    chd_file* file = context ? m_worker_files[context - 1] : m_file;
+    chd_error err = chd_read(file, hunk, out);
     if (err != CHDERR_NONE)
     {
-        fprintf(stderr, "chd: chd_read: %s\n", chd_error_string(err));
+        fprintf(stderr, "chd: read: %s\n", chd_error_string(err));
         return false;
     }
-
     return true;
 }
 
@@ -68,13 +94,23 @@ void CHD_Reader::find_offset()
 
 void CHD_Reader::close()
 {
-    chd_close(m_file);
+    m_cache.stop();
+    for (chd_file* file : m_worker_files)
+        chd_close(file);
+    m_worker_files.clear();
+
+    if (m_file)
+        chd_close(m_file);
+    m_file = nullptr;
+    m_header = nullptr;
+    m_virtptr = 0;
+    m_size = 0;
 }
 
 size_t CHD_Reader::read(uint8_t* buff, size_t bytes)
 {
-    assert(bytes);
-    assert(m_virtptr + bytes <= m_size);
+    if (!bytes || m_virtptr + bytes > m_size)
+        return 0;
 
     const uint64_t start = m_virtptr;
     const uint64_t end = start + bytes;
@@ -84,19 +120,7 @@ size_t CHD_Reader::read(uint8_t* buff, size_t bytes)
 
     for (uint32_t i = (uint32_t)start_hunk; i <= end_hunk; i++)
     {
-        if (i != m_current_hunk)
-        {
-            chd_error err = chd_read(m_file, i, m_buf.get());
-            if (err != CHDERR_NONE)
-            {
-                fprintf(stderr, "chd: read: %s\n", chd_error_string(err));
-                return total_read;
-            }
-
-            m_current_hunk = i;
-        }
-
-        const uint64_t local_ofs = start - (uint64_t)start_hunk * m_header->hunkbytes;
+        const uint64_t local_ofs = (i == start_hunk) ? start - (uint64_t)start_hunk * m_header->hunkbytes : 0;
         uint64_t readlen = m_header->hunkbytes;
 
         if (i == start_hunk)
@@ -104,9 +128,11 @@ size_t CHD_Reader::read(uint8_t* buff, size_t bytes)
         if (i == end_hunk)
             readlen -= m_header->hunkbytes - (end - (uint64_t)end_hunk * m_header->hunkbytes);
 
-        assert(readlen <= bytes);
+        if (!readlen)
+            continue;
 
-        memcpy(buff, m_buf.get() + local_ofs + m_sector_offset, readlen);
+        if (!m_cache.read(i, local_ofs + m_sector_offset, buff, readlen))
+            return total_read;
         total_read += readlen;
 
         //m_virtptr += readlen;
@@ -120,6 +146,17 @@ size_t CHD_Reader::read(uint8_t* buff, size_t bytes)
     return total_read;
 }
 
+void CHD_Reader::will_read(size_t sector, size_t count)
+{
+    uint64_t start = (uint64_t)sector * m_header->unitbytes;
+    if (start >= m_size)
+        return;
+
+    uint64_t end = std::min(start + (uint64_t)count * m_header->unitbytes, (uint64_t)m_size);
+    uint64_t start_hunk = start / m_header->hunkbytes;
+    m_cache.prefetch((uint32_t)start_hunk, (uint32_t)((end - 1) / m_header->hunkbytes - start_hunk + 1));
+}
+
 void CHD_Reader::seek(size_t ofs, std::ios::seekdir whence)
 {
     ofs *= m_header->unitbytes;
@@ -2,16 +2,21 @@
 #define __CHD_H_
 
 #include <memory>
+#include <vector>
 #include <libchdr/chd.h>
+#include "cdvd_blockcache.hpp"
 #include "cdvd_container.hpp"
 
 class CHD_Reader : public CDVD_Container
 {
     public:
+        ~CHD_Reader();
+
         bool open(std::string name);
         void close();
         size_t read(uint8_t* buff, size_t bytes);
         void seek(size_t pos, std::ios::seekdir whence);
+        void will_read(size_t sector, size_t count);
 
         bool is_open();
         size_t get_size();
@@ -23,10 +28,13 @@ class CHD_Reader : public CDVD_Container
         uint32_t m_sector_offset {0};
         uint64_t m_virtptr {0};
         size_t m_size {0};
-        uint32_t m_current_hunk {0};
-        std::unique_ptr<uint8_t[]> m_buf;
+
+        //libchdr's decoders aren't thread safe, so each block cache worker opens the file itself
+        std::vector<chd_file*> m_worker_files;
+        CDVD_BlockCache m_cache;
 
         void find_offset();
+        bool decode_hunk(int context, uint32_t hunk, uint8_t* out);
 };
 
 
@@ -8,8 +8,8 @@ Based off reference by unknownbrackets:
 
 #include "cso_reader.hpp"
 #include <zlib.h>
+#include <algorithm>
 #include <cstring>
-#include <cassert>
 
 constexpr uint32_t FOURCC(const char chars[4])
 {
@@ -46,8 +46,7 @@ struct CSO_Header
 CSO_Reader::CSO_Reader() :
     m_size(0), m_shift(0), m_blocksize(0), m_version(0), m_virtptr(0),
     m_indices(nullptr),
-    m_framesize(0), m_curframe(0xFFFFFFFF),
-    m_frame(nullptr), m_readbuf(nullptr) {}
+    m_framesize(0), m_numblocks(0) {}
 
 CSO_Reader::~CSO_Reader()
 {
@@ -72,7 +71,7 @@ uint32_t CSO_Reader::get_blocksize()
 
 uint32_t CSO_Reader::get_numblocks()
 {
-    return (uint32_t)(m_size / m_blocksize);
+    return m_numblocks;
 }
 
 
@@ -108,109 +107,98 @@ uint64_t CSO_Reader::tell()
     return m_virtptr;
 }
 
-bool CSO_Reader::read_block_internal(uint32_t block)
+//Runs on the block cache's workers as well as the reading thread
+bool CSO_Reader::decode_block(int context, uint32_t block, uint8_t* frame)
 {
-    // if this block was decoded last time we don't need to do it again
-    if (block == m_curframe)
-        return true;
-    
     uint32_t index = m_indices[block];
     uint64_t ofs = (uint64_t)(index & ~IDX_COMPRESS_BIT) << m_shift;
     uint64_t len = ((uint64_t)(m_indices[block + 1] & ~IDX_COMPRESS_BIT) << m_shift) - ofs;
-    
-    if (index & IDX_COMPRESS_BIT) // if uncompressed
+    bool uncompressed = index & IDX_COMPRESS_BIT;
+    uint8_t* readbuf = uncompressed ? frame : m_readbufs[context].data();
+
     {
+        std::lock_guard<std::mutex> lock(m_file_mutex);
+        m_file.clear();
         m_file.seekg(ofs, std::ios::beg);
-        m_file.read((char*)m_frame, len);
+        m_file.read((char*)readbuf, len);
         if ((uint64_t)m_file.gcount() != len)
         {
-            fprintf(stderr, "read error reading (uncompressed) block %d\n", block);
-            m_curframe = 0xFFFFFFFF;
+            fprintf(stderr, "read error reading (%s) block %d\n", uncompressed ? "uncompressed" : "compressed", block);
             return false;
         }
     }
-    else // compressed
-    {
-        m_file.seekg(ofs, std::ios::beg);
-        m_file.read((char*)m_readbuf, len);
-        if ((uint64_t)m_file.gcount() != len)
-        {
-            fprintf(stderr, "read error reading (compressed) block %d\n", block);
-            return false;
-        }
 
-        z_stream z;
-        z.zalloc = Z_NULL;
-        z.zfree = Z_NULL;
-        z.opaque = Z_NULL;
-        if (inflateInit2(&z, -15) != Z_OK)
-        {
-            fprintf(stderr, "Unable to initialize inflate: %s\n", (z.msg) ? z.msg : "?");
-            return false;
-        }
-
-        z.next_in = m_readbuf;
-        z.avail_in = len;
-        z.next_out = m_frame;
-        z.avail_out = m_framesize;
+    if (uncompressed)
+        return true;
 
-        auto res = inflate(&z, Z_FINISH);
-        if (res != Z_STREAM_END)
-        {
-            fprintf(stderr, "zlib error on block %d: %d, %s\n", block, res, (z.msg) ? z.msg: "?");
-            m_curframe = 0xFFFFFFFF;
-            return false;
+    z_stream z;
+    z.zalloc = Z_NULL;
+    z.zfree = Z_NULL;
+    z.opaque = Z_NULL;
+    if (inflateInit2(&z, -15) != Z_OK)
+    {
+        fprintf(stderr, "Unable to initialize inflate: %s\n", (z.msg) ? z.msg : "?");
+        return false;
+    }
 
-        }
+    z.next_in = readbuf;
+    z.avail_in = (uInt)len;
+    z.next_out = frame;
+    z.avail_out = m_framesize;
 
-        size_t read = z.total_out;
+    auto res = inflate(&z, Z_FINISH);
+    size_t read = z.total_out;
+    inflateEnd(&z);
 
-        if (read < m_blocksize)
-        {
-            fprintf(stderr, "compressed sector %d decoded to less than the blocksize\n", block);
-            m_curframe = 0xFFFFFFFF;
-            return false;
-        }
+    if (res != Z_STREAM_END)
+    {
+        fprintf(stderr, "zlib error on block %d: %d\n", block, res);
+        return false;
+    }
 
-        inflateEnd(&z);
+    if (read < m_blocksize)
+    {
+        fprintf(stderr, "compressed sector %d decoded to less than the blocksize\n", block);
+        return false;
     }
-    
-    m_curframe = block;
+
     return true;
 }
 
 size_t CSO_Reader::read(uint8_t* dst, size_t size)
 {
-    assert(size);
-    assert(m_virtptr + size <= m_size);
-    
-    const uint64_t start = m_virtptr;
-    const uint64_t end = start + size;
-    const auto start_block = (uint32_t)(start / m_blocksize);
-    const auto end_block = (uint32_t)(end / m_blocksize);
-    
+    if (m_virtptr >= m_size)
+        return 0;
+    size = std::min(size, (size_t)(m_size - m_virtptr));
+
     uint64_t total_read = 0;
-    for (uint32_t i = start_block; i <= end_block; ++i)
+    while (total_read < size)
     {
-        if (!read_block_internal(i))
+        const auto block = (uint32_t)(m_virtptr / m_blocksize);
+        const uint64_t local_ofs = m_virtptr - (uint64_t)block * m_blocksize;
+        const uint64_t readlen = std::min((uint64_t)m_blocksize - local_ofs, (uint64_t)(size - total_read));
+
+        if (!m_cache.read(block, local_ofs, dst, readlen))
             return total_read;
-        
-        const uint64_t local_ofs = start - (uint64_t)start_block * m_blocksize;
-        uint64_t readlen = m_blocksize;
-        if (i == start_block)
-            readlen -= local_ofs;
-        if (i == end_block)
-            readlen -= m_blocksize - (end - (uint64_t)end_block * m_blocksize);
-
-        memcpy(dst, m_frame + local_ofs, readlen);
+
         total_read += readlen;
         m_virtptr += readlen;
         dst += readlen;
     }
-    
+
     return total_read;
 }
 
+void CSO_Reader::will_read(size_t sector, size_t count)
+{
+    uint64_t start = (uint64_t)sector * 2048;
+    if (start >= m_size)
+        return;
+
+    uint64_t end = std::min(start + (uint64_t)count * 2048, (uint64_t)m_size);
+    m_cache.prefetch((uint32_t)(start / m_blocksize), (uint32_t)((end - 1) / m_blocksize - start / m_blocksize + 1));
+}
+
 bool CSO_Reader::open(std::string name)
 {
     close();
@@ -312,20 +300,22 @@ bool CSO_Reader::open(std::string name)
     m_shift = header.index_shift;
     m_blocksize = header.block_len;
     m_framesize = framesize;
-    m_frame = new uint8_t[m_framesize];
-    m_readbuf = new uint8_t[m_framesize];
+    m_numblocks = num_entries - 1;
+
+    //Decompressed frames are cached and the next 256 KB decompressed ahead of the reader
+    int workers = CDVD_BlockCache::default_worker_count();
+    m_readbufs.assign(workers + 1, std::vector<uint8_t>(m_framesize));
+    m_cache.start(m_framesize, m_numblocks, 16 * 1024 * 1024, workers, std::max(4u, (256 * 1024) / m_blocksize),
+                  [this](int context, uint32_t block, uint8_t* frame) { return decode_block(context, block, frame); });
     
     return true;
 }
 
 void CSO_Reader::close()
 {
-    delete[] m_readbuf;
-    m_readbuf = nullptr;
+    m_cache.stop();
+    m_readbufs.clear();
 
-    delete[] m_frame;
-    m_frame = nullptr;
-    
     delete[] m_indices;
     m_indices = nullptr;
 
@@ -338,5 +328,5 @@ void CSO_Reader::close()
     m_shift = 0;
     m_blocksize = 0;
     m_framesize = 0;
-    m_curframe = 0xFFFFFFFF;
+    m_numblocks = 0;
 }
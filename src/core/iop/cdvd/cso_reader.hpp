@@ -3,6 +3,9 @@
 
 #include <fstream>
 #include <cstdint>
+#include <mutex>
+#include <vector>
+#include "cdvd_blockcache.hpp"
 #include "cdvd_container.hpp"
 
 class CSO_Reader : public CDVD_Container
@@ -18,11 +21,14 @@ class CSO_Reader : public CDVD_Container
         uint32_t* m_indices;
 
         uint32_t m_framesize;
-        uint32_t m_curframe;
-        uint8_t* m_frame;
-        uint8_t* m_readbuf;
+        uint32_t m_numblocks;
 
-        bool read_block_internal(uint32_t block);
+        //The file is shared by the block cache's workers, decompression isn't
+        std::mutex m_file_mutex;
+        std::vector<std::vector<uint8_t>> m_readbufs;
+        CDVD_BlockCache m_cache;
+
+        bool decode_block(int context, uint32_t block, uint8_t* frame);
     public:
         CSO_Reader();
         ~CSO_Reader();
@@ -31,6 +37,7 @@ class CSO_Reader : public CDVD_Container
         void close();
         size_t read(uint8_t* dst, size_t size);
         void seek(size_t ofs, std::ios::seekdir whence);
+        void will_read(size_t sector, size_t count);
 
         bool is_open();
         size_t get_size();
@@ -1,42 +1,180 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
 #include "iso_reader.hpp"
 
-ISO_Reader::ISO_Reader()
+ISO_Reader::ISO_Reader() : mapping(nullptr), map_handle(nullptr), mapped_pos(0), size(0)
+{
+
+}
+
+ISO_Reader::~ISO_Reader()
+{
+    close();
+}
+
+bool ISO_Reader::map_file(std::string name)
+{
+#ifdef _WIN32
+    HANDLE file_handle = CreateFileA(name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                     FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_handle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size) || !file_size.QuadPart)
+    {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    //The mapping object keeps the file open
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file_handle);
+    if (!mapping_handle)
+        return false;
+
+    void* view = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping_handle);
+        return false;
+    }
+
+    map_handle = mapping_handle;
+    size = (size_t)file_size.QuadPart;
+    mapping = (const uint8_t*)view;
+#else
+    int fd = ::open(name.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || !info.st_size)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    //The mapping keeps the file open
+    void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return false;
+
+    size = (size_t)info.st_size;
+    mapping = (const uint8_t*)view;
+#endif
+    mapped_pos = 0;
+    return true;
+}
+
+void ISO_Reader::unmap_file()
 {
+    if (!mapping)
+        return;
 
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+    CloseHandle((HANDLE)map_handle);
+    map_handle = nullptr;
+#else
+    munmap((void*)mapping, size);
+#endif
+    mapping = nullptr;
 }
 
 bool ISO_Reader::open(std::string name)
 {
-    if (file.is_open())
+    if (is_open())
         close();
 
+    if (map_file(name))
+        return true;
+
     file.open(name, std::ios::binary);
-    return file.is_open();
+    if (!file.is_open())
+        return false;
+
+    file.seekg(0, std::ios::end);
+    size = file.tellg();
+    file.seekg(0);
+    return true;
 }
 
 void ISO_Reader::close()
 {
+    unmap_file();
     file.close();
 }
 
 size_t ISO_Reader::read(uint8_t* buff, size_t bytes)
 {
+    if (mapping)
+    {
+        bytes = std::min(bytes, size - std::min(mapped_pos, size));
+        std::memcpy(buff, mapping + mapped_pos, bytes);
+        mapped_pos += bytes;
+        return bytes;
+    }
+
     file.read((char*)buff, bytes);
     return file.gcount();
 }
 
 void ISO_Reader::seek(size_t pos, std::ios::seekdir whence)
 {
+    if (mapping)
+    {
+        mapped_pos = pos * 2048;
+        return;
+    }
+
+    //A read past the end of the disc mustn't leave the stream unusable for later reads
+    file.clear();
     file.seekg(pos * 2048);
 }
 
+const uint8_t* ISO_Reader::map(size_t sector, size_t bytes)
+{
+    if (!mapping || sector * 2048 + bytes > size)
+        return nullptr;
+    return mapping + sector * 2048;
+}
+
+void ISO_Reader::will_read(size_t sector, size_t count)
+{
+#ifndef _WIN32
+    if (!mapping || sector * 2048 >= size)
+        return;
+
+    //madvise wants page aligned ranges. Only the start of a long read is brought in up front,
+    //the sequential hint lets the kernel keep up with the rest.
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t WILLNEED_BYTES = 4 * 1024 * 1024;
+
+    size_t start = (sector * 2048) & ~(page_size - 1);
+    size_t end = std::min(sector * 2048 + count * 2048, size);
+    madvise((void*)(mapping + start), end - start, MADV_SEQUENTIAL);
+    madvise((void*)(mapping + start), std::min(end - start, WILLNEED_BYTES), MADV_WILLNEED);
+#endif
+}
+
 bool ISO_Reader::is_open()
 {
-    return file.is_open();
+    return mapping || file.is_open();
 }
 
 size_t ISO_Reader::get_size()
 {
-    file.seekg(0, std::ios::end);
-    return file.tellg();
+    return size;
 }
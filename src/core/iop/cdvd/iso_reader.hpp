@@ -5,15 +5,28 @@
 class ISO_Reader : public CDVD_Container
 {
     protected:
+        //The whole image is mapped when possible, with buffered reads as the fallback
+        const uint8_t* mapping;
+        void* map_handle;
+        size_t mapped_pos;
+
         std::ifstream file;
+        size_t size;
+
+        bool map_file(std::string name);
+        void unmap_file();
     public:
         ISO_Reader();
+        ~ISO_Reader();
 
         bool open(std::string name);
         void close();
         size_t read(uint8_t *buff, size_t bytes);
         void seek(size_t pos, std::ios::seekdir whence);
 
+        const uint8_t* map(size_t sector, size_t bytes);
+        void will_read(size_t sector, size_t count);
+
         bool is_open();
         size_t get_size();
 };
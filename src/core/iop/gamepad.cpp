@@ -6,7 +6,6 @@
 
 //Reply buffers taken from PCSX2's LilyPad
 
-uint8_t Gamepad::mask_mode[7] = {0x5A, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x5A};
 const uint8_t Gamepad::vref_param[7] = {0x5A, 0x00, 0x00, 0x02, 0x00, 0x00, 0x5A};
 const uint8_t Gamepad::config_exit[7] = {0x5A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
 const uint8_t Gamepad::set_mode[7] = {0x5A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
@@ -154,6 +153,8 @@ uint8_t Gamepad::write_SIO(uint8_t value)
                 set_result(vref_param);
                 return 0xF3;
             case 'A': //0x41 - query masked mode
+            {
+                uint8_t mask_mode[7] = {0x5A, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x5A};
                 if (pad_mode == DIGITAL)
                 {
                     mask_mode[3] = 0;
@@ -170,6 +171,7 @@ uint8_t Gamepad::write_SIO(uint8_t value)
                 }
                 set_result(mask_mode);
                 return 0xF3;
+            }
             case 'D': //0x44 - set mode and lock
                 set_result(set_mode);
                 reset_vibrate();
@@ -56,7 +56,6 @@ class Gamepad
         int data_count;
 
         uint8_t mask[2];
-        static uint8_t mask_mode[7];
         const static uint8_t vref_param[7];
         const static uint8_t config_exit[7];
         const static uint8_t set_mode[7];
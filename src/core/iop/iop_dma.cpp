@@ -6,6 +6,7 @@
 #include "spu/spu.hpp"
 
 #include "../errors.hpp"
+#include "../trace.hpp"
 #include "../sif.hpp"
 
 IOP_DMA::IOP_DMA(IOP_INTC* intc, CDVD_Drive* cdvd, SubsystemInterface* sif, SIO2* sio2, class SPU* spu, class SPU* spu2) :
@@ -25,6 +26,7 @@ void IOP_DMA::reset(uint8_t* RAM)
 {
     this->RAM = RAM;
     active_channel = nullptr;
+    SIF0_junk_words = 0;
     queued_channels.clear();
     for (int i = 0; i < 16; i++)
     {
@@ -62,10 +64,15 @@ void IOP_DMA::run(int cycles)
     }
 }
 
+bool IOP_DMA::is_idle()
+{
+    return !active_channel;
+}
+
 void IOP_DMA::process_CDVD()
 {
     uint32_t count = channels[IOP_CDVD].word_count * channels[IOP_CDVD].block_size * 4;
-    printf("[IOP DMA] CDVD bytes: $%08X\n", count);
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] CDVD bytes: $%08X\n", count);
     uint32_t bytes_read = cdvd->read_to_RAM(RAM + channels[IOP_CDVD].addr, count);
     if (count <= bytes_read)
     {
@@ -167,7 +174,6 @@ void IOP_DMA::process_SPU2()
 
 void IOP_DMA::process_SIF0()
 {
-    static int junk_words = 0;
     if (channels[IOP_SIF0].word_count)
     {
         uint32_t data = *(uint32_t*)&RAM[channels[IOP_SIF0].addr];
@@ -177,7 +183,7 @@ void IOP_DMA::process_SIF0()
         channels[IOP_SIF0].word_count--;
         if (!channels[IOP_SIF0].word_count)
         {
-            sif->send_SIF0_junk(junk_words);
+            sif->send_SIF0_junk(SIF0_junk_words);
             if (channels[IOP_SIF0].tag_end)
                 transfer_end(IOP_SIF0);
         }
@@ -204,14 +210,14 @@ void IOP_DMA::process_SIF0()
          * I have surmised that the correct behavior on nonaligned transfers is to read the oldest values
          * from previous transfers. This indeed results in the game's memory being nonzero, allowing it to go in-game.
          */
-        junk_words = (words & 0x3) ? (4 - (words & 0x3)) : 0;
+        SIF0_junk_words = (words & 0x3) ? (4 - (words & 0x3)) : 0;
 
         channels[IOP_SIF0].tag_addr += 16;
 
-        printf("[IOP DMA] Read SIF0 DMAtag!\n");
-        printf("Data: $%08X\n", data);
-        printf("Words: $%08X\n", channels[IOP_SIF0].word_count);
-        printf("Junk: %d\n", junk_words);
+        TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] Read SIF0 DMAtag!\n");
+        TRACE_DEBUG(Trace::IOP_DMA, "Data: $%08X\n", data);
+        TRACE_DEBUG(Trace::IOP_DMA, "Words: $%08X\n", channels[IOP_SIF0].word_count);
+        TRACE_DEBUG(Trace::IOP_DMA, "Junk: %d\n", SIF0_junk_words);
 
         if ((data & (1 << 31)) || (data & (1 << 30)))
             channels[IOP_SIF0].tag_end = true;
@@ -240,9 +246,9 @@ void IOP_DMA::process_SIF1()
         //EEtag
         sif->read_SIF1();
         sif->read_SIF1();
-        printf("[IOP DMA] Read SIF1 DMAtag!\n");
-        printf("Addr: $%08X\n", channels[IOP_SIF1].addr);
-        printf("Words: $%08X\n", channels[IOP_SIF1].word_count);
+        TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] Read SIF1 DMAtag!\n");
+        TRACE_DEBUG(Trace::IOP_DMA, "Addr: $%08X\n", channels[IOP_SIF1].addr);
+        TRACE_DEBUG(Trace::IOP_DMA, "Words: $%08X\n", channels[IOP_SIF1].word_count);
         if ((data & (1 << 31)) || (data & (1 << 30)))
             channels[IOP_SIF1].tag_end = true;
     }
@@ -279,7 +285,7 @@ void IOP_DMA::process_SIO2out()
 
 void IOP_DMA::transfer_end(int index)
 {
-    printf("[IOP DMA] %s transfer ended\n", CHAN(index));
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] %s transfer ended\n", CHAN(index));
     channels[index].control.busy = false;
     channels[index].tag_end = false;
 
@@ -291,7 +297,7 @@ void IOP_DMA::transfer_end(int index)
         index -= 8;
     if (DICR.MASK[dicr2] & (1 << index))
     {
-        printf("[IOP DMA] IRQ requested: $%08X $%08X\n", DICR.STAT[dicr2], DICR.MASK[dicr2]);
+        TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] IRQ requested: $%08X $%08X\n", DICR.STAT[dicr2], DICR.MASK[dicr2]);
         DICR.STAT[dicr2] |= 1 << index;
         intc->assert_irq(3);
     }
@@ -382,7 +388,7 @@ uint32_t IOP_DMA::get_chan_control(int index)
 
 void IOP_DMA::set_DPCR(uint32_t value)
 {
-    printf("[IOP DMA] Set DPCR: $%08X\n", value);
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] Set DPCR: $%08X\n", value);
     for (int i = 0; i < 8; i++)
     {
         bool old_enable = DPCR.enable[i];
@@ -395,7 +401,7 @@ void IOP_DMA::set_DPCR(uint32_t value)
 
 void IOP_DMA::set_DPCR2(uint32_t value)
 {
-    printf("[IOP DMA] Set DPCR2: $%08X\n", value);
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] Set DPCR2: $%08X\n", value);
     for (int i = 8; i < 16; i++)
     {
         int bit = i - 8;
@@ -451,13 +457,13 @@ void IOP_DMA::clear_DMA_request(int index)
 
 void IOP_DMA::set_chan_addr(int index, uint32_t value)
 {
-    printf("[IOP DMA] %s addr: $%08X\n", CHAN(index), value);
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] %s addr: $%08X\n", CHAN(index), value);
     channels[index].addr = value;
 }
 
 void IOP_DMA::set_chan_block(int index, uint32_t value)
 {
-    printf("[IOP DMA] %s block: $%08X\n", CHAN(index), value);
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] %s block: $%08X\n", CHAN(index), value);
     channels[index].block_size = value & 0xFFFF;
     channels[index].word_count = value >> 16;
     channels[index].size = channels[index].block_size * channels[index].word_count;
@@ -465,21 +471,21 @@ void IOP_DMA::set_chan_block(int index, uint32_t value)
 
 void IOP_DMA::set_chan_size(int index, uint16_t value)
 {
-    printf("[IOP DMA] %s size: $%04X\n", CHAN(index), value);
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] %s size: $%04X\n", CHAN(index), value);
     channels[index].block_size = value;
     channels[index].size = channels[index].block_size * channels[index].word_count;
 }
 
 void IOP_DMA::set_chan_count(int index, uint16_t value)
 {
-    printf("[IOP DMA] %s count: $%04X\n", CHAN(index), value);
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] %s count: $%04X\n", CHAN(index), value);
     channels[index].word_count = value;
     channels[index].size = channels[index].block_size * channels[index].word_count;
 }
 
 void IOP_DMA::set_chan_control(int index, uint32_t value)
 {
-    printf("[IOP DMA] %s control: $%08X\n", CHAN(index), value);
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] %s control: $%08X\n", CHAN(index), value);
     bool old_busy = channels[index].control.busy;
     channels[index].control.direction_from = value & 1;
     channels[index].control.unk8 = value & (1 << 8);
@@ -512,7 +518,7 @@ void IOP_DMA::set_chan_control(int index, uint32_t value)
 
 void IOP_DMA::set_chan_tag_addr(int index, uint32_t value)
 {
-    printf("[IOP DMA] %s tag addr: $%08X\n", CHAN(index), value);
+    TRACE_DEBUG(Trace::IOP_DMA, "[IOP DMA] %s tag addr: $%08X\n", CHAN(index), value);
     channels[index].tag_addr = value;
 }
 
@@ -572,7 +578,7 @@ void IOP_DMA::find_new_active_channel()
     }
 
     queued_channels.erase(channel_to_erase);
-    printf("New active channel: %s\n", CHAN(active_channel->index));
+    TRACE_DEBUG(Trace::IOP_DMA, "New active channel: %s\n", CHAN(active_channel->index));
 }
 
 void IOP_DMA::apply_dma_functions()
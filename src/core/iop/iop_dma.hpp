@@ -83,6 +83,7 @@ class IOP_DMA
         SPU *spu, *spu2;
         IOP_DMA_Channel channels[16];
         IOP_DMA_Channel* active_channel;
+        int SIF0_junk_words;
         std::list<IOP_DMA_Channel*> queued_channels;
 
         //Merge of DxCR, DxCR2, DxCR3 for easier processing
@@ -108,6 +109,7 @@ class IOP_DMA
 
         void reset(uint8_t* RAM);
         void run(int cycles);
+        bool is_idle();
 
         uint32_t get_DPCR();
         uint32_t get_DPCR2();
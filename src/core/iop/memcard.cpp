@@ -1,3 +1,12 @@
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstring>
 #include <fstream>
 #include "../errors.hpp"
@@ -15,14 +24,50 @@
  * Once the card has been detected successfully, handling read/write/erase commands is quite simple.
  */
 
+/**
+ * Saving works a page at a time. Writes mark pages dirty, and once a frame the dirty pages are copied
+ * and handed to a flush thread, so the emulator never waits on the disk.
+ *
+ * So that a crash or power loss can't leave a half-written card, the flush thread first writes the
+ * pages to a journal next to the card and syncs it. Only then are the pages written into the card
+ * itself, after which the journal is deleted. Opening a card replays a complete journal left behind
+ * by an interrupted flush, and discards an incomplete one, which means the card was never touched.
+ */
+
+#define JOURNAL_MAGIC 0x314A4D44 //DMJ1
+#define JOURNAL_END 0x454E4F44 //DONE
+
+static bool sync_file(FILE* file)
+{
+    if (fflush(file))
+        return false;
+#ifdef _WIN32
+    return !_commit(_fileno(file));
+#else
+    return !fsync(fileno(file));
+#endif
+}
+
+static uint32_t journal_checksum(uint32_t checksum, const uint8_t* data, size_t size)
+{
+    //FNV-1a
+    for (size_t i = 0; i < size; i++)
+        checksum = (checksum ^ data[i]) * 16777619;
+    return checksum;
+}
+
 Memcard::Memcard()
 {
     mem = nullptr;
     file_opened = false;
+    is_dirty = false;
+    flush_quit = false;
 }
 
 Memcard::~Memcard()
 {
+    save_if_dirty();
+    stop_flush_thread();
     delete[] mem;
 }
 
@@ -36,8 +81,27 @@ void Memcard::reset()
     terminator = 0x55;
 }
 
+uint32_t Memcard::raw_page_size()
+{
+    //On standard memory cards, an additional 16 bytes is included in every page for ECC.
+    return specs.page_size + 16;
+}
+
+std::string Memcard::journal_name()
+{
+    return file_name + ".journal";
+}
+
 bool Memcard::open(std::string file_name)
 {
+    //Anything still bound for the previous card has to reach it first
+    save_if_dirty();
+    stop_flush_thread();
+
+    this->file_name = file_name;
+    if (!replay_journal())
+        Errors::print_warning("[Memcard] Failed to recover %s from its journal\n", file_name.c_str());
+
     std::ifstream file(file_name, std::ios::binary);
 
     if (mem)
@@ -54,14 +118,15 @@ bool Memcard::open(std::string file_name)
         specs.page_count = 0x4000;
         file_opened = true;
 
-        //On standard memory cards, an additional 16 bytes is included in every page for ECC.
-        size_t memcard_size = (specs.page_size + 16) * specs.page_count;
+        size_t memcard_size = raw_page_size() * specs.page_count;
 
         mem = new uint8_t[memcard_size];
         file.read((char*)mem, memcard_size);
         file.close();
 
-        this->file_name = file_name;
+        dirty_pages.assign(specs.page_count, false);
+        flush_quit = false;
+        flush_thread = std::thread(&Memcard::flush_loop, this);
     }
     else
     {
@@ -89,15 +154,162 @@ void Memcard::start_transfer()
     memset(response_buffer, 0, sizeof(response_buffer));
 }
 
+void Memcard::mark_dirty(uint32_t addr, uint32_t size)
+{
+    uint32_t first = addr / raw_page_size();
+    uint32_t last = std::min((addr + size - 1) / raw_page_size(), specs.page_count - 1);
+    for (uint32_t page = first; page <= last; page++)
+        dirty_pages[page] = true;
+    is_dirty = true;
+}
+
 void Memcard::save_if_dirty()
 {
-    if (is_dirty && file_opened)
+    if (!is_dirty || !file_opened)
+        return;
+
     {
-        std::ofstream file(file_name, std::ios::binary);
-        file.write((char*)mem, 0x840000);
-        file.close();
-        is_dirty = false;
+        std::lock_guard<std::mutex> lock(flush_mutex);
+        for (uint32_t page = 0; page < specs.page_count; page++)
+        {
+            if (!dirty_pages[page])
+                continue;
+
+            uint8_t* data = &mem[page * raw_page_size()];
+            pending_pages[page].assign(data, data + raw_page_size());
+            dirty_pages[page] = false;
+        }
+    }
+    is_dirty = false;
+    flush_notifier.notify_one();
+}
+
+void Memcard::stop_flush_thread()
+{
+    if (!flush_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(flush_mutex);
+        flush_quit = true;
     }
+    flush_notifier.notify_one();
+    flush_thread.join();
+}
+
+void Memcard::flush_loop()
+{
+    std::unique_lock<std::mutex> lock(flush_mutex);
+    while (true)
+    {
+        flush_notifier.wait(lock, [this] { return flush_quit || !pending_pages.empty(); });
+        if (pending_pages.empty())
+            return;
+
+        //A game's save is spread over many frames, so give it a moment to finish and write it out in one go
+        if (!flush_quit)
+            flush_notifier.wait_for(lock, std::chrono::milliseconds(250), [this] { return flush_quit; });
+
+        std::map<uint32_t, std::vector<uint8_t>> pages;
+        pages.swap(pending_pages);
+        lock.unlock();
+        write_pages(pages);
+        lock.lock();
+    }
+}
+
+void Memcard::write_pages(const std::map<uint32_t, std::vector<uint8_t>>& pages)
+{
+    FILE* journal = fopen(journal_name().c_str(), "wb");
+    if (!journal)
+    {
+        Errors::print_warning("[Memcard] Failed to create %s\n", journal_name().c_str());
+        return;
+    }
+
+    uint32_t header[2] = {JOURNAL_MAGIC, (uint32_t)pages.size()};
+    uint32_t checksum = 2166136261;
+    bool success = fwrite(header, sizeof(header), 1, journal) == 1;
+    for (auto& page : pages)
+    {
+        checksum = journal_checksum(checksum, (const uint8_t*)&page.first, sizeof(uint32_t));
+        checksum = journal_checksum(checksum, page.second.data(), page.second.size());
+        success &= fwrite(&page.first, sizeof(uint32_t), 1, journal) == 1;
+        success &= fwrite(page.second.data(), page.second.size(), 1, journal) == 1;
+    }
+    uint32_t trailer[2] = {checksum, JOURNAL_END};
+    success &= fwrite(trailer, sizeof(trailer), 1, journal) == 1;
+    success &= sync_file(journal);
+    fclose(journal);
+
+    if (!success)
+    {
+        //The card itself is untouched, and an incomplete journal is ignored when the card is opened
+        Errors::print_warning("[Memcard] Failed to write %s\n", journal_name().c_str());
+        return;
+    }
+
+    FILE* card = fopen(file_name.c_str(), "r+b");
+    success = card != nullptr;
+    if (card)
+    {
+        for (auto& page : pages)
+        {
+            success &= !fseek(card, (long)(page.first * page.second.size()), SEEK_SET);
+            success &= fwrite(page.second.data(), page.second.size(), 1, card) == 1;
+        }
+        success &= sync_file(card);
+        fclose(card);
+    }
+
+    //On failure the journal stays behind and is replayed the next time the card is opened
+    if (success)
+        remove(journal_name().c_str());
+    else
+        Errors::print_warning("[Memcard] Failed to write %s\n", file_name.c_str());
+}
+
+bool Memcard::replay_journal()
+{
+    FILE* journal = fopen(journal_name().c_str(), "rb");
+    if (!journal)
+        return true;
+
+    //A standard 8 MB card. This runs before the card has been loaded.
+    const uint32_t page_count = 0x4000;
+    const uint32_t page_size = 0x200 + 16;
+
+    std::map<uint32_t, std::vector<uint8_t>> pages;
+    uint32_t header[2], trailer[2];
+    uint32_t checksum = 2166136261;
+    bool complete = fread(header, sizeof(header), 1, journal) == 1 && header[0] == JOURNAL_MAGIC &&
+            header[1] <= page_count;
+
+    for (uint32_t i = 0; complete && i < header[1]; i++)
+    {
+        uint32_t page;
+        std::vector<uint8_t> data(page_size);
+        complete = fread(&page, sizeof(uint32_t), 1, journal) == 1 && page < page_count &&
+                fread(data.data(), page_size, 1, journal) == 1;
+        checksum = journal_checksum(checksum, (const uint8_t*)&page, sizeof(uint32_t));
+        checksum = journal_checksum(checksum, data.data(), page_size);
+        pages[page] = std::move(data);
+    }
+
+    complete = complete && fread(trailer, sizeof(trailer), 1, journal) == 1 &&
+            trailer[0] == checksum && trailer[1] == JOURNAL_END;
+    fclose(journal);
+
+    if (!complete)
+    {
+        Errors::print_warning("[Memcard] Discarding incomplete journal for %s\n", file_name.c_str());
+        remove(journal_name().c_str());
+        return true;
+    }
+
+    printf("[Memcard] Replaying journal for %s (%zu pages)\n", file_name.c_str(), pages.size());
+    write_pages(pages);
+    return !std::ifstream(journal_name()).is_open();
 }
 
 uint8_t Memcard::write_serial(uint8_t data)
@@ -194,7 +406,7 @@ uint8_t Memcard::write_serial(uint8_t data)
                 cmd_length = 2;
                 response_end();
 
-                is_dirty = true;
+                mark_dirty(mem_addr, 528 * 16);
 
                 for (unsigned int i = 0; i < 528 * 16; i++)
                     mem[mem_addr + i] = 0xFF;
@@ -375,7 +587,7 @@ void Memcard::write_mem(uint8_t data)
     }
     else if (cmd_params - 1 < mem_write_size)
     {
-        is_dirty = true;
+        mark_dirty(mem_addr, 1);
         mem[mem_addr] = data;
         mem_addr++;
     }
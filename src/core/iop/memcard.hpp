@@ -1,7 +1,12 @@
 #ifndef MEMCARD_HPP
 #define MEMCARD_HPP
+#include <condition_variable>
 #include <cstdint>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 struct MemcardSpecs
 {
@@ -24,6 +29,20 @@ class Memcard
         std::string file_name;
         bool file_opened;
         bool is_dirty;
+        std::vector<bool> dirty_pages;
+
+        //Writes to the card file happen on the flush thread, see save_if_dirty
+        std::thread flush_thread;
+        std::mutex flush_mutex;
+        std::condition_variable flush_notifier;
+        std::map<uint32_t, std::vector<uint8_t>> pending_pages;
+        bool flush_quit;
+
+        void flush_loop();
+        void write_pages(const std::map<uint32_t, std::vector<uint8_t>>& pages);
+        void stop_flush_thread();
+        bool replay_journal();
+        std::string journal_name();
 
         uint8_t response_buffer[1024];
         unsigned int response_read_pos;
@@ -44,6 +63,9 @@ class Memcard
         void do_auth_f0(uint8_t value);
         uint8_t do_checksum(uint8_t* buff, unsigned int size);
 
+        uint32_t raw_page_size();
+        void mark_dirty(uint32_t addr, uint32_t size);
+
         void sector_op(uint8_t value);
         void read_mem(uint32_t addr, uint8_t size);
         void write_mem(uint8_t data);
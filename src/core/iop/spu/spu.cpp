@@ -5,12 +5,15 @@
 #include <ostream>
 #include <sstream>
 #include <cstring>
+#include <emmintrin.h>
 #include "spu.hpp"
 #include "../iop_dma.hpp"
 #include "../iop_intc.hpp"
 #include "spu_adpcm.hpp"
+#include "../../audio/audiostream.hpp"
 #include "../../audio/utils.hpp"
 #include "../../errors.hpp"
+#include "../../trace.hpp"
 
 /**
  * Notes on "AutoDMA", as it seems to not be documented anywhere else
@@ -25,10 +28,8 @@
 #define REVERB_REG_BASE 0x2E4
 
 
-uint16_t SPU::spdif_irq = 0;
-uint16_t SPU::core_att[2];
-uint32_t SPU::IRQA[2];
-SPU::SPU(int id, IOP_INTC* intc, IOP_DMA* dma) : id(id), intc(intc), dma(dma)
+SPU::SPU(int id, IOP_INTC* intc, IOP_DMA* dma, SPU_SharedRegs* shared) :
+    id(id), intc(intc), dma(dma), shared(shared), output_stream(nullptr)
 { 
 
 }
@@ -40,12 +41,12 @@ void SPU::reset(uint8_t* RAM)
     status.DMA_ready = false;
     transfer_addr = 0;
     current_addr = 0;
-    core_att[id-1] = 0;
+    shared->core_att[id-1] = 0;
     autodma_ctrl = 0x0;
     buffer_pos = 0;
     key_on = 0;
     key_off = 0xFFFFFF;
-    spdif_irq = 0;
+    shared->spdif_irq = 0;
     current_buffer = 0;
     data_input_volume_l = 0x7FFF;
     data_input_volume_r = 0x7FFF;
@@ -75,27 +76,45 @@ void SPU::reset(uint8_t* RAM)
         voices[i].reset();
     }
 
-    IRQA[id-1] = 0x800;
+    shared->IRQA[id-1] = 0x800;
 
     ENDX = 0;
 }
 
+void SPU::set_output_stream(AudioStream* stream)
+{
+    output_stream = stream;
+}
+
+//Samples are generated lazily by the emulator. Anything that reads or changes SPU state from outside
+//has to bring the SPUs up to date first.
+void SPU::set_sync_callback(std::function<void()> callback)
+{
+    sync_callback = callback;
+}
+
+void SPU::sync()
+{
+    if (sync_callback)
+        sync_callback();
+}
+
 void SPU::spu_check_irq(uint32_t address)
 {
     for (int j = 0; j < 2; j++)
     {
-        if (address == IRQA[j] && (core_att[j] & (1 << 6)))
+        if (address == shared->IRQA[j] && (shared->core_att[j] & (1 << 6)))
             spu_irq(j);
     }
 }
 
 void SPU::spu_irq(int index)
 {
-    if (spdif_irq & (4 << index))
+    if (shared->spdif_irq & (4 << index))
         return;
 
-    printf("[SPU%d] IRQA interrupt!\n", index);
-    spdif_irq |= 4 << index;
+    TRACE_DEBUG(Trace::SPU, "[SPU%d] IRQA interrupt!\n", index);
+    shared->spdif_irq |= 4 << index;
     intc->assert_irq(9);
 }
 
@@ -125,7 +144,7 @@ void SPU::switch_block(int voice_id)
     voice.next_sample = voice.pcm.at(voice.sample_idx);
 }
 
-stereo_sample SPU::voice_gen_sample(int voice_id)
+void SPU::advance_voice(int voice_id)
 {
     Voice &voice = voices[voice_id];
 
@@ -190,19 +209,13 @@ stereo_sample SPU::voice_gen_sample(int voice_id)
         voice.old1 = voice.next_sample;
         voice.next_sample = voice.pcm.at(voice.sample_idx);
     }
+}
 
-    int16_t output_sample = 0;
-
-    if (!(voice_noise_gen & (1 << voice_id)))
-    {
-        output_sample = interpolate(voice_id);
-    }
-    else
-    {
-        output_sample = noise.output;
-    }
+stereo_sample SPU::finish_voice(int voice_id, int16_t output_sample)
+{
+    Voice &voice = voices[voice_id];
 
-    output_sample = (output_sample * voice.adsr.volume) >> 15;
+    output_sample = (int16_t)((output_sample * voice.adsr.volume) >> 15);
     voice.outx = output_sample;
 
     if (voice_id == 1)
@@ -215,8 +228,8 @@ stereo_sample SPU::voice_gen_sample(int voice_id)
     }
 
     stereo_sample out;
-    out.left = (output_sample*voice.left_vol.value) >> 15;
-    out.right = (output_sample*voice.right_vol.value) >> 15;
+    out.left = (int16_t)((output_sample*voice.left_vol.value) >> 15);
+    out.right = (int16_t)((output_sample*voice.right_vol.value) >> 15);
 
     voice.left_vol.advance();
     voice.right_vol.advance();
@@ -225,6 +238,56 @@ stereo_sample SPU::voice_gen_sample(int voice_id)
     return out;
 }
 
+stereo_sample SPU::voice_gen_sample(int voice_id)
+{
+    advance_voice(voice_id);
+
+    int16_t output_sample = 0;
+
+    if (!(voice_noise_gen & (1 << voice_id)))
+    {
+        output_sample = interpolate(voice_id);
+    }
+    else
+    {
+        output_sample = noise.output;
+    }
+
+    return finish_voice(voice_id, output_sample);
+}
+
+void SPU::gen_voice_samples(stereo_sample* samples)
+{
+    //Pitch modulation makes a voice depend on the previous voice's output for the same sample.
+    //Voices reading from the capture buffers at the start of RAM would see the VOICE1/VOICE3
+    //writes of earlier voices. Both cases are generated one voice at a time.
+    bool serial = voice_pitch_mod & 0xFFFFFE;
+    for (int i = 0; i < 24 && !serial; i++)
+        serial = voices[i].current_addr < 0x1000;
+
+    if (serial)
+    {
+        for (int i = 0; i < 24; i++)
+            samples[i] = voice_gen_sample(i);
+        return;
+    }
+
+    alignas(16) int16_t interpolated[24];
+
+    for (int i = 0; i < 24; i++)
+        advance_voice(i);
+
+    interpolate_voices(interpolated);
+
+    for (int i = 0; i < 24; i++)
+    {
+        int16_t output_sample = interpolated[i];
+        if (voice_noise_gen & (1 << i))
+            output_sample = noise.output;
+        samples[i] = finish_voice(i, output_sample);
+    }
+}
+
 void SPU::gen_sample()
 {
 
@@ -234,14 +297,25 @@ void SPU::gen_sample()
     stereo_sample core_wet = {};
     stereo_sample memin = {};
 
+    stereo_sample samples[24];
+    gen_voice_samples(samples);
+
+    //The dry and wet busses are accumulated together. A saturating add is the same as clamp16 on each step.
+    __m128i busses = _mm_setzero_si128();
     for (int i = 0; i < 24; i++)
     {
-        stereo_sample sample = voice_gen_sample(i);
-
-        voices_dry.mix(sample, voices[i].mix_state.dry_l, voices[i].mix_state.dry_r);
-        voices_wet.mix(sample, voices[i].mix_state.wet_l, voices[i].mix_state.wet_r);
+        const VoiceMix& mix = voices[i].mix_state;
+        __m128i sample = _mm_setr_epi16(mix.dry_l ? samples[i].left : 0, mix.dry_r ? samples[i].right : 0,
+                                        mix.wet_l ? samples[i].left : 0, mix.wet_r ? samples[i].right : 0,
+                                        0, 0, 0, 0);
+        busses = _mm_adds_epi16(busses, sample);
     }
 
+    voices_dry.left = (int16_t)_mm_extract_epi16(busses, 0);
+    voices_dry.right = (int16_t)_mm_extract_epi16(busses, 1);
+    voices_wet.left = (int16_t)_mm_extract_epi16(busses, 2);
+    voices_wet.right = (int16_t)_mm_extract_epi16(busses, 3);
+
     memout(MEMOUTL, voices_dry.left);
     memout(MEMOUTR, voices_dry.right);
     memout(MEMOUTEL, voices_wet.left);
@@ -289,8 +363,9 @@ void SPU::gen_sample()
         memout(SINR, core_output.right);
     }
 
-    // This would be where to get the PCM for an audio backend,
     // core_output on SPU2 represents the final mixed output.
+    if (output_stream)
+        output_stream->push(core_output);
 
     if (wav_output)
     {
@@ -366,7 +441,7 @@ void SPU::start_DMA(int size)
 {
     if (running_ADMA())
     {
-        printf("[SPU%d] ADMA started with size: $%08X\n",id, size);
+        TRACE_DEBUG(Trace::SPU, "[SPU%d] ADMA started with size: $%08X\n",id, size);
         ADMA_progress = 0;
     }
     status.DMA_ready = false;
@@ -380,6 +455,7 @@ void SPU::pause_DMA()
 
 uint32_t SPU::read_DMA()
 {
+    sync();
     uint32_t value = RAM[current_addr];
     spu_check_irq(current_addr);
     current_addr++;
@@ -397,6 +473,7 @@ uint32_t SPU::read_DMA()
 
 void SPU::write_DMA(uint32_t value)
 {
+    sync();
     //printf("[SPU%d] Write mem $%08X ($%08X)\n", id, value, current_addr);
     RAM[current_addr] = value & 0xFFFF;
     spu_check_irq(current_addr);
@@ -414,6 +491,7 @@ void SPU::write_DMA(uint32_t value)
 
 void SPU::write_ADMA(uint8_t *source_RAM)
 {
+    sync();
     int next_buffer = 1 - current_buffer;
 
     //if (ADMA_progress == 0)
@@ -461,7 +539,7 @@ void SPU::write(uint32_t addr, uint16_t data)
 uint16_t SPU::read_mem()
 {
     uint16_t return_value = RAM[current_addr];
-    printf("[SPU%d] Read mem $%04X ($%08X)\n", id, return_value, current_addr);
+    TRACE_DEBUG(Trace::SPU, "[SPU%d] Read mem $%04X ($%08X)\n", id, return_value, current_addr);
 
     spu_check_irq(current_addr);
     current_addr++;
@@ -472,7 +550,7 @@ uint16_t SPU::read_mem()
 
 void SPU::write_mem(uint16_t value)
 {
-    printf("[SPU%d] Write mem $%04X ($%08X)\n", id, value, current_addr);
+    TRACE_DEBUG(Trace::SPU, "[SPU%d] Write mem $%04X ($%08X)\n", id, value, current_addr);
     RAM[current_addr] = value;
     
     spu_check_irq(current_addr);
@@ -482,16 +560,17 @@ void SPU::write_mem(uint16_t value)
 
 uint16_t SPU::read16(uint32_t addr)
 {
+    sync();
     uint16_t reg = 0;
     addr &= 0x7FF;
     if (addr >= 0x760)
     {
         if (addr == 0x7C2)
         {
-            printf("[SPU] Read SPDIF_IRQ: $%04X\n", spdif_irq);
-            return spdif_irq;
+            TRACE_DEBUG(Trace::SPU, "[SPU] Read SPDIF_IRQ: $%04X\n", shared->spdif_irq);
+            return shared->spdif_irq;
         }
-        printf("[SPU] Read high addr $%04X\n", addr);
+        TRACE_DEBUG(Trace::SPU, "[SPU] Read high addr $%04X\n", addr);
         return 0;
     }
    
@@ -507,22 +586,22 @@ uint16_t SPU::read16(uint32_t addr)
         switch (reg)
         {
             case 0:
-                printf("[SPU%d] Read Voice %d SSAH: $%04X\n", id, v, (voices[v].start_addr >> 16) & 0xF);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Read Voice %d SSAH: $%04X\n", id, v, (voices[v].start_addr >> 16) & 0xF);
                 return (voices[v].start_addr >> 16) & 0xF;
             case 2:
-                printf("[SPU%d] Read Voice %d SSAL: $%04X\n", id, v, voices[v].start_addr & 0xFFFF);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Read Voice %d SSAL: $%04X\n", id, v, voices[v].start_addr & 0xFFFF);
                 return voices[v].start_addr & 0xFFFF;
             case 4:
-                printf("[SPU%d] Read Voice %d LSAXH: $%04X\n", id, v, (voices[v].loop_addr >> 16) & 0xF);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Read Voice %d LSAXH: $%04X\n", id, v, (voices[v].loop_addr >> 16) & 0xF);
                 return (voices[v].loop_addr >> 16) & 0xF;
             case 6:
-                printf("[SPU%d] Read Voice %d LSAXL: $%04X\n", id, v, voices[v].loop_addr & 0xFFFF);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Read Voice %d LSAXL: $%04X\n", id, v, voices[v].loop_addr & 0xFFFF);
                 return voices[v].loop_addr & 0xFFFF;
             case 8:
-                printf("[SPU%d] Read Voice %d NAXH: $%04X\n", id, v, (voices[v].current_addr >> 16) & 0xF);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Read Voice %d NAXH: $%04X\n", id, v, (voices[v].current_addr >> 16) & 0xF);
                 return (voices[v].current_addr >> 16) & 0xF;
             case 10:
-                printf("[SPU%d] Read Voice %d NAXL: $%04X\n", id, v, voices[v].current_addr & 0xFFFF);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Read Voice %d NAXL: $%04X\n", id, v, voices[v].current_addr & 0xFFFF);
                 return voices[v].current_addr & 0xFFFF;
         }
     }
@@ -554,48 +633,48 @@ uint16_t SPU::read16(uint32_t addr)
             //printf("[SPU%d] Read VMIXERL: $%04X\n", id, voice_mixwet_right & 0xFFFF);
             return voice_mixwet_right >> 16;
         case 0x198:
-            printf("[SPU%d] Read MMIX $%04X\n", id, mix_state.reg);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read MMIX $%04X\n", id, mix_state.reg);
             return mix_state.reg;
         case 0x19A:
-            printf("[SPU%d] Read Core Att: $%04X\n", id, (core_att[id-1]));
-            return core_att[id-1];
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read Core Att: $%04X\n", id, (shared->core_att[id-1]));
+            return shared->core_att[id-1];
         case 0x19C:
-            printf("[SPU%d] Read IRQA Hi: $%04X\n", id, IRQA[id - 1] >> 16);
-            return (IRQA[id - 1] >> 16);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read IRQA Hi: $%04X\n", id, shared->IRQA[id - 1] >> 16);
+            return (shared->IRQA[id - 1] >> 16);
         case 0x19E:
-            printf("[SPU%d] Read IRQA Lo: $%04X\n", id, IRQA[id - 1] & 0xFFFF);
-            return (IRQA[id - 1] & 0xFFFF);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read IRQA Lo: $%04X\n", id, shared->IRQA[id - 1] & 0xFFFF);
+            return (shared->IRQA[id - 1] & 0xFFFF);
         case 0x1A0:
-            printf("[SPU%d] Read KON1: $%04X\n", id, (key_off >> 16));
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read KON1: $%04X\n", id, (key_off >> 16));
             return (key_on & 0xFFFF);
         case 0x1A2:
-            printf("[SPU%d] Read KON0: $%04X\n", id, (key_on & 0xFFFF));
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read KON0: $%04X\n", id, (key_on & 0xFFFF));
             return (key_on >> 16);
         case 0x1A4:
-            printf("[SPU%d] Read KOFF1: $%04X\n", id, (key_off >> 16));
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read KOFF1: $%04X\n", id, (key_off >> 16));
             return (key_off & 0xFFFF);
         case 0x1A6:
-            printf("[SPU%d] Read KOFF0: $%04X\n", id, (key_off & 0xFFFF));
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read KOFF0: $%04X\n", id, (key_off & 0xFFFF));
             return (key_off >> 16);
         case 0x1A8:
-            printf("[SPU%d] Read TSAH: $%04X\n", id, transfer_addr >> 16);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read TSAH: $%04X\n", id, transfer_addr >> 16);
             return transfer_addr >> 16;
         case 0x1AA:
-            printf("[SPU%d] Read TSAL: $%04X\n", id, transfer_addr & 0xFFFF);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read TSAL: $%04X\n", id, transfer_addr & 0xFFFF);
             return transfer_addr & 0xFFFF;
         case 0x1AC:            
             return read_mem();
         case 0x1B0:
-            printf("[SPU%d] Read ADMA stat: $%04X\n", id, autodma_ctrl);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read ADMA stat: $%04X\n", id, autodma_ctrl);
             return autodma_ctrl;
         case 0x2E0:
-            printf("[SPU%d] Read ESAH: $%04X\n", id, (reverb.effect_area_start >> 16));
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read ESAH: $%04X\n", id, (reverb.effect_area_start >> 16));
             return reverb.effect_area_start >> 16;
         case 0x2E2:
-            printf("[SPU%d] Read ESAL: $%04X\n", id, (reverb.effect_area_start & 0xFFFF));
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read ESAL: $%04X\n", id, (reverb.effect_area_start & 0xFFFF));
             return reverb.effect_area_start & 0xFFFF;
         case 0x33C:
-            printf("[SPU%d] Read EEA: $%04X\n", id, reverb.effect_area_end);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read EEA: $%04X\n", id, reverb.effect_area_end);
             return reverb.effect_area_end >> 16;
         case 0x340:
             reg = ENDX >> 16;
@@ -608,10 +687,10 @@ uint16_t SPU::read16(uint32_t addr)
         case 0x344:
             reg |= status.DMA_ready << 7;
             reg |= status.DMA_busy << 10;
-            printf("[SPU%d] Read status: $%04X\n", id, reg);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read status: $%04X\n", id, reg);
             return reg;
         default:
-            printf("[SPU%d] Unrecognized read16 from addr $%08X\n", id, addr);
+            TRACE_WARN(Trace::SPU, "[SPU%d] Unrecognized read16 from addr $%08X\n", id, addr);
             reg = 0;
     }
     return reg;
@@ -624,25 +703,25 @@ uint16_t SPU::read_voice_reg(uint32_t addr)
     switch (reg)
     {
         case 0:
-            printf("[SPU%d] Read V%d VOLL: $%04X\n", id, v, voices[v].left_vol.value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read V%d VOLL: $%04X\n", id, v, voices[v].left_vol.value);
             return static_cast<uint16_t>(voices[v].left_vol.value);
         case 2:
-            printf("[SPU%d] Read V%d VOLR: $%04X\n", id, v, voices[v].right_vol.value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read V%d VOLR: $%04X\n", id, v, voices[v].right_vol.value);
             return static_cast<uint16_t>(voices[v].right_vol.value);
         case 4:
-            printf("[SPU%d] ReadV%d PITCH: $%04X\n", id, v, voices[v].pitch);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] ReadV%d PITCH: $%04X\n", id, v, voices[v].pitch);
             return voices[v].pitch;
         case 6:
-            printf("[SPU%d] Read V%d ADSR1: $%04X\n", id, v, voices[v].adsr.adsr1);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read V%d ADSR1: $%04X\n", id, v, voices[v].adsr.adsr1);
             return voices[v].adsr.adsr1;
         case 8:
-            printf("[SPU%d] Read V%d ADSR2: $%04X\n", id, v, voices[v].adsr.adsr2);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read V%d ADSR2: $%04X\n", id, v, voices[v].adsr.adsr2);
             return voices[v].adsr.adsr2;
         case 10:
-            printf("[SPU%d] Read V%d ENVX: $%04X\n", id, v, voices[v].adsr.volume);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Read V%d ENVX: $%04X\n", id, v, voices[v].adsr.volume);
             return static_cast<uint16_t>(voices[v].adsr.volume);
         default:
-            printf("[SPU%d] V%d Read $%08X\n", id, v, addr);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] V%d Read $%08X\n", id, v, addr);
             return 0;
     }
 }
@@ -657,13 +736,13 @@ void SPU::write_reverb_reg32(uint32_t addr, uint16_t value)
         unsigned int reg = (addr - REVERB_REG_BASE)/2;
         if (reg & 1)
         {
-            printf("[SPU%d] Write %04X reverb reg L %04X\n", id, value, reg/2);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write %04X reverb reg L %04X\n", id, value, reg/2);
             reverb.regs[reg/2] &= ~0xFFFFu;
             reverb.regs[reg/2] |= value;
         }
         else
         {
-            printf("[SPU%d] Write %04X reverb reg H %04X\n", id, value, reg/2);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write %04X reverb reg H %04X\n", id, value, reg/2);
             reverb.regs[reg/2] &= 0xFFFFu;
             reverb.regs[reg/2] |= static_cast<uint32_t>(value << 16);
         }
@@ -671,20 +750,21 @@ void SPU::write_reverb_reg32(uint32_t addr, uint16_t value)
     else
     {
         unsigned int reg = (addr - REVERB_REG_BASE)/2;
-        printf("[SPU%d] Write to reverb reg %04X of %04X while reverb on\n", id, reg/2, value);
+        TRACE_DEBUG(Trace::SPU, "[SPU%d] Write to reverb reg %04X of %04X while reverb on\n", id, reg/2, value);
     }
 }
 
 void SPU::write16(uint32_t addr, uint16_t value)
 {
+    sync();
     addr &= 0x7FF;
 
     if (addr >= 0x760)
     {
         if (addr == 0x7C2)
         {
-            printf("[SPU] Write SPDIF_IRQ: $%04X\n", value);
-            spdif_irq = value;
+            TRACE_DEBUG(Trace::SPU, "[SPU] Write SPDIF_IRQ: $%04X\n", value);
+            shared->spdif_irq = value;
             return;
         }
 
@@ -735,39 +815,39 @@ void SPU::write16(uint32_t addr, uint16_t value)
         switch (addr)
         {
             case 0x760:
-                printf("[SPU%d] Write MVOLL: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write MVOLL: $%04X\n", id, value);
                 MVOLL.set(value);
                 break;
             case 0x762:
-                printf("[SPU%d] Write MVOLR: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write MVOLR: $%04X\n", id, value);
                 MVOLR.set(value);
                 break;
             case 0x764:
-                printf("[SPU%d] Write EVOLL: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write EVOLL: $%04X\n", id, value);
                 effect_volume_l = static_cast<int16_t>(value);
                 break;
             case 0x766:
-                printf("[SPU%d] Write EVOLR: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write EVOLR: $%04X\n", id, value);
                 effect_volume_r = static_cast<int16_t>(value);
                 break;
             case 0x768:
-                printf("[SPU%d] Write AVOLL: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write AVOLL: $%04X\n", id, value);
                 core_volume_l = static_cast<int16_t>(value);
                 break;
             case 0x76A:
-                printf("[SPU%d] Write AVOLR: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write AVOLR: $%04X\n", id, value);
                 core_volume_r = static_cast<int16_t>(value);
                 break;
             case 0x76C:
-                printf("[SPU%d] Write (ADMA vol) BVOLL: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write (ADMA vol) BVOLL: $%04X\n", id, value);
                 data_input_volume_l = static_cast<int16_t>(value);
                 break;
             case 0x76E:
-                printf("[SPU%d] Write (ADMA vol) BVOLR: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write (ADMA vol) BVOLR: $%04X\n", id, value);
                 data_input_volume_r = static_cast<int16_t>(value);
                 break;
             default:
-                printf("[SPU] Write high addr $%04X: $%04X\n", addr, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU] Write high addr $%04X: $%04X\n", addr, value);
                 return;
         }
 
@@ -788,27 +868,27 @@ void SPU::write16(uint32_t addr, uint16_t value)
             case 0: //SSAH
                 voices[v].start_addr &= 0xFFFF;
                 voices[v].start_addr |= (value & 0xF) << 16;
-                printf("[SPU%d] Write V%d SSA: $%08X (H: $%04X)\n", id, v, voices[v].start_addr, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d SSA: $%08X (H: $%04X)\n", id, v, voices[v].start_addr, value);
                 break;
             case 2: //SSAL
                 voices[v].start_addr &= ~0xFFFF;
                 voices[v].start_addr |= value & 0xFFF8;
-                printf("[SPU%d] Write V%d SSA: $%08X (L: $%04X)\n", id, v, voices[v].start_addr, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d SSA: $%08X (L: $%04X)\n", id, v, voices[v].start_addr, value);
                 break;
             case 4: //LSAXH
                 voices[v].loop_addr &= 0xFFFF;
                 voices[v].loop_addr |= (value & 0xF) << 16;
                 voices[v].loop_addr_specified = true;
-                printf("[SPU%d] Write V%d LSAX: $%08X (H: $%04X)\n", id, v, voices[v].loop_addr, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d LSAX: $%08X (H: $%04X)\n", id, v, voices[v].loop_addr, value);
                 break;
             case 6: //LSAXL
                 voices[v].loop_addr &= ~0xFFFF;
                 voices[v].loop_addr |= value & 0xFFF8;
                 voices[v].loop_addr_specified = true;
-                printf("[SPU%d] Write V%d LSAX: $%08X (L: $%04X)\n", id, v, voices[v].loop_addr, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d LSAX: $%08X (L: $%04X)\n", id, v, voices[v].loop_addr, value);
                 break;
             default:
-                printf("[SPU%d] Write voice %d: $%04X ($%08X)\n", id, (addr - 0x1C0) / 0xC, value, addr);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write voice %d: $%04X ($%08X)\n", id, (addr - 0x1C0) / 0xC, value, addr);
         }
         return;
     }
@@ -820,27 +900,27 @@ void SPU::write16(uint32_t addr, uint16_t value)
     switch (addr)
     {
         case 0x180:
-            printf("[SPU%d] Write PMONH: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write PMONH: $%04X\n", id, value);
             voice_pitch_mod &= ~0xFFFFu;
             voice_pitch_mod |= value;
             break;
         case 0x182:
-            printf("[SPU%d] Write PMONL: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write PMONL: $%04X\n", id, value);
             voice_pitch_mod &= 0xFFFF;
             voice_pitch_mod |= static_cast<uint32_t>(value << 16);
             break;
         case 0x184:
-            printf("[SPU%d] Write NONH: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write NONH: $%04X\n", id, value);
             voice_noise_gen &= ~0xFFFFu;
             voice_noise_gen |= value;
             break;
         case 0x186:
-            printf("[SPU%d] Write NONL: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write NONL: $%04X\n", id, value);
             voice_noise_gen &= 0xFFFF;
             voice_noise_gen |= static_cast<uint32_t>(value << 16);
             break;
         case 0x188:
-            printf("[SPU%d] Write VMIXLH: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write VMIXLH: $%04X\n", id, value);
             voice_mixdry_left &= ~0xFFFFu;
             voice_mixdry_left |= value;
             for (int i = 0; i < 16; i++)
@@ -849,7 +929,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
             }
             break;
         case 0x18A:
-            printf("[SPU%d] Write VMIXLL: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write VMIXLL: $%04X\n", id, value);
             voice_mixdry_left &= 0xFFFF;
             voice_mixdry_left |= static_cast<uint32_t>(value << 16);
             for (int i = 0; i < 8; i++)
@@ -858,7 +938,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
             }
             break;
         case 0x18C:
-            printf("[SPU%d] Write VMIXELH: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write VMIXELH: $%04X\n", id, value);
             voice_mixwet_left &= ~0xFFFFu;
             voice_mixwet_left |= value;
             for (int i = 0; i < 16; i++)
@@ -867,7 +947,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
             }
             break;
         case 0x18E:
-            printf("[SPU%d] Write VMIXELL: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write VMIXELL: $%04X\n", id, value);
             voice_mixwet_left &= 0xFFFF;
             voice_mixwet_left |= static_cast<uint32_t>(value << 16);
             for (int i = 0; i < 8; i++)
@@ -876,7 +956,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
             }
             break;
         case 0x190:
-            printf("[SPU%d] Write VMIXRH: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write VMIXRH: $%04X\n", id, value);
             voice_mixdry_right &= ~0xFFFFu;
             voice_mixdry_right |= value;
             for (int i = 0; i < 16; i++)
@@ -885,7 +965,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
             }
             break;
         case 0x192:
-            printf("[SPU%d] Write VMIXRL: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write VMIXRL: $%04X\n", id, value);
             voice_mixdry_right &= 0xFFFF;
             voice_mixdry_right |= static_cast<uint32_t>(value << 16);
             for (int i = 0; i < 8; i++)
@@ -894,7 +974,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
             }
             break;
         case 0x194:
-            printf("[SPU%d] Write VMIXERH: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write VMIXERH: $%04X\n", id, value);
             voice_mixwet_right &= ~0xFFFFu;
             voice_mixwet_right |= value;
             for (int i = 0; i < 16; i++)
@@ -903,7 +983,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
             }
             break;
         case 0x196:
-            printf("[SPU%d] Write VMIXERL: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write VMIXERL: $%04X\n", id, value);
             voice_mixwet_right &= 0xFFFF;
             voice_mixwet_right |= static_cast<uint32_t>(value << 16);
             for (int i = 0; i < 8; i++)
@@ -912,15 +992,15 @@ void SPU::write16(uint32_t addr, uint16_t value)
             }
             break;
         case 0x198:
-            printf("[SPU%d] Write MMIX: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write MMIX: $%04X\n", id, value);
             mix_state.read(value);
             break;
         case 0x19A:
-            printf("[SPU%d] Write Core Att: $%04X\n", id, value);
-            if (core_att[id - 1] & (1 << 6))
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write Core Att: $%04X\n", id, value);
+            if (shared->core_att[id - 1] & (1 << 6))
             {
                 if (!(value & (1 << 6)))
-                    spdif_irq &= ~(2 << id);
+                    shared->spdif_irq &= ~(2 << id);
             }
 
             if (!running_ADMA())
@@ -930,7 +1010,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
                 else
                     clear_dma_req();
             }
-            core_att[id - 1] = value & 0x7FFF;
+            shared->core_att[id - 1] = value & 0x7FFF;
             if (value & (1 << 15))
             {
                 // On this registers PS1 counterpart this would have been the enable bit.
@@ -942,39 +1022,39 @@ void SPU::write16(uint32_t addr, uint16_t value)
             }
             if (((value >> 7) & 1) != effect_enable)
             {
-                printf("[SPU%d] Reverb enable changed to %d\n", id, (value >> 7) & 1);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Reverb enable changed to %d\n", id, (value >> 7) & 1);
             }
             output_enable = (value >> 14) & 1;
             noise.clock = (value >> 8) & 0x3F;
             effect_enable = (value >> 7) & 1;
             break;
         case 0x19C:
-            printf("[SPU%d] Write IRQA_H: $%04X\n", id, value);
-            IRQA[id - 1] &= 0xFFFF;
-            IRQA[id - 1] |= (value & 0xF) << 16;
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write IRQA_H: $%04X\n", id, value);
+            shared->IRQA[id - 1] &= 0xFFFF;
+            shared->IRQA[id - 1] |= (value & 0xF) << 16;
             break;
         case 0x19E:
-            printf("[SPU%d] Write IRQA_L: $%04X\n", id, value);
-            IRQA[id - 1] &= ~0xFFFF;
-            IRQA[id - 1] |= value & 0xFFFF;
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write IRQA_L: $%04X\n", id, value);
+            shared->IRQA[id - 1] &= ~0xFFFF;
+            shared->IRQA[id - 1] |= value & 0xFFFF;
             break;
         case 0x1A0:
-            printf("[SPU%d] Write KON0: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write KON0: $%04X\n", id, value);
             key_on &= ~0xFFFF;
             key_on |= value;
             break;
         case 0x1A2:
-            printf("[SPU%d] Write KON1: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write KON1: $%04X\n", id, value);
             key_on &= ~0xFF0000;
             key_on |= (value & 0xFF) << 16;
             break;
         case 0x1A4:
-            printf("[SPU%d] Write KOFF0: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write KOFF0: $%04X\n", id, value);
             key_off &= ~0xFFFF;
             key_off |= value;
             break;
         case 0x1A6:
-            printf("[SPU%d] Write KOFF1: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write KOFF1: $%04X\n", id, value);
             key_off &= ~0xFF0000;
             key_off |= (value & 0xFF) << 16;
             break;
@@ -982,19 +1062,19 @@ void SPU::write16(uint32_t addr, uint16_t value)
             transfer_addr &= 0xFFFF;
             transfer_addr |= (value & 0xF) << 16;
             current_addr = transfer_addr;
-            printf("[SPU%d] Write Transfer addr: $%08X (H: $%04X)\n", id, transfer_addr, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write Transfer addr: $%08X (H: $%04X)\n", id, transfer_addr, value);
             break;
         case 0x1AA:
             transfer_addr &= ~0xFFFF;
             transfer_addr |= value;
             current_addr = transfer_addr;
-            printf("[SPU%d] Write Transfer addr: $%08X (L: $%04X)\n", id, transfer_addr, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write Transfer addr: $%08X (L: $%04X)\n", id, transfer_addr, value);
             break;
         case 0x1AC:
             write_mem(value);
             break;
         case 0x1B0:
-            printf("[SPU%d] Write ADMA: $%04X\n", id, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write ADMA: $%04X\n", id, value);
             // How ADMA read mode works is unknown so just die.
             if (value & 0x4)
                 Errors::die("[SPU%d] ADMA bit 2 set, value %04x\n", id, value);
@@ -1005,7 +1085,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
         case 0x2E0:
             if (!effect_enable)
             {
-                printf("[SPU%d] Write ESAH: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write ESAH: $%04X\n", id, value);
                 reverb.effect_pos = 0;
                 reverb.effect_area_start &= 0xFFFF;
                 reverb.effect_area_start |= (value & 0x3F) << 16;
@@ -1014,7 +1094,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
         case 0x2E2:
             if (!effect_enable)
             {
-                printf("[SPU%d] Write ESAL: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write ESAL: $%04X\n", id, value);
                 reverb.effect_pos = 0;
                 reverb.effect_area_start &= ~0xFFFF;
                 reverb.effect_area_start |= value;
@@ -1023,7 +1103,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
         case 0x33C:
             if (!effect_enable)
             {
-                printf("[SPU%d] Write EEA: $%04X\n", id, value);
+                TRACE_DEBUG(Trace::SPU, "[SPU%d] Write EEA: $%04X\n", id, value);
                 reverb.effect_pos = 0;
                 reverb.effect_area_end &= 0xFFFF;
                 reverb.effect_area_end |= (static_cast<uint32_t>(value & 0x3F) << 16) | 0xFFFF;
@@ -1036,7 +1116,7 @@ void SPU::write16(uint32_t addr, uint16_t value)
             ENDX &= 0xFFFF;
             break;
         default:
-            printf("[SPU%d] Unrecognized write16 to addr $%08X of $%04X\n", id, addr, value);
+            TRACE_WARN(Trace::SPU, "[SPU%d] Unrecognized write16 to addr $%08X of $%04X\n", id, addr, value);
     }
 }
 
@@ -1047,35 +1127,35 @@ void SPU::write_voice_reg(uint32_t addr, uint16_t value)
     switch (reg)
     {
         case 0:
-            printf("[SPU%d] Write V%d VOLL: $%04X\n", id, v, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d VOLL: $%04X\n", id, v, value);
             voices[v].left_vol.set(value);
             break;
         case 2:
-            printf("[SPU%d] Write V%d VOLR: $%04X\n", id, v, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d VOLR: $%04X\n", id, v, value);
             voices[v].right_vol.set(value);
             break;
         case 4:
-            printf("[SPU%d] Write V%d PITCH: $%04X\n", id, v, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d PITCH: $%04X\n", id, v, value);
             voices[v].pitch = value & 0xFFFF;
             if (voices[v].pitch > 0x4000)
                 voices[v].pitch = 0x4000;
             break;
         case 6:
-            printf("[SPU%d] Write V%d ADSR1: $%04X\n", id, v, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d ADSR1: $%04X\n", id, v, value);
             voices[v].adsr.adsr1 = value;
             voices[v].adsr.update();
             break;
         case 8:
-            printf("[SPU%d] Write V%d ADSR2: $%04X\n", id, v, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d ADSR2: $%04X\n", id, v, value);
             voices[v].adsr.adsr2 = value;
             voices[v].adsr.update();
             break;
         case 10:
-            printf("[SPU%d] Write V%d ENVX: $%04X\n", id, v, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] Write V%d ENVX: $%04X\n", id, v, value);
             voices[v].adsr.volume = static_cast<int16_t>(value);
             break;
         default:
-            printf("[SPU%d] V%d write $%08X: $%04X\n", id, v, addr, value);
+            TRACE_DEBUG(Trace::SPU, "[SPU%d] V%d write $%08X: $%04X\n", id, v, addr, value);
     }
 }
 
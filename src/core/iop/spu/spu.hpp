@@ -2,6 +2,7 @@
 #define SPU_HPP
 #include <cstdint>
 #include <fstream>
+#include <functional>
 #include "spu_envelope.hpp"
 #include "../../audio/utils.hpp"
 #include "spu_adpcm.hpp"
@@ -166,8 +167,17 @@ struct SPU_STAT
     bool DMA_busy;
 };
 
+//Registers that either core can check, owned by the Emulator so that instances don't share them
+struct SPU_SharedRegs
+{
+    uint16_t core_att[2];
+    uint16_t spdif_irq;
+    uint32_t IRQA[2];
+};
+
 class IOP_INTC;
 class IOP_DMA;
+class AudioStream;
 
 class SPU
 {
@@ -175,6 +185,7 @@ class SPU
         unsigned int id;
         IOP_INTC* intc;
         IOP_DMA* dma;
+        SPU_SharedRegs* shared;
 
         enum MEMOUT
         {
@@ -190,12 +201,10 @@ class SPU
 
         uint16_t* RAM;
         Voice voices[24];
-        static uint16_t core_att[2];
         SPU_STAT status;
 
         WAVWriter* coreout;
-
-        static uint16_t spdif_irq;
+        AudioStream* output_stream;
 
         Reverb reverb;
         Noise noise;
@@ -236,13 +245,19 @@ class SPU
         uint32_t ADMA_progress;
         uint32_t buffer_pos;
 
-        static uint32_t IRQA[2];
         uint32_t ENDX;
         uint32_t key_on;
         uint32_t key_off;
 
+        std::function<void()> sync_callback;
+        void sync();
+
+        void advance_voice(int voice_id);
+        stereo_sample finish_voice(int voice_id, int16_t output_sample);
         stereo_sample voice_gen_sample(int voice_id);
+        void gen_voice_samples(stereo_sample* samples);
         int16_t interpolate(int voice);
+        void interpolate_voices(int16_t* out);
 
         void key_on_voice(int v);
         void key_off_voice(int v);
@@ -268,13 +283,16 @@ class SPU
         void clear_dma_req();
         void set_dma_req();
     public:
-        SPU(int id, IOP_INTC* intc, IOP_DMA* dma);
+        SPU(int id, IOP_INTC* intc, IOP_DMA* dma, SPU_SharedRegs* shared);
 
         bool running_ADMA();
         bool wav_output = false;
 
         void reset(uint8_t* RAM);
+        void set_sync_callback(std::function<void()> callback);
+        void set_output_stream(AudioStream* stream);
         void gen_sample();
+        bool IRQ_enabled();
 
         void start_DMA(int size);
         void pause_DMA();
@@ -290,13 +308,18 @@ class SPU
         void write16(uint32_t addr, uint16_t value);
         uint32_t get_memin_addr();
 
-        void gaussianConstructTable();
+        static void gaussianConstructTable();
 
         void load_state(std::ifstream& state);
         void save_state(std::ofstream& state);
 
 };
 
+inline bool SPU::IRQ_enabled()
+{
+    return (shared->core_att[0] | shared->core_att[1]) & (1 << 6);
+}
+
 inline bool SPU::running_ADMA()
 {
     return (autodma_ctrl & (1 << (id - 1)));
@@ -1,15 +1,19 @@
 #include "spu.hpp"
 #include <cmath>
 #include <cfenv>
+#include <mutex>
+#include <emmintrin.h>
 #ifndef M_PI
     #define M_PI 3.14159265358979323846
 #endif
 
 int16_t gaussianTable[512];
+static std::once_flag gaussian_table_built;
 
 // Generates the table for gaussian interpolation
 // research by nocash and Ryphecha, implementation borrowed from Near
-void SPU::gaussianConstructTable() {
+static void construct_gaussian_table()
+{
     const int originalRounding = fegetround();
     fesetround(FE_TONEAREST);
     double table[512];
@@ -54,6 +58,12 @@ void SPU::gaussianConstructTable() {
     fesetround(originalRounding);
 }
 
+//The table is read-only once built, so every emulator instance shares it
+void SPU::gaussianConstructTable()
+{
+    std::call_once(gaussian_table_built, construct_gaussian_table);
+}
+
 
 int16_t SPU::interpolate(int voice)
 {
@@ -68,3 +78,43 @@ int16_t SPU::interpolate(int voice)
 
     return out;
 }
+
+//Same as interpolate, for all voices at once. Products are taken at 32 bits and the sum is
+//truncated to 16 bits at the end, which matches the wrapping 16-bit sum above.
+void SPU::interpolate_voices(int16_t* out)
+{
+    alignas(16) int16_t taps[4][24];
+    alignas(16) int16_t history[4][24];
+
+    for (int v = 0; v < 24; v++)
+    {
+        int16_t i = (voices[v].counter & 0x0ff0) >> 4;
+        taps[0][v] = gaussianTable[0x0FF - i];
+        taps[1][v] = gaussianTable[0x1FF - i];
+        taps[2][v] = gaussianTable[0x100 + i];
+        taps[3][v] = gaussianTable[0x000 + i];
+        history[0][v] = voices[v].old3;
+        history[1][v] = voices[v].old2;
+        history[2][v] = voices[v].old1;
+        history[3][v] = voices[v].next_sample;
+    }
+
+    for (int v = 0; v < 24; v += 8)
+    {
+        __m128i sum_lo = _mm_setzero_si128();
+        __m128i sum_hi = _mm_setzero_si128();
+        for (int i = 0; i < 4; i++)
+        {
+            __m128i tap = _mm_load_si128((const __m128i*)&taps[i][v]);
+            __m128i sample = _mm_load_si128((const __m128i*)&history[i][v]);
+            __m128i lo = _mm_mullo_epi16(tap, sample);
+            __m128i hi = _mm_mulhi_epi16(tap, sample);
+            sum_lo = _mm_add_epi32(sum_lo, _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 15));
+            sum_hi = _mm_add_epi32(sum_hi, _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 15));
+        }
+
+        sum_lo = _mm_srai_epi32(_mm_slli_epi32(sum_lo, 16), 16);
+        sum_hi = _mm_srai_epi32(_mm_slli_epi32(sum_hi, 16), 16);
+        _mm_store_si128((__m128i*)&out[v], _mm_packs_epi32(sum_lo, sum_hi));
+    }
+}
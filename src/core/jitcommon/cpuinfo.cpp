@@ -0,0 +1,78 @@
+#include <cstdint>
+#include "cpuinfo.hpp"
+#include "../errors.hpp"
+#include "../trace.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, leaf, subleaf);
+    for (int i = 0; i < 4; i++)
+        regs[i] = info[i];
+#elif defined(__x86_64__) || defined(__i386__)
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#else
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+#endif
+}
+
+static uint64_t xgetbv(uint32_t index)
+{
+#if defined(_MSC_VER)
+    return _xgetbv(index);
+#elif defined(__x86_64__) || defined(__i386__)
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+    return ((uint64_t)edx << 32) | eax;
+#else
+    return 0;
+#endif
+}
+
+static HostCPU::Features probe()
+{
+    HostCPU::Features features = {};
+    uint32_t regs[4];
+
+    cpuid(0, 0, regs);
+    uint32_t max_leaf = regs[0];
+
+    cpuid(1, 0, regs);
+    features.sse41 = regs[2] & (1 << 19);
+
+    //The CPU supporting AVX isn't enough, the OS must also save the YMM registers on a context switch
+    bool osxsave = regs[2] & (1 << 27);
+    bool os_saves_ymm = osxsave && (xgetbv(0) & 0x6) == 0x6;
+    features.avx = (regs[2] & (1 << 28)) && os_saves_ymm;
+    features.fma = (regs[2] & (1 << 12)) && features.avx;
+
+    if (max_leaf >= 7)
+    {
+        cpuid(7, 0, regs);
+        features.avx2 = (regs[1] & (1 << 5)) && features.avx;
+        features.bmi2 = regs[1] & (1 << 8);
+    }
+    return features;
+}
+
+const HostCPU::Features& HostCPU::get_features()
+{
+    static const Features features = probe();
+    return features;
+}
+
+void HostCPU::print_features()
+{
+    const Features& features = get_features();
+    TRACE_INFO(Trace::CORE, "[HostCPU] SSE4.1: %d AVX: %d AVX2: %d FMA: %d BMI2: %d\n",
+               features.sse41, features.avx, features.avx2, features.fma, features.bmi2);
+    if (!features.sse41)
+        Errors::print_warning("[HostCPU] SSE4.1 isn't supported, the JITs won't run on this CPU\n");
+}
@@ -0,0 +1,40 @@
+#ifndef CPUINFO_HPP
+#define CPUINFO_HPP
+
+/**
+Instruction set extensions of the host CPU, probed once with CPUID.
+
+The JITs require SSE4.1. When AVX is available, and the OS saves the YMM state, they emit
+three-operand VEX forms instead, which drop the register copies the two-operand SSE forms need
+and free XMM0 from its role as the implicit BLENDVPS mask. Only 128-bit VEX forms are emitted,
+which zero the upper YMM halves, so mixing them with legacy SSE code has no transition penalty.
+**/
+
+namespace HostCPU
+{
+    struct Features
+    {
+        bool sse41;
+        bool avx;
+        bool avx2;
+        bool fma;
+        bool bmi2;
+    };
+
+    const Features& get_features();
+
+    //Reports the features found, and warns if the JITs can't run on this host
+    void print_features();
+
+    inline bool has_avx()
+    {
+        return get_features().avx;
+    }
+
+    inline bool has_avx2()
+    {
+        return get_features().avx2;
+    }
+};
+
+#endif // CPUINFO_HPP
@@ -57,38 +57,28 @@ void Emitter64::rexw_r_rm(REG_64 reg, REG_64 rm)
     block->write<uint8_t>(rex);
 }
 
-void Emitter64::vex(REG_64 source, REG_64 source2, REG_64 dest, bool packed)
+void Emitter64::vex(uint8_t prefix, uint8_t map, bool wide, REG_64 reg, REG_64 vvvv, REG_64 rm)
 {
-    if (source2 & 0x8)
-        vex3(source, source2, dest, packed);
+    //R, B and vvvv are stored inverted. The two byte form implies the 0F map, W0 and no B bit.
+    uint8_t inv_vvvv = (~vvvv & 0xF) << 3;
+    if (map == VEX_0F && !wide && !(rm & 0x8))
+    {
+        block->write<uint8_t>(0xC5);
+        block->write<uint8_t>(((reg & 0x8) ? 0 : 0x80) | inv_vvvv | prefix);
+    }
     else
-        vex2(source, dest, packed);
-}
-
-void Emitter64::vex2(REG_64 source, REG_64 dest, bool packed)
-{
-    block->write<uint8_t>(0xC5);
-    uint8_t result = 0xF8;
-    if (!packed)
-        result |= 0x2;
-    if (dest & 0x8)
-        result -= 0x80;
-    result += -(source << 3);
-    block->write<uint8_t>(result);
+    {
+        block->write<uint8_t>(0xC4);
+        block->write<uint8_t>(((reg & 0x8) ? 0 : 0x80) | 0x40 | ((rm & 0x8) ? 0 : 0x20) | map);
+        block->write<uint8_t>((wide ? 0x80 : 0) | inv_vvvv | prefix);
+    }
 }
 
-void Emitter64::vex3(REG_64 source, REG_64 source2, REG_64 dest, bool packed)
+void Emitter64::vex_op(uint8_t prefix, uint8_t map, uint8_t opcode, REG_64 reg, REG_64 vvvv, REG_64 rm)
 {
-    block->write<uint8_t>(0xC4);
-    uint8_t result = 0xC1;
-    if (dest & 0x8)
-        result -= 0x80;
-    block->write<uint8_t>(result);
-    result = 0x78;
-    if (!packed)
-        result |= 0x2;
-    result += -(source << 3);
-    block->write<uint8_t>(result);
+    vex(prefix, map, false, reg, vvvv, rm);
+    block->write<uint8_t>(opcode);
+    modrm(0b11, reg, rm);
 }
 
 void Emitter64::modrm(uint8_t mode, uint8_t reg, uint8_t rm)
@@ -167,6 +157,20 @@ void Emitter64::INC16(REG_64 dest)
     modrm(0b11, 0, dest);
 }
 
+void Emitter64::INC64_MEM(REG_64 mem, uint32_t offset)
+{
+    rexw_rm(mem);
+    block->write<uint8_t>(0xFF);
+    if ((mem & 7) == 5 || offset != 0)
+        modrm(0b10, 0, mem);
+    else
+        modrm(0, 0, mem);
+    if ((mem & 7) == 4)
+        block->write<uint8_t>(0x24);
+    if ((mem & 7) == 5 || offset != 0)
+        block->write<uint32_t>(offset);
+}
+
 void Emitter64::AND8_REG_IMM(uint8_t imm, REG_64 dest)
 {
     rex_rm(dest);
@@ -1464,6 +1468,13 @@ uint8_t* Emitter64::JCC_NEAR_DEFERRED(ConditionCode cc)
     return addr;
 }
 
+void Emitter64::JCC_NEAR(ConditionCode cc, uint8_t* dest)
+{
+    block->write<uint8_t>(0x0F);
+    block->write<uint8_t>((int)cc | 0x80);
+    block->write<uint32_t>(dest - block->get_code_pos() - 4);
+}
+
 void Emitter64::set_jump_dest(uint8_t *jump)
 {
     uint8_t* jump_dest_addr = block->get_code_pos();
@@ -1682,7 +1693,10 @@ void Emitter64::PAND_XMM_FROM_MEM(REG_64 indir_source, REG_64 xmm_dest, uint32_t
     rex_r_rm(xmm_dest, indir_source);
     block->write<uint8_t>(0x0F);
     block->write<uint8_t>(0xDB);
-    modrm(0, xmm_dest, indir_source);
+    if ((indir_source & 7) == 5 || offset)
+        modrm(0b10, xmm_dest, indir_source);
+    else
+        modrm(0b0, xmm_dest, indir_source);
     if ((indir_source & 7) == 4)
         block->write<uint8_t>(0x24);
     if ((indir_source & 7) == 5 || offset)
@@ -2113,7 +2127,10 @@ void Emitter64::POR_XMM_FROM_MEM(REG_64 indir_source, REG_64 xmm_dest, uint32_t
     rex_r_rm(xmm_dest, indir_source);
     block->write<uint8_t>(0x0F);
     block->write<uint8_t>(0xEB);
-    modrm(0, xmm_dest, indir_source);
+    if ((indir_source & 7) == 5 || offset)
+        modrm(0b10, xmm_dest, indir_source);
+    else
+        modrm(0b0, xmm_dest, indir_source);
     if ((indir_source & 7) == 4)
         block->write<uint8_t>(0x24);
     if ((indir_source & 7) == 5 || offset)
@@ -2302,6 +2319,78 @@ void Emitter64::PSUBUSW(REG_64 xmm_source, REG_64 xmm_dest)
     modrm(0b11, xmm_dest, xmm_source);
 }
 
+void Emitter64::PUNPCKHBW(REG_64 xmm_source, REG_64 xmm_dest)
+{
+    block->write<uint8_t>(0x66);
+    rex_r_rm(xmm_dest, xmm_source);
+    block->write<uint8_t>(0x0F);
+    block->write<uint8_t>(0x68);
+    modrm(0b11, xmm_dest, xmm_source);
+}
+
+void Emitter64::PUNPCKHWD(REG_64 xmm_source, REG_64 xmm_dest)
+{
+    block->write<uint8_t>(0x66);
+    rex_r_rm(xmm_dest, xmm_source);
+    block->write<uint8_t>(0x0F);
+    block->write<uint8_t>(0x69);
+    modrm(0b11, xmm_dest, xmm_source);
+}
+
+void Emitter64::PUNPCKHDQ(REG_64 xmm_source, REG_64 xmm_dest)
+{
+    block->write<uint8_t>(0x66);
+    rex_r_rm(xmm_dest, xmm_source);
+    block->write<uint8_t>(0x0F);
+    block->write<uint8_t>(0x6A);
+    modrm(0b11, xmm_dest, xmm_source);
+}
+
+void Emitter64::PUNPCKHQDQ(REG_64 xmm_source, REG_64 xmm_dest)
+{
+    block->write<uint8_t>(0x66);
+    rex_r_rm(xmm_dest, xmm_source);
+    block->write<uint8_t>(0x0F);
+    block->write<uint8_t>(0x6D);
+    modrm(0b11, xmm_dest, xmm_source);
+}
+
+void Emitter64::PUNPCKLBW(REG_64 xmm_source, REG_64 xmm_dest)
+{
+    block->write<uint8_t>(0x66);
+    rex_r_rm(xmm_dest, xmm_source);
+    block->write<uint8_t>(0x0F);
+    block->write<uint8_t>(0x60);
+    modrm(0b11, xmm_dest, xmm_source);
+}
+
+void Emitter64::PUNPCKLWD(REG_64 xmm_source, REG_64 xmm_dest)
+{
+    block->write<uint8_t>(0x66);
+    rex_r_rm(xmm_dest, xmm_source);
+    block->write<uint8_t>(0x0F);
+    block->write<uint8_t>(0x61);
+    modrm(0b11, xmm_dest, xmm_source);
+}
+
+void Emitter64::PUNPCKLDQ(REG_64 xmm_source, REG_64 xmm_dest)
+{
+    block->write<uint8_t>(0x66);
+    rex_r_rm(xmm_dest, xmm_source);
+    block->write<uint8_t>(0x0F);
+    block->write<uint8_t>(0x62);
+    modrm(0b11, xmm_dest, xmm_source);
+}
+
+void Emitter64::PUNPCKLQDQ(REG_64 xmm_source, REG_64 xmm_dest)
+{
+    block->write<uint8_t>(0x66);
+    rex_r_rm(xmm_dest, xmm_source);
+    block->write<uint8_t>(0x0F);
+    block->write<uint8_t>(0x6C);
+    modrm(0b11, xmm_dest, xmm_source);
+}
+
 void Emitter64::PXOR_XMM(REG_64 xmm_source, REG_64 xmm_dest)
 {
     block->write<uint8_t>(0x66);
@@ -2586,23 +2675,104 @@ void Emitter64::CVTTPS2DQ(REG_64 xmm_source, REG_64 xmm_dest)
     modrm(0b11, xmm_dest, xmm_source);
 }
 
+void Emitter64::VADDPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_NP, VEX_0F, 0x58, xmm_dest, xmm_source, xmm_source2);
+}
+
 void Emitter64::VADDSS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
 {
-    vex(xmm_source, xmm_source2, xmm_dest, false);
-    block->write<uint8_t>(0x58);
-    modrm(0b11, 0, xmm_source2);
+    vex_op(VEX_F3, VEX_0F, 0x58, xmm_dest, xmm_source, xmm_source2);
 }
 
-void Emitter64::VMINPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+void Emitter64::VBLENDVPS(REG_64 xmm_mask, REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
 {
-    vex(xmm_source, xmm_source2, xmm_dest, true);
-    block->write<uint8_t>(0x5D);
-    modrm(0b11, 0, xmm_source2);
+    vex_op(VEX_66, VEX_0F3A, 0x4A, xmm_dest, xmm_source, xmm_source2);
+    block->write<uint8_t>((uint8_t)(xmm_mask << 4));
 }
 
 void Emitter64::VMAXPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
 {
-    vex(xmm_source, xmm_source2, xmm_dest, true);
-    block->write<uint8_t>(0x5F);
-    modrm(0b11, 0, xmm_source2);
+    vex_op(VEX_NP, VEX_0F, 0x5F, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VMINPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_NP, VEX_0F, 0x5D, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VMULPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_NP, VEX_0F, 0x59, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VSHUFPS(uint8_t imm, REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_NP, VEX_0F, 0xC6, xmm_dest, xmm_source, xmm_source2);
+    block->write<uint8_t>(imm);
+}
+
+void Emitter64::VSUBPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_NP, VEX_0F, 0x5C, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPADDB(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F, 0xFC, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPADDW(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F, 0xFD, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPADDD(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F, 0xFE, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPAND(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F, 0xDB, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPMAXSD(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F38, 0x3D, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPMINSD(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F38, 0x39, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPOR(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F, 0xEB, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPSUBB(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F, 0xF8, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPSUBW(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F, 0xF9, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPSUBD(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F, 0xFA, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VPXOR(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F, 0xEF, xmm_dest, xmm_source, xmm_source2);
+}
+
+void Emitter64::VBROADCASTSS(REG_64 xmm_source, REG_64 xmm_dest)
+{
+    vex_op(VEX_66, VEX_0F38, 0x18, xmm_dest, REG_64::XMM0, xmm_source);
 }
@@ -49,6 +49,22 @@ enum class ConditionCode
     G = 15, NLE = 15
 };
 
+//Legacy prefix and opcode map implied by a VEX encoded instruction
+enum VEX_PREFIX
+{
+    VEX_NP = 0,
+    VEX_66 = 1,
+    VEX_F3 = 2,
+    VEX_F2 = 3
+};
+
+enum VEX_MAP
+{
+    VEX_0F = 1,
+    VEX_0F38 = 2,
+    VEX_0F3A = 3
+};
+
 class Emitter64
 {
     private:
@@ -61,9 +77,8 @@ class Emitter64
         void rexw_rm(REG_64 rm);
         void rexw_r_rm(REG_64 reg, REG_64 rm);
         void modrm(uint8_t mode, uint8_t reg, uint8_t rm);
-        void vex(REG_64 source, REG_64 source2, REG_64 dest, bool packed);
-        void vex2(REG_64 source, REG_64 dest, bool packed);
-        void vex3(REG_64 source, REG_64 source2, REG_64 dest, bool packed);
+        void vex(uint8_t prefix, uint8_t map, bool wide, REG_64 reg, REG_64 vvvv, REG_64 rm);
+        void vex_op(uint8_t prefix, uint8_t map, uint8_t opcode, REG_64 reg, REG_64 vvvv, REG_64 rm);
 
         int get_rip_offset(uint64_t addr);
     public:
@@ -79,6 +94,7 @@ class Emitter64
         void ADD64_REG_IMM(uint32_t imm, REG_64 dest);
 
         void INC16(REG_64 dest);
+        void INC64_MEM(REG_64 mem, uint32_t offset = 0);
 
         void AND8_REG_IMM(uint8_t imm, REG_64 dest);
         void AND16_AX(uint16_t imm);
@@ -230,6 +246,7 @@ class Emitter64
 
         uint8_t* JMP_NEAR_DEFERRED();
         uint8_t* JCC_NEAR_DEFERRED(ConditionCode cc);
+        void JCC_NEAR(ConditionCode cc, uint8_t* dest);
 
         void set_jump_dest(uint8_t* jump);
 
@@ -317,6 +334,14 @@ class Emitter64
         void PSUBSD(REG_64 xmm_source, REG_64 xmm_dest);
         void PSUBUSB(REG_64 xmm_source, REG_64 xmm_dest);
         void PSUBUSW(REG_64 xmm_source, REG_64 xmm_dest);
+        void PUNPCKHBW(REG_64 xmm_source, REG_64 xmm_dest);
+        void PUNPCKHWD(REG_64 xmm_source, REG_64 xmm_dest);
+        void PUNPCKHDQ(REG_64 xmm_source, REG_64 xmm_dest);
+        void PUNPCKHQDQ(REG_64 xmm_source, REG_64 xmm_dest);
+        void PUNPCKLBW(REG_64 xmm_source, REG_64 xmm_dest);
+        void PUNPCKLWD(REG_64 xmm_source, REG_64 xmm_dest);
+        void PUNPCKLDQ(REG_64 xmm_source, REG_64 xmm_dest);
+        void PUNPCKLQDQ(REG_64 xmm_source, REG_64 xmm_dest);
         void PXOR_XMM(REG_64 xmm_source, REG_64 xmm_dest);
         void PXOR_XMM_FROM_MEM(REG_64 indir_source, REG_64 xmm_dest, uint32_t offset = 0);
 
@@ -355,9 +380,31 @@ class Emitter64
         //Convert truncated floats into 32-bit signed integers
         void CVTTPS2DQ(REG_64 xmm_source, REG_64 xmm_dest);
 
+        //AVX three-operand forms: dest = source OP source2. Callers check HostCPU::has_avx first.
+        void VADDPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
         void VADDSS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
-        void VMINPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+
+        //Takes each lane from source2 where the sign bit of the mask is set, else from source
+        void VBLENDVPS(REG_64 xmm_mask, REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
         void VMAXPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VMINPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VMULPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VSHUFPS(uint8_t imm, REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VSUBPS(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPADDB(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPADDW(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPADDD(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPAND(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPMAXSD(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPMINSD(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPOR(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPSUBB(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPSUBW(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPSUBD(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+        void VPXOR(REG_64 xmm_source, REG_64 xmm_source2, REG_64 xmm_dest);
+
+        //AVX2, callers check HostCPU::has_avx2
+        void VBROADCASTSS(REG_64 xmm_source, REG_64 xmm_dest);
 };
 
 #endif // EMITTER64_HPP
@@ -6,6 +6,8 @@ namespace IR
 Block::Block()
 {
     cycle_count = 0;
+    idle_loop = false;
+    loop = false;
 }
 
 void Block::add_instr(Instruction &instr)
@@ -23,6 +25,16 @@ int Block::get_cycle_count() const
     return cycle_count;
 }
 
+bool Block::is_idle_loop() const
+{
+    return idle_loop;
+}
+
+bool Block::is_loop() const
+{
+    return loop;
+}
+
 Instruction Block::get_next_instr()
 {
     if (!instructions.size())
@@ -42,4 +54,14 @@ void Block::set_cycle_count(int cycles)
     cycle_count = cycles;
 }
 
+void Block::set_idle_loop(bool idle)
+{
+    idle_loop = idle;
+}
+
+void Block::set_loop(bool looping)
+{
+    loop = looping;
+}
+
 };
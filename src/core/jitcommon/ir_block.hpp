@@ -11,6 +11,8 @@ class Block
     private:
         std::list<Instruction> instructions;
         int cycle_count;
+        bool idle_loop;
+        bool loop;
     public:
         Block();
 
@@ -18,9 +20,13 @@ class Block
 
         unsigned int get_instruction_count() const;
         int get_cycle_count() const;
+        bool is_idle_loop() const;
+        bool is_loop() const;
         Instruction get_next_instr();
 
         void set_cycle_count(int cycles);
+        void set_idle_loop(bool idle);
+        void set_loop(bool looping);
 };
 
 };
@@ -5,6 +5,7 @@
 #include <sys/mman.h>
 #endif
 
+#include <cstdio>
 #include <limits>
 #include <cstring>
 
@@ -45,6 +46,11 @@ void JitBlock::clear() {
     literals_start = code_start;
 }
 
+const std::string& JitBlock::get_name() const
+{
+    return jit_name;
+}
+
 /*!
  * Get the start of the current block's code
  */
@@ -107,6 +113,24 @@ void JitBlock::print_literal_pool()
 // JIT Heap Common
 ///////////////////
 
+std::string jit_block_label(uint64_t state)
+{
+    if (state == ~0ULL)
+        return "prologue";
+    char label[20];
+    snprintf(label, sizeof(label), "%016llX", (unsigned long long)state);
+    return label;
+}
+
+std::string jit_block_label(const VUBlockState &state)
+{
+    if (state.pc == 0xFFFF && state.prev_pc == 0xFFFE)
+        return "prologue";
+    char label[24];
+    snprintf(label, sizeof(label), "%08X_%04X", state.program, state.pc);
+    return label;
+}
+
 
 void* JitHeap::rwx_alloc(std::size_t size)
 {
@@ -626,6 +650,16 @@ EEJitBlockRecord* EEJitHeap::insert_block(uint32_t PC, JitBlock *block)
     record.code_end = (uint8_t*)dest + literal_size + code_size;
     record.block_data.pc = PC;
 
+    if (JitProfiler::is_enabled())
+    {
+        char name[32];
+        if (PC == 0xFFFFFFFF)
+            snprintf(name, sizeof(name), "%s_prologue", block->get_name().c_str());
+        else
+            snprintf(name, sizeof(name), "%s_%08X", block->get_name().c_str(), PC);
+        JitProfiler::register_code(record.code_start, code_size, name);
+    }
+
     uint32_t page = PC / 4096;
     EEPageRecord* page_record = lookup_ee_page(page);
 
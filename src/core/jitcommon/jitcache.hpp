@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <string>
 #include "../errors.hpp"
+#include "jitprofiler.hpp"
 
 /*!
  * A record to keep track of a JIT block in a JIT heap. Points to the x86 code/literals, as well as some block_data
@@ -45,6 +46,7 @@ public:
     uint8_t *get_code_pos();
     uint8_t *get_literals_start();
     void set_code_pos(uint8_t *pos);
+    const std::string& get_name() const;
     void print_block();
     void print_literal_pool();
 
@@ -90,6 +92,12 @@ inline void JitBlock::write(T value) {
 }
 
 
+struct VUBlockState;
+
+// Names for JitProfiler, describing the state a block was compiled for
+std::string jit_block_label(uint64_t state);
+std::string jit_block_label(const VUBlockState &state);
+
 /*!
  * Common jit Heap functions shared by all jit heaps
  */
@@ -207,6 +215,9 @@ public:
         record.code_end = (uint8_t*)dest + literal_size + code_size;
         record.block_data = data;
 
+        if (JitProfiler::is_enabled())
+            JitProfiler::register_code(record.code_start, code_size, block->get_name() + "_" + jit_block_label(data));
+
         // add to hash table
         auto it = block_map.insert({data, record}).first;
         return &it->second;
@@ -0,0 +1,32 @@
+#include <algorithm>
+#include <vector>
+#include "jitfallbacks.hpp"
+#include "../trace.hpp"
+
+uint64_t* JitFallbackCounters::get_counter(const std::string& opcode_name)
+{
+    return &counters[opcode_name];
+}
+
+void JitFallbackCounters::print(const char* jit_name) const
+{
+    std::vector<std::pair<std::string, uint64_t>> sorted;
+    uint64_t total = 0;
+    for (auto& counter : counters)
+    {
+        if (counter.second)
+            sorted.push_back(counter);
+        total += counter.second;
+    }
+    if (!total)
+        return;
+
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<std::string, uint64_t>& a, const std::pair<std::string, uint64_t>& b)
+              { return a.second > b.second; });
+
+    TRACE_INFO(Trace::CORE, "[%s] %llu interpreter fallbacks:\n", jit_name, (unsigned long long)total);
+    for (auto& counter : sorted)
+        TRACE_INFO(Trace::CORE, "[%s]     %-10s %llu\n", jit_name, counter.first.c_str(),
+                   (unsigned long long)counter.second);
+}
@@ -0,0 +1,28 @@
+#ifndef JITFALLBACKS_HPP
+#define JITFALLBACKS_HPP
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+Counts how often each opcode runs through a JIT's interpreter fallback.
+
+Every fallback site in recompiled code increments the counter of its opcode, which costs one
+memory increment next to the register flush and call the fallback already makes. Counters are
+handed out at recompile time and kept in map nodes, so their addresses stay valid for as long
+as the JIT exists, including across cache flushes. The counts are reported when the emulator
+shuts down and show which instructions are worth emitting natively.
+**/
+
+class JitFallbackCounters
+{
+    private:
+        std::map<std::string, uint64_t> counters;
+    public:
+        uint64_t* get_counter(const std::string& opcode_name);
+
+        //Reports the counts in descending order, if any fallback ran
+        void print(const char* jit_name) const;
+};
+
+#endif // JITFALLBACKS_HPP
@@ -0,0 +1,182 @@
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdint>
+#include <mutex>
+#include "jitprofiler.hpp"
+#include "../errors.hpp"
+
+std::atomic<int> JitProfiler::enabled_modes(0);
+
+#ifdef __linux__
+
+//See tools/perf/Documentation/jitdump-specification.txt in the Linux tree
+struct JitDumpHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t elf_mach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+};
+
+struct JitDumpCodeLoad
+{
+    uint32_t id;
+    uint32_t total_size;
+    uint64_t timestamp;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t code_addr;
+    uint64_t code_size;
+    uint64_t code_index;
+};
+
+constexpr static uint32_t JITDUMP_MAGIC = 0x4A695444;
+constexpr static uint32_t JITDUMP_CODE_LOAD = 0;
+constexpr static uint32_t EM_X86_64 = 62;
+
+static std::mutex profiler_mutex;
+static FILE* perf_map = nullptr;
+static FILE* jitdump = nullptr;
+static void* jitdump_marker = nullptr;
+static long jitdump_marker_size = 0;
+static uint64_t code_index = 0;
+
+static uint64_t get_timestamp()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void open_perf_map()
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/perf-%d.map", getpid());
+    perf_map = fopen(path, "w");
+    if (!perf_map)
+        Errors::print_warning("[JitProfiler] Failed to open %s\n", path);
+}
+
+static void open_jitdump()
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/jit-%d.dump", getpid());
+    jitdump = fopen(path, "w+");
+    if (!jitdump)
+    {
+        Errors::print_warning("[JitProfiler] Failed to open %s\n", path);
+        return;
+    }
+
+    //perf finds the dump through an executable mapping of it in the recorded process
+    jitdump_marker_size = sysconf(_SC_PAGESIZE);
+    jitdump_marker = mmap(nullptr, jitdump_marker_size, PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(jitdump), 0);
+    if (jitdump_marker == MAP_FAILED)
+    {
+        Errors::print_warning("[JitProfiler] Failed to map %s, perf won't find it\n", path);
+        jitdump_marker = nullptr;
+    }
+
+    JitDumpHeader header;
+    header.magic = JITDUMP_MAGIC;
+    header.version = 1;
+    header.total_size = sizeof(header);
+    header.elf_mach = EM_X86_64;
+    header.pad1 = 0;
+    header.pid = getpid();
+    header.timestamp = get_timestamp();
+    header.flags = 0;
+    fwrite(&header, sizeof(header), 1, jitdump);
+    fflush(jitdump);
+}
+
+void JitProfiler::enable(int modes)
+{
+    std::lock_guard<std::mutex> lock(profiler_mutex);
+    if ((modes & PERF_MAP) && !perf_map)
+        open_perf_map();
+    if ((modes & JITDUMP) && !jitdump)
+        open_jitdump();
+    enabled_modes = (perf_map ? PERF_MAP : 0) | (jitdump ? JITDUMP : 0);
+}
+
+void JitProfiler::shutdown()
+{
+    std::lock_guard<std::mutex> lock(profiler_mutex);
+    enabled_modes = 0;
+    if (perf_map)
+    {
+        fclose(perf_map);
+        perf_map = nullptr;
+    }
+    if (jitdump_marker)
+    {
+        munmap(jitdump_marker, jitdump_marker_size);
+        jitdump_marker = nullptr;
+    }
+    if (jitdump)
+    {
+        fclose(jitdump);
+        jitdump = nullptr;
+    }
+}
+
+void JitProfiler::register_code(const void* code, std::size_t size, const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(profiler_mutex);
+
+    //Flushed per block so the files are usable even if the emulator doesn't exit cleanly
+    if (perf_map)
+    {
+        fprintf(perf_map, "%llx %llx %s\n", (unsigned long long)code, (unsigned long long)size, name.c_str());
+        fflush(perf_map);
+    }
+
+    if (jitdump)
+    {
+        JitDumpCodeLoad record;
+        record.id = JITDUMP_CODE_LOAD;
+        record.total_size = (uint32_t)(sizeof(record) + name.size() + 1 + size);
+        record.timestamp = get_timestamp();
+        record.pid = getpid();
+        record.tid = (uint32_t)syscall(SYS_gettid);
+        record.vma = (uint64_t)code;
+        record.code_addr = (uint64_t)code;
+        record.code_size = size;
+        record.code_index = code_index++;
+        fwrite(&record, sizeof(record), 1, jitdump);
+        fwrite(name.c_str(), name.size() + 1, 1, jitdump);
+        fwrite(code, size, 1, jitdump);
+        fflush(jitdump);
+    }
+}
+
+#else
+
+void JitProfiler::enable(int modes)
+{
+    Errors::print_warning("[JitProfiler] JIT profiling is only supported on Linux\n");
+}
+
+void JitProfiler::shutdown()
+{
+
+}
+
+void JitProfiler::register_code(const void* code, std::size_t size, const std::string& name)
+{
+
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef JITPROFILER_HPP
+#define JITPROFILER_HPP
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+/**
+Makes recompiled code visible to host profilers. Every block inserted into a JIT heap is reported
+with a name describing what it was compiled from, e.g. EE_001F4A80 for an EE block starting at
+that PC, VU_<microprogram CRC>_<PC> or GS-pixel_<draw state>.
+
+PERF_MAP appends to /tmp/perf-<pid>.map, which perf report reads as is. Heaps reuse addresses
+after a flush, and the map can't say when a block was replaced, so samples taken after a flush
+may be attributed to an older block.
+
+JITDUMP writes /tmp/jit-<pid>.dump, which also records the code and load times and so handles
+reused addresses. It needs `perf record -k mono` followed by `perf inject --jit`.
+
+Both are Linux only and off by default. The JITs run on the emulator and GS threads, so
+registration is locked.
+**/
+
+namespace JitProfiler
+{
+    enum Mode
+    {
+        PERF_MAP = 1,
+        JITDUMP = 2
+    };
+
+    extern std::atomic<int> enabled_modes;
+
+    void enable(int modes);
+    void shutdown();
+
+    void register_code(const void* code, std::size_t size, const std::string& name);
+
+    inline bool is_enabled()
+    {
+        return enabled_modes.load(std::memory_order_relaxed) != 0;
+    }
+};
+
+#endif // JITPROFILER_HPP
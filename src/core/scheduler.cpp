@@ -23,6 +23,7 @@ void Scheduler::reset()
     iop_cycles.remainder = 0;
 
     next_event_id = 0;
+    run_cycles = 0;
 
     closest_event_time = TimestampLimit::max();
 
@@ -32,13 +33,17 @@ void Scheduler::reset()
     timer_event_id = register_function([this] (uint64_t param) { timer_event(param);});
 }
 
-unsigned int Scheduler::calculate_run_cycles()
+//Devices only run between slices, so slices are kept short while any of them has work to do.
+//When only the CPUs are busy, the slice is bounded by the next event and the CPUs' own interleaving.
+unsigned int Scheduler::calculate_run_cycles(bool devices_idle)
 {
     if (!events.size())
         Errors::die("[Scheduler] No events registered");
     const static int MAX_CYCLES = 32;
-    if (ee_cycles.count + MAX_CYCLES <= closest_event_time)
-        run_cycles = MAX_CYCLES;
+    const static int MAX_IDLE_CYCLES = 128;
+    int max_cycles = devices_idle ? MAX_IDLE_CYCLES : MAX_CYCLES;
+    if (ee_cycles.count + max_cycles <= closest_event_time)
+        run_cycles = max_cycles;
     else
     {
         int64_t delta = closest_event_time - ee_cycles.count;
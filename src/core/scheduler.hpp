@@ -67,12 +67,13 @@ class Scheduler
 
         void reset();
 
-        unsigned int calculate_run_cycles();
+        unsigned int calculate_run_cycles(bool devices_idle = false);
         unsigned int get_bus_run_cycles();
         unsigned int get_iop_run_cycles();
 
         int64_t get_ee_cycles();
         int64_t get_iop_cycles();
+        int64_t get_slice_start_cycles();
 
         int register_function(std::function<void(uint64_t)> func);
         int register_timer_callback(std::function<void(uint64_t, bool)> cb);
@@ -107,4 +108,9 @@ inline int64_t Scheduler::get_iop_cycles()
     return iop_cycles.count;
 }
 
+inline int64_t Scheduler::get_slice_start_cycles()
+{
+    return ee_cycles.count - run_cycles;
+}
+
 #endif // SCHEDULER_HPP
@@ -4,7 +4,7 @@
 
 #define VER_MAJOR 0
 #define VER_MINOR 0
-#define VER_REV 50
+#define VER_REV 52
 
 using namespace std;
 
@@ -68,6 +68,9 @@ void Emulator::load_state(const char *file_name)
     //Emulator info
     state.read((char*)&VBLANK_sent, sizeof(VBLANK_sent));
     state.read((char*)&frames, sizeof(frames));
+    state.read((char*)&next_sound_sample, sizeof(next_sound_sample));
+    state.read((char*)&sound_event_time, sizeof(sound_event_time));
+    state.read((char*)&sound_event_id, sizeof(sound_event_id));
 
     //RAM
     state.read((char*)RDRAM, 1024 * 1024 * 32);
@@ -143,6 +146,9 @@ void Emulator::save_state(const char *file_name)
     //Emulator info
     state.write((char*)&VBLANK_sent, sizeof(VBLANK_sent));
     state.write((char*)&frames, sizeof(frames));
+    state.write((char*)&next_sound_sample, sizeof(next_sound_sample));
+    state.write((char*)&sound_event_time, sizeof(sound_event_time));
+    state.write((char*)&sound_event_id, sizeof(sound_event_id));
 
     //RAM
     state.write((char*)RDRAM, 1024 * 1024 * 32);
@@ -853,6 +859,7 @@ void CDVD_Drive::load_state(ifstream &state)
     state.read((char*)&disc_type, sizeof(disc_type));
     state.read((char*)&speed, sizeof(speed));
     state.read((char*)&current_sector, sizeof(current_sector));
+    state.read((char*)&container_sector, sizeof(container_sector));
     state.read((char*)&sector_pos, sizeof(sector_pos));
     state.read((char*)&sectors_left, sizeof(sectors_left));
     state.read((char*)&block_size, sizeof(block_size));
@@ -883,6 +890,7 @@ void CDVD_Drive::save_state(ofstream &state)
     state.write((char*)&disc_type, sizeof(disc_type));
     state.write((char*)&speed, sizeof(speed));
     state.write((char*)&current_sector, sizeof(current_sector));
+    state.write((char*)&container_sector, sizeof(container_sector));
     state.write((char*)&sector_pos, sizeof(sector_pos));
     state.write((char*)&sectors_left, sizeof(sectors_left));
     state.write((char*)&block_size, sizeof(block_size));
@@ -996,14 +1004,14 @@ void Gamepad::save_state(ofstream &state)
 void SPU::load_state(ifstream &state)
 {
     state.read((char*)&voices, sizeof(voices));
-    state.read((char*)&core_att, sizeof(core_att));
+    state.read((char*)&shared->core_att, sizeof(shared->core_att));
     state.read((char*)&status, sizeof(status));
-    state.read((char*)&spdif_irq, sizeof(spdif_irq));
+    state.read((char*)&shared->spdif_irq, sizeof(shared->spdif_irq));
     state.read((char*)&transfer_addr, sizeof(transfer_addr));
     state.read((char*)&current_addr, sizeof(current_addr));
     state.read((char*)&autodma_ctrl, sizeof(autodma_ctrl));
     state.read((char*)&buffer_pos, sizeof(buffer_pos));
-    state.read((char*)&IRQA, sizeof(IRQA));
+    state.read((char*)&shared->IRQA, sizeof(shared->IRQA));
     state.read((char*)&ENDX, sizeof(ENDX));
     state.read((char*)&key_off, sizeof(key_off));
     state.read((char*)&key_on, sizeof(key_on));
@@ -1036,14 +1044,14 @@ void SPU::load_state(ifstream &state)
 void SPU::save_state(ofstream &state)
 {
     state.write((char*)&voices, sizeof(voices));
-    state.write((char*)&core_att, sizeof(core_att));
+    state.write((char*)&shared->core_att, sizeof(shared->core_att));
     state.write((char*)&status, sizeof(status));
-    state.write((char*)&spdif_irq, sizeof(spdif_irq));
+    state.write((char*)&shared->spdif_irq, sizeof(shared->spdif_irq));
     state.write((char*)&transfer_addr, sizeof(transfer_addr));
     state.write((char*)&current_addr, sizeof(current_addr));
     state.write((char*)&autodma_ctrl, sizeof(autodma_ctrl));
     state.write((char*)&buffer_pos, sizeof(buffer_pos));
-    state.write((char*)&IRQA, sizeof(IRQA));
+    state.write((char*)&shared->IRQA, sizeof(shared->IRQA));
     state.write((char*)&ENDX, sizeof(ENDX));
     state.write((char*)&key_off, sizeof(key_off));
     state.write((char*)&key_on, sizeof(key_on));
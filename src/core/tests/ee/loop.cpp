@@ -0,0 +1,218 @@
+#include "../../emulator.hpp"
+#include "../../ee/ee_jittrans.hpp"
+#include "../testcheck.hpp"
+#include <cstring>
+
+using namespace std;
+
+struct LoopBody
+{
+    const char* name;
+    vector<uint32_t> instrs;
+};
+
+struct LoopState
+{
+    uint64_t gpr[32][2];
+    uint32_t fpr[32];
+    uint32_t vf[32][4];
+    uint32_t PC;
+    uint64_t cycle_count;
+    int64_t cycles_to_run;
+};
+
+static const uint32_t LOOP_ADDR = 0xBFC00000;
+static const uint32_t SCRATCH_ADDR = 0x100000;
+
+static uint32_t addiu(int rt, int rs, int16_t imm)
+{
+    return (0x09 << 26) | (rs << 21) | (rt << 16) | (uint16_t)imm;
+}
+
+static uint32_t special(int funct, int rd, int rs, int rt)
+{
+    return (rs << 21) | (rt << 16) | (rd << 11) | funct;
+}
+
+static uint32_t paddw(int rd, int rs, int rt)
+{
+    return (0x1C << 26) | (rs << 21) | (rt << 16) | (rd << 11) | 0x08;
+}
+
+static uint32_t mem_op(int op, int rt, int base, int16_t offset)
+{
+    return ((uint32_t)op << 26) | (base << 21) | (rt << 16) | (uint16_t)offset;
+}
+
+static uint32_t fpu_op(int funct, int fd, int fs, int ft)
+{
+    return (0x11u << 26) | (0x10 << 21) | (ft << 16) | (fs << 11) | (fd << 6) | funct;
+}
+
+static uint32_t vu0_op(int funct, int fd, int fs, int ft)
+{
+    return (0x12u << 26) | (1 << 25) | (0xF << 21) | (ft << 16) | (fs << 11) | (fd << 6) | funct;
+}
+
+//QMFC2 rt, vfs
+static uint32_t qmfc2(int rt, int fs)
+{
+    return (0x12u << 26) | (0x01 << 21) | (rt << 16) | (fs << 11);
+}
+
+//The loops the EE JIT keeps in registers. $11 points at a scratch area in RDRAM for the memory calls.
+static vector<LoopBody> loop_bodies()
+{
+    const uint32_t ADDU = 0x21, DADDU = 0x2D, XOR = 0x26;
+    const uint32_t SW = 0x2B, LW = 0x23, SD = 0x3F, LD = 0x37;
+    const uint32_t ADD_S = 0x00, SUB_S = 0x01;
+    const uint32_t VADD = 0x28, VMUL = 0x2A;
+
+    vector<LoopBody> bodies;
+
+    //XMM registers are live across the calls, so they are saved on the stack around them
+    bodies.push_back({"memory call", {fpu_op(ADD_S, 1, 1, 2), paddw(3, 3, 4), mem_op(SW, 5, 11, 0),
+                                      mem_op(LW, 6, 11, 0), fpu_op(ADD_S, 3, 3, 1), paddw(7, 7, 3),
+                                      special(DADDU, 5, 5, 6)}});
+    bodies.push_back({"written before the call", {addiu(2, 2, 5), paddw(12, 12, 13), fpu_op(SUB_S, 4, 4, 5),
+                                                  mem_op(SD, 2, 11, 8), special(ADDU, 9, 9, 2)}});
+    bodies.push_back({"written after the call", {mem_op(LD, 3, 11, 16), paddw(14, 14, 12),
+                                                 fpu_op(ADD_S, 6, 6, 5), special(XOR, 15, 15, 3),
+                                                 mem_op(SD, 15, 11, 16)}});
+    bodies.push_back({"UpdateVU0", {vu0_op(VADD, 1, 1, 2), special(ADDU, 2, 2, 3), vu0_op(VMUL, 3, 3, 4),
+                                    qmfc2(4, 1), paddw(5, 5, 4), fpu_op(ADD_S, 1, 1, 2)}});
+    return bodies;
+}
+
+//The body, then $10 counted down to zero by the branch back to the start, then an idle loop
+static int write_loop(uint8_t* BIOS, const LoopBody& body)
+{
+    vector<uint32_t> program = body.instrs;
+    program.push_back(addiu(10, 10, -1));
+    int branch = (int)program.size();
+    program.push_back((0x05 << 26) | (10 << 21) | (uint16_t)(-(branch + 1))); //bne $10, $zero, start
+    program.push_back(special(0x2D, 8, 8, 5)); //daddu $8, $8, $5
+    program.push_back(0x1000FFFF); //beq $zero, $zero, -1
+    program.push_back(0);
+
+    memcpy(BIOS, program.data(), program.size() * sizeof(uint32_t));
+    return branch + 2;
+}
+
+//Runs self-looping blocks through the JIT, which keeps them in registers across iterations, and
+//compares the GPRs, FPRs and VF registers with the interpreter after the same number of iterations.
+void Emulator::test_ee_loop()
+{
+    ofstream test_output("test_log.txt");
+
+    uint8_t saved_bios[64 * 4];
+    uint8_t saved_scratch[32];
+    memcpy(saved_bios, BIOS, sizeof(saved_bios));
+    memcpy(saved_scratch, RDRAM + SCRATCH_ADDR, sizeof(saved_scratch));
+
+    //Resets the EE, FPU and VU0 to the same state for each run
+    auto start_loop = [&](CPU_MODE mode, uint32_t iterations)
+    {
+        cpu.reset();
+        fpu.reset();
+        vu0.reset();
+        set_ee_mode(mode);
+        for (int i = 1; i < 32; i++)
+        {
+            cpu.set_gpr<uint64_t>(i, 0x0123456789ABCDEFULL * i);
+            cpu.set_gpr<uint64_t>(i, 0xFEDCBA9876543210ULL ^ (i << 8), 1);
+        }
+        cpu.set_gpr<uint64_t>(10, iterations);
+        cpu.set_gpr<uint64_t>(11, 0xA0000000 | SCRATCH_ADDR);
+        for (int i = 0; i < 32; i++)
+        {
+            float value = 1.0f + (float)i * 0.125f;
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            fpu.mtc(i, bits);
+        }
+        for (int i = 1; i < 32; i++)
+        {
+            for (int field = 0; field < 4; field++)
+                vu0.set_gpr_f(i, field, i == 4 ? 1.0f : 0.5f + (float)i + (float)field * 0.25f);
+        }
+        memset(RDRAM + SCRATCH_ADDR, 0x5A, 32);
+    };
+
+    auto get_state = [&](LoopState& state)
+    {
+        for (int i = 0; i < 32; i++)
+        {
+            state.gpr[i][0] = cpu.get_gpr<uint64_t>(i);
+            state.gpr[i][1] = cpu.get_gpr<uint64_t>(i, 1);
+            state.fpr[i] = fpu.get_gpr(i);
+            for (int field = 0; field < 4; field++)
+                state.vf[i][field] = vu0.get_gpr_u(i, field);
+        }
+        state.PC = cpu.get_PC();
+        state.cycle_count = cpu.get_cycle_count();
+        state.cycles_to_run = (int64_t)(cpu.get_cycle_count_goal() - cpu.get_cycle_count());
+    };
+
+    auto same_regs = [](const LoopState& a, const LoopState& b)
+    {
+        return !memcmp(a.gpr, b.gpr, sizeof(a.gpr)) && !memcmp(a.fpr, b.fpr, sizeof(a.fpr)) &&
+               !memcmp(a.vf, b.vf, sizeof(a.vf)) && a.PC == b.PC;
+    };
+
+    //The interpreter charges fetches from the uncached BIOS against the slice and the JIT counts cycles per
+    //block, so the cycle counts are checked against the slices given rather than against each other
+    test_output << "-- TEST BEGIN\n";
+    for (const LoopBody& body : loop_bodies())
+    {
+        int loop_length = write_loop(BIOS, body);
+        LoopState interpreter, jit;
+
+        //The loop runs to the end and the idle loop after it takes the rest of the slice
+        start_loop(CPU_MODE::INTERPRETER, 20);
+        cpu.run(4096);
+        get_state(interpreter);
+        start_loop(CPU_MODE::JIT, 20);
+        cpu.run(4096);
+        get_state(jit);
+        CHECK(string(body.name) + ", 20 iterations", same_regs(interpreter, jit) &&
+              jit.cycle_count == 4096 && jit.cycles_to_run == 0 && interpreter.cycles_to_run == 0);
+
+        //The cycles the JIT counts per iteration, and whether it keeps the loop in registers
+        start_loop(CPU_MODE::JIT, 1000);
+        EE_JitTranslator translator;
+        IR::Block block = translator.translate(cpu);
+        uint64_t block_cycles = (uint64_t)block.get_cycle_count();
+
+        //Slices shorter than an iteration, of exactly three, and of a little more. The JIT leaves at the
+        //back-edge of the iteration the slice runs out in, carrying the extra cycles into the next slice.
+        bool timeslice_ok = block.is_loop();
+        for (int slice : {7, (int)block_cycles * 3, (int)block_cycles * 3 + 4})
+        {
+            const int slices = 50;
+            start_loop(CPU_MODE::JIT, 1000);
+            for (int i = 0; i < slices; i++)
+                cpu.run(slice);
+            get_state(jit);
+
+            //The interpreter then runs that many iterations an instruction at a time
+            uint64_t iterations = 1000 - jit.gpr[10][0];
+            start_loop(CPU_MODE::INTERPRETER, 1000);
+            while (cpu.get_cycle_count() < iterations * loop_length)
+                cpu.run(1);
+            get_state(interpreter);
+
+            timeslice_ok &= same_regs(interpreter, jit) && jit.PC == LOOP_ADDR &&
+                            jit.cycle_count == iterations * block_cycles &&
+                            jit.cycle_count + jit.cycles_to_run == (uint64_t)(slice * slices) &&
+                            jit.cycles_to_run <= 0 && jit.cycles_to_run > -(int64_t)block_cycles;
+        }
+        CHECK(string(body.name) + ", timeslice", timeslice_ok);
+    }
+    test_output << "-- TEST END\n";
+    test_output.flush();
+
+    memcpy(BIOS, saved_bios, sizeof(saved_bios));
+    memcpy(RDRAM + SCRATCH_ADDR, saved_scratch, sizeof(saved_scratch));
+    cpu.reset();
+}
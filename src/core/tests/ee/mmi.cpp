@@ -0,0 +1,147 @@
+#include "../../emulator.hpp"
+#include "../../ee/emotiondisasm.hpp"
+#include <cstring>
+#include <random>
+
+using namespace std;
+
+struct MMI_Op
+{
+    uint32_t funct, sub;
+};
+
+//The MMI ops the EE JIT emits natively
+static vector<MMI_Op> native_mmi_ops()
+{
+    const uint32_t mmi0[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x10,
+                             0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B};
+    const uint32_t mmi1[] = {0x01, 0x02, 0x03, 0x05, 0x06, 0x07, 0x0A, 0x10, 0x11, 0x12, 0x14, 0x15,
+                             0x16, 0x18, 0x19, 0x1A};
+    const uint32_t mmi2[] = {0x0D, 0x0E, 0x12, 0x13, 0x1A, 0x1B, 0x1E, 0x1F};
+    const uint32_t mmi3[] = {0x0E, 0x12, 0x13, 0x1A, 0x1E};
+
+    vector<MMI_Op> ops;
+    //PSLLH, PSRLH, PSRAH, PSLLW, PSRLW, PSRAW
+    for (uint32_t funct : {0x34, 0x36, 0x37, 0x3C, 0x3E, 0x3F})
+        ops.push_back({funct, 0});
+    for (uint32_t sub : mmi0)
+        ops.push_back({0x08, sub});
+    for (uint32_t sub : mmi1)
+        ops.push_back({0x28, sub});
+    for (uint32_t sub : mmi2)
+        ops.push_back({0x09, sub});
+    for (uint32_t sub : mmi3)
+        ops.push_back({0x29, sub});
+    return ops;
+}
+
+//Mostly values at the edges of the byte, halfword and word lanes
+static uint64_t random_lanes(mt19937_64& rng)
+{
+    const uint8_t edge_bytes[] = {0x00, 0x01, 0x55, 0x7F, 0x80, 0xFF};
+    switch (rng() % 8)
+    {
+        case 0:
+            return 0;
+        case 1:
+            return ~0ULL;
+        case 2:
+            return 0x8000000080000000ULL;
+        case 3:
+            return 0x7FFFFFFF7FFFFFFFULL;
+        case 4:
+            return rng() & 0x0000FFFF0000FFFFULL;
+        case 5:
+        {
+            uint64_t value = 0;
+            for (int i = 0; i < 8; i++)
+                value |= (uint64_t)edge_bytes[rng() % sizeof(edge_bytes)] << (i * 8);
+            return value;
+        }
+        default:
+            return rng();
+    }
+}
+
+//Runs each natively emitted MMI op through the interpreter and the JIT and compares the registers,
+//LO and HI.
+//Registers are drawn from a small pool so that sources and destinations alias, $zero included.
+void Emulator::test_ee_mmi()
+{
+    ofstream test_output("test_log.txt");
+    mt19937_64 rng(1234);
+    const int trials = 64;
+
+    //Each test is the op followed by an idle loop at the reset vector
+    uint8_t saved_bios[12];
+    memcpy(saved_bios, BIOS, sizeof(saved_bios));
+    *(uint32_t*)&BIOS[4] = 0x1000FFFF; //beq $zero, $zero, -1
+    *(uint32_t*)&BIOS[8] = 0;
+
+    test_output << "-- TEST BEGIN\n";
+    int failed_ops = 0;
+    for (MMI_Op op : native_mmi_ops())
+    {
+        uint32_t instr = (0x1C << 26) | (op.sub << 6) | op.funct;
+        string name = EmotionDisasm::disasm_instr(instr, 0);
+        name = name.substr(0, name.find(' '));
+
+        int mismatches = 0;
+        for (int trial = 0; trial < trials; trial++)
+        {
+            uint32_t rs = static_cast<uint32_t>(rng() % 6);
+            uint32_t rt = static_cast<uint32_t>(rng() % 6);
+            uint32_t rd = static_cast<uint32_t>(rng() % 6);
+            uint32_t sa = op.funct == 0x08 || op.funct == 0x28 || op.funct == 0x09 || op.funct == 0x29 ?
+                        op.sub : static_cast<uint32_t>(rng() % 32);
+            *(uint32_t*)&BIOS[0] = instr | (rs << 21) | (rt << 16) | (rd << 11) | (sa << 6);
+
+            uint64_t inputs[6][2];
+            for (int i = 0; i < 6; i++)
+            {
+                inputs[i][0] = i ? random_lanes(rng) : 0;
+                inputs[i][1] = i ? random_lanes(rng) : 0;
+            }
+
+            //$0-$5, then LO and HI
+            uint64_t results[2][8][2];
+            for (int mode = 0; mode < 2; mode++)
+            {
+                cpu.reset();
+                set_ee_mode(mode ? CPU_MODE::JIT : CPU_MODE::INTERPRETER);
+                for (int i = 1; i < 6; i++)
+                {
+                    cpu.set_gpr<uint64_t>(i, inputs[i][0]);
+                    cpu.set_gpr<uint64_t>(i, inputs[i][1], 1);
+                }
+                cpu.run(16);
+                for (int i = 0; i < 6; i++)
+                {
+                    results[mode][i][0] = cpu.get_gpr<uint64_t>(i);
+                    results[mode][i][1] = cpu.get_gpr<uint64_t>(i, 1);
+                }
+                results[mode][6][0] = cpu.get_LO();
+                results[mode][6][1] = cpu.get_LO1();
+                results[mode][7][0] = cpu.get_HI();
+                results[mode][7][1] = cpu.get_HI1();
+            }
+
+            if (memcmp(results[0], results[1], sizeof(results[0])))
+            {
+                if (!mismatches)
+                    test_output << "  " << EmotionDisasm::disasm_instr(*(uint32_t*)&BIOS[0], 0) << " differs\n";
+                mismatches++;
+            }
+        }
+
+        test_output << "  " << name << ": " << (mismatches ? "FAIL" : "ok") << "\n";
+        if (mismatches)
+            failed_ops++;
+    }
+    test_output << failed_ops << " ops differ from the interpreter\n";
+    test_output << "-- TEST END\n";
+    test_output.flush();
+
+    memcpy(BIOS, saved_bios, sizeof(saved_bios));
+    cpu.reset();
+}
@@ -0,0 +1,155 @@
+#include "../../emulator.hpp"
+#include "../testcheck.hpp"
+#include <cstring>
+#include <random>
+
+using namespace std;
+
+struct SpriteBlend
+{
+    const char* name;
+    bool alpha_blend, colclamp, pabe;
+};
+
+struct SpriteColor
+{
+    uint8_t r, g, b, a;
+};
+
+//The frame is a single 64x32 PSMCT32 page, the 32x32 PSMCT32 texture lives a few pages after it
+static const int FRAME_WIDTH = 64;
+static const int FRAME_HEIGHT = 32;
+static const int TEX_SIZE = 32;
+static const uint32_t FRAME_PAGE = 0;
+static const uint32_t TEX_PAGE = 20;
+
+//Host to local transfer of 32-bit pixels through HWREG
+static void upload(GraphicsSynthesizer& gs, uint32_t page, int width, int height, const vector<uint32_t>& pixels)
+{
+    uint64_t base = page * 32;
+    gs.write64(0x50, (base << 32) | (1ULL << 48));
+    gs.write64(0x51, 0);
+    gs.write64(0x52, (uint64_t)width | ((uint64_t)height << 32));
+    gs.write64(0x53, 0);
+    for (size_t i = 0; i < pixels.size(); i += 2)
+        gs.write64(0x54, pixels[i] | ((uint64_t)pixels[i + 1] << 32));
+}
+
+//Local to host transfer of the whole frame
+static vector<uint32_t> download_frame(GraphicsSynthesizer& gs)
+{
+    gs.write64(0x50, (uint64_t)(FRAME_PAGE * 32) | ((uint64_t)(FRAME_WIDTH / 64) << 16));
+    gs.write64(0x51, 0);
+    gs.write64(0x52, (uint64_t)FRAME_WIDTH | ((uint64_t)FRAME_HEIGHT << 32));
+    gs.write64(0x53, 1);
+    gs.request_gs_download();
+
+    vector<uint32_t> pixels;
+    while (pixels.size() < FRAME_WIDTH * FRAME_HEIGHT)
+    {
+        uint128_t quad;
+        bool have_data;
+        tie(quad, have_data) = gs.read_gs_download();
+        if (!have_data)
+            break;
+        for (int i = 0; i < 4; i++)
+            pixels.push_back(quad._u32[i]);
+    }
+    gs.wait_for_download();
+    return pixels;
+}
+
+//Draws the same textured sprites with the row-at-a-time sprite path and a pixel at a time, and compares
+//the frames pixel for pixel. Dithering stays off since the draw pixel JIT does not dither.
+void Emulator::test_gs_sprite()
+{
+    ofstream test_output("test_log.txt");
+
+    mt19937 rng(1234);
+    vector<uint32_t> texture(TEX_SIZE * TEX_SIZE), background(FRAME_WIDTH * FRAME_HEIGHT);
+    for (uint32_t& texel : texture)
+    {
+        //Saturated texels overflow Highlight along with a bright vertex color
+        texel = (uint32_t)rng();
+        if (!(rng() % 4))
+            texel = 0xFFFFFFFF;
+    }
+    for (uint32_t& pixel : background)
+        pixel = (uint32_t)rng();
+
+    const vector<SpriteBlend> blends =
+    {
+        {"no blending", false, true, false},
+        {"blending", true, true, false},
+        {"blending without COLCLAMP", true, false, false},
+        {"blending with PABE", true, true, true},
+    };
+
+    //Neutral, overflowing and dark vertex colors. A vertex alpha of 0xFF takes Highlight past 0xFF.
+    const vector<SpriteColor> colors = {{0x80, 0x80, 0x80, 0x80}, {0xFF, 0x40, 0xC0, 0xFF}, {0x10, 0x70, 0x30, 0x60}};
+
+    upload(gs, TEX_PAGE, TEX_SIZE, TEX_SIZE, texture);
+
+    //PRMODECONT, FOGCOL, ZBUF with ZMSK, TEST, SCISSOR, XYOFFSET, TEX1, CLAMP, FRAME and ALPHA = (Cs - Cd) * As + Cd
+    gs.write64(0x1A, 1);
+    gs.write64(0x3D, 0x203C90);
+    gs.write64(0x4E, (1ULL << 32) | 100);
+    gs.write64(0x47, 0);
+    gs.write64(0x40, (uint64_t)(FRAME_WIDTH - 1) << 16 | (uint64_t)(FRAME_HEIGHT - 1) << 48);
+    gs.write64(0x18, 0);
+    gs.write64(0x14, 0);
+    gs.write64(0x08, 0);
+    gs.write64(0x4C, (uint64_t)FRAME_PAGE | ((uint64_t)(FRAME_WIDTH / 64) << 16));
+    gs.write64(0x42, 0x44);
+    gs.write64(0x45, 0);
+    gs.write64(0x4A, 0);
+
+    test_output << "-- TEST BEGIN\n";
+    for (int tfx = 0; tfx < 4; tfx++)
+    {
+        for (int tcc = 0; tcc < 2; tcc++)
+        {
+            //TBP0, TBW = 1, PSMCT32, 32x32, TCC and TFX
+            gs.write64(0x06, (uint64_t)(TEX_PAGE * 32) | (1ULL << 14) | (5ULL << 26) | (5ULL << 30) |
+                             ((uint64_t)tcc << 34) | ((uint64_t)tfx << 35));
+            for (int fog = 0; fog < 2; fog++)
+            {
+                for (const SpriteBlend& blend : blends)
+                {
+                    gs.write64(0x46, blend.colclamp);
+                    gs.write64(0x49, blend.pabe);
+
+                    bool same = true;
+                    for (const SpriteColor& color : colors)
+                    {
+                        vector<uint32_t> frames[2];
+                        for (int spans = 0; spans < 2; spans++)
+                        {
+                            upload(gs, FRAME_PAGE, FRAME_WIDTH, FRAME_HEIGHT, background);
+                            gs.set_sprite_spans(spans);
+
+                            //Sprite with UV, TME, FGE and ABE. The texture is stretched by half along x.
+                            gs.write64(0x00, 6 | (1 << 4) | (fog << 5) | (blend.alpha_blend << 6) | (1 << 8));
+                            gs.write64(0x01, color.r | (color.g << 8) | (color.b << 16) | ((uint64_t)color.a << 24) |
+                                             (0x3F800000ULL << 32));
+                            gs.write64(0x03, 0);
+                            gs.write64(0x04, (3 << 4) | (2 << 20) | (0x60ULL << 56));
+                            gs.write64(0x03, (21 << 4) | (27 << 20));
+                            gs.write64(0x04, (45 << 4) | (29 << 20) | (0x60ULL << 56));
+                            frames[spans] = download_frame(gs);
+                        }
+                        same &= frames[0].size() == background.size() && frames[0] != background &&
+                                frames[0] == frames[1];
+                    }
+
+                    CHECK("TFX " + to_string(tfx) + (tcc ? ", RGBA" : ", RGB") + (fog ? ", fog, " : ", ") +
+                          blend.name, same);
+                }
+            }
+        }
+    }
+    test_output << "-- TEST END\n";
+    test_output.flush();
+
+    gs.set_sprite_spans(true);
+}
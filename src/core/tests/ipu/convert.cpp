@@ -0,0 +1,182 @@
+#include "../../emulator.hpp"
+#include "../testcheck.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace std;
+
+//The mpeg2decode reference IDCT the IPU used before it was vectorized
+static void scalar_IDCT(const double table[8][8], const int16_t* pUV, int16_t* pXY)
+{
+    double tmp[64];
+    for (int i = 0; i < 8; i++)
+    {
+        for (int j = 0; j < 8; j++)
+        {
+            double partial_product = 0.0;
+            for (int k = 0; k < 8; k++)
+                partial_product += table[k][j] * pUV[8 * i + k];
+            tmp[8 * i + j] = partial_product;
+        }
+    }
+
+    for (int j = 0; j < 8; j++)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            double partial_product = 0.0;
+            for (int k = 0; k < 8; k++)
+                partial_product += table[k][i] * tmp[8 * k + j];
+            pXY[8 * i + j] = (int16_t)(int)floor(partial_product + 0.5);
+        }
+    }
+}
+
+//The per-pixel CSC the IPU used before it was vectorized
+static void scalar_YCbCr_to_RGB32(const unsigned int* crcb_map, uint32_t TH0, uint32_t TH1,
+                                  const uint8_t* block, uint8_t* rgb32)
+{
+    const uint8_t* lum_block = block;
+    const uint8_t* cb_block = block + 0x100;
+    const uint8_t* cr_block = block + 0x140;
+
+    for (int index = 0; index < 0x100; index++)
+    {
+        float lum = lum_block[index];
+        float cb = cb_block[crcb_map[index]];
+        float cr = cr_block[crcb_map[index]];
+
+        float r = lum + 1.402f * (cr - 128);
+        float g = lum - 0.34414f * (cb - 128) - 0.71414f * (cr - 128);
+        float b = lum + 1.772f * (cb - 128);
+
+        r = min(max(r, 0.0f), 255.0f);
+        g = min(max(g, 0.0f), 255.0f);
+        b = min(max(b, 0.0f), 255.0f);
+
+        uint8_t alpha;
+        if (r < (float)TH0 && g < (float)TH0 && b < (float)TH0)
+            alpha = 0;
+        else if (r < (float)TH1 && g < (float)TH1 && b < (float)TH1)
+            alpha = 0x40;
+        else
+            alpha = 0x80;
+
+        rgb32[4 * index] = (uint8_t)r;
+        rgb32[4 * index + 1] = (uint8_t)g;
+        rgb32[4 * index + 2] = (uint8_t)b;
+        rgb32[4 * index + 3] = alpha;
+    }
+}
+
+static void scalar_RGB32_to_RGB16(const int8_t dither_mtx[4][4], const uint8_t* rgb32, uint16_t* rgb16,
+                                  bool dithering)
+{
+    for (int index = 0; index < 0x100; index++)
+    {
+        const int dither = dithering ? dither_mtx[(index >> 4) & 3][index & 3] : 0;
+        const int r = max(0, min(rgb32[4 * index] + dither, 255)) >> 3;
+        const int g = max(0, min(rgb32[4 * index + 1] + dither, 255)) >> 3;
+        const int b = max(0, min(rgb32[4 * index + 2] + dither, 255)) >> 3;
+        const int a = rgb32[4 * index + 3] == 0x40;
+        rgb16[index] = (uint16_t)(r | g << 5 | b << 10 | a << 15);
+    }
+}
+
+//Runs the SIMD IDCT and CSC kernels of the IPU and their scalar references on the same random blocks,
+//including coefficients and colors that saturate, and checks that the outputs are identical.
+void Emulator::test_ipu_convert()
+{
+    ofstream test_output("test_log.txt");
+
+    mt19937 rng(1234);
+    const int BLOCKS = 2000;
+
+    test_output << "-- TEST BEGIN\n";
+
+    //Dense, sparse, DC-only, the 12-bit coefficient range and the edges of the 16-bit range
+    const char* idct_kinds[] = {"dense", "sparse", "DC only", "12-bit limits", "16-bit limits"};
+    for (int kind = 0; kind < 5; kind++)
+    {
+        bool same = true;
+        for (int n = 0; n < BLOCKS; n++)
+        {
+            alignas(16) int16_t coeffs[64] = {}, simd[64], scalar[64];
+            for (int i = 0; i < 64; i++)
+            {
+                switch (kind)
+                {
+                    case 0:
+                        coeffs[i] = (int16_t)((int)(rng() % 4096) - 2048);
+                        break;
+                    case 1:
+                        if (!(rng() % 8))
+                            coeffs[i] = (int16_t)((int)(rng() % 512) - 256);
+                        break;
+                    case 2:
+                        if (!i)
+                            coeffs[i] = (int16_t)((int)(rng() % 4096) - 2048);
+                        break;
+                    case 3:
+                        coeffs[i] = (rng() & 1) ? 2047 : -2048;
+                        break;
+                    default:
+                        coeffs[i] = (rng() & 1) ? INT16_MAX : INT16_MIN;
+                        break;
+                }
+            }
+            ipu.perform_IDCT(coeffs, simd);
+            scalar_IDCT(ipu.IDCT_table, coeffs, scalar);
+            same &= !memcmp(simd, scalar, sizeof(simd));
+        }
+        CHECK(string("IDCT, ") + idct_kinds[kind], same);
+    }
+
+    uint32_t old_TH0 = ipu.TH0, old_TH1 = ipu.TH1;
+
+    //Random samples, and samples at 0 and 255 that push every channel past the clamp
+    const char* csc_kinds[] = {"random", "saturating"};
+    for (int kind = 0; kind < 2; kind++)
+    {
+        bool same_rgb32 = true, same_rgb16 = true;
+        for (int n = 0; n < BLOCKS; n++)
+        {
+            alignas(16) uint8_t block[0x180], simd[4 * 0x100], scalar[4 * 0x100];
+            for (uint8_t& sample : block)
+                sample = kind ? ((rng() & 1) ? 0xFF : 0x00) : (uint8_t)rng();
+
+            ipu.TH0 = (uint32_t)(rng() % 0x100);
+            ipu.TH1 = ipu.TH0 + (uint32_t)(rng() % (0x101 - ipu.TH0));
+            ipu.convert_YCbCr_to_RGB32(block, simd);
+            scalar_YCbCr_to_RGB32(ipu.crcb_map, ipu.TH0, ipu.TH1, block, scalar);
+            same_rgb32 &= !memcmp(simd, scalar, sizeof(simd));
+
+            //RGB16 is checked on the converted block and on random colors with random alphas
+            if (n & 1)
+            {
+                for (uint8_t& byte : scalar)
+                    byte = kind ? ((rng() & 1) ? 0xFF : 0x00) : (uint8_t)rng();
+                for (int i = 0; i < 0x100; i++)
+                    scalar[4 * i + 3] = (rng() & 1) ? 0x40 : (uint8_t)rng();
+            }
+
+            for (int dithering = 0; dithering < 2; dithering++)
+            {
+                alignas(16) uint16_t simd16[0x100], scalar16[0x100];
+                ipu.convert_RGB32_to_RGB16(scalar, simd16, dithering);
+                scalar_RGB32_to_RGB16(ipu.dither_mtx, scalar, scalar16, dithering);
+                same_rgb16 &= !memcmp(simd16, scalar16, sizeof(simd16));
+            }
+        }
+        CHECK(string("CSC to RGB32, ") + csc_kinds[kind], same_rgb32);
+        CHECK(string("CSC to RGB16, ") + csc_kinds[kind], same_rgb16);
+    }
+
+    ipu.TH0 = old_TH0;
+    ipu.TH1 = old_TH1;
+
+    test_output << "-- TEST END\n";
+    test_output.flush();
+}
@@ -0,0 +1,101 @@
+#include "../../emulator.hpp"
+#include "../../jitcommon/jitcache.hpp"
+#include "../../jitcommon/jitprofiler.hpp"
+#include "../testcheck.hpp"
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+//Reads back the records the EE heap reported for its prologue and a block
+void Emulator::test_jit_profiler()
+{
+    ofstream test_output("test_log.txt");
+
+    test_output << "-- TEST BEGIN\n";
+#ifdef __linux__
+    JitProfiler::enable(JitProfiler::PERF_MAP | JitProfiler::JITDUMP);
+
+    const uint8_t code[] = {0x48, 0x89, 0xC8, 0xC3}; //mov rax, rcx; ret
+    JitBlock block("EE");
+    for (uint8_t byte : code)
+        block.write<uint8_t>(byte);
+
+    EEJitHeap heap;
+    heap.insert_block(0xFFFFFFFF, &block);
+    EEJitBlockRecord* record = heap.insert_block(0x001F4A80, &block);
+
+    JitProfiler::shutdown();
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/perf-%d.map", getpid());
+    ifstream perf_map(path);
+    string line, expected;
+    snprintf(path, sizeof(path), "%llx %llx EE_001F4A80", (unsigned long long)record->code_start,
+             (unsigned long long)sizeof(code));
+    expected = path;
+    bool found_prologue = false, found_block = false;
+    while (getline(perf_map, line))
+    {
+        found_prologue |= line.find(" EE_prologue") != string::npos;
+        found_block |= line == expected;
+    }
+    test_output << "perf map:\n";
+    CHECK("prologue", found_prologue);
+    CHECK("block", found_block);
+
+    //Header: magic, version, total_size, elf_mach, pad1, pid, timestamp, flags
+    snprintf(path, sizeof(path), "/tmp/jit-%d.dump", getpid());
+    ifstream jitdump(path, ios::binary);
+    vector<char> dump((istreambuf_iterator<char>(jitdump)), istreambuf_iterator<char>());
+    uint32_t header[6] = {};
+    if (dump.size() >= 40)
+        memcpy(header, dump.data(), sizeof(header));
+    test_output << "jitdump:\n";
+    CHECK("magic", header[0] == 0x4A695444);
+    CHECK("version", header[1] == 1);
+    CHECK("header size", header[2] == 40);
+    CHECK("machine", header[3] == 62);
+    CHECK("pid", header[5] == (uint32_t)getpid());
+
+    //Code load records: id, total_size, timestamp, pid, tid, vma, code_addr, code_size, code_index,
+    //then the name and the code bytes
+    size_t pos = header[2];
+    int loads = 0;
+    bool block_ok = false;
+    while (pos + 56 <= dump.size())
+    {
+        uint32_t id, total_size;
+        uint64_t code_addr, code_size;
+        memcpy(&id, &dump[pos], 4);
+        memcpy(&total_size, &dump[pos + 4], 4);
+        memcpy(&code_addr, &dump[pos + 32], 8);
+        memcpy(&code_size, &dump[pos + 40], 8);
+        if (!total_size || pos + total_size > dump.size())
+            break;
+
+        const char* name = &dump[pos + 56];
+        if (id == 0)
+        {
+            loads++;
+            if (!strcmp(name, "EE_001F4A80"))
+            {
+                const char* bytes = name + strlen(name) + 1;
+                block_ok = code_addr == (uint64_t)record->code_start && code_size == sizeof(code) &&
+                        total_size == 56 + strlen(name) + 1 + sizeof(code) && !memcmp(bytes, code, sizeof(code));
+            }
+        }
+        pos += total_size;
+    }
+    CHECK("code loads", loads == 2);
+    CHECK("block", block_ok);
+#else
+    test_output << "  perf maps and jitdump are Linux only\n";
+#endif
+    test_output << "-- TEST END\n";
+    test_output.flush();
+}
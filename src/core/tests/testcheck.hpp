@@ -0,0 +1,8 @@
+#ifndef TESTCHECK_HPP
+#define TESTCHECK_HPP
+
+//Writes one named result of a test to test_output
+#define CHECK(name, cond) \
+    test_output << "  " << name << ": " << ((cond) ? "ok" : "FAIL") << "\n"
+
+#endif // TESTCHECK_HPP
@@ -0,0 +1,103 @@
+#include "../../emulator.hpp"
+#include "../../ee/vu_jittrans.hpp"
+#include "../testcheck.hpp"
+#include <memory>
+
+using namespace std;
+
+static const uint32_t NOP_LOWER = 0x8000033C;
+static const uint32_t NOP_UPPER = 0x000002FF;
+static const uint32_t ADD_UPPER = (0xF << 21) | (3 << 16) | (2 << 11) | (1 << 6) | 0x28; //ADD.xyzw vf1, vf2, vf3
+static const uint32_t FMAND_LOWER = (0x1Au << 25) | (2 << 16) | (1 << 11); //FMAND vi1, vi2
+
+//Counts the MAC flag updates emitted for the VU1 block at address 0
+static int mac_flag_updates(VectorUnit& vu, VU_JitTranslator& trans)
+{
+    trans.reset_instr_info();
+    vu.set_PC(0);
+    IR::Block block = trans.translate(vu, vu.get_instr_mem(), 0xFFFFFFFF);
+
+    int updates = 0;
+    while (block.get_instruction_count())
+    {
+        if (block.get_next_instr().op == IR::Opcode::UpdateMacFlags)
+            updates++;
+    }
+    return updates;
+}
+
+//Ten ADDs, then a B to 0x100 whose target decides what the flags can reach
+static void write_adds_and_branch(VectorUnit& vu)
+{
+    for (int i = 0; i < 10; i++)
+    {
+        vu.write_instr<uint32_t>(i * 8, NOP_LOWER);
+        vu.write_instr<uint32_t>(i * 8 + 4, ADD_UPPER);
+    }
+    vu.write_instr<uint32_t>(80, (0x20u << 25) | ((0x100 - 88) / 8));
+    vu.write_instr<uint32_t>(84, NOP_UPPER);
+    vu.write_instr<uint32_t>(88, NOP_LOWER);
+    vu.write_instr<uint32_t>(92, NOP_UPPER);
+}
+
+//Writes lower/upper pairs, each pair being one instruction
+static void write_instrs(VectorUnit& vu, uint16_t addr, const uint32_t* instrs, int count)
+{
+    for (int i = 0; i < count; i++)
+        vu.write_instr<uint32_t>(addr + i * 4, instrs[i]);
+}
+
+//Checks which VU1 blocks keep their flags up to date, by whether a flag read or the end of the
+//microprogram is reachable from them before later MAC writes overwrite the result. Of the ten
+//ADDs, the three at the end of the block keep their updates; the ones at the start are overwritten
+//by the rest of the chain before anything can read them.
+void Emulator::test_vu_flag_liveness()
+{
+    ofstream test_output("test_log.txt");
+    unique_ptr<VU_JitTranslator> trans(new VU_JitTranslator);
+
+    test_output << "-- TEST BEGIN\n";
+    vu1.reset();
+    write_adds_and_branch(vu1);
+
+    //0x100: B to itself, nothing can read the flags
+    const uint32_t spin[] = {(0x20u << 25) | 0x7FF, NOP_UPPER, NOP_LOWER, NOP_UPPER};
+    write_instrs(vu1, 0x100, spin, 4);
+    CHECK("endless loop", mac_flag_updates(vu1, *trans) == 0);
+
+    //0x100: E-bit, the flags persist into the next microprogram
+    const uint32_t ebit[] = {NOP_LOWER, NOP_UPPER | (1 << 30), NOP_LOWER, NOP_UPPER};
+    write_instrs(vu1, 0x100, ebit, 4);
+    CHECK("E-bit", mac_flag_updates(vu1, *trans) == 3);
+
+    //0x100: T-bit, the microprogram ends if FBRST enables it
+    const uint32_t tbit[] = {NOP_LOWER, NOP_UPPER | (1 << 27), (0x20u << 25) | 0x7FF, NOP_UPPER,
+                             NOP_LOWER, NOP_UPPER};
+    write_instrs(vu1, 0x100, tbit, 6);
+    CHECK("T-bit", mac_flag_updates(vu1, *trans) == 3);
+
+    //0x100: FMAND, then the endless loop
+    const uint32_t fmand[] = {FMAND_LOWER, NOP_UPPER, (0x20u << 25) | 0x7FF, NOP_UPPER, NOP_LOWER, NOP_UPPER};
+    write_instrs(vu1, 0x100, fmand, 6);
+    CHECK("read at branch target", mac_flag_updates(vu1, *trans) == 3);
+
+    //FMAND past the delay slot, as the pass follows the fallthrough of every branch
+    write_instrs(vu1, 0x100, spin, 4);
+    vu1.write_instr<uint32_t>(96, FMAND_LOWER);
+    vu1.write_instr<uint32_t>(100, NOP_UPPER);
+    CHECK("read on the fallthrough", mac_flag_updates(vu1, *trans) == 3);
+
+    //0x100: four more ADDs, then the E-bit. Nothing from the first block makes it to the end
+    const uint32_t adds_ebit[] = {NOP_LOWER, ADD_UPPER, NOP_LOWER, ADD_UPPER, NOP_LOWER, ADD_UPPER,
+                                  NOP_LOWER, ADD_UPPER, NOP_LOWER, NOP_UPPER | (1 << 30), NOP_LOWER, NOP_UPPER};
+    write_instrs(vu1, 0x100, adds_ebit, 12);
+    vu1.write_instr<uint32_t>(96, NOP_LOWER);
+    CHECK("overwritten before the E-bit", mac_flag_updates(vu1, *trans) == 0);
+
+    //Unless a path gets to a read first
+    vu1.write_instr<uint32_t>(96, FMAND_LOWER);
+    CHECK("overwritten on one path only", mac_flag_updates(vu1, *trans) == 3);
+
+    test_output << "-- TEST END\n";
+    test_output.flush();
+}
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include "trace.hpp"
+#include "errors.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+struct RingHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t record_count;
+};
+
+static const char* CATEGORY_NAMES[Trace::CATEGORY_COUNT] =
+{
+    "core", "ee", "iop", "vu", "vif", "gif", "gs", "ipu", "dmac", "iop_dma", "spu", "cdvd", "sif"
+};
+
+static const char* LEVEL_NAMES[] =
+{
+    "error", "warn", "info", "debug"
+};
+
+std::atomic<int> Trace::levels[Trace::CATEGORY_COUNT];
+std::atomic<int> Trace::ring_level(-1);
+thread_local const Trace::GuestClock* Trace::guest_clock = nullptr;
+
+static std::mutex sink_mutex;
+static std::vector<Trace::RingRecord> ring;
+static std::size_t ring_next = 0;
+static uint64_t ring_written = 0;
+
+//Arrays of atomics can't be brace initialized before C++17
+static struct LevelInitializer
+{
+    LevelInitializer()
+    {
+        Trace::set_all_levels(Trace::LEVEL_INFO);
+    }
+} level_initializer;
+
+static uint64_t read_host_tsc()
+{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+void Trace::set_level(Category category, Level level)
+{
+    levels[category].store(level, std::memory_order_relaxed);
+}
+
+void Trace::set_all_levels(Level level)
+{
+    for (int i = 0; i < CATEGORY_COUNT; i++)
+        set_level((Category)i, level);
+}
+
+static bool parse_name(const char* name, std::size_t len, const char** names, int count, int& index)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strlen(names[i]) == len && !strncmp(name, names[i], len))
+        {
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Trace::parse_levels(const char* spec)
+{
+    while (*spec)
+    {
+        const char* end = strchr(spec, ',');
+        if (!end)
+            end = spec + strlen(spec);
+        const char* equals = (const char*)memchr(spec, '=', end - spec);
+        if (!equals)
+        {
+            Errors::print_warning("[Trace] Expected category=level, got %.*s\n", (int)(end - spec), spec);
+            return false;
+        }
+
+        int level;
+        if (!parse_name(equals + 1, end - equals - 1, LEVEL_NAMES, 4, level))
+        {
+            Errors::print_warning("[Trace] Unknown level %.*s\n", (int)(end - equals - 1), equals + 1);
+            return false;
+        }
+
+        int category;
+        if (equals - spec == 3 && !strncmp(spec, "all", 3))
+            set_all_levels((Level)level);
+        else if (parse_name(spec, equals - spec, CATEGORY_NAMES, CATEGORY_COUNT, category))
+            set_level((Category)category, (Level)level);
+        else
+        {
+            Errors::print_warning("[Trace] Unknown category %.*s\n", (int)(equals - spec), spec);
+            return false;
+        }
+
+        spec = *end ? end + 1 : end;
+    }
+    return true;
+}
+
+const char* Trace::get_category_name(Category category)
+{
+    return CATEGORY_NAMES[category];
+}
+
+void Trace::enable_ring(std::size_t records, Level level)
+{
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    ring.assign(records, RingRecord());
+    ring_next = 0;
+    ring_written = 0;
+    ring_level = level;
+}
+
+void Trace::disable_ring()
+{
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    ring_level = -1;
+    std::vector<RingRecord>().swap(ring);
+    ring_next = 0;
+    ring_written = 0;
+}
+
+bool Trace::is_ring_enabled()
+{
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    return !ring.empty();
+}
+
+bool Trace::dump_ring(const char* path)
+{
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        Errors::print_warning("[Trace] Failed to open %s\n", path);
+        return false;
+    }
+
+    std::size_t count = ring_written < ring.size() ? ring_written : ring.size();
+    RingHeader header;
+    memcpy(header.magic, "DOBTRACE", sizeof(header.magic));
+    header.version = 1;
+    header.record_size = sizeof(RingRecord);
+    header.record_count = count;
+    fwrite(&header, sizeof(header), 1, file);
+
+    //Once the ring has wrapped, the oldest record is the next one to be overwritten
+    std::size_t start = count < ring.size() ? 0 : ring_next;
+    for (std::size_t i = 0; i < count; i++)
+        fwrite(&ring[(start + i) % ring.size()], sizeof(RingRecord), 1, file);
+    fclose(file);
+    return true;
+}
+
+void Trace::log(Category category, Level level, const char* fmt, ...)
+{
+    //Either sink may be the only one that wants the message
+    bool print = level <= levels[category].load(std::memory_order_relaxed);
+    uint64_t cycle = guest_clock ? guest_clock->load(std::memory_order_relaxed) : 0;
+
+    char message[ERROR_STRING_MAX_LENGTH + 1];
+    va_list args;
+    va_start(args, fmt);
+    int length = vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+    if (length < 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    if (print)
+        fputs(message, stdout);
+
+    if (!ring.empty() && level <= ring_level.load(std::memory_order_relaxed))
+    {
+        RingRecord& record = ring[ring_next];
+        record.guest_cycle = cycle;
+        record.host_tsc = read_host_tsc();
+        record.category = category;
+        record.level = level;
+        record.length = (uint16_t)std::min((std::size_t)length, sizeof(record.message) - 1);
+        memcpy(record.message, message, record.length);
+        record.message[record.length] = 0;
+
+        ring_next = (ring_next + 1) % ring.size();
+        ring_written++;
+    }
+}
@@ -0,0 +1,132 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+Categorized trace messages, replacing raw printf calls in the devices.
+
+Every message has a category and a level. Levels above TRACE_MAX_LEVEL are compiled out, which
+by default drops DEBUG messages from release builds, so per-register and per-transfer traces
+cost nothing there. The remaining levels are filtered per category at runtime, with INFO as the
+default, so a debug build stays as quiet as a release build until a category is turned up.
+
+Messages go to stdout and, when enabled, to a ring of fixed size binary records stamped with the
+guest EE cycle and the host TSC. The ring has a level of its own, so it can keep DEBUG messages
+from the last moments before a hang or crash without the cost of printing them, and is written
+out with dump_ring. Devices run on the emulator thread and the GS on its own, so the sinks are
+locked.
+**/
+
+#define TRACE_LEVEL_ERROR 0
+#define TRACE_LEVEL_WARN 1
+#define TRACE_LEVEL_INFO 2
+#define TRACE_LEVEL_DEBUG 3
+
+#ifndef TRACE_MAX_LEVEL
+#ifdef NDEBUG
+#define TRACE_MAX_LEVEL TRACE_LEVEL_INFO
+#else
+#define TRACE_MAX_LEVEL TRACE_LEVEL_DEBUG
+#endif
+#endif
+
+#ifdef __GNUC__
+#define TRACE_PRINTF_FORMAT __attribute__((format(printf, 3, 4)))
+#else
+#define TRACE_PRINTF_FORMAT
+#endif
+
+namespace Trace
+{
+    enum Category
+    {
+        CORE,
+        EE,
+        IOP,
+        VU,
+        VIF,
+        GIF,
+        GS,
+        IPU,
+        DMAC,
+        IOP_DMA,
+        SPU,
+        CDVD,
+        SIF,
+        CATEGORY_COUNT
+    };
+
+    enum Level
+    {
+        LEVEL_ERROR = TRACE_LEVEL_ERROR,
+        LEVEL_WARN = TRACE_LEVEL_WARN,
+        LEVEL_INFO = TRACE_LEVEL_INFO,
+        LEVEL_DEBUG = TRACE_LEVEL_DEBUG
+    };
+
+    struct RingRecord
+    {
+        uint64_t guest_cycle;
+        uint64_t host_tsc;
+        uint8_t category;
+        uint8_t level;
+        uint16_t length;
+        char message[108];
+    };
+
+    //EE cycle count that records are stamped with. Each emulator instance keeps one, which both its
+    //emulator thread and its GS thread point at.
+    typedef std::atomic<uint64_t> GuestClock;
+
+    extern std::atomic<int> levels[CATEGORY_COUNT];
+    extern std::atomic<int> ring_level; //-1 while the ring is disabled
+    extern thread_local const GuestClock* guest_clock;
+
+    void set_level(Category category, Level level);
+    void set_all_levels(Level level);
+
+    //Parses a comma separated list of category=level, e.g. "spu=debug,cdvd=warn". "all" sets
+    //every category.
+    bool parse_levels(const char* spec);
+
+    const char* get_category_name(Category category);
+
+    //Allocates a ring of the given number of records, discarding any previous contents. The ring
+    //takes every category's messages up to level, whatever is printed.
+    void enable_ring(std::size_t records, Level level = LEVEL_DEBUG);
+    void disable_ring();
+    bool is_ring_enabled();
+
+    //Writes the ring oldest record first, after a header with the record count and size
+    bool dump_ring(const char* path);
+
+    void log(Category category, Level level, const char* fmt, ...) TRACE_PRINTF_FORMAT;
+
+    inline bool is_enabled(Category category, Level level)
+    {
+        return level <= levels[category].load(std::memory_order_relaxed) ||
+               level <= ring_level.load(std::memory_order_relaxed);
+    }
+
+    //Per thread, as each emulator instance and its GS run on threads of their own
+    inline void set_guest_clock(const GuestClock* clock)
+    {
+        guest_clock = clock;
+    }
+};
+
+#define TRACE(category, level, ...) \
+    do \
+    { \
+        if ((level) <= TRACE_MAX_LEVEL && Trace::is_enabled(category, level)) \
+            Trace::log(category, level, __VA_ARGS__); \
+    } while (0)
+
+#define TRACE_ERROR(category, ...) TRACE(category, Trace::LEVEL_ERROR, __VA_ARGS__)
+#define TRACE_WARN(category, ...) TRACE(category, Trace::LEVEL_WARN, __VA_ARGS__)
+#define TRACE_INFO(category, ...) TRACE(category, Trace::LEVEL_INFO, __VA_ARGS__)
+#define TRACE_DEBUG(category, ...) TRACE(category, Trace::LEVEL_DEBUG, __VA_ARGS__)
+
+#endif // TRACE_HPP
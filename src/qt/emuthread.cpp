@@ -1,5 +1,4 @@
 #include <cmath>
-#include <chrono>
 #include <fstream>
 
 #include "emuthread.hpp"
@@ -47,6 +46,21 @@ void EmuThread::set_skip_BIOS_hack(SKIP_HACK skip)
     wait_for_lock([=]() { e.set_skip_BIOS_hack(skip); } );
 }
 
+void EmuThread::set_frame_queue_depth(int depth)
+{
+    wait_for_lock([=]() { e.set_frame_queue_depth(depth); } );
+}
+
+void EmuThread::set_frame_limit(bool limited)
+{
+    wait_for_lock([=]() { e.set_frame_limit(limited); } );
+}
+
+void EmuThread::set_max_frameskip(int frames)
+{
+    wait_for_lock([=]() { e.set_max_frameskip(frames); } );
+}
+
 void EmuThread::set_ee_mode(CPU_MODE mode)
 {
     wait_for_lock([=]() {  e.set_ee_mode(mode); } );
@@ -137,6 +151,25 @@ void EmuThread::gsdump_single_frame()
     wait_for_lock([=]() { e.request_gsdump_single_frame(); } );
 }
 
+void EmuThread::start_profiler(int interval_us)
+{
+    wait_for_lock([=]() { e.start_profiler(interval_us); } );
+}
+
+bool EmuThread::stop_profiler(const char* path)
+{
+    bool success = false;
+
+    wait_for_lock([=, &success]()
+    {
+        e.stop_profiler();
+        if (path)
+            success = e.write_profile(path);
+    });
+
+    return success;
+}
+
 GSMessage& EmuThread::get_next_gsdump_message()
 {
     if(!buffered_gs_messages) {
@@ -183,11 +216,13 @@ void EmuThread::gsdump_run()
                 {
                     printf("gsdump frame render\n");
                     e.get_gs().render_CRT();
+                    e.get_gs().finish_frames();
+                    uint32_t* frame = e.get_gs().get_framebuffer();
                     int w, h, new_w, new_h;
                     e.get_inner_resolution(w, h);
                     e.get_resolution(new_w, new_h);
 
-                    emit completed_frame(e.get_gs().get_framebuffer(), w, h, new_w, new_h);
+                    emit completed_frame(frame, w, h, new_w, new_h);
                     printf("gsdump frame render complete\n");
                     pause(PAUSE_EVENT::FRAME_ADVANCE);
                     return;
@@ -243,21 +278,16 @@ void EmuThread::run()
             {
                 QMutexLocker locker(&emu_mutex);
                 e.run();
+
+                //The frame presented can be an older one than was just emulated, and its resolution goes with it
+                uint32_t* frame = e.get_framebuffer();
                 int w, h, new_w, new_h;
                 e.get_inner_resolution(w, h);
                 e.get_resolution(new_w, new_h);
-                emit completed_frame(e.get_framebuffer(), w, h, new_w, new_h);
+                emit completed_frame(frame, w, h, new_w, new_h);
 
-                //Update FPS
-                double FPS;
-                do
-                {
-                    chrono::system_clock::time_point now = chrono::system_clock::now();
-                    chrono::duration<double> elapsed_seconds = now - old_frametime;
-                    FPS = 1.0 / elapsed_seconds.count();
-                } while (FPS > 60.0);
-                old_frametime = chrono::system_clock::now();
-                emit update_FPS(FPS);
+                //The core paces itself, this only reports how fast it's going
+                emit update_FPS(e.get_frame_stats().fps);
             }
             catch (non_fatal_error &error)
             {
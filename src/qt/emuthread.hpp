@@ -1,7 +1,6 @@
 #ifndef EMUTHREAD_HPP
 #define EMUTHREAD_HPP
 
-#include <chrono>
 
 #include <QMutex>
 #include <QThread>
@@ -30,7 +29,6 @@ class EmuThread : public QThread
         QMutex emu_mutex;
         Emulator e;
 
-        std::chrono::system_clock::time_point old_frametime;
         std::ifstream gsdump;
         std::atomic_bool gsdump_reading;
         std::atomic_bool block_run_loop;
@@ -47,6 +45,9 @@ class EmuThread : public QThread
 
         void set_skip_BIOS_hack(SKIP_HACK skip);
         void set_wavout(bool state);
+        void set_frame_queue_depth(int depth);
+        void set_frame_limit(bool limited);
+        void set_max_frameskip(int frames);
         void set_ee_mode(CPU_MODE mode);
         void set_vu0_mode(CPU_MODE mode);
         void set_vu1_mode(CPU_MODE mode);
@@ -60,6 +61,8 @@ class EmuThread : public QThread
         bool gsdump_read(const char* name);
         void gsdump_write_toggle();
         void gsdump_single_frame();
+        void start_profiler(int interval_us);
+        bool stop_profiler(const char* path); //A null path discards the profile
         GSMessage& get_next_gsdump_message();
         bool gsdump_eof();
         std::atomic_bool frame_advance;
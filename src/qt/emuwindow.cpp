@@ -18,6 +18,9 @@
 #include "gamelistwidget.hpp"
 #include "bios.hpp"
 
+#include "../core/jitcommon/jitprofiler.hpp"
+#include "../core/trace.hpp"
+
 #include "arg.h"
 
 using namespace std;
@@ -143,6 +146,16 @@ int EmuWindow::init(int argc, char** argv)
         case 'g':
             gsdump = ARGF();
             break;
+        case 'p':
+            JitProfiler::enable(JitProfiler::PERF_MAP);
+            break;
+        case 'j':
+            JitProfiler::enable(JitProfiler::JITDUMP);
+            break;
+        case 't':
+            if (!Trace::parse_levels(ARGF()))
+                return 1;
+            break;
         case 'h':
         default:
             printf("usage: %s [options]\n\n", argv0);
@@ -152,6 +165,9 @@ int EmuWindow::init(int argc, char** argv)
             printf("-h\t\tshow this message\n");
             printf("-s\t\tskip BIOS\n");
             printf("-g {.GSD}\t\trun a gsdump\n");
+            printf("-p\t\twrite /tmp/perf-<pid>.map for perf\n");
+            printf("-j\t\twrite a perf jitdump to /tmp\n");
+            printf("-t {CAT=LEVEL,...}\tset trace levels, e.g. all=warn,spu=debug\n");
             return 1;
     } ARGEND
 
@@ -174,6 +190,7 @@ int EmuWindow::init(int argc, char** argv)
 EmuWindow::~EmuWindow()
 {
     emu_thread.wait();
+    JitProfiler::shutdown();
 }
 
 
@@ -193,6 +210,10 @@ int EmuWindow::load_exec(const char* file_name, bool skip_BIOS)
     if (!Settings::instance().memcard_path.isEmpty())
         emu_thread.load_memcard(0, Settings::instance().memcard_path.toStdString().c_str());
 
+    emu_thread.set_frame_queue_depth(Settings::instance().frame_queue_depth);
+    emu_thread.set_frame_limit(Settings::instance().frame_limit);
+    emu_thread.set_max_frameskip(Settings::instance().max_frameskip);
+
     QString ext = file_info.suffix();
     if(QString::compare(ext, "elf", Qt::CaseInsensitive) == 0)
     {
@@ -397,6 +418,41 @@ void EmuWindow::create_menu()
     });
 
 
+    auto profiler_action = new QAction(tr("Guest &Profiler"), this);
+    profiler_action->setCheckable(true);
+    connect(profiler_action, &QAction::triggered, this, [=] (){
+        if (profiler_action->isChecked())
+        {
+            emu_thread.start_profiler(1000);
+            return;
+        }
+
+        QString path = QFileDialog::getSaveFileName(
+            this, tr("Save profile as collapsed stacks"), "profile.folded"
+        );
+        if (path.isEmpty())
+            emu_thread.stop_profiler(nullptr);
+        else
+            emu_thread.stop_profiler(path.toLocal8Bit().constData());
+    });
+
+    auto trace_ring_action = new QAction(tr("&Trace Ring Buffer"), this);
+    trace_ring_action->setCheckable(true);
+    connect(trace_ring_action, &QAction::triggered, this, [=] (){
+        if (trace_ring_action->isChecked())
+        {
+            Trace::enable_ring(1 << 16);
+            return;
+        }
+
+        QString path = QFileDialog::getSaveFileName(
+            this, tr("Save trace ring"), "trace.bin"
+        );
+        if (!path.isEmpty())
+            Trace::dump_ring(path.toLocal8Bit().constData());
+        Trace::disable_ring();
+    });
+
     auto shutdown_action = new QAction(tr("&Shutdown"), this);
     connect(shutdown_action, &QAction::triggered, this, [=]() {
         emu_thread.pause(PAUSE_EVENT::GAME_NOT_LOADED);
@@ -411,6 +467,8 @@ void EmuWindow::create_menu()
     emulation_menu->addSeparator();
     emulation_menu->addAction(frame_action);
     emulation_menu->addAction(wavoutput_action);
+    emulation_menu->addAction(profiler_action);
+    emulation_menu->addAction(trace_ring_action);
     emulation_menu->addSeparator();
     emulation_menu->addAction(shutdown_action);
 
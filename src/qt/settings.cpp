@@ -38,6 +38,9 @@ void Settings::reset()
     rom_directories_to_remove = QStringList();
     memcard_path = qsettings().value("memcard_path", "").toString();
     scaling_factor = qsettings().value("ui_scaling_factor", 1).toInt();
+    frame_queue_depth = qsettings().value("frame_queue_depth", 2).toInt();
+    max_frameskip = qsettings().value("max_frameskip", 0).toInt();
+    frame_limit = qsettings().value("frame_limit", true).toBool();
     d_theme = qsettings().value("Dark Theme", true).toBool();
     l_theme = qsettings().value("Light Theme", false).toBool();
 
@@ -74,6 +77,9 @@ void Settings::save()
     qsettings().setValue("screenshot_directory", screenshot_directory);
     qsettings().setValue("memcard_path", memcard_path);
     qsettings().setValue("ui_scaling_factor", scaling_factor);
+    qsettings().setValue("frame_queue_depth", frame_queue_depth);
+    qsettings().setValue("max_frameskip", max_frameskip);
+    qsettings().setValue("frame_limit", frame_limit);
     qsettings().setValue("Dark Theme", d_theme);
     qsettings().setValue("Light Theme", l_theme);
     qsettings().sync();
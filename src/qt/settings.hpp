@@ -29,10 +29,13 @@ class Settings final : public QObject
         QStringList recent_roms;
 
         int scaling_factor;
+        int frame_queue_depth;
+        int max_frameskip;
 
         bool vu0_jit_enabled;
         bool vu1_jit_enabled;
         bool ee_jit_enabled;
+        bool frame_limit;
         bool d_theme;
         bool l_theme;
 